@@ -0,0 +1,564 @@
+#include "app_local_ctrl.h"
+#include <esp_log.h>
+#include <esp_random.h>
+#include <esp_vfs_eventfd.h>
+#include <nvs_flash.h>
+#include <mdns.h>
+#include <cbor.h>
+#include <qrcode.h>
+#include <mbedtls/md.h>
+#include <lwip/sockets.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <unistd.h>
+
+#define LOCAL_CTRL_TASK_STACK   4096
+#define LOCAL_CTRL_EXEC_DEPTH   8
+
+#define LC_DIR_CLIENT           'C'
+#define LC_DIR_HUB              'H'
+
+typedef struct {
+    int fd;
+    bool authed;
+    bool subscribed;
+    uint8_t nonce[LOCAL_CTRL_NONCE_LEN];
+    uint8_t session[32];
+    uint32_t rx_ctr;
+    uint32_t tx_ctr;
+    uint8_t rx[2 + LOCAL_CTRL_MAX_FRAME + LOCAL_CTRL_TAG_LEN];
+    size_t rx_len;
+    uint8_t tx[LOCAL_CTRL_TX_BUF];
+    size_t tx_len;
+} lc_client_t;
+
+typedef struct {
+    int op;
+    int seq;
+    int dev;
+    int val;
+    bool has_mac;
+    uint8_t mac[32];
+} lc_req_t;
+
+typedef struct {
+    app_dev_t dev;
+    int value;
+} lc_exec_t;
+
+static lc_client_t s_clients[LOCAL_CTRL_MAX_CLIENTS];
+static const esp_rmaker_param_t *s_bound[APP_DEV_MAX];
+static atomic_uint s_dirty;
+static int s_event_fd = -1;
+static QueueHandle_t s_exec_queue;
+
+static uint8_t s_key[LOCAL_CTRL_KEY_LEN];
+
+// --- KEY & AUTH ---
+
+static void key_load(void) {
+    nvs_handle_t h;
+    if (nvs_open("storage", NVS_READWRITE, &h) == ESP_OK) {
+        size_t len = sizeof(s_key);
+        if (nvs_get_blob(h, "lc_key", s_key, &len) != ESP_OK || len != sizeof(s_key)) {
+            esp_fill_random(s_key, sizeof(s_key));
+            nvs_set_blob(h, "lc_key", s_key, sizeof(s_key));
+            nvs_commit(h);
+            ESP_LOGI(TAG, "Generated new local control key");
+        }
+        nvs_close(h);
+    } else {
+        esp_fill_random(s_key, sizeof(s_key));
+        ESP_LOGW(TAG, "NVS unavailable, local control key will not persist");
+    }
+}
+
+// Serial console only: printf, so it never reaches the log hooks that Insights uploads.
+static void key_print(void) {
+    char hex[LOCAL_CTRL_KEY_LEN * 2 + 1];
+    for (int i = 0; i < LOCAL_CTRL_KEY_LEN; i++) {
+        snprintf(&hex[i * 2], 3, "%02x", s_key[i]);
+    }
+    printf("Local control key: %s\n", hex);
+    esp_qrcode_config_t cfg = ESP_QRCODE_CONFIG_DEFAULT();
+    esp_qrcode_generate(&cfg, hex);
+}
+
+static bool mac_equal(const uint8_t *a, const uint8_t *b, size_t len) {
+    uint8_t diff = 0;
+    for (size_t i = 0; i < len; i++) {
+        diff |= a[i] ^ b[i];
+    }
+    return diff == 0;
+}
+
+static bool auth_check(const lc_client_t *c, const uint8_t *mac) {
+    uint8_t expected[32];
+    if (mbedtls_md_hmac(mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), s_key, sizeof(s_key),
+                        c->nonce, sizeof(c->nonce), expected) != 0) {
+        return false;
+    }
+    return mac_equal(expected, mac, sizeof(expected));
+}
+
+static bool session_init(lc_client_t *c) {
+    uint8_t in[7 + LOCAL_CTRL_NONCE_LEN];
+    memcpy(in, "session", 7);
+    memcpy(in + 7, c->nonce, sizeof(c->nonce));
+    c->rx_ctr = c->tx_ctr = 0;
+    return mbedtls_md_hmac(mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), s_key, sizeof(s_key),
+                           in, sizeof(in), c->session) == 0;
+}
+
+static bool frame_tag(const lc_client_t *c, uint8_t dir, uint32_t ctr, const uint8_t *cbor, size_t len,
+                      uint8_t tag[LOCAL_CTRL_TAG_LEN]) {
+    uint8_t in[5 + LOCAL_CTRL_MAX_FRAME];
+    uint8_t mac[32];
+    if (len > LOCAL_CTRL_MAX_FRAME) {
+        return false;
+    }
+    in[0] = dir;
+    in[1] = ctr >> 24;
+    in[2] = ctr >> 16;
+    in[3] = ctr >> 8;
+    in[4] = ctr;
+    memcpy(in + 5, cbor, len);
+    if (mbedtls_md_hmac(mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), c->session, sizeof(c->session),
+                        in, 5 + len, mac) != 0) {
+        return false;
+    }
+    memcpy(tag, mac, LOCAL_CTRL_TAG_LEN);
+    return true;
+}
+
+// --- FRAMING ---
+
+static void client_close(lc_client_t *c) {
+    if (c->fd >= 0) {
+        close(c->fd);
+        ESP_LOGI(TAG, "Local client disconnected");
+    }
+    memset(c, 0, sizeof(*c));
+    c->fd = -1;
+}
+
+// Sends what the socket takes without waiting; the rest goes when select() says it can.
+static void client_flush(lc_client_t *c) {
+    size_t off = 0;
+    while (off < c->tx_len) {
+        int n = send(c->fd, c->tx + off, c->tx_len - off, MSG_DONTWAIT);
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        }
+        if (n <= 0) {
+            client_close(c);
+            return;
+        }
+        off += n;
+    }
+    c->tx_len -= off;
+    memmove(c->tx, c->tx + off, c->tx_len);
+}
+
+// frame has room for the tag after the CBOR payload.
+static bool send_frame(lc_client_t *c, uint8_t *frame, const CborEncoder *enc) {
+    if (c->fd < 0) {
+        return false;
+    }
+    size_t len = cbor_encoder_get_buffer_size(enc, frame + 2);
+    if (c->authed) {
+        if (!frame_tag(c, LC_DIR_HUB, c->tx_ctr++, frame + 2, len, frame + 2 + len)) {
+            client_close(c);
+            return false;
+        }
+        len += LOCAL_CTRL_TAG_LEN;
+    }
+    frame[0] = len >> 8;
+    frame[1] = len & 0xff;
+    len += 2;
+    if (c->tx_len + len > sizeof(c->tx)) {
+        // One slow client must not hold up the others sharing this task.
+        ESP_LOGW(TAG, "Local client not reading, disconnecting");
+        client_close(c);
+        return false;
+    }
+    memcpy(c->tx + c->tx_len, frame, len);
+    c->tx_len += len;
+    client_flush(c);
+    return c->fd >= 0;
+}
+
+static void put_int(CborEncoder *map, lc_key_t key, int val) {
+    cbor_encode_int(map, key);
+    cbor_encode_int(map, val);
+}
+
+static void send_hello(lc_client_t *c) {
+    uint8_t frame[2 + LOCAL_CTRL_MAX_FRAME + LOCAL_CTRL_TAG_LEN];
+    CborEncoder enc, map;
+    esp_fill_random(c->nonce, sizeof(c->nonce));
+    cbor_encoder_init(&enc, frame + 2, LOCAL_CTRL_MAX_FRAME, 0);
+    cbor_encoder_create_map(&enc, &map, 2);
+    put_int(&map, LC_KEY_OP, LC_OP_HELLO);
+    cbor_encode_int(&map, LC_KEY_NONCE);
+    cbor_encode_byte_string(&map, c->nonce, sizeof(c->nonce));
+    cbor_encoder_close_container(&enc, &map);
+    send_frame(c, frame, &enc);
+}
+
+// dev < 0 with with_state sends the full state array; dev >= 0 sends one value.
+static void send_reply(lc_client_t *c, int op, int seq, lc_status_t status, int dev, bool with_state) {
+    uint8_t frame[2 + LOCAL_CTRL_MAX_FRAME + LOCAL_CTRL_TAG_LEN];
+    CborEncoder enc, map, arr;
+    size_t pairs = 3 + (dev >= 0 ? 2 : 0) + (with_state ? 1 : 0);
+    cbor_encoder_init(&enc, frame + 2, LOCAL_CTRL_MAX_FRAME, 0);
+    cbor_encoder_create_map(&enc, &map, pairs);
+    put_int(&map, LC_KEY_OP, op);
+    put_int(&map, LC_KEY_SEQ, seq);
+    put_int(&map, LC_KEY_STATUS, status);
+    if (dev >= 0) {
+        put_int(&map, LC_KEY_DEV, dev);
+        put_int(&map, LC_KEY_VAL, app_device_get(dev));
+    }
+    if (with_state) {
+        cbor_encode_int(&map, LC_KEY_STATE);
+        cbor_encoder_create_array(&map, &arr, APP_DEV_MAX);
+        for (int d = 0; d < APP_DEV_MAX; d++) {
+            cbor_encode_int(&arr, app_device_get(d));
+        }
+        cbor_encoder_close_container(&map, &arr);
+    }
+    cbor_encoder_close_container(&enc, &map);
+    send_frame(c, frame, &enc);
+}
+
+static void send_event(lc_client_t *c, app_dev_t dev, int val) {
+    uint8_t frame[2 + LOCAL_CTRL_MAX_FRAME + LOCAL_CTRL_TAG_LEN];
+    CborEncoder enc, map;
+    cbor_encoder_init(&enc, frame + 2, LOCAL_CTRL_MAX_FRAME, 0);
+    cbor_encoder_create_map(&enc, &map, 3);
+    put_int(&map, LC_KEY_OP, LC_OP_EVENT);
+    put_int(&map, LC_KEY_DEV, dev);
+    put_int(&map, LC_KEY_VAL, val);
+    cbor_encoder_close_container(&enc, &map);
+    send_frame(c, frame, &enc);
+}
+
+// --- REQUEST HANDLING ---
+
+static bool parse_request(const uint8_t *buf, size_t len, lc_req_t *req) {
+    CborParser parser;
+    CborValue it, map;
+    memset(req, 0, sizeof(*req));
+    req->op = req->dev = -1;
+
+    if (cbor_parser_init(buf, len, 0, &parser, &it) != CborNoError || !cbor_value_is_map(&it) ||
+        cbor_value_enter_container(&it, &map) != CborNoError) {
+        return false;
+    }
+    while (!cbor_value_at_end(&map)) {
+        int key;
+        if (!cbor_value_is_integer(&map) || cbor_value_get_int(&map, &key) != CborNoError ||
+            cbor_value_advance_fixed(&map) != CborNoError || cbor_value_at_end(&map)) {
+            return false;
+        }
+        int *dst = NULL;
+        switch (key) {
+            case LC_KEY_OP:  dst = &req->op;  break;
+            case LC_KEY_SEQ: dst = &req->seq; break;
+            case LC_KEY_DEV: dst = &req->dev; break;
+            case LC_KEY_VAL: dst = &req->val; break;
+            case LC_KEY_MAC:
+                if (cbor_value_is_byte_string(&map)) {
+                    size_t n = sizeof(req->mac);
+                    if (cbor_value_copy_byte_string(&map, req->mac, &n, &map) != CborNoError || n != sizeof(req->mac)) {
+                        return false;
+                    }
+                    req->has_mac = true;
+                    continue;
+                }
+                break;
+            default:
+                break;
+        }
+        if (dst && cbor_value_is_integer(&map)) {
+            cbor_value_get_int(&map, dst);
+        } else if (dst && cbor_value_is_boolean(&map)) {
+            bool b;
+            cbor_value_get_boolean(&map, &b);
+            *dst = b;
+        }
+        if (cbor_value_advance(&map) != CborNoError) {
+            return false;
+        }
+    }
+    return req->op >= 0;
+}
+
+static void handle_request(lc_client_t *c, const uint8_t *buf, size_t len) {
+    lc_req_t req;
+    if (!parse_request(buf, len, &req)) {
+        send_reply(c, -1, 0, LC_STATUS_BAD_REQUEST, -1, false);
+        return;
+    }
+    if (!c->authed) {
+        if (req.op == LC_OP_AUTH && req.has_mac && auth_check(c, req.mac) && session_init(c)) {
+            c->authed = true;
+            send_reply(c, req.op, req.seq, LC_STATUS_OK, -1, false);
+        } else {
+            ESP_LOGW(TAG, "Local client failed authentication");
+            send_reply(c, req.op, req.seq, LC_STATUS_UNAUTHORIZED, -1, false);
+            client_close(c);
+        }
+        return;
+    }
+
+    bool dev_valid = req.dev >= 0 && req.dev < APP_DEV_MAX;
+    switch (req.op) {
+        case LC_OP_GET:
+            if (req.dev < 0) {
+                send_reply(c, req.op, req.seq, LC_STATUS_OK, -1, true);
+            } else if (dev_valid) {
+                send_reply(c, req.op, req.seq, LC_STATUS_OK, req.dev, false);
+            } else {
+                send_reply(c, req.op, req.seq, LC_STATUS_INVALID_DEVICE, -1, false);
+            }
+            break;
+        case LC_OP_SET: {
+            if (!dev_valid) {
+                send_reply(c, req.op, req.seq, LC_STATUS_INVALID_DEVICE, -1, false);
+                break;
+            }
+            // Acknowledge once queued; the actuation (with its buzzer feedback)
+            // runs on the exec task and subscribers see the result as an EVENT.
+            lc_exec_t job = { .dev = req.dev, .value = req.val };
+            lc_status_t st = xQueueSend(s_exec_queue, &job, 0) == pdTRUE ? LC_STATUS_OK : LC_STATUS_BUSY;
+            send_reply(c, req.op, req.seq, st, -1, false);
+            break;
+        }
+        case LC_OP_SUBSCRIBE:
+            c->subscribed = req.val != 0;
+            send_reply(c, req.op, req.seq, LC_STATUS_OK, -1, c->subscribed);
+            break;
+        default:
+            send_reply(c, req.op, req.seq, LC_STATUS_BAD_REQUEST, -1, false);
+            break;
+    }
+}
+
+static void client_read(lc_client_t *c) {
+    int n = recv(c->fd, c->rx + c->rx_len, sizeof(c->rx) - c->rx_len, MSG_DONTWAIT);
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+        return;
+    }
+    if (n <= 0) {
+        client_close(c);
+        return;
+    }
+    c->rx_len += n;
+    while (c->fd >= 0 && c->rx_len >= 2) {
+        size_t flen = (c->rx[0] << 8) | c->rx[1];
+        size_t tag_len = c->authed ? LOCAL_CTRL_TAG_LEN : 0;
+        if (flen <= tag_len || flen > LOCAL_CTRL_MAX_FRAME + tag_len) {
+            client_close(c);
+            return;
+        }
+        if (c->rx_len < 2 + flen) {
+            break;
+        }
+        if (c->authed) {
+            uint8_t tag[LOCAL_CTRL_TAG_LEN];
+            size_t cbor_len = flen - tag_len;
+            if (!frame_tag(c, LC_DIR_CLIENT, c->rx_ctr++, c->rx + 2, cbor_len, tag) ||
+                !mac_equal(tag, c->rx + 2 + cbor_len, sizeof(tag))) {
+                ESP_LOGW(TAG, "Local client sent a frame with a bad tag");
+                client_close(c);
+                return;
+            }
+        }
+        handle_request(c, c->rx + 2, flen - tag_len);
+        if (c->fd < 0) {
+            return;
+        }
+        c->rx_len -= 2 + flen;
+        memmove(c->rx, c->rx + 2 + flen, c->rx_len);
+    }
+}
+
+static void client_accept(int listen_fd) {
+    int fd = accept(listen_fd, NULL, NULL);
+    if (fd < 0) return;
+
+    lc_client_t *c = NULL;
+    for (int i = 0; i < LOCAL_CTRL_MAX_CLIENTS; i++) {
+        if (s_clients[i].fd < 0) { c = &s_clients[i]; break; }
+    }
+    if (!c) {
+        ESP_LOGW(TAG, "Local control: too many clients");
+        close(fd);
+        return;
+    }
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+    c->fd = fd;
+    ESP_LOGI(TAG, "Local client connected");
+    send_hello(c);
+}
+
+static void flush_events(void) {
+    uint64_t cnt;
+    read(s_event_fd, &cnt, sizeof(cnt));
+    unsigned mask = atomic_exchange(&s_dirty, 0);
+    for (int d = 0; mask && d < APP_DEV_MAX; d++) {
+        if (!(mask & (1u << d))) continue;
+        int val = app_device_get(d);
+        for (int i = 0; i < LOCAL_CTRL_MAX_CLIENTS; i++) {
+            if (s_clients[i].fd >= 0 && s_clients[i].subscribed) {
+                send_event(&s_clients[i], d, val);
+            }
+        }
+    }
+}
+
+// --- TASKS ---
+
+static void local_ctrl_task(void *arg) {
+    int listen_fd = (int)(intptr_t)arg;
+    while (1) {
+        fd_set rfds, wfds;
+        FD_ZERO(&rfds);
+        FD_ZERO(&wfds);
+        FD_SET(listen_fd, &rfds);
+        FD_SET(s_event_fd, &rfds);
+        int maxfd = listen_fd > s_event_fd ? listen_fd : s_event_fd;
+        for (int i = 0; i < LOCAL_CTRL_MAX_CLIENTS; i++) {
+            if (s_clients[i].fd >= 0) {
+                FD_SET(s_clients[i].fd, &rfds);
+                if (s_clients[i].tx_len > 0) {
+                    FD_SET(s_clients[i].fd, &wfds);
+                }
+                if (s_clients[i].fd > maxfd) maxfd = s_clients[i].fd;
+            }
+        }
+        if (select(maxfd + 1, &rfds, &wfds, NULL, NULL) <= 0) {
+            continue;
+        }
+        for (int i = 0; i < LOCAL_CTRL_MAX_CLIENTS; i++) {
+            if (s_clients[i].fd >= 0 && FD_ISSET(s_clients[i].fd, &wfds)) {
+                client_flush(&s_clients[i]);
+            }
+        }
+        if (FD_ISSET(s_event_fd, &rfds)) {
+            flush_events();
+        }
+        for (int i = 0; i < LOCAL_CTRL_MAX_CLIENTS; i++) {
+            if (s_clients[i].fd >= 0 && FD_ISSET(s_clients[i].fd, &rfds)) {
+                client_read(&s_clients[i]);
+            }
+        }
+        if (FD_ISSET(listen_fd, &rfds)) {
+            client_accept(listen_fd);
+        }
+    }
+}
+
+static void local_exec_task(void *arg) {
+    lc_exec_t job;
+    while (1) {
+        if (xQueueReceive(s_exec_queue, &job, portMAX_DELAY)) {
+            app_device_set(job.dev, job.value);
+        }
+    }
+}
+
+// --- PUBLIC API ---
+
+void app_local_ctrl_bind(app_dev_t dev, const esp_rmaker_param_t *param) {
+    if (dev < APP_DEV_MAX) {
+        s_bound[dev] = param;
+    }
+}
+
+void app_local_ctrl_notify(const esp_rmaker_param_t *param) {
+    for (int d = 0; d < APP_DEV_MAX; d++) {
+        if (s_bound[d] == param) {
+            atomic_fetch_or(&s_dirty, 1u << d);
+            if (s_event_fd >= 0) {
+                uint64_t one = 1;
+                write(s_event_fd, &one, sizeof(one));
+            }
+            return;
+        }
+    }
+}
+
+esp_err_t app_local_ctrl_start(void) {
+    key_load();
+    key_print();
+    for (int i = 0; i < LOCAL_CTRL_MAX_CLIENTS; i++) {
+        s_clients[i].fd = -1;
+    }
+
+    esp_vfs_eventfd_config_t efd_cfg = ESP_VFS_EVENTD_CONFIG_DEFAULT();
+    esp_err_t err = esp_vfs_eventfd_register(&efd_cfg);
+    if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) {
+        return err;
+    }
+    int efd = eventfd(0, 0);
+    if (efd < 0) {
+        return ESP_FAIL;
+    }
+
+    int listen_fd = socket(AF_INET, SOCK_STREAM, IPPROTO_IP);
+    if (listen_fd < 0) {
+        close(efd);
+        return ESP_FAIL;
+    }
+    int one = 1;
+    setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(LOCAL_CTRL_PORT),
+        .sin_addr.s_addr = htonl(INADDR_ANY),
+    };
+    if (bind(listen_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+        listen(listen_fd, LOCAL_CTRL_MAX_CLIENTS) != 0) {
+        ESP_LOGE(TAG, "Local control: bind/listen failed");
+        close(listen_fd);
+        close(efd);
+        return ESP_FAIL;
+    }
+
+    s_exec_queue = xQueueCreate(LOCAL_CTRL_EXEC_DEPTH, sizeof(lc_exec_t));
+    if (!s_exec_queue) {
+        close(listen_fd);
+        close(efd);
+        return ESP_ERR_NO_MEM;
+    }
+    s_event_fd = efd;
+
+    // RainMaker local control may already own mDNS; mdns_init() is a no-op then.
+    err = mdns_init();
+    if (err == ESP_OK) {
+        char host[64];
+        if (mdns_hostname_get(host) != ESP_OK) {
+            mdns_hostname_set("smarthub");
+        }
+        mdns_txt_item_t txt[] = {
+            { "node", esp_rmaker_get_node_id() },
+            { "proto", "cbor1" },
+        };
+        err = mdns_service_add(NULL, LOCAL_CTRL_SERVICE, LOCAL_CTRL_PROTO, LOCAL_CTRL_PORT, txt, 2);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Local control: mDNS advertisement failed (%s)", esp_err_to_name(err));
+    }
+
+    xTaskCreate(local_exec_task, "local_exec", 4096, NULL, 5, NULL);
+    xTaskCreate(local_ctrl_task, "local_ctrl", LOCAL_CTRL_TASK_STACK, (void *)(intptr_t)listen_fd, 6, NULL);
+    ESP_LOGI(TAG, "Local control listening on port %d (%s.%s)", LOCAL_CTRL_PORT, LOCAL_CTRL_SERVICE, LOCAL_CTRL_PROTO);
+    return ESP_OK;
+}
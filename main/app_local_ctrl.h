@@ -0,0 +1,73 @@
+#pragma once
+
+#include <esp_err.h>
+#include <esp_rmaker_core.h>
+#include "app_support.h"
+
+// --- LOCAL CONTROL CONFIGURATION ---
+#define LOCAL_CTRL_SERVICE      "_smarthub"
+#define LOCAL_CTRL_PROTO        "_tcp"
+#define LOCAL_CTRL_PORT         8090
+#define LOCAL_CTRL_MAX_CLIENTS  4
+#define LOCAL_CTRL_MAX_FRAME    128     // CBOR payload bytes, excluding the 2-byte length and the tag
+#define LOCAL_CTRL_KEY_LEN      16
+#define LOCAL_CTRL_NONCE_LEN    16
+#define LOCAL_CTRL_TAG_LEN      16
+#define LOCAL_CTRL_TX_BUF       1024    // Per client; a client that lets it fill up is dropped
+
+/*
+ * Wire format: every frame is a 2-byte big-endian length followed by one
+ * CBOR map with small integer keys. On connect the hub sends HELLO with a
+ * nonce; the client must answer AUTH with HMAC-SHA256(key, nonce) before
+ * any other op is accepted.
+ *
+ * From the hub's reply to AUTH on, every frame in either direction ends with
+ * a tag, counted in the length: the first 16 bytes of
+ * HMAC-SHA256(session key, dir | counter | CBOR), where the session key is
+ * HMAC-SHA256(key, "session" | nonce), dir is 'C' from the client and 'H'
+ * from the hub, and counter is the 4-byte big-endian number of tagged frames
+ * sent before in that direction. A frame with a wrong tag closes the
+ * connection, so frames cannot be forged, replayed or reordered.
+ *
+ * The key is generated on first boot and stored in NVS. It never leaves the
+ * device except on the serial console, where it is printed at boot as hex and
+ * as a QR code, so getting it takes physical access to the hub.
+ *
+ * tools/smarthub_ctl.py is the reference client and load generator.
+ */
+typedef enum {
+    LC_KEY_OP = 0,
+    LC_KEY_SEQ,
+    LC_KEY_DEV,
+    LC_KEY_VAL,
+    LC_KEY_STATUS,
+    LC_KEY_NONCE,
+    LC_KEY_MAC,
+    LC_KEY_STATE,
+} lc_key_t;
+
+typedef enum {
+    LC_OP_HELLO = 0,    // hub -> client: {op, nonce}
+    LC_OP_AUTH,         // client -> hub: {op, seq, mac}
+    LC_OP_GET,          // {op, seq[, dev]} -> {op, seq, status, dev, val} or {op, seq, status, state[]}
+    LC_OP_SET,          // {op, seq, dev, val} -> {op, seq, status}
+    LC_OP_SUBSCRIBE,    // {op, seq, val: 0|1} -> {op, seq, status, state[]}
+    LC_OP_EVENT,        // hub -> subscribers: {op, dev, val}
+} lc_op_t;
+
+typedef enum {
+    LC_STATUS_OK = 0,
+    LC_STATUS_BAD_REQUEST,
+    LC_STATUS_UNAUTHORIZED,
+    LC_STATUS_INVALID_DEVICE,
+    LC_STATUS_BUSY,
+} lc_status_t;
+
+// Starts the TCP server and advertises it over mDNS. Call once Wi-Fi is up.
+esp_err_t app_local_ctrl_start(void);
+
+// Maps a reported param to a device so subscribers get a push on change.
+void app_local_ctrl_bind(app_dev_t dev, const esp_rmaker_param_t *param);
+
+// Called from app_report_param(); cheap no-op for unbound params.
+void app_local_ctrl_notify(const esp_rmaker_param_t *param);
@@ -1,4 +1,7 @@
 #include "app_support.h"
+#include "app_offline.h"
+#include "app_local_ctrl.h"
+#include "app_zones.h"
 #include <esp_log.h>
 #include <nvs_flash.h>
 #include <esp_rmaker_core.h>
@@ -11,6 +14,7 @@
 #include <esp_rmaker_schedule.h>
 #include <esp_rmaker_scenes.h>
 #include <esp_diagnostics.h>
+#include <esp_diagnostics_event.h>
 #include <string.h>
 #include <esp_timer.h>
 
@@ -51,6 +55,8 @@ static esp_rmaker_param_t *param_tv_status;
 static esp_rmaker_param_t *param_plug_power;
 static esp_rmaker_param_t *param_plug_status;
 
+static esp_rmaker_device_t *app_devices[APP_DEV_MAX];
+
 // State
 static bool system_armed = true;
 static bool door_is_open = false;
@@ -69,11 +75,36 @@ volatile bool blinking_active = false; // Exposed for app_support.c
 // --- FUNCTIONS ---
 
 void send_alert(const char *msg) {
-    esp_rmaker_param_update_and_report(param_alert, esp_rmaker_str(msg));
-    esp_rmaker_raise_alert(msg);
+    app_report_param(param_alert, esp_rmaker_str(msg));
+    app_raise_alert(msg);
     ESP_LOGW(TAG, "ALERT: %s", msg);
 }
 
+// Caller must hold sys_mutex.
+static void set_security_state(bool armed, const char *via) {
+    char buf[48];
+    system_armed = armed;
+    buzzer_tone(false);
+
+    if(system_armed) {
+        beep(100); vTaskDelay(100); beep(100);
+        snprintf(buf, sizeof(buf), "Door Locked via %s", via);
+        send_alert(buf);
+        app_report_param(param_sec_status, esp_rmaker_str("Door Locked"));
+        app_report_param(param_home_sec, esp_rmaker_str("Locked"));
+        ESP_LOGI(TAG, "System Locked");
+        ESP_DIAG_EVENT(EVT_SEC, "Door Locked");
+    } else {
+        beep(500);
+        snprintf(buf, sizeof(buf), "Door Unlocked via %s", via);
+        send_alert(buf);
+        app_report_param(param_sec_status, esp_rmaker_str("Door Unlocked"));
+        app_report_param(param_home_sec, esp_rmaker_str("Unlocked"));
+        ESP_LOGI(TAG, "System Unlocked");
+        ESP_DIAG_EVENT(EVT_SEC, "Door Unlocked");
+    }
+}
+
 static void keypad_init(void) {
     for (int r = 0; r < KEYPAD_ROWS; r++) {
         gpio_reset_pin(KEYPAD_ROW_GPIOS[r]);
@@ -116,82 +147,65 @@ static void keypad_task(void *arg) {
                         indicate_device_on();
                         buzzer_fan_speed_sound(fan_speed);
                         
-                        esp_rmaker_param_update_and_report(param_fan_power, esp_rmaker_bool(fan_state));
-                        esp_rmaker_param_update_and_report(param_fan_speed, esp_rmaker_int(fan_speed));
+                        app_report_param(param_fan_power, esp_rmaker_bool(fan_state));
+                        app_report_param(param_fan_speed, esp_rmaker_int(fan_speed));
                         
                         char buf[32];
                         if (fan_speed == 0) snprintf(buf, sizeof(buf), "Fan Off");
                         else snprintf(buf, sizeof(buf), "Fan Speed %d", fan_speed);
                         
-                        esp_rmaker_param_update_and_report(param_fan_status, esp_rmaker_str(buf));
-                        esp_rmaker_param_update_and_report(param_home_fan, esp_rmaker_str(buf));
+                        app_report_param(param_fan_status, esp_rmaker_str(buf));
+                        app_report_param(param_home_fan, esp_rmaker_str(buf));
                         
                         ESP_LOGI(TAG, "Fan Speed: %d", fan_speed);
-                        ESP_DIAG_EVENT(EVT_DEV, "Fan Manual Control: %d", fan_speed);
+                        ESP_DIAG_EVENT_FAST(EVT_DEV, "Fan Manual Control: %d", fan_speed);
                         send_alert(fan_state ? "Fan Turned ON (Keypad)" : "Fan Turned OFF (Keypad)");
                     }
                     else if (key == 'B') {
                         light_state = !light_state;
                         if (light_state) buzzer_light_sound();
                         indicate_device_on();
-                        esp_rmaker_param_update_and_report(param_light_power, esp_rmaker_bool(light_state));
-                        esp_rmaker_param_update_and_report(param_light_status, esp_rmaker_str(light_state ? "Light On" : "Light Off"));
-                        esp_rmaker_param_update_and_report(param_home_light, esp_rmaker_str(light_state ? "On" : "Off"));
+                        app_report_param(param_light_power, esp_rmaker_bool(light_state));
+                        app_report_param(param_light_status, esp_rmaker_str(light_state ? "Light On" : "Light Off"));
+                        app_report_param(param_home_light, esp_rmaker_str(light_state ? "On" : "Off"));
                         ESP_LOGI(TAG, "Light Toggled: %d", light_state);
-                        ESP_DIAG_EVENT(EVT_DEV, "Light %s (Keypad)", light_state ? "ON" : "OFF");
+                        ESP_DIAG_EVENT_FAST(EVT_DEV, "Light %s (Keypad)", light_state ? "ON" : "OFF");
                         send_alert(light_state ? "Light Turned ON (Keypad)" : "Light Turned OFF (Keypad)");
                     }
                     else if (key == 'C') {
                         tv_state = !tv_state;
                         if (tv_state) buzzer_tv_sound();
                         indicate_device_on();
-                        esp_rmaker_param_update_and_report(param_tv_power, esp_rmaker_bool(tv_state));
-                        esp_rmaker_param_update_and_report(param_tv_status, esp_rmaker_str(tv_state ? "TV On" : "TV Off"));
-                        esp_rmaker_param_update_and_report(param_home_tv, esp_rmaker_str(tv_state ? "On" : "Off"));
+                        app_report_param(param_tv_power, esp_rmaker_bool(tv_state));
+                        app_report_param(param_tv_status, esp_rmaker_str(tv_state ? "TV On" : "TV Off"));
+                        app_report_param(param_home_tv, esp_rmaker_str(tv_state ? "On" : "Off"));
                         ESP_LOGI(TAG, "TV Toggled: %d", tv_state);
-                        ESP_DIAG_EVENT(EVT_DEV, "TV %s (Keypad)", tv_state ? "ON" : "OFF");
+                        ESP_DIAG_EVENT_FAST(EVT_DEV, "TV %s (Keypad)", tv_state ? "ON" : "OFF");
                         send_alert(tv_state ? "TV Turned ON (Keypad)" : "TV Turned OFF (Keypad)");
                     }
                     else if (key == 'D') {
                         plug_state = !plug_state;
                         if (plug_state) buzzer_plug_sound();
                         indicate_device_on();
-                        esp_rmaker_param_update_and_report(param_plug_power, esp_rmaker_bool(plug_state));
-                        esp_rmaker_param_update_and_report(param_plug_status, esp_rmaker_str(plug_state ? "Plug On" : "Plug Off"));
-                        esp_rmaker_param_update_and_report(param_home_plug, esp_rmaker_str(plug_state ? "On" : "Off"));
+                        app_report_param(param_plug_power, esp_rmaker_bool(plug_state));
+                        app_report_param(param_plug_status, esp_rmaker_str(plug_state ? "Plug On" : "Plug Off"));
+                        app_report_param(param_home_plug, esp_rmaker_str(plug_state ? "On" : "Off"));
                         ESP_LOGI(TAG, "Plug Toggled: %d", plug_state);
-                        ESP_DIAG_EVENT(EVT_DEV, "Plug %s (Keypad)", plug_state ? "ON" : "OFF");
+                        ESP_DIAG_EVENT_FAST(EVT_DEV, "Plug %s (Keypad)", plug_state ? "ON" : "OFF");
                         send_alert(plug_state ? "Plug Turned ON (Keypad)" : "Plug Turned OFF (Keypad)");
                     }
                     else if (key == '*') {
                         password_index = 0;
                         memset(password_buffer, 0, sizeof(password_buffer));
-                        esp_rmaker_param_update_and_report(param_sec_status, esp_rmaker_str("Cleared"));
+                        app_report_param(param_sec_status, esp_rmaker_str("Cleared"));
                         ESP_LOGI(TAG, "Buffer Cleared");
                     }
                     else if (key == '#') {
                         if (strcmp(password_buffer, master_password) == 0) {
-                            system_armed = !system_armed;
-                            buzzer_tone(false);
-                            
-                            if(system_armed) {
-                                beep(100); vTaskDelay(100); beep(100);
-                                send_alert("Door Locked via Keypad");
-                                esp_rmaker_param_update_and_report(param_sec_status, esp_rmaker_str("Door Locked"));
-                                esp_rmaker_param_update_and_report(param_home_sec, esp_rmaker_str("Locked"));
-                                ESP_LOGI(TAG, "System Locked");
-                                ESP_DIAG_EVENT(EVT_SEC, "Door Locked");
-                            } else {
-                                beep(500);
-                                send_alert("Door Unlocked via Keypad");
-                                esp_rmaker_param_update_and_report(param_sec_status, esp_rmaker_str("Door Unlocked"));
-                                esp_rmaker_param_update_and_report(param_home_sec, esp_rmaker_str("Unlocked"));
-                                ESP_LOGI(TAG, "System Unlocked");
-                                ESP_DIAG_EVENT(EVT_SEC, "Door Unlocked");
-                            }
+                            set_security_state(!system_armed, "Keypad");
                         } else {
                             ESP_LOGW(TAG, "Wrong Password Attempt");
-                            esp_rmaker_param_update_and_report(param_sec_status, esp_rmaker_str("Wrong Password"));
+                            app_report_param(param_sec_status, esp_rmaker_str("Wrong Password"));
                             buzzer_error_sound();
                             send_alert("Invalid Password Entered");
                             ESP_DIAG_EVENT(EVT_SEC, "Invalid Password");
@@ -204,7 +218,7 @@ static void keypad_task(void *arg) {
                             if (password_index < 4) {
                                 password_buffer[password_index++] = key;
                                 password_buffer[password_index] = '\0';
-                                esp_rmaker_param_update_and_report(param_sec_status, esp_rmaker_str("Entering Password..."));
+                                app_report_param(param_sec_status, esp_rmaker_str("Entering Password..."));
                             } else {
                                 ESP_LOGW(TAG, "Password buffer full");
                             }
@@ -227,60 +241,53 @@ static void sensor_task(void *arg) {
     
     gpio_reset_pin(LED_RED_GPIO); gpio_set_direction(LED_RED_GPIO, GPIO_MODE_OUTPUT);
     gpio_reset_pin(LED_GREEN_GPIO); gpio_set_direction(LED_GREEN_GPIO, GPIO_MODE_OUTPUT);
-    gpio_reset_pin(TRIG_GPIO); gpio_set_direction(TRIG_GPIO, GPIO_MODE_OUTPUT);
-    gpio_reset_pin(ECHO_GPIO); gpio_set_direction(ECHO_GPIO, GPIO_MODE_INPUT);
     
     DHT11_init((gpio_num_t)DHT_GPIO);
 
     TickType_t last_dht_read = 0;
-    int64_t last_activity_time = 0;
     bool temp_alert_sent = false;
+    zone_evt_t evts[MAX_ZONES];
 
     while (1) {
         xSemaphoreTake(sys_mutex, portMAX_DELAY);
 
-        float dist = get_distance_cm();
-        bool person_nearby = (dist > 0 && dist < DOOR_THRESHOLD_CM);
-        
-        if (!door_is_open) {
-            if (person_nearby && !system_armed) {
-                door_is_open = true;
-                last_activity_time = esp_timer_get_time();
+        int n = app_zones_step(system_armed, evts, MAX_ZONES);
+        for (int i = 0; i < n; i++) {
+            const char *zone = app_zones_name(evts[i].zone);
+            char buf[64];
 
-                esp_rmaker_param_update_and_report(param_door_status, esp_rmaker_bool(door_is_open));
-                esp_rmaker_param_update_and_report(param_home_door, esp_rmaker_str("Open"));
+            if (evts[i].type == ZONE_EVT_OPENED) {
+                door_is_open = true;
+                app_report_param(param_door_status, esp_rmaker_bool(door_is_open));
+                app_report_param(param_home_door, esp_rmaker_str("Open"));
                 
                 buzzer_doorbell();
-                send_alert("Automatic Door Opened");
-                esp_rmaker_param_update_and_report(param_sec_status, esp_rmaker_str("Door Opened"));
-                esp_rmaker_param_update_and_report(param_home_sec, esp_rmaker_str("Door Open"));
+                snprintf(buf, sizeof(buf), "Automatic Door Opened: %s", zone);
+                send_alert(buf);
+                app_report_param(param_sec_status, esp_rmaker_str("Door Opened"));
+                app_report_param(param_home_sec, esp_rmaker_str("Door Open"));
                 
-                ESP_LOGI(TAG, "Door Opened Automatically");
-                ESP_DIAG_EVENT(EVT_DOOR, "Door Opened");
-            }
-        } else {
-            if (person_nearby) {
-                last_activity_time = esp_timer_get_time();
+                ESP_LOGI(TAG, "Door Opened Automatically: %s", zone);
+                ESP_DIAG_EVENT_FAST(EVT_DOOR, "Door Opened: %s", zone);
+                continue;
             }
 
-            if ((esp_timer_get_time() - last_activity_time > 10000000) || system_armed) {
-                door_is_open = false;
-                
-                if (!system_armed) {
-                    system_armed = true;
-                    send_alert("System Auto-Armed: No Activity");
-                } else {
-                    send_alert("Door Closed");
-                }
-
-                esp_rmaker_param_update_and_report(param_door_status, esp_rmaker_bool(door_is_open));
-                esp_rmaker_param_update_and_report(param_home_door, esp_rmaker_str("Closed"));
-                esp_rmaker_param_update_and_report(param_sec_status, esp_rmaker_str(system_armed ? "Door Locked" : "Door Unlocked"));
-                esp_rmaker_param_update_and_report(param_home_sec, esp_rmaker_str(system_armed ? "Locked" : "Unlocked"));
-                
-                ESP_LOGI(TAG, "Door Closed / System Locked");
-                ESP_DIAG_EVENT(EVT_DOOR, "Door Closed");
+            door_is_open = app_zones_any_open();
+            if (evts[i].type == ZONE_EVT_IDLE_TIMEOUT && !system_armed && !door_is_open) {
+                system_armed = true;
+                send_alert("System Auto-Armed: No Activity");
+            } else {
+                snprintf(buf, sizeof(buf), "Door Closed: %s", zone);
+                send_alert(buf);
             }
+
+            app_report_param(param_door_status, esp_rmaker_bool(door_is_open));
+            app_report_param(param_home_door, esp_rmaker_str(door_is_open ? "Open" : "Closed"));
+            app_report_param(param_sec_status, esp_rmaker_str(system_armed ? "Door Locked" : "Door Unlocked"));
+            app_report_param(param_home_sec, esp_rmaker_str(system_armed ? "Locked" : "Unlocked"));
+            
+            ESP_LOGI(TAG, "Door Closed: %s", zone);
+            ESP_DIAG_EVENT_FAST(EVT_DOOR, "Door Closed: %s", zone);
         }
 
         if (!blinking_active) {
@@ -304,15 +311,15 @@ static void sensor_task(void *arg) {
         if (xTaskGetTickCount() - last_dht_read > pdMS_TO_TICKS(2000)) {
             struct dht11_reading r = DHT11_read();
             if (r.status == 0) {
-                esp_rmaker_param_update_and_report(param_temp, esp_rmaker_float(r.temperature));
-                esp_rmaker_param_update_and_report(param_humidity, esp_rmaker_float(r.humidity));
+                app_report_param(param_temp, esp_rmaker_float(r.temperature));
+                app_report_param(param_humidity, esp_rmaker_float(r.humidity));
 
                 if (r.temperature > 50.0) {
                     if (!temp_alert_sent) {
                         char alert_msg[64];
                         snprintf(alert_msg, sizeof(alert_msg), "High Temp Alert: %.1f C", (float)r.temperature);
                         send_alert(alert_msg);
-                        ESP_DIAG_EVENT(EVT_SYS, "High Temperature: %.1f", (float)r.temperature);
+                        ESP_DIAG_EVENT_FAST(EVT_SYS, "High Temperature: %.1f", (float)r.temperature);
                         buzzer_error_sound(); 
                         temp_alert_sent = true;
                     }
@@ -324,7 +331,7 @@ static void sensor_task(void *arg) {
             }
             last_dht_read = xTaskGetTickCount();
         }
-        vTaskDelay(pdMS_TO_TICKS(100));
+        vTaskDelay(pdMS_TO_TICKS(ZONE_SLOT_MS));
     }
 }
 
@@ -351,9 +358,9 @@ static esp_err_t write_cb(const esp_rmaker_device_t *device, const esp_rmaker_pa
                 nvs_close(my_handle);
             }
             send_alert("Security Password Changed via App");
-            esp_rmaker_param_update_and_report(param, esp_rmaker_str("Updated"));
+            app_report_param(param, esp_rmaker_str("Updated"));
         } else {
-            esp_rmaker_param_update_and_report(param, esp_rmaker_str("Invalid"));
+            app_report_param(param, esp_rmaker_str("Invalid"));
         }
         return ESP_OK;
     }
@@ -363,20 +370,20 @@ static esp_err_t write_cb(const esp_rmaker_device_t *device, const esp_rmaker_pa
             fan_speed = val.val.i;
             fan_state = (fan_speed > 0);
             
-            esp_rmaker_param_update_and_report(param_fan_power, esp_rmaker_bool(fan_state));
+            app_report_param(param_fan_power, esp_rmaker_bool(fan_state));
             
             char buf[32];
             if (fan_speed == 0) snprintf(buf, sizeof(buf), "Fan Off");
             else snprintf(buf, sizeof(buf), "Fan Speed %d", fan_speed);
             
-            esp_rmaker_param_update_and_report(param_fan_status, esp_rmaker_str(buf));
-            esp_rmaker_param_update_and_report(param_home_fan, esp_rmaker_str(buf));
+            app_report_param(param_fan_status, esp_rmaker_str(buf));
+            app_report_param(param_home_fan, esp_rmaker_str(buf));
             
             buzzer_fan_speed_sound(fan_speed);
-            ESP_DIAG_EVENT(EVT_DEV, "Fan Speed Changed: %d", fan_speed);
+            ESP_DIAG_EVENT_FAST(EVT_DEV, "Fan Speed Changed: %d", fan_speed);
             send_alert(fan_state ? "Fan Speed Changed (App)" : "Fan Turned OFF (App)");
         }
-        esp_rmaker_param_update_and_report(param, val);
+        app_report_param(param, val);
     }
     else if (strcmp(param_name, "Power") == 0) {
         bool state = val.val.b;
@@ -387,14 +394,14 @@ static esp_err_t write_cb(const esp_rmaker_device_t *device, const esp_rmaker_pa
             if (fan_state && fan_speed == 0) fan_speed = 1;
             if (!fan_state) fan_speed = 0;
             
-            esp_rmaker_param_update_and_report(param_fan_speed, esp_rmaker_int(fan_speed));
+            app_report_param(param_fan_speed, esp_rmaker_int(fan_speed));
             
             char buf[32];
             if (fan_speed == 0) snprintf(buf, sizeof(buf), "Fan Off");
             else snprintf(buf, sizeof(buf), "Fan Speed %d", fan_speed);
             
-            esp_rmaker_param_update_and_report(param_fan_status, esp_rmaker_str(buf));
-            esp_rmaker_param_update_and_report(param_home_fan, esp_rmaker_str(buf));
+            app_report_param(param_fan_status, esp_rmaker_str(buf));
+            app_report_param(param_home_fan, esp_rmaker_str(buf));
 
              if (changed && fan_state) {
                 buzzer_fan_sound();
@@ -402,40 +409,40 @@ static esp_err_t write_cb(const esp_rmaker_device_t *device, const esp_rmaker_pa
             } else {
                 buzzer_fan_speed_sound(fan_speed);
             }
-            ESP_DIAG_EVENT(EVT_DEV, "Fan %s (App)", fan_state ? "ON" : "OFF");
+            ESP_DIAG_EVENT_FAST(EVT_DEV, "Fan %s (App)", fan_state ? "ON" : "OFF");
             send_alert(fan_state ? "Fan Turned ON (App)" : "Fan Turned OFF (App)");
         }
         else if (strcmp(device_name, "Light") == 0) {
             if (light_state != state) { light_state = state; changed = true; }
-            esp_rmaker_param_update_and_report(param_light_status, esp_rmaker_str(state ? "Light On" : "Light Off"));
-            esp_rmaker_param_update_and_report(param_home_light, esp_rmaker_str(state ? "On" : "Off"));
+            app_report_param(param_light_status, esp_rmaker_str(state ? "Light On" : "Light Off"));
+            app_report_param(param_home_light, esp_rmaker_str(state ? "On" : "Off"));
             if (changed && state) {
                 buzzer_light_sound();
                 indicate_device_on();
             }
-            ESP_DIAG_EVENT(EVT_DEV, "Light %s (App)", light_state ? "ON" : "OFF");
+            ESP_DIAG_EVENT_FAST(EVT_DEV, "Light %s (App)", light_state ? "ON" : "OFF");
             send_alert(light_state ? "Light Turned ON (App)" : "Light Turned OFF (App)");
         }
         else if (strcmp(device_name, "TV") == 0) {
             if (tv_state != state) { tv_state = state; changed = true; }
-            esp_rmaker_param_update_and_report(param_tv_status, esp_rmaker_str(state ? "TV On" : "TV Off"));
-            esp_rmaker_param_update_and_report(param_home_tv, esp_rmaker_str(state ? "On" : "Off"));
+            app_report_param(param_tv_status, esp_rmaker_str(state ? "TV On" : "TV Off"));
+            app_report_param(param_home_tv, esp_rmaker_str(state ? "On" : "Off"));
             if (changed && state) {
                 buzzer_tv_sound();
                 indicate_device_on();
             }
-            ESP_DIAG_EVENT(EVT_DEV, "TV %s (App)", tv_state ? "ON" : "OFF");
+            ESP_DIAG_EVENT_FAST(EVT_DEV, "TV %s (App)", tv_state ? "ON" : "OFF");
             send_alert(tv_state ? "TV Turned ON (App)" : "TV Turned OFF (App)");
         }
         else if (strcmp(device_name, "Plug") == 0) {
             if (plug_state != state) { plug_state = state; changed = true; }
-            esp_rmaker_param_update_and_report(param_plug_status, esp_rmaker_str(state ? "Plug On" : "Plug Off"));
-            esp_rmaker_param_update_and_report(param_home_plug, esp_rmaker_str(state ? "On" : "Off"));
+            app_report_param(param_plug_status, esp_rmaker_str(state ? "Plug On" : "Plug Off"));
+            app_report_param(param_home_plug, esp_rmaker_str(state ? "On" : "Off"));
             if (changed && state) {
                 buzzer_plug_sound();
                 indicate_device_on();
             }
-            ESP_DIAG_EVENT(EVT_DEV, "Plug %s (App)", plug_state ? "ON" : "OFF");
+            ESP_DIAG_EVENT_FAST(EVT_DEV, "Plug %s (App)", plug_state ? "ON" : "OFF");
             send_alert(plug_state ? "Plug Turned ON (App)" : "Plug Turned OFF (App)");
         }
         
@@ -443,11 +450,50 @@ static esp_err_t write_cb(const esp_rmaker_device_t *device, const esp_rmaker_pa
             buzzer_fan_sound();
         }
 
-        esp_rmaker_param_update_and_report(param, val);
+        app_report_param(param, val);
     }
     return ESP_OK;
 }
 
+// --- DEVICE ACCESS (local control) ---
+
+int app_device_get(app_dev_t dev) {
+    switch (dev) {
+        case APP_DEV_FAN:      return fan_speed;
+        case APP_DEV_LIGHT:    return light_state;
+        case APP_DEV_TV:       return tv_state;
+        case APP_DEV_PLUG:     return plug_state;
+        case APP_DEV_SECURITY: return (system_armed ? 1 : 0) | (door_is_open ? 2 : 0);
+        default:               return -1;
+    }
+}
+
+// Routes through write_cb so local and cloud writes behave identically.
+esp_err_t app_device_set(app_dev_t dev, int value) {
+    esp_rmaker_write_ctx_t ctx = { .src = ESP_RMAKER_REQ_SRC_LOCAL };
+    switch (dev) {
+        case APP_DEV_FAN:
+            if (value < 0) value = 0;
+            if (value > 5) value = 5;
+            return write_cb(app_devices[dev], param_fan_speed, esp_rmaker_int(value), NULL, &ctx);
+        case APP_DEV_LIGHT:
+            return write_cb(app_devices[dev], param_light_power, esp_rmaker_bool(value != 0), NULL, &ctx);
+        case APP_DEV_TV:
+            return write_cb(app_devices[dev], param_tv_power, esp_rmaker_bool(value != 0), NULL, &ctx);
+        case APP_DEV_PLUG:
+            return write_cb(app_devices[dev], param_plug_power, esp_rmaker_bool(value != 0), NULL, &ctx);
+        case APP_DEV_SECURITY:
+            xSemaphoreTake(sys_mutex, portMAX_DELAY);
+            if ((value != 0) != system_armed) {
+                set_security_state(value != 0, "Local Control");
+            }
+            xSemaphoreGive(sys_mutex);
+            return ESP_OK;
+        default:
+            return ESP_ERR_INVALID_ARG;
+    }
+}
+
 void app_main()
 {
     esp_err_t err = nvs_flash_init();
@@ -470,6 +516,7 @@ void app_main()
     notification_queue = xQueueCreate(5, sizeof(struct { char message[96]; }));
 
     app_network_init();
+    app_offline_init();
 
     esp_rmaker_config_t rainmaker_cfg = { .enable_time_sync = true };
     esp_rmaker_node_t *node = esp_rmaker_node_init(&rainmaker_cfg, "SMART_HOME_SYSTEM", "ESP32+Sensors");
@@ -507,10 +554,12 @@ void app_main()
 
     esp_rmaker_device_add_param(sec, param_door_status);
     esp_rmaker_device_add_param(sec, param_sec_status);
+    app_zones_init(sec);
     
     esp_rmaker_device_add_cb(sec, write_cb, NULL);
     
     esp_rmaker_node_add_device(node, sec);
+    app_devices[APP_DEV_SECURITY] = sec;
 
     esp_rmaker_device_t *fan = esp_rmaker_device_create("Fan", ESP_RMAKER_DEVICE_FAN, NULL);
     param_fan_power = esp_rmaker_power_param_create("Power", false);
@@ -527,6 +576,7 @@ void app_main()
 
     esp_rmaker_device_add_cb(fan, write_cb, NULL);
     esp_rmaker_node_add_device(node, fan);
+    app_devices[APP_DEV_FAN] = fan;
 
     esp_rmaker_device_t *light = esp_rmaker_device_create("Light", ESP_RMAKER_DEVICE_LIGHTBULB, NULL);
     param_light_power = esp_rmaker_power_param_create("Power", false);
@@ -537,6 +587,7 @@ void app_main()
     esp_rmaker_device_add_param(light, param_light_status);
     esp_rmaker_device_add_cb(light, write_cb, NULL);
     esp_rmaker_node_add_device(node, light);
+    app_devices[APP_DEV_LIGHT] = light;
 
     esp_rmaker_device_t *tv = esp_rmaker_device_create("TV", ESP_RMAKER_DEVICE_TV, NULL);
     param_tv_power = esp_rmaker_power_param_create("Power", false);
@@ -547,6 +598,7 @@ void app_main()
     esp_rmaker_device_add_param(tv, param_tv_status);
     esp_rmaker_device_add_cb(tv, write_cb, NULL);
     esp_rmaker_node_add_device(node, tv);
+    app_devices[APP_DEV_TV] = tv;
 
     esp_rmaker_device_t *plug = esp_rmaker_device_create("Plug", ESP_RMAKER_DEVICE_SOCKET, NULL);
     param_plug_power = esp_rmaker_power_param_create("Power", false);
@@ -557,6 +609,7 @@ void app_main()
     esp_rmaker_device_add_param(plug, param_plug_status);
     esp_rmaker_device_add_cb(plug, write_cb, NULL);
     esp_rmaker_node_add_device(node, plug);
+    app_devices[APP_DEV_PLUG] = plug;
 
     esp_rmaker_ota_enable_default();
     app_insights_enable();
@@ -564,6 +617,13 @@ void app_main()
     esp_rmaker_start();
     app_network_start(POP_TYPE_RANDOM);
 
+    app_local_ctrl_bind(APP_DEV_FAN, param_fan_speed);
+    app_local_ctrl_bind(APP_DEV_LIGHT, param_light_power);
+    app_local_ctrl_bind(APP_DEV_TV, param_tv_power);
+    app_local_ctrl_bind(APP_DEV_PLUG, param_plug_power);
+    app_local_ctrl_bind(APP_DEV_SECURITY, param_home_sec);
+    app_local_ctrl_start();
+
     xTaskCreate(sensor_task, "sensor_task", 4096, NULL, 5, NULL);
     xTaskCreate(keypad_task, "keypad_task", 4096, NULL, 5, NULL);
     xTaskCreate(notification_task, "notify_task", 3072, NULL, 3, NULL);
@@ -0,0 +1,262 @@
+#include "app_offline.h"
+#include "app_support.h"
+#include "app_local_ctrl.h"
+#include <esp_log.h>
+#include <esp_attr.h>
+#include <esp_event.h>
+#include <esp_rmaker_common_events.h>
+#include <esp_rmaker_work_queue.h>
+#include <esp_timer.h>
+#include <freertos/semphr.h>
+#include <string.h>
+
+#define OFFLINE_ALERT_MAGIC 0x0FF1A1E7
+#define OFFLINE_RETRY_MS    5000    // Before replaying again after a failed report or enqueue
+
+// --- PENDING PARAM TABLE (last value wins) ---
+typedef struct {
+    const esp_rmaker_param_t *param;
+    esp_rmaker_param_val_t val;
+    char str[OFFLINE_STR_LEN];  // Owned copy for string/object/array values
+} pending_param_t;
+
+// --- ALERT RING (survives soft resets) ---
+typedef struct {
+    uint32_t magic;
+    uint32_t head;
+    uint32_t count;
+    char msg[OFFLINE_MAX_ALERTS][OFFLINE_ALERT_LEN];
+} alert_ring_t;
+
+RTC_NOINIT_ATTR static alert_ring_t s_alerts;
+
+static pending_param_t s_pending[OFFLINE_MAX_PARAMS];
+static int s_pending_count;
+static SemaphoreHandle_t s_lock;
+static volatile bool s_mqtt_up;
+static volatile bool s_online;     // true only once the backlog has been flushed
+static esp_timer_handle_t s_retry_timer;
+
+static bool is_str_type(esp_rmaker_val_type_t type) {
+    return type == RMAKER_VAL_TYPE_STRING || type == RMAKER_VAL_TYPE_OBJECT ||
+           type == RMAKER_VAL_TYPE_ARRAY;
+}
+
+static void pending_store(pending_param_t *p, const esp_rmaker_param_t *param, esp_rmaker_param_val_t val) {
+    p->param = param;
+    p->val = val;
+    if (is_str_type(val.type)) {
+        strlcpy(p->str, val.val.s ? val.val.s : "", sizeof(p->str));
+        p->val.val.s = p->str;
+    }
+}
+
+static int pending_find(const esp_rmaker_param_t *param) {
+    for (int i = 0; i < s_pending_count; i++) {
+        if (s_pending[i].param == param) return i;
+    }
+    return -1;
+}
+
+static void alert_push(const char *msg) {
+    if (s_alerts.count == OFFLINE_MAX_ALERTS) {
+        ESP_LOGW(TAG, "Offline alert queue full, dropping oldest: %s", s_alerts.msg[s_alerts.head]);
+        s_alerts.head = (s_alerts.head + 1) % OFFLINE_MAX_ALERTS;
+        s_alerts.count--;
+    }
+    uint32_t tail = (s_alerts.head + s_alerts.count) % OFFLINE_MAX_ALERTS;
+    strlcpy(s_alerts.msg[tail], msg, OFFLINE_ALERT_LEN);
+    s_alerts.count++;
+}
+
+// Puts back params whose report failed, unless a newer value was queued meanwhile.
+static void pending_requeue(const pending_param_t *batch, int n) {
+    int lost = 0;
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    for (int i = 0; i < n; i++) {
+        if (pending_find(batch[i].param) >= 0) {
+            continue;
+        }
+        if (s_pending_count == OFFLINE_MAX_PARAMS) {
+            lost++;
+            continue;
+        }
+        pending_store(&s_pending[s_pending_count++], batch[i].param, batch[i].val);
+    }
+    xSemaphoreGive(s_lock);
+    if (lost) {
+        ESP_LOGW(TAG, "Offline param table full, dropped %d replayed param(s)", lost);
+    }
+}
+
+// --- REPLAY ---
+
+static void offline_replay(void *priv);
+
+static void offline_retry_later(void) {
+    esp_timer_stop(s_retry_timer);
+    esp_timer_start_once(s_retry_timer, (uint64_t)OFFLINE_RETRY_MS * 1000);
+}
+
+static void offline_schedule_replay(void) {
+    if (esp_rmaker_work_queue_add_task_with_prio(offline_replay, NULL,
+                                                 ESP_RMAKER_WORK_PRIO_URGENT, 0) != ESP_OK) {
+        ESP_LOGW(TAG, "Work queue full, replaying offline queue in %d ms", OFFLINE_RETRY_MS);
+        offline_retry_later();
+    }
+}
+
+static void offline_retry_timer_cb(void *arg) {
+    if (s_mqtt_up) {
+        offline_schedule_replay();
+    }
+}
+
+static void offline_replay(void *priv) {
+    static pending_param_t batch[OFFLINE_MAX_PARAMS];
+    char alert[OFFLINE_ALERT_LEN];
+
+    while (s_mqtt_up) {
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        int n = s_pending_count;
+        bool have_alert = s_alerts.count > 0;
+        if (n == 0 && !have_alert) {
+            s_online = true;
+            xSemaphoreGive(s_lock);
+            ESP_LOGI(TAG, "Offline queue flushed");
+            return;
+        }
+        for (int i = 0; i < n; i++) {
+            pending_store(&batch[i], s_pending[i].param, s_pending[i].val);
+        }
+        s_pending_count = 0;
+        if (have_alert) {
+            strlcpy(alert, s_alerts.msg[s_alerts.head], sizeof(alert));
+        }
+        xSemaphoreGive(s_lock);
+
+        // esp_rmaker_param_update() only stages a value; the final
+        // update_and_report() sends every staged param in one message.
+        for (int i = 0; i < n - 1; i++) {
+            esp_rmaker_param_update(batch[i].param, batch[i].val);
+        }
+        if (n > 0) {
+            if (esp_rmaker_param_update_and_report(batch[n - 1].param, batch[n - 1].val) != ESP_OK) {
+                pending_requeue(batch, n);
+                ESP_LOGW(TAG, "Param replay failed, retrying in %d ms", OFFLINE_RETRY_MS);
+                offline_retry_later();
+                return;
+            }
+            ESP_LOGI(TAG, "Replayed %d param(s) in one report", n);
+        }
+
+        // Alerts go out one at a time, oldest first, and are only dropped once accepted.
+        if (have_alert) {
+            if (esp_rmaker_raise_alert(alert) != ESP_OK) {
+                ESP_LOGW(TAG, "Alert replay failed, retrying in %d ms", OFFLINE_RETRY_MS);
+                offline_retry_later();
+                return;
+            }
+            xSemaphoreTake(s_lock, portMAX_DELAY);
+            s_alerts.head = (s_alerts.head + 1) % OFFLINE_MAX_ALERTS;
+            s_alerts.count--;
+            xSemaphoreGive(s_lock);
+        }
+    }
+}
+
+static void offline_event_handler(void* arg, esp_event_base_t event_base,
+                                  int32_t event_id, void* event_data) {
+    switch (event_id) {
+        case RMAKER_MQTT_EVENT_CONNECTED:
+            s_mqtt_up = true;
+            offline_schedule_replay();
+            break;
+        case RMAKER_MQTT_EVENT_DISCONNECTED:
+            s_mqtt_up = false;
+            s_online = false;
+            esp_timer_stop(s_retry_timer);
+            break;
+        default:
+            break;
+    }
+}
+
+// --- PUBLIC API ---
+
+esp_err_t app_offline_init(void) {
+    if (s_alerts.magic != OFFLINE_ALERT_MAGIC || s_alerts.head >= OFFLINE_MAX_ALERTS ||
+        s_alerts.count > OFFLINE_MAX_ALERTS) {
+        memset(&s_alerts, 0, sizeof(s_alerts));
+        s_alerts.magic = OFFLINE_ALERT_MAGIC;
+    } else if (s_alerts.count > 0) {
+        ESP_LOGI(TAG, "Recovered %u offline alert(s) from RTC memory", (unsigned)s_alerts.count);
+        for (int i = 0; i < OFFLINE_MAX_ALERTS; i++) {
+            s_alerts.msg[i][OFFLINE_ALERT_LEN - 1] = '\0';
+        }
+    }
+
+    s_lock = xSemaphoreCreateMutex();
+    if (!s_lock) {
+        return ESP_ERR_NO_MEM;
+    }
+    const esp_timer_create_args_t timer_args = {
+        .callback = offline_retry_timer_cb,
+        .name = "offline_retry",
+    };
+    if (esp_timer_create(&timer_args, &s_retry_timer) != ESP_OK) {
+        return ESP_ERR_NO_MEM;
+    }
+    esp_err_t err = esp_event_loop_create_default();
+    if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) {
+        return err;
+    }
+    return esp_event_handler_register(RMAKER_COMMON_EVENT, ESP_EVENT_ANY_ID, offline_event_handler, NULL);
+}
+
+bool app_offline_is_connected(void) {
+    return s_online;
+}
+
+esp_err_t app_report_param(const esp_rmaker_param_t *param, esp_rmaker_param_val_t val) {
+    app_local_ctrl_notify(param);
+    // s_online is tested under the lock the replay sets it with, once the queue is empty,
+    // so that a value queued here is either replayed or reported directly.
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    if (s_online) {
+        xSemaphoreGive(s_lock);
+        return esp_rmaker_param_update_and_report(param, val);
+    }
+    if (is_str_type(val.type) && val.val.s && strlen(val.val.s) >= OFFLINE_STR_LEN) {
+        xSemaphoreGive(s_lock);
+        ESP_LOGW(TAG, "Value too long to queue offline, reporting directly");
+        return esp_rmaker_param_update_and_report(param, val);
+    }
+
+    // Keep the local model current so reads and local control see the new value.
+    esp_rmaker_param_update(param, val);
+
+    int idx = pending_find(param);
+    if (idx < 0) {
+        if (s_pending_count == OFFLINE_MAX_PARAMS) {
+            xSemaphoreGive(s_lock);
+            ESP_LOGW(TAG, "Offline param table full");
+            return ESP_ERR_NO_MEM;
+        }
+        idx = s_pending_count++;
+    }
+    pending_store(&s_pending[idx], param, val);
+    xSemaphoreGive(s_lock);
+    return ESP_OK;
+}
+
+esp_err_t app_raise_alert(const char *msg) {
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    if (s_online) {
+        xSemaphoreGive(s_lock);
+        return esp_rmaker_raise_alert(msg);
+    }
+    alert_push(msg);
+    xSemaphoreGive(s_lock);
+    return ESP_OK;
+}
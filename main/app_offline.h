@@ -0,0 +1,24 @@
+#pragma once
+
+#include <esp_err.h>
+#include <esp_rmaker_core.h>
+
+// --- OFFLINE QUEUE CONFIGURATION ---
+#define OFFLINE_MAX_PARAMS      32   // Distinct params that can be pending at once
+#define OFFLINE_MAX_ALERTS      8    // Alerts kept across Wi-Fi drops and reboots
+#define OFFLINE_ALERT_LEN       96
+#define OFFLINE_STR_LEN         96
+
+// Must be called before any report/alert goes through the queue.
+esp_err_t app_offline_init(void);
+
+// Drop-in replacement for esp_rmaker_param_update_and_report().
+// Online: reported immediately. Offline: value updated locally and
+// coalesced (last value wins) until MQTT reconnects.
+esp_err_t app_report_param(const esp_rmaker_param_t *param, esp_rmaker_param_val_t val);
+
+// Drop-in replacement for esp_rmaker_raise_alert().
+// Offline alerts are kept in RTC memory, in order, and replayed on reconnect.
+esp_err_t app_raise_alert(const char *msg);
+
+bool app_offline_is_connected(void);
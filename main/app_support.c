@@ -7,9 +7,14 @@
 #include <esp_ota_ops.h>
 #include <esp_insights.h>
 #include <esp_diagnostics.h>
+#include <esp_diagnostics_system_metrics.h>
+#include <esp_rmaker_common_console.h>
 #include <esp_rmaker_mqtt.h>
 #include <esp_rmaker_common_events.h>
+#include <esp_rmaker_work_queue.h>
+#include <freertos/semphr.h>
 #include <string.h>
+#include <stdlib.h>
 
 // --- UTILITIES & DRIVERS ---
 
@@ -137,22 +142,22 @@ void beep(int ms) {
 }
 
 // --- ULTRASONIC SENSOR ---
-float get_distance_cm(void) {
-    gpio_set_level(TRIG_GPIO, 0);
+float get_distance_cm(gpio_num_t trig, gpio_num_t echo) {
+    gpio_set_level(trig, 0);
     esp_rom_delay_us(2);
-    gpio_set_level(TRIG_GPIO, 1);
+    gpio_set_level(trig, 1);
     esp_rom_delay_us(10);
-    gpio_set_level(TRIG_GPIO, 0);
+    gpio_set_level(trig, 0);
 
     int64_t start = esp_timer_get_time();
     int64_t timeout = start + 25000;
     
-    while (gpio_get_level(ECHO_GPIO) == 0) {
+    while (gpio_get_level(echo) == 0) {
         if (esp_timer_get_time() > timeout) return -1.0;
     }
     
     int64_t echo_start = esp_timer_get_time();
-    while (gpio_get_level(ECHO_GPIO) == 1) {
+    while (gpio_get_level(echo) == 1) {
         if (esp_timer_get_time() > echo_start + 25000) break;
     }
     int64_t echo_end = esp_timer_get_time();
@@ -181,23 +186,240 @@ void notification_task(void *arg) {
 #define INSIGHTS_TOPIC_SUFFIX       "diagnostics/from-node"
 #define INSIGHTS_TOPIC_RULE         "insights_message_delivery"
 
-static int app_insights_data_send(void *data, size_t len)
+/*
+ * Batching transport: Insights payloads are appended to one buffer and sent as
+ * a single QoS1 publish when the batch is full or has lingered long enough.
+ * Each payload gets a virtual msg_id outside the 16-bit MQTT range; when the
+ * batch's real publish is acked, success is posted for every payload in it.
+ * No MQTT budget means "retry later", not failure.
+ *
+ * Payloads are concatenated as they are, up to CONFIG_APP_INSIGHTS_BATCH_MAX_MSGS
+ * of them; set it to 1 for a backend which does not split such a publish.
+ *
+ * A batch whose publish is not acked within INSIGHTS_BATCH_ACK_TIMEOUT_MS, or
+ * is in flight when MQTT disconnects, is reported failed so that its slot is
+ * freed and Insights sends the data again.
+ */
+#define INSIGHTS_BATCH_MAX_SIZE     (8 * 1024)  // Upper bound for one MQTT publish
+#define INSIGHTS_BATCH_MAX_MSGS     CONFIG_APP_INSIGHTS_BATCH_MAX_MSGS
+#define INSIGHTS_BATCH_INFLIGHT     2
+#define INSIGHTS_BATCH_LINGER_MS    1500
+#ifdef CONFIG_ESP_RMAKER_MQTT_BUDGET_REVIVE_PERIOD
+#define INSIGHTS_BUDGET_RETRY_MS    (CONFIG_ESP_RMAKER_MQTT_BUDGET_REVIVE_PERIOD * 1000)
+#else
+#define INSIGHTS_BUDGET_RETRY_MS    5000
+#endif
+#ifdef CONFIG_ESP_RMAKER_MQTT_PUBLISH_TIMEOUT
+#define INSIGHTS_BATCH_ACK_TIMEOUT_MS   (CONFIG_ESP_RMAKER_MQTT_PUBLISH_TIMEOUT * 1000)
+#else
+#define INSIGHTS_BATCH_ACK_TIMEOUT_MS   30000
+#endif
+#define INSIGHTS_EVENT_POST_TICKS   pdMS_TO_TICKS(500)
+#define INSIGHTS_VIRTUAL_ID_BASE    0x10000
+
+typedef struct {
+    int mqtt_msg_id;            // 0 when the slot is free
+    int64_t sent_us;
+    uint8_t count;
+    int ids[INSIGHTS_BATCH_MAX_MSGS];
+} insights_batch_t;
+
+typedef struct {
+    insights_batch_t batch;
+    int32_t event;
+} insights_batch_result_t;
+
+static struct {
+    SemaphoreHandle_t lock;
+    uint8_t *buf;
+    size_t len;
+    uint8_t count;
+    int ids[INSIGHTS_BATCH_MAX_MSGS];
+    insights_batch_t inflight[INSIGHTS_BATCH_INFLIGHT];
+    int next_id;
+    esp_timer_handle_t flush_timer;
+} s_batch;
+
+static void insights_batch_arm(uint32_t ms)
+{
+    esp_timer_stop(s_batch.flush_timer);
+    esp_timer_start_once(s_batch.flush_timer, (uint64_t)ms * 1000);
+}
+
+static void insights_batch_post(const insights_batch_t *done, int32_t insights_event, TickType_t timeout)
+{
+    esp_insights_transport_event_data_t data;
+    for (int i = 0; i < done->count; i++) {
+        memset(&data, 0, sizeof(data));
+        data.msg_id = done->ids[i];
+        if (esp_event_post(INSIGHTS_EVENT, insights_event, &data, sizeof(data), timeout) != ESP_OK) {
+            // Insights times the message out itself and sends the data again.
+            ESP_LOGW(TAG, "Insights event for msg_id %d dropped", data.msg_id);
+        }
+    }
+}
+
+static void insights_batch_post_work(void *priv)
+{
+    insights_batch_result_t *result = priv;
+    insights_batch_post(&result->batch, result->event, INSIGHTS_EVENT_POST_TICKS);
+    free(result);
+}
+
+/*
+ * Called from the default event loop task, so the events are posted from the
+ * work queue: posting to a full loop queue from the loop task would wait for
+ * itself. If that fails, they are posted without waiting.
+ */
+static void insights_batch_report(const insights_batch_t *done, int32_t insights_event)
+{
+    if (done->count == 0) {
+        return;
+    }
+    insights_batch_result_t *result = malloc(sizeof(*result));
+    if (result) {
+        result->batch = *done;
+        result->event = insights_event;
+        if (esp_rmaker_work_queue_add_task_with_prio(insights_batch_post_work, result,
+                                                     ESP_RMAKER_WORK_PRIO_BACKGROUND, 0) == ESP_OK) {
+            return;
+        }
+        free(result);
+    }
+    insights_batch_post(done, insights_event, 0);
+}
+
+/* Frees the slots matching msg_id (0 for all of them) into done, with the lock held */
+static int insights_batch_take_inflight(int mqtt_msg_id, insights_batch_t done[INSIGHTS_BATCH_INFLIGHT])
+{
+    int n = 0;
+    for (int i = 0; i < INSIGHTS_BATCH_INFLIGHT; i++) {
+        insights_batch_t *slot = &s_batch.inflight[i];
+        if (slot->mqtt_msg_id != 0 && (mqtt_msg_id == 0 || slot->mqtt_msg_id == mqtt_msg_id)) {
+            done[n++] = *slot;
+            slot->mqtt_msg_id = 0;
+        }
+    }
+    return n;
+}
+
+static void insights_batch_flush(void)
 {
     char topic[128];
     int msg_id = -1;
+    insights_batch_t expired[INSIGHTS_BATCH_INFLIGHT];
+    int n_expired = 0;
+
+    xSemaphoreTake(s_batch.lock, portMAX_DELAY);
+    int64_t now = esp_timer_get_time();
+    for (int i = 0; i < INSIGHTS_BATCH_INFLIGHT; i++) {
+        insights_batch_t *slot = &s_batch.inflight[i];
+        if (slot->mqtt_msg_id != 0 && now - slot->sent_us > (int64_t)INSIGHTS_BATCH_ACK_TIMEOUT_MS * 1000) {
+            ESP_LOGW(TAG, "Insights batch msg_id %d not acked, reporting it failed", slot->mqtt_msg_id);
+            expired[n_expired++] = *slot;
+            slot->mqtt_msg_id = 0;
+        }
+    }
+    if (s_batch.len == 0) {
+        xSemaphoreGive(s_batch.lock);
+        goto report;
+    }
+    insights_batch_t *slot = NULL;
+    for (int i = 0; i < INSIGHTS_BATCH_INFLIGHT; i++) {
+        if (s_batch.inflight[i].mqtt_msg_id == 0) {
+            slot = &s_batch.inflight[i];
+            break;
+        }
+    }
+    if (!slot || esp_rmaker_mqtt_is_budget_available() == false) {
+        insights_batch_arm(INSIGHTS_BUDGET_RETRY_MS);
+        xSemaphoreGive(s_batch.lock);
+        goto report;
+    }
+    esp_rmaker_create_mqtt_topic(topic, sizeof(topic), INSIGHTS_TOPIC_SUFFIX, INSIGHTS_TOPIC_RULE);
+    if (esp_rmaker_mqtt_publish(topic, s_batch.buf, s_batch.len, RMAKER_MQTT_QOS1, &msg_id) != ESP_OK || msg_id <= 0) {
+        insights_batch_arm(INSIGHTS_BUDGET_RETRY_MS);
+        xSemaphoreGive(s_batch.lock);
+        goto report;
+    }
+    ESP_LOGD(TAG, "Insights batch: %d payload(s), %d bytes, msg_id %d", s_batch.count, (int)s_batch.len, msg_id);
+    slot->mqtt_msg_id = msg_id;
+    slot->sent_us = now;
+    slot->count = s_batch.count;
+    memcpy(slot->ids, s_batch.ids, s_batch.count * sizeof(int));
+    s_batch.len = 0;
+    s_batch.count = 0;
+    xSemaphoreGive(s_batch.lock);
+
+report:
+    for (int i = 0; i < n_expired; i++) {
+        insights_batch_post(&expired[i], INSIGHTS_EVENT_TRANSPORT_SEND_FAILED, INSIGHTS_EVENT_POST_TICKS);
+    }
+}
+
+static void insights_batch_flush_work(void *priv)
+{
+    insights_batch_flush();
+}
+
+static void insights_batch_timer_cb(void *arg)
+{
+    if (esp_rmaker_work_queue_add_task_with_prio(insights_batch_flush_work, NULL,
+                                                 ESP_RMAKER_WORK_PRIO_BACKGROUND, 0) != ESP_OK) {
+        // Not flushed from the timer task, which a publish could hold up.
+        ESP_LOGW(TAG, "Work queue full, flushing Insights batch in %d ms", INSIGHTS_BUDGET_RETRY_MS);
+        insights_batch_arm(INSIGHTS_BUDGET_RETRY_MS);
+    }
+}
+
+static int app_insights_data_send(void *data, size_t len)
+{
     if (data == NULL) {
         return 0;
     }
-    char *node_id = esp_rmaker_get_node_id();
-    if (!node_id) {
+    if (!esp_rmaker_get_node_id() || len > INSIGHTS_BATCH_MAX_SIZE) {
         return -1;
     }
-    if (esp_rmaker_mqtt_is_budget_available() == false) {
-        return ESP_FAIL;
+
+    xSemaphoreTake(s_batch.lock, portMAX_DELAY);
+    if (s_batch.len + len > INSIGHTS_BATCH_MAX_SIZE || s_batch.count == INSIGHTS_BATCH_MAX_MSGS) {
+        xSemaphoreGive(s_batch.lock);
+        insights_batch_flush();
+        xSemaphoreTake(s_batch.lock, portMAX_DELAY);
+        if (s_batch.len + len > INSIGHTS_BATCH_MAX_SIZE || s_batch.count == INSIGHTS_BATCH_MAX_MSGS) {
+            // Still no room: let Insights keep the data and retry next period.
+            xSemaphoreGive(s_batch.lock);
+            return -1;
+        }
+    }
+    memcpy(s_batch.buf + s_batch.len, data, len);
+    s_batch.len += len;
+    int id = s_batch.next_id;
+    s_batch.next_id = (id >= INT32_MAX - 1) ? INSIGHTS_VIRTUAL_ID_BASE + 1 : id + 1;
+    s_batch.ids[s_batch.count++] = id;
+    if (s_batch.count == INSIGHTS_BATCH_MAX_MSGS) {
+        xSemaphoreGive(s_batch.lock);
+        insights_batch_flush();
+        return id;
+    }
+    if (s_batch.count == 1) {
+        insights_batch_arm(INSIGHTS_BATCH_LINGER_MS);
+    }
+    xSemaphoreGive(s_batch.lock);
+    return id;
+}
+
+/* mqtt_msg_id 0 completes every batch in flight */
+static void insights_batch_complete(int mqtt_msg_id, int32_t insights_event)
+{
+    insights_batch_t done[INSIGHTS_BATCH_INFLIGHT];
+    xSemaphoreTake(s_batch.lock, portMAX_DELAY);
+    int n = insights_batch_take_inflight(mqtt_msg_id, done);
+    xSemaphoreGive(s_batch.lock);
+
+    for (int i = 0; i < n; i++) {
+        insights_batch_report(&done[i], insights_event);
     }
-    esp_rmaker_create_mqtt_topic(topic, sizeof(topic), INSIGHTS_TOPIC_SUFFIX, INSIGHTS_TOPIC_RULE);
-    esp_rmaker_mqtt_publish(topic, data, len, RMAKER_MQTT_QOS1, &msg_id);
-    return msg_id;
 }
 
 static void rmaker_common_event_handler(void* arg, esp_event_base_t event_base,
@@ -206,12 +428,21 @@ static void rmaker_common_event_handler(void* arg, esp_event_base_t event_base,
     if (event_base != RMAKER_COMMON_EVENT) {
         return;
     }
-    esp_insights_transport_event_data_t data;
+    int msg_id = event_data ? *(int *)event_data : 0;
     switch(event_id) {
         case RMAKER_MQTT_EVENT_PUBLISHED:
-            memset(&data, 0, sizeof(data));
-            data.msg_id = *(int *)event_data;
-            esp_event_post(INSIGHTS_EVENT, INSIGHTS_EVENT_TRANSPORT_SEND_SUCCESS, &data, sizeof(data), portMAX_DELAY);
+            if (msg_id > 0) {
+                insights_batch_complete(msg_id, INSIGHTS_EVENT_TRANSPORT_SEND_SUCCESS);
+            }
+            break;
+        case RMAKER_MQTT_EVENT_MSG_DELETED:
+            if (msg_id > 0) {
+                insights_batch_complete(msg_id, INSIGHTS_EVENT_TRANSPORT_SEND_FAILED);
+            }
+            break;
+        case RMAKER_MQTT_EVENT_DISCONNECTED:
+            // Acks of the batches in flight may never come; Insights sends their data again.
+            insights_batch_complete(0, INSIGHTS_EVENT_TRANSPORT_SEND_FAILED);
             break;
         default:
             break;
@@ -227,6 +458,18 @@ esp_err_t app_insights_enable(void)
 
     char *node_id = esp_rmaker_get_node_id();
 
+    s_batch.lock = xSemaphoreCreateMutex();
+    s_batch.buf = malloc(INSIGHTS_BATCH_MAX_SIZE);
+    s_batch.next_id = INSIGHTS_VIRTUAL_ID_BASE + 1;
+    const esp_timer_create_args_t timer_args = {
+        .callback = insights_batch_timer_cb,
+        .name = "insights_batch",
+    };
+    if (!s_batch.lock || !s_batch.buf || esp_timer_create(&timer_args, &s_batch.flush_timer) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to set up Insights batching");
+        return ESP_ERR_NO_MEM;
+    }
+
     esp_insights_transport_config_t transport = {
         .callbacks.data_send  = app_insights_data_send,
     };
@@ -242,5 +485,10 @@ esp_err_t app_insights_enable(void)
 
     esp_insights_enable(&config);
 
+#if CONFIG_DIAG_ENABLE_HEAP_PROFILER
+    esp_rmaker_common_console_init();
+    esp_diag_heap_profiler_register_cmd();
+#endif
+
     return ESP_OK;
 }
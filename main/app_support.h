@@ -31,6 +31,16 @@
 #define EVT_DEV   "DEVICE"
 #define EVT_SYS   "SYSTEM"
 
+// --- DEVICES (shared by keypad, RainMaker and local control) ---
+typedef enum {
+    APP_DEV_FAN = 0,    // value: speed 0-5
+    APP_DEV_LIGHT,      // value: 0/1
+    APP_DEV_TV,         // value: 0/1
+    APP_DEV_PLUG,       // value: 0/1
+    APP_DEV_SECURITY,   // value: bit0 armed, bit1 door open (set: armed 0/1)
+    APP_DEV_MAX,
+} app_dev_t;
+
 // --- SHARED GLOBALS ---
 extern esp_rmaker_param_t *param_ota_url;
 extern QueueHandle_t notification_queue;
@@ -39,6 +49,8 @@ extern QueueHandle_t notification_queue;
 
 // From app_main.c (Called by support)
 void send_alert(const char *msg);
+int app_device_get(app_dev_t dev);
+esp_err_t app_device_set(app_dev_t dev, int value);
 
 // From app_support.c (Called by main)
 void buzzer_init(void);
@@ -54,7 +66,7 @@ void buzzer_error_sound(void);
 
 void indicate_device_on(void);
 void beep(int ms);
-float get_distance_cm(void);
+float get_distance_cm(gpio_num_t trig, gpio_num_t echo);
 
 void notification_task(void *arg);
 esp_err_t app_insights_enable(void);
@@ -0,0 +1,147 @@
+#include "app_zones.h"
+#include "app_support.h"
+#include "app_offline.h"
+#include <esp_log.h>
+#include <esp_timer.h>
+
+// --- ZONE TABLE ---
+// Add one line per door/window sensor. Zones are ranged one at a time,
+// so sensors can share a wall without hearing each other's echoes.
+static const zone_cfg_t zone_table[] = {
+    { "Front Door", TRIG_GPIO, ECHO_GPIO, DOOR_THRESHOLD_CM, 2, ZONE_AUTO_LOCK_MS },
+    // { "Back Door", GPIO_NUM_0, GPIO_NUM_8, DOOR_THRESHOLD_CM, 1, ZONE_AUTO_LOCK_MS },
+};
+
+#define ZONE_NO_ECHO_CM 400.0f     // Missing echo: treat as nothing in range
+
+#define ZONE_COUNT ((int)(sizeof(zone_table) / sizeof(zone_table[0])))
+_Static_assert(ZONE_COUNT <= MAX_ZONES, "Too many zones in zone_table");
+
+// --- ZONE STATE (struct-of-arrays) ---
+// Hot fields used by the per-step pass are kept in their own arrays so
+// scanning all zones touches a few contiguous bytes per zone.
+static struct {
+    // Scheduling (smooth weighted round-robin)
+    int16_t credit[MAX_ZONES];
+    uint8_t weight[MAX_ZONES];
+
+    // Filter: median of the last three readings
+    float sample[3][MAX_ZONES];
+    uint8_t sample_idx[MAX_ZONES];
+    uint8_t sample_cnt[MAX_ZONES];
+
+    // Door state
+    bool near[MAX_ZONES];
+    bool open[MAX_ZONES];
+    int64_t last_activity[MAX_ZONES];
+    int64_t auto_lock_us[MAX_ZONES];
+
+    esp_rmaker_param_t *param[MAX_ZONES];
+} zones;
+
+static int weight_total;
+
+static float median3(float a, float b, float c) {
+    if (a > b) { float t = a; a = b; b = t; }
+    if (b > c) { b = c; }
+    return a > b ? a : b;
+}
+
+static void zone_filter_push(int z, float d) {
+    zones.sample[zones.sample_idx[z]][z] = d;
+    zones.sample_idx[z] = (zones.sample_idx[z] + 1) % 3;
+    if (zones.sample_cnt[z] < 3) zones.sample_cnt[z]++;
+}
+
+static float zone_filtered(int z) {
+    if (zones.sample_cnt[z] < 3) {
+        return zones.sample[(zones.sample_idx[z] + 2) % 3][z];
+    }
+    return median3(zones.sample[0][z], zones.sample[1][z], zones.sample[2][z]);
+}
+
+// Each zone gets `priority` slots per round, spread out evenly.
+static int zone_pick_next(void) {
+    int best = 0;
+    for (int z = 0; z < ZONE_COUNT; z++) {
+        zones.credit[z] += zones.weight[z];
+        if (zones.credit[z] > zones.credit[best]) best = z;
+    }
+    zones.credit[best] -= weight_total;
+    return best;
+}
+
+// --- PUBLIC API ---
+
+esp_err_t app_zones_init(esp_rmaker_device_t *dev) {
+    weight_total = 0;
+    for (int z = 0; z < ZONE_COUNT; z++) {
+        const zone_cfg_t *cfg = &zone_table[z];
+        gpio_reset_pin(cfg->trig); gpio_set_direction(cfg->trig, GPIO_MODE_OUTPUT);
+        gpio_reset_pin(cfg->echo); gpio_set_direction(cfg->echo, GPIO_MODE_INPUT);
+
+        zones.weight[z] = cfg->priority ? cfg->priority : 1;
+        weight_total += zones.weight[z];
+        zones.auto_lock_us[z] = (int64_t)cfg->auto_lock_ms * 1000;
+
+        zones.param[z] = esp_rmaker_param_create(cfg->name, NULL, esp_rmaker_bool(false), PROP_FLAG_READ);
+        if (!zones.param[z]) {
+            return ESP_ERR_NO_MEM;
+        }
+        esp_rmaker_device_add_param(dev, zones.param[z]);
+    }
+    ESP_LOGI(TAG, "%d door zone(s) registered", ZONE_COUNT);
+    return ESP_OK;
+}
+
+int app_zones_step(bool armed, zone_evt_t *evts, int max_evts) {
+    int z = zone_pick_next();
+    float d = get_distance_cm(zone_table[z].trig, zone_table[z].echo);
+    zone_filter_push(z, d > 0 ? d : ZONE_NO_ECHO_CM);
+    zones.near[z] = zone_filtered(z) < zone_table[z].threshold_cm;
+
+    int n = 0;
+    int64_t now = esp_timer_get_time();
+    for (int i = 0; i < ZONE_COUNT && n < max_evts; i++) {
+        if (!zones.open[i]) {
+            if (zones.near[i] && !armed) {
+                zones.open[i] = true;
+                zones.last_activity[i] = now;
+                evts[n++] = (zone_evt_t){ .zone = i, .type = ZONE_EVT_OPENED };
+            }
+            continue;
+        }
+        if (zones.near[i]) {
+            zones.last_activity[i] = now;
+        }
+        if (armed) {
+            zones.open[i] = false;
+            evts[n++] = (zone_evt_t){ .zone = i, .type = ZONE_EVT_CLOSED };
+        } else if (now - zones.last_activity[i] > zones.auto_lock_us[i]) {
+            zones.open[i] = false;
+            evts[n++] = (zone_evt_t){ .zone = i, .type = ZONE_EVT_IDLE_TIMEOUT };
+        }
+    }
+
+    for (int i = 0; i < n; i++) {
+        int e = evts[i].zone;
+        app_report_param(zones.param[e], esp_rmaker_bool(zones.open[e]));
+    }
+    return n;
+}
+
+int app_zones_count(void) {
+    return ZONE_COUNT;
+}
+
+const char *app_zones_name(int zone) {
+    return (zone >= 0 && zone < ZONE_COUNT) ? zone_table[zone].name : "?";
+}
+
+bool app_zones_any_open(void) {
+    bool any = false;
+    for (int z = 0; z < ZONE_COUNT; z++) {
+        any |= zones.open[z];
+    }
+    return any;
+}
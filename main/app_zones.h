@@ -0,0 +1,41 @@
+#pragma once
+
+#include <esp_err.h>
+#include <esp_rmaker_core.h>
+#include <driver/gpio.h>
+
+// --- ZONE CONFIGURATION ---
+#define MAX_ZONES           8
+#define ZONE_SLOT_MS        60          // One ranging per slot, so echoes never overlap
+#define ZONE_AUTO_LOCK_MS   10000
+
+typedef struct {
+    const char *name;           // Also the zone's RainMaker param name
+    gpio_num_t trig;
+    gpio_num_t echo;
+    float threshold_cm;
+    uint8_t priority;           // Ranging slots per scheduling round (>= 1)
+    uint32_t auto_lock_ms;      // Idle time before the zone closes
+} zone_cfg_t;
+
+typedef enum {
+    ZONE_EVT_OPENED,
+    ZONE_EVT_CLOSED,            // Closed because the system was armed
+    ZONE_EVT_IDLE_TIMEOUT,      // Closed by the zone's auto-lock timer
+} zone_evt_type_t;
+
+typedef struct {
+    uint8_t zone;
+    zone_evt_type_t type;
+} zone_evt_t;
+
+// Configures every zone's pins and adds one "<name>" bool param per zone to dev.
+esp_err_t app_zones_init(esp_rmaker_device_t *dev);
+
+// Ranges the next zone in the schedule, then updates open/close state for all
+// zones in one pass. Returns the number of events written to evts.
+int app_zones_step(bool armed, zone_evt_t *evts, int max_evts);
+
+int app_zones_count(void);
+const char *app_zones_name(int zone);
+bool app_zones_any_open(void);
@@ -9,12 +9,17 @@
 #include <soc/soc_memory_layout.h>
 #include <freertos/FreeRTOS.h>
 #include <freertos/semphr.h>
+#include <freertos/task.h>
+#include <esp_event.h>
 #include <esp_system.h>
 #include <esp_log.h>
 #include <nvs_flash.h>
 
 #include <esp_diag_data_store.h>
 #include "rtc_store.h"
+#include "rtc_store_flash.h"
+#include "rtc_store_peek.h"
+#include "rtc_store_stats.h"
 #include <esp_crc.h>
 #include <inttypes.h>
 
@@ -62,14 +67,47 @@
 #define DIAG_NON_CRITICAL_DATA_REPORTING_WATERMARK \
     ((DIAG_NON_CRITICAL_BUF_SIZE * (100 - CONFIG_DIAG_DATA_STORE_REPORTING_WATERMARK_PERCENT)) / 100)
 
+/* With the flash tier, data is spilled to flash once the buffer is filled halfway between the
+ * reporting watermark and full, which only happens when reporting can't keep up, e.g. while offline.
+ * A spill empties the buffer: critical records can't be told apart in RTC memory, so the tail is
+ * the one place known to be a record boundary, and large records need the room anyway.
+ */
+#define RTC_STORE_SPILL_PERCENT         ((100 + CONFIG_DIAG_DATA_STORE_REPORTING_WATERMARK_PERCENT) / 2)
+#define RTC_STORE_SPILL_WATERMARK(size) (((size) * (100 - RTC_STORE_SPILL_PERCENT)) / 100)
+
+#ifndef RTC_STORE_SPILL_TASK_STACK
+#define RTC_STORE_SPILL_TASK_STACK      3072
+#endif
+#ifndef RTC_STORE_SPILL_TASK_PRIO
+#define RTC_STORE_SPILL_TASK_PRIO       5
+#endif
+
 /* non critical data is stored in Length - Value format */
 #define SIZE_OF_DATA_LEN    sizeof(size_t)
 
-// Assumption is RTC memory size will never exeed UINT16_MAX
+/* Smallest non-critical record: meta index byte, header and one byte of data */
+#define RTC_STORE_REC_MIN           (1 + sizeof(rtc_store_non_critical_data_hdr_t) + 1)
+
+/* The record index has a slot for every RTC_STORE_REC_MIN bytes of the buffer, so that the buffer
+ * can always be filled with records of any size
+ */
+#define RTC_STORE_REC_INDEX_SIZE    ((DIAG_NON_CRITICAL_BUF_SIZE + RTC_STORE_REC_MIN - 1) / RTC_STORE_REC_MIN)
+#define RTC_STORE_REC_SLOT(offset)  ((offset) / RTC_STORE_REC_MIN)
+
+/* Bump whenever the layout of rtc_store_t changes, so that data left in RTC memory by a firmware
+ * with another layout is discarded instead of misread after an update
+ */
+#define RTC_STORE_LAYOUT_VERSION    2
+#define RTC_STORE_LAYOUT            ((RTC_STORE_LAYOUT_VERSION << 24) ^ (uint32_t) sizeof(rtc_store_t))
+
+#define RTC_STORE_OFFSET_BITS       16
+_Static_assert(DIAG_CRITICAL_BUF_SIZE < (1 << RTC_STORE_OFFSET_BITS), "critical data size too large");
+_Static_assert(DIAG_NON_CRITICAL_BUF_SIZE < (1 << RTC_STORE_OFFSET_BITS), "non critical data size too large");
+
 typedef union {
     struct {
-        uint16_t read_offset;
-        uint16_t filled;
+        uint32_t read_offset : RTC_STORE_OFFSET_BITS;
+        uint32_t filled : RTC_STORE_OFFSET_BITS;
     };
     uint32_t value;
 } data_store_info_t;
@@ -80,10 +118,50 @@ typedef struct {
     data_store_info_t info;
 } data_store_t;
 
+/* Non-critical data is a lock-free multi-producer, single-consumer ring.
+ *
+ * A writer reserves buffer space with a compare-and-swap on `info`, fills in the record, and then
+ * commits it in one step by storing the record's end offset with RTC_STORE_REC_COMMITTED into the
+ * index slot of the offset it starts at. Records are at least RTC_STORE_REC_MIN bytes long, so no
+ * two records in the buffer start in the same slot. The reader only ever sees records up to the
+ * first one which is reserved but not committed yet.
+ *
+ * The index also lets the store find how many records to drop for a given amount of space by
+ * scanning a few uint16s, instead of reading record headers out of the buffer one by one.
+ *
+ * Writers never block, so non-critical data can be written concurrently from any task or ISR.
+ * `lock` then only serializes readers with each other.
+ */
+#define RTC_STORE_REC_COMMITTED     0x8000
+#define RTC_STORE_REC_END_MASK      0x7FFF
+_Static_assert(DIAG_NON_CRITICAL_BUF_SIZE <= RTC_STORE_REC_END_MASK, "non critical data size too large");
+
+#if CONFIG_RTC_STORE_OVERWRITE_NON_CRITICAL_DATA
+/* Reader gives up after this many copies torn by concurrent eviction */
+#define RTC_STORE_READ_RETRIES      4
+#endif
+
 typedef struct {
-    SemaphoreHandle_t lock;     // critical lock
+    uint16_t slot[RTC_STORE_REC_INDEX_SIZE];    // end offset of the record starting there, | RTC_STORE_REC_COMMITTED
+    uint16_t head_end;                          // same for the oldest record while a spill splits it, else 0
+} rec_index_t;
+
+typedef struct {
+    SemaphoreHandle_t lock;     // critical lock; for lock-free rbuf, serializes readers only
     data_store_t *store;        // pointer to rtc data store
     size_t wrap_cnt;            // keep track of no. of times wrapping happened
+    rec_index_t *index;         // record index, only for the lock-free rbuf
+    rtc_store_flash_type_t tier;    // stream of this rbuf in the flash tier
+    bool read_from_flash;       // the reader's last copy came from the flash tier
+    bool head_aligned;          // read_offset is on a record boundary, false while a spill splits one
+    bool pinned;                // a peek is outstanding, nothing but its commit may free space
+    uint32_t written;           // bytes accepted so far, wraps around
+#if CONFIG_RTC_STORE_OVERWRITE_NON_CRITICAL_DATA
+    bool evicting;              // held while dropping records from the head, by an evicting writer or the reader
+    uint32_t evict_seq;         // odd while an eviction frees space, bumped again once it is done
+    uint32_t evicted;           // bytes evicted so far, only changes while evict_seq is odd
+    uint32_t evicted_at_read;   // `evicted` as of the reader's last copy
+#endif
 } rbuf_data_t;
 
 typedef struct {
@@ -92,6 +170,7 @@ typedef struct {
     rbuf_data_t non_critical;
     rtc_store_meta_header_t *meta_hdr;
     char sha_sum[RTC_STORE_HEX_SHA_SIZE + 1];
+    TaskHandle_t spill_task;    // only with the flash tier
 } rtc_store_priv_data_t;
 
 // have a strategy to invalidate data beyond this
@@ -108,9 +187,11 @@ typedef struct {
     struct {
         data_store_t store;
         uint8_t buf[DIAG_NON_CRITICAL_BUF_SIZE];
+        rec_index_t index;
     } non_critical;
     rtc_store_meta_header_t meta[RTC_STORE_MAX_META_RECORDS];
     uint8_t meta_hdr_idx;
+    uint32_t layout;    // RTC_STORE_LAYOUT of the firmware which wrote the data
 } rtc_store_t;
 
 typedef struct {
@@ -129,99 +210,191 @@ static inline size_t data_store_get_size(data_store_t *store)
     return store->size;
 }
 
-static inline size_t data_store_get_free_at_end(data_store_t *store)
+static inline uint32_t data_store_info_load(data_store_t *store)
 {
-    data_store_info_t *info = (data_store_info_t *) &store->info;
-    size_t free_at_end = 0;
-    if (info->read_offset + info->filled < store->size) {
-        free_at_end = store->size - (info->filled + info->read_offset);
-    }
-    return free_at_end;
+    return __atomic_load_n(&store->info.value, __ATOMIC_ACQUIRE);
+}
+
+static inline bool data_store_info_cas(data_store_t *store, uint32_t *expected, uint32_t desired)
+{
+    return __atomic_compare_exchange_n(&store->info.value, expected, desired, false,
+                                       __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
 }
 
 static inline size_t data_store_get_free(data_store_t *store)
 {
-    data_store_info_t *info = (data_store_info_t *) &store->info;
-    return store->size - info->filled;
+    data_store_info_t info = { .value = data_store_info_load(store) };
+    return store->size - info.filled;
 }
 
 static inline size_t data_store_get_filled(data_store_t *store)
 {
-    data_store_info_t *info = (data_store_info_t *) &store->info;
-    return info->filled;
+    data_store_info_t info = { .value = data_store_info_load(store) };
+    return info.filled;
 }
 
-static void rtc_store_read_complete(rbuf_data_t *rbuf_data, size_t len)
+/* Wraps an offset which is at most one buffer size past the end */
+static inline size_t data_store_wrap(data_store_t *store, size_t offset)
 {
-    data_store_info_t info =  {
-        .value = rbuf_data->store->info.value,
-    };
-#if RTC_STORE_DBG_PRINTS
-    ESP_LOGI(TAG, "to free %u, size %u", len, rbuf_data->store->size);
-#endif
-    // modify new pointers
-    info.filled -= len;
-    info.read_offset += len;
+    return (offset >= store->size) ? offset - store->size : offset;
+}
 
-    if (((data_store_info_t *) &info)->read_offset > rbuf_data->store->size) {
-        ((data_store_info_t *) &info)->read_offset -= rbuf_data->store->size;
-        rbuf_data->wrap_cnt++; // wrap around count
+static void data_store_copy_to(data_store_t *store, size_t offset, const void *data, size_t len)
+{
+    size_t to_end = store->size - offset;
+    if (len > to_end) {
+        memcpy(store->buf + offset, data, to_end);
+        memcpy(store->buf, (const uint8_t *) data + to_end, len - to_end);
+    } else {
+        memcpy(store->buf + offset, data, len);
     }
+}
 
-    // commit modifications
-    rbuf_data->store->info.value = info.value;
+static void data_store_copy_from(data_store_t *store, size_t offset, void *buf, size_t len)
+{
+    size_t to_end = store->size - offset;
+    if (len > to_end) {
+        memcpy(buf, store->buf + offset, to_end);
+        memcpy((uint8_t *) buf + to_end, store->buf, len - to_end);
+    } else {
+        memcpy(buf, store->buf + offset, len);
+    }
 }
 
-static void rtc_store_write_complete(rbuf_data_t *rbuf_data, size_t len)
+/* Distance from the head to a record end, in (0, size] */
+static inline size_t rec_end_dist(data_store_t *store, size_t read_offset, uint16_t end)
 {
-    data_store_info_t *info = (data_store_info_t *) &rbuf_data->store->info;
-#if RTC_STORE_DBG_PRINTS
-    ESP_LOGI(TAG, "before write_complete, filled %" PRIu16 ", size %u, read_offset %" PRIu16 ", len %u",
-             info->filled, rbuf_data->store->size, info->read_offset, len);
-#endif
+    return (end + store->size - read_offset - 1) % store->size + 1;
+}
 
-    info->filled += len;
+/* Index slot of the oldest record */
+static inline uint16_t *rec_index_head(rec_index_t *index, data_store_info_t info)
+{
+    return index->head_end ? &index->head_end : &index->slot[RTC_STORE_REC_SLOT(info.read_offset)];
+}
 
+/* Walks committed records from the head, each one starting where the one before ends, up to the
+ * first uncommitted one. Stops before a record which ends past `limit` bytes, or once `want` bytes
+ * are covered. Returns the number of records, their total length goes to *len.
+ */
+static uint32_t rec_index_scan(rbuf_data_t *rbuf_data, data_store_info_t info,
+                               size_t limit, size_t want, size_t *len)
+{
+    rec_index_t *index = rbuf_data->index;
+    uint16_t *slot = rec_index_head(index, info);
+    uint32_t n;
+    size_t covered = 0;
+
+    for (n = 0; covered < want; n++) {
+        uint16_t rec = __atomic_load_n(slot, __ATOMIC_ACQUIRE);
+        if (!(rec & RTC_STORE_REC_COMMITTED)) {
+            break;
+        }
+        // past the tail, the slot may belong to a record at the head, which ends before `covered`
+        size_t dist = rec_end_dist(rbuf_data->store, info.read_offset, rec & RTC_STORE_REC_END_MASK);
+        if (dist > limit || dist <= covered) {
+            break;
+        }
+        covered = dist;
+        slot = &index->slot[RTC_STORE_REC_SLOT(rec & RTC_STORE_REC_END_MASK)];
+    }
+    *len = covered;
+    return n;
+}
+
+/* Length of the committed records at the head of a lock-free rbuf */
+static size_t rtc_store_committed_len(rbuf_data_t *rbuf_data, data_store_info_t info)
+{
+    size_t len;
+    rec_index_scan(rbuf_data, info, info.filled, SIZE_MAX, &len);
+    return len;
+}
+
+/* Only the reader, or an evicting writer while holding `evicting`, frees space */
+static void rtc_store_read_complete(rbuf_data_t *rbuf_data, size_t len)
+{
+    data_store_t *store = rbuf_data->store;
+    data_store_info_t info = { .value = data_store_info_load(store) };
+    data_store_info_t new_info;
 #if RTC_STORE_DBG_PRINTS
-    ESP_LOGI(TAG, "after write_complete, filled %" PRIu16 ", size %u, read_offset %" PRIu16 ", len %u",
-             info->filled, rbuf_data->store->size, info->read_offset, len);
+    ESP_LOGI(TAG, "to free %u, size %u", len, store->size);
 #endif
+    if (rbuf_data->index) {
+        // retire the index slots of records which are freed completely, before their space is
+        // handed out again
+        rec_index_t *index = rbuf_data->index;
+        uint16_t *slot = rec_index_head(index, info);
+        size_t rec_len;
+        uint32_t n = rec_index_scan(rbuf_data, info, len, SIZE_MAX, &rec_len);
+        for (uint32_t i = 0; i < n; i++) {
+            uint16_t end = *slot & RTC_STORE_REC_END_MASK;
+            *slot = 0;
+            slot = &index->slot[RTC_STORE_REC_SLOT(end)];
+        }
+        // a record freed in part keeps its end in head_end, as new records may start in its slot
+        if (rec_len < len && slot != &index->head_end) {
+            index->head_end = *slot;
+            *slot = 0;
+        }
+    }
+    // writers may grow `filled` meanwhile, read_offset stays ours
+    do {
+        new_info.value = info.value;
+        new_info.filled -= len;
+        new_info.read_offset = data_store_wrap(store, info.read_offset + len);
+    } while (!data_store_info_cas(store, &info.value, new_info.value));
+
+    if (new_info.read_offset < info.read_offset) {
+        rbuf_data->wrap_cnt++; // wrap around count
+    }
 }
 
-// Caller has made sure that enough memory is free...
-static size_t rtc_store_write_at_offset(rbuf_data_t *rbuf_data, void *data, size_t len, size_t offset)
+/* Reserves len bytes at the tail. Returns the write offset, or -1 if there is not enough free space */
+static int rtc_store_reserve(rbuf_data_t *rbuf_data, size_t len, size_t *curr_free)
 {
-    data_store_info_t *info = (data_store_info_t *) &rbuf_data->store->info;
+    data_store_t *store = rbuf_data->store;
+    data_store_info_t info = { .value = data_store_info_load(store) };
+    data_store_info_t new_info;
+
+    do {
+        if (store->size - info.filled < len) {
+            *curr_free = store->size - info.filled;
+            return -1;
+        }
+        new_info.value = info.value;
+        new_info.filled += len;
+    } while (!data_store_info_cas(store, &info.value, new_info.value));
+
 #if RTC_STORE_DBG_PRINTS
-    ESP_LOGI(TAG, "(write_at_offset): size %u, available: %u, filled %u, read_ptr %" PRIu16 ", to_write %u",
-             rbuf_data->store->size, data_store_get_free(rbuf_data->store),
-             data_store_get_filled(rbuf_data->store), info->read_offset, len);
+    ESP_LOGI(TAG, "reserved %u, filled %" PRIu16 ", size %u, read_offset %" PRIu16,
+             len, new_info.filled, store->size, info.read_offset);
 #endif
+    *curr_free = store->size - new_info.filled;
+    return data_store_wrap(store, info.read_offset + info.filled);
+}
 
-    uint16_t write_offset = info->filled + info->read_offset;
-    if (write_offset >= rbuf_data->store->size) { // wrap around
-        write_offset -= rbuf_data->store->size;
-    }
-
-    size_t free_at_end = data_store_get_free_at_end(rbuf_data->store);
-    if (free_at_end && (free_at_end < offset)) {
-        offset -= free_at_end;
-        memcpy(rbuf_data->store->buf + offset, data, len);
-    } else if (free_at_end && (free_at_end < offset + len)) {
-        free_at_end -= offset;
-        uint8_t *write_ptr = (uint8_t *) (rbuf_data->store->buf + write_offset + offset);
-        memcpy(write_ptr, data, free_at_end);
-        memcpy(rbuf_data->store->buf, data + free_at_end, len - free_at_end);
-    } else {
-        uint8_t *write_ptr = (uint8_t *) (rbuf_data->store->buf + write_offset + offset);
-        memcpy(write_ptr, data, len);
+static void rtc_store_post_event(int32_t event_id, const void *data, size_t len)
+{
+    if (xPortInIsrContext()) {
+#if CONFIG_ESP_EVENT_POST_FROM_ISR
+        esp_event_isr_post(ESP_DIAG_DATA_STORE_EVENT, event_id, NULL, 0, NULL);
+#endif
+        return;
     }
-    return len;
+    esp_event_post(ESP_DIAG_DATA_STORE_EVENT, event_id, data, len, 0);
 }
 
-static size_t rtc_store_write(rbuf_data_t *rbuf_data, void *data, size_t len)
+/* Wakes up the spill task, if there is a flash tier */
+static void rtc_store_spill_notify(void)
 {
-    return rtc_store_write_at_offset(rbuf_data, data, len, 0);
+    if (!s_priv_data.spill_task) {
+        return;
+    }
+    if (xPortInIsrContext()) {
+        vTaskNotifyGiveFromISR(s_priv_data.spill_task, NULL);
+    } else {
+        xTaskNotifyGive(s_priv_data.spill_task);
+    }
 }
 
 esp_err_t rtc_store_critical_data_write(void *data, size_t len)
@@ -244,30 +417,77 @@ esp_err_t rtc_store_critical_data_write(void *data, size_t len)
     }
     xSemaphoreTake(s_priv_data.critical.lock, portMAX_DELAY);
 
-    size_t curr_free = data_store_get_free(s_priv_data.critical.store);
-    // size_t free_at_end = data_store_get_free_at_end(s_priv_data.critical.store);
+    size_t curr_free;
+    data_store_t *store = s_priv_data.critical.store;
+    int offset = rtc_store_reserve(&s_priv_data.critical, len_real, &curr_free);
     // If no space available... Raise write fail event
-    if (curr_free < len_real) {
+    if (offset < 0) {
         esp_event_post(ESP_DIAG_DATA_STORE_EVENT, ESP_DIAG_DATA_STORE_EVENT_CRITICAL_DATA_WRITE_FAIL, data, len_real, 0);
 #if RTC_STORE_DBG_PRINTS
         printf("%s, curr_free %d, req_free %d\n", TAG, curr_free, len_real);
 #endif
         ret = ESP_ERR_NO_MEM;
     } else { // we have enough space of (len + 1)
-        rtc_store_write(&s_priv_data.critical, &s_rtc_store.meta_hdr_idx, 1);
-        rtc_store_write_at_offset(&s_priv_data.critical, data, len, 1);
-        rtc_store_write_complete(&s_priv_data.critical, len + 1);
-        curr_free = data_store_get_free(s_priv_data.critical.store);
+        store->buf[offset] = s_rtc_store.meta_hdr_idx;
+        data_store_copy_to(store, data_store_wrap(store, offset + 1), data, len);
+        __atomic_add_fetch(&s_priv_data.critical.written, len_real, __ATOMIC_RELAXED);
     }
     xSemaphoreGive(s_priv_data.critical.lock);
 
+    if (curr_free < RTC_STORE_SPILL_WATERMARK(DIAG_CRITICAL_BUF_SIZE)) {
+        rtc_store_spill_notify();
+    }
     if (curr_free < DIAG_CRITICAL_DATA_REPORTING_WATERMARK) {
         esp_event_post(ESP_DIAG_DATA_STORE_EVENT, ESP_DIAG_DATA_STORE_EVENT_CRITICAL_DATA_LOW_MEM, NULL, 0, 0);
     }
     return ret;
 }
 
-static int rtc_store_data_read_unsafe(rbuf_data_t *rbuf_data, uint8_t *buf, size_t size);
+#if CONFIG_RTC_STORE_OVERWRITE_NON_CRITICAL_DATA
+static inline bool rtc_store_evict_trylock(rbuf_data_t *rbuf_data)
+{
+    return !__atomic_test_and_set(&rbuf_data->evicting, __ATOMIC_ACQUIRE);
+}
+
+static inline void rtc_store_evict_unlock(rbuf_data_t *rbuf_data)
+{
+    __atomic_clear(&rbuf_data->evicting, __ATOMIC_RELEASE);
+}
+
+/* Drops as many of the oldest records as needed to free `need` bytes, in one step. The index gives
+ * the eviction point directly, so this does not depend on how many small records are queued.
+ * A writer which finds another eviction in progress gives up instead of waiting for it, so this
+ * never blocks.
+ */
+static esp_err_t rtc_store_evict(rbuf_data_t *rbuf_data, size_t need)
+{
+    esp_err_t ret = ESP_ERR_NO_MEM;
+    size_t len;
+
+    if (!rtc_store_evict_trylock(rbuf_data)) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (rbuf_data->pinned) {
+        rtc_store_evict_unlock(rbuf_data);
+        return ESP_ERR_NO_MEM;
+    }
+    data_store_info_t info = { .value = data_store_info_load(rbuf_data->store) };
+    // Records can only be dropped once their writers have committed them
+    rec_index_scan(rbuf_data, info, info.filled, need, &len);
+    if (len >= need) {
+        // Odd from before the space is freed until after, so that a reader copying from the old
+        // head meanwhile, while other writers reuse the space, always sees its copy is torn
+        __atomic_add_fetch(&rbuf_data->evict_seq, 1, __ATOMIC_ACQ_REL);
+        __atomic_store_n(&rbuf_data->evicted, rbuf_data->evicted + len, __ATOMIC_RELAXED);
+        rtc_store_read_complete(rbuf_data, len);
+        rbuf_data->head_aligned = true;
+        __atomic_add_fetch(&rbuf_data->evict_seq, 1, __ATOMIC_RELEASE);
+        ret = ESP_OK;
+    }
+    rtc_store_evict_unlock(rbuf_data);
+    return ret;
+}
+#endif
 
 esp_err_t rtc_store_non_critical_data_write(const char *dg, void *data, size_t len)
 {
@@ -282,8 +502,10 @@ esp_err_t rtc_store_non_critical_data_write(const char *dg, void *data, size_t l
         return ESP_ERR_INVALID_STATE;
     }
     rtc_store_non_critical_data_hdr_t header;
+    data_store_t *store = s_priv_data.non_critical.store;
     size_t req_free = sizeof(header) + len + 1; // 1 byte for meta index
     size_t curr_free;
+    int offset;
 
     if (req_free > DIAG_NON_CRITICAL_BUF_SIZE) {
         printf("rtc_store_non_critical_data_write: len too large %d, size %d\n",
@@ -291,63 +513,53 @@ esp_err_t rtc_store_non_critical_data_write(const char *dg, void *data, size_t l
         return ESP_FAIL;
     }
 
-    if (xSemaphoreTake(s_priv_data.non_critical.lock, 0) == pdFALSE) {
-        return ESP_FAIL;
-    }
-
+    while ((offset = rtc_store_reserve(&s_priv_data.non_critical, req_free, &curr_free)) < 0) {
 #if CONFIG_RTC_STORE_OVERWRITE_NON_CRITICAL_DATA
-    /* Make enough room for the item */
-    while (data_store_get_free(s_priv_data.non_critical.store) < req_free) {
-        uint8_t tmp_buf[sizeof(header) + 1];
-        rtc_store_data_read_unsafe(&s_priv_data.non_critical, tmp_buf, sizeof(tmp_buf));
-        memcpy(&header, tmp_buf + 1, sizeof(header)); // because 1 byte is meta_hdr idx
-        size_t to_free = sizeof(tmp_buf) + header.len;
-        rtc_store_read_complete(&s_priv_data.non_critical, to_free);
-    }
-#else // just check if we have enough space to write the item
-    curr_free = data_store_get_free(s_priv_data.non_critical.store);
-    if (curr_free < req_free) {
-        xSemaphoreGive(s_priv_data.non_critical.lock);
-        esp_event_post(ESP_DIAG_DATA_STORE_EVENT, ESP_DIAG_DATA_STORE_EVENT_NON_CRITICAL_DATA_LOW_MEM, NULL, 0, 0);
+        /* Make enough room for the item */
+        if (rtc_store_evict(&s_priv_data.non_critical, req_free - curr_free) != ESP_OK) {
+            return ESP_ERR_NO_MEM;
+        }
+#else // not enough space to write the item
+        rtc_store_spill_notify();
+        rtc_store_post_event(ESP_DIAG_DATA_STORE_EVENT_NON_CRITICAL_DATA_LOW_MEM, NULL, 0);
         return ESP_ERR_NO_MEM;
-    }
 #endif
+    }
     memset(&header, 0, sizeof(header));
     header.len = len;
 
-    // we have made sure of free size at this point, write index byte, data header and then actual data
-    rtc_store_write(&s_priv_data.non_critical, &s_rtc_store.meta_hdr_idx, 1);
-    rtc_store_write_at_offset(&s_priv_data.non_critical, &header, sizeof(header), 1);
-    rtc_store_write_at_offset(&s_priv_data.non_critical, data, len, 1 + sizeof(header));
-    rtc_store_write_complete(&s_priv_data.non_critical, req_free);
-
-    curr_free = data_store_get_free(s_priv_data.non_critical.store);
-    xSemaphoreGive(s_priv_data.non_critical.lock);
+    // space is ours at this point, write index byte, data header and actual data, then commit
+    store->buf[offset] = s_rtc_store.meta_hdr_idx;
+    data_store_copy_to(store, data_store_wrap(store, offset + 1), &header, sizeof(header));
+    data_store_copy_to(store, data_store_wrap(store, offset + 1 + sizeof(header)), data, len);
+    __atomic_store_n(&s_priv_data.non_critical.index->slot[RTC_STORE_REC_SLOT(offset)],
+                     data_store_wrap(store, offset + req_free) | RTC_STORE_REC_COMMITTED, __ATOMIC_RELEASE);
+    __atomic_add_fetch(&s_priv_data.non_critical.written, req_free, __ATOMIC_RELAXED);
 
+    if (curr_free < RTC_STORE_SPILL_WATERMARK(DIAG_NON_CRITICAL_BUF_SIZE)) {
+        rtc_store_spill_notify();
+    }
     // Post low memory event even if data overwrite is enabled.
     if (curr_free < DIAG_NON_CRITICAL_DATA_REPORTING_WATERMARK) {
-        esp_event_post(ESP_DIAG_DATA_STORE_EVENT, ESP_DIAG_DATA_STORE_EVENT_NON_CRITICAL_DATA_LOW_MEM, NULL, 0, 0);
+        rtc_store_post_event(ESP_DIAG_DATA_STORE_EVENT_NON_CRITICAL_DATA_LOW_MEM, NULL, 0);
     }
     return ESP_OK;
 }
 
-static int rtc_store_data_read_unsafe(rbuf_data_t *rbuf_data, uint8_t *buf, size_t size)
+static size_t rtc_store_readable_len(rbuf_data_t *rbuf_data, data_store_info_t info)
 {
-    data_store_info_t *info = (data_store_info_t *) &rbuf_data->store->info;
+    return rbuf_data->index ? rtc_store_committed_len(rbuf_data, info) : info.filled;
+}
 
-    if (info->filled < size) {
-        size = info->filled;
-    }
+static int rtc_store_data_read_unsafe(rbuf_data_t *rbuf_data, uint8_t *buf, size_t size)
+{
+    data_store_info_t info = { .value = data_store_info_load(rbuf_data->store) };
+    size_t readable = rtc_store_readable_len(rbuf_data, info);
 
-    size_t data_at_end = rbuf_data->store->size - info->read_offset;
-    if (data_at_end < size) {
-        // data is wrapped, read data in 2 parts
-        memcpy(buf, rbuf_data->store->buf + info->read_offset, data_at_end);
-        memcpy(buf + data_at_end, rbuf_data->store->buf, size - data_at_end);
-    } else {
-        // single memcpy
-        memcpy(buf, rbuf_data->store->buf + info->read_offset, size);
+    if (readable < size) {
+        size = readable;
     }
+    data_store_copy_from(rbuf_data->store, info.read_offset, buf, size);
     return size;
 }
 
@@ -361,25 +573,172 @@ static int rtc_store_data_read(rbuf_data_t *rbuf_data, uint8_t *buf, size_t size
     }
 
     xSemaphoreTake(rbuf_data->lock, portMAX_DELAY);
+    // spilled data is older than anything still in RTC memory, so it goes out first
+    rbuf_data->read_from_flash = rtc_store_flash_pending(rbuf_data->tier) > 0;
+    if (rbuf_data->read_from_flash) {
+        size = rtc_store_flash_read(rbuf_data->tier, buf, size);
+        xSemaphoreGive(rbuf_data->lock);
+        return size;
+    }
+#if CONFIG_RTC_STORE_OVERWRITE_NON_CRITICAL_DATA
+    if (rbuf_data->index) {
+        // a writer may evict what we are copying; retry if an eviction overlapped the copy
+        int retries = RTC_STORE_READ_RETRIES;
+        uint32_t seq, evicted;
+        int len = 0;
+        do {
+            seq = __atomic_load_n(&rbuf_data->evict_seq, __ATOMIC_ACQUIRE);
+            if (seq & 1) {
+                continue;
+            }
+            evicted = __atomic_load_n(&rbuf_data->evicted, __ATOMIC_RELAXED);
+            len = rtc_store_data_read_unsafe(rbuf_data, buf, size);
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            if (seq == __atomic_load_n(&rbuf_data->evict_seq, __ATOMIC_RELAXED)) {
+                rbuf_data->evicted_at_read = evicted;
+                xSemaphoreGive(rbuf_data->lock);
+                return len;
+            }
+        } while (--retries);
+        // nothing was read, so nothing must be released either
+        rbuf_data->evicted_at_read = __atomic_load_n(&rbuf_data->evicted, __ATOMIC_RELAXED);
+        xSemaphoreGive(rbuf_data->lock);
+        return 0;
+    }
+#endif
     size = rtc_store_data_read_unsafe(rbuf_data, buf, size);
     xSemaphoreGive(rbuf_data->lock);
     return size;
 }
 
+/* `since_read`: size counts from the head as of the last read, rather than the current head.
+ * The reader's view covers the flash tier too, and its bytes are released from there first.
+ */
+static esp_err_t rtc_store_data_release_locked(rbuf_data_t *rbuf_data, size_t size, bool since_read)
+{
+    esp_err_t ret = ESP_OK;
+#if CONFIG_RTC_STORE_OVERWRITE_NON_CRITICAL_DATA
+    if (rbuf_data->index) {
+        // evicting writers never wait, so they can't be holding this for long
+        while (!rtc_store_evict_trylock(rbuf_data)) {
+            vTaskDelay(1);
+        }
+        // records evicted since the read are gone already, only free what is left of them
+        uint32_t evicted = rbuf_data->evicted - rbuf_data->evicted_at_read;
+        rbuf_data->evicted_at_read = rbuf_data->evicted;
+        // evictions only took bytes out of the reader's view if it read from RTC memory
+        if (since_read && !rbuf_data->read_from_flash) {
+            size = (evicted < size) ? size - evicted : 0;
+        }
+    }
+#endif
+    if (since_read) {
+        size -= rtc_store_flash_release(rbuf_data->tier, size);
+    }
+    data_store_info_t info = { .value = data_store_info_load(rbuf_data->store) };
+    if (rtc_store_readable_len(rbuf_data, info) < size) {
+        ret = ESP_FAIL;
+    } else if (size) {
+        rtc_store_read_complete(rbuf_data, size);
+        rbuf_data->head_aligned = true; // whole records are released
+    }
+#if CONFIG_RTC_STORE_OVERWRITE_NON_CRITICAL_DATA
+    if (rbuf_data->index) {
+        rtc_store_evict_unlock(rbuf_data);
+    }
+#endif
+    return ret;
+}
+
 static esp_err_t rtc_store_data_release(rbuf_data_t *rbuf_data, size_t size)
 {
     if (!s_priv_data.init) {
         return ESP_ERR_INVALID_STATE;
     }
     xSemaphoreTake(rbuf_data->lock, portMAX_DELAY);
-    data_store_info_t *info = (data_store_info_t *) &rbuf_data->store->info;
-    if (info->filled < size) {
+    bool from_flash = rbuf_data->read_from_flash;
+    esp_err_t ret = rtc_store_data_release_locked(rbuf_data, size, true);
+    xSemaphoreGive(rbuf_data->lock);
+
+    // keep the reporter coming back until the backlog in flash is drained
+    if (from_flash && ret == ESP_OK && rtc_store_flash_pending(rbuf_data->tier)) {
+        rtc_store_post_event(rbuf_data->index ? ESP_DIAG_DATA_STORE_EVENT_NON_CRITICAL_DATA_LOW_MEM :
+                             ESP_DIAG_DATA_STORE_EVENT_CRITICAL_DATA_LOW_MEM, NULL, 0);
+    }
+    return ret;
+}
+
+/* Moves all readable data to the flash tier, in chunks which end on record boundaries where they
+ * can. Writes straight from the (up to two) spans of the ring, so that
+ * no bounce buffer is needed. For critical data this holds off writers for one chunk at a time.
+ */
+static void rtc_store_spill(rbuf_data_t *rbuf_data)
+{
+    data_store_t *store = rbuf_data->store;
+    size_t written;
+
+    do {
+        // erasing the next sector takes a while, don't hold any lock of ours for that
+        if (rtc_store_flash_prepare() != ESP_OK) {
+            return;
+        }
+        xSemaphoreTake(rbuf_data->lock, portMAX_DELAY);
+        if (rbuf_data->pinned) {
+            // the reader is working on it in place, the next write brings us back
+            xSemaphoreGive(rbuf_data->lock);
+            return;
+        }
+#if CONFIG_RTC_STORE_OVERWRITE_NON_CRITICAL_DATA
+        // writers must not evict what is being copied, they fail instead of waiting meanwhile
+        if (rbuf_data->index) {
+            while (!rtc_store_evict_trylock(rbuf_data)) {
+                vTaskDelay(1);
+            }
+        }
+#endif
+        written = 0;
+        data_store_info_t info = { .value = data_store_info_load(store) };
+        size_t len = rtc_store_readable_len(rbuf_data, info);
+        bool aligned_after = true;
+        if (len > RTC_STORE_FLASH_CHUNK_MAX) {
+            len = RTC_STORE_FLASH_CHUNK_MAX;
+            aligned_after = false;
+        }
+        if (rbuf_data->index && len) {
+            // cut at a record end, records larger than a chunk are split
+            size_t rec_len;
+            rec_index_scan(rbuf_data, info, len, SIZE_MAX, &rec_len);
+            if (rec_len) {
+                len = rec_len;
+                aligned_after = true;
+            }
+        }
+        if (len) {
+            size_t to_end = store->size - info.read_offset;
+            size_t len1 = (len < to_end) ? len : to_end;
+            written = rtc_store_flash_append(rbuf_data->tier, rbuf_data->head_aligned,
+                                             store->buf + info.read_offset, len1, store->buf, len - len1);
+            if (written) {
+                rtc_store_read_complete(rbuf_data, written);
+                rbuf_data->head_aligned = (written == len) && aligned_after;
+            }
+        }
+#if CONFIG_RTC_STORE_OVERWRITE_NON_CRITICAL_DATA
+        if (rbuf_data->index) {
+            rtc_store_evict_unlock(rbuf_data);
+        }
+#endif
         xSemaphoreGive(rbuf_data->lock);
-        return ESP_FAIL;
+    } while (written);
+}
+
+static void rtc_store_spill_task(void *arg)
+{
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        rtc_store_spill(&s_priv_data.critical);
+        rtc_store_spill(&s_priv_data.non_critical);
     }
-    rtc_store_read_complete(rbuf_data, size);
-    xSemaphoreGive(rbuf_data->lock);
-    return ESP_OK;
 }
 
 int rtc_store_critical_data_read(uint8_t *buf, size_t size)
@@ -420,6 +779,120 @@ esp_err_t rtc_store_non_critical_data_release(size_t size)
     return rtc_store_data_release(&s_priv_data.non_critical, size);
 }
 
+/* Pins the head and hands out the readable data where it is. Writers only ever touch the space
+ * after it, and everything which frees space (spill, eviction) leaves a pinned rbuf alone.
+ */
+static esp_err_t rtc_store_data_peek(rbuf_data_t *rbuf_data, rtc_store_span_t spans[2], size_t size)
+{
+    if (!spans) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(spans, 0, 2 * sizeof(rtc_store_span_t));
+    if (!s_priv_data.init) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    xSemaphoreTake(rbuf_data->lock, portMAX_DELAY);
+    if (rbuf_data->pinned) {
+        xSemaphoreGive(rbuf_data->lock);
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (rtc_store_flash_pending(rbuf_data->tier)) {
+        xSemaphoreGive(rbuf_data->lock);
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+#if CONFIG_RTC_STORE_OVERWRITE_NON_CRITICAL_DATA
+    if (rbuf_data->index) {
+        while (!rtc_store_evict_trylock(rbuf_data)) {
+            vTaskDelay(1);
+        }
+        rbuf_data->evicted_at_read = rbuf_data->evicted;
+        rbuf_data->pinned = true;
+        rtc_store_evict_unlock(rbuf_data);
+    }
+#endif
+    rbuf_data->pinned = true;
+    rbuf_data->read_from_flash = false;
+
+    data_store_t *store = rbuf_data->store;
+    data_store_info_t info = { .value = data_store_info_load(store) };
+    size_t len = rtc_store_readable_len(rbuf_data, info);
+    if (len > size) {
+        len = size;
+    }
+    size_t to_end = store->size - info.read_offset;
+    spans[0].data = store->buf + info.read_offset;
+    spans[0].len = (len < to_end) ? len : to_end;
+    spans[1].data = store->buf;
+    spans[1].len = len - spans[0].len;
+    xSemaphoreGive(rbuf_data->lock);
+    return ESP_OK;
+}
+
+static esp_err_t rtc_store_data_commit(rbuf_data_t *rbuf_data, size_t size)
+{
+    esp_err_t ret = ESP_OK;
+
+    if (!s_priv_data.init) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    xSemaphoreTake(rbuf_data->lock, portMAX_DELAY);
+    if (!rbuf_data->pinned) {
+        ret = ESP_ERR_INVALID_STATE;
+    } else {
+        rbuf_data->pinned = false;
+        if (size) {
+            ret = rtc_store_data_release_locked(rbuf_data, size, true);
+        }
+    }
+    xSemaphoreGive(rbuf_data->lock);
+    return ret;
+}
+
+esp_err_t rtc_store_critical_data_peek(rtc_store_span_t spans[2], size_t size)
+{
+    return rtc_store_data_peek(&s_priv_data.critical, spans, size);
+}
+
+esp_err_t rtc_store_critical_data_commit(size_t size)
+{
+    return rtc_store_data_commit(&s_priv_data.critical, size);
+}
+
+esp_err_t rtc_store_non_critical_data_peek(rtc_store_span_t spans[2], size_t size)
+{
+    return rtc_store_data_peek(&s_priv_data.non_critical, spans, size);
+}
+
+esp_err_t rtc_store_non_critical_data_commit(size_t size)
+{
+    return rtc_store_data_commit(&s_priv_data.non_critical, size);
+}
+
+static esp_err_t rtc_store_data_stats(rbuf_data_t *rbuf_data, rtc_store_stats_t *stats)
+{
+    if (!stats) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_priv_data.init) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    stats->size = data_store_get_size(rbuf_data->store);
+    stats->filled = data_store_get_filled(rbuf_data->store);
+    stats->flash_pending = rtc_store_flash_pending(rbuf_data->tier);
+    stats->written = __atomic_load_n(&rbuf_data->written, __ATOMIC_RELAXED);
+    return ESP_OK;
+}
+
+esp_err_t rtc_store_critical_data_stats(rtc_store_stats_t *stats)
+{
+    return rtc_store_data_stats(&s_priv_data.critical, stats);
+}
+
+esp_err_t rtc_store_non_critical_data_stats(rtc_store_stats_t *stats)
+{
+    return rtc_store_data_stats(&s_priv_data.non_critical, stats);
+}
+
 static void rtc_store_rbuf_deinit(rbuf_data_t *rbuf_data)
 {
     if (rbuf_data->lock) {
@@ -430,6 +903,11 @@ static void rtc_store_rbuf_deinit(rbuf_data_t *rbuf_data)
 
 void rtc_store_deinit(void)
 {
+    if (s_priv_data.spill_task) {
+        vTaskDelete(s_priv_data.spill_task);
+        s_priv_data.spill_task = NULL;
+    }
+    rtc_store_flash_deinit();
     rtc_store_rbuf_deinit(&s_priv_data.critical);
     rtc_store_rbuf_deinit(&s_priv_data.non_critical);
     s_priv_data.init = false;
@@ -445,10 +923,48 @@ static bool rtc_store_integrity_check(data_store_t *store)
     return true;
 }
 
+/* Drops records whose writer was interrupted by the reset, and clears every index slot but those
+ * of the records which are left
+ */
+static void rtc_store_rbuf_recover(rbuf_data_t *rbuf_data)
+{
+    data_store_t *store = rbuf_data->store;
+    rec_index_t *index = rbuf_data->index;
+    data_store_info_t info = { .value = store->info.value };
+    size_t committed;
+
+    info.read_offset = data_store_wrap(store, info.read_offset);
+    uint32_t records = rec_index_scan(rbuf_data, info, info.filled, SIZE_MAX, &committed);
+    if (committed != info.filled) {
+        printf("%s: discarding %u bytes of uncommitted data...\n", TAG, info.filled - committed);
+        info.filled = committed;
+    }
+    if (!records) {
+        index->head_end = 0;
+    }
+    // the records left start in slots which follow each other around the index, from the first one
+    uint32_t slot = RTC_STORE_REC_SLOT(index->head_end ? index->head_end & RTC_STORE_REC_END_MASK : info.read_offset);
+    uint32_t next = index->head_end ? slot : RTC_STORE_REC_INDEX_SIZE;
+    if (index->head_end) {
+        records--;
+    }
+    for (uint32_t i = 0; i < RTC_STORE_REC_INDEX_SIZE; i++, slot = (slot + 1) % RTC_STORE_REC_INDEX_SIZE) {
+        if (records && (slot == next || next == RTC_STORE_REC_INDEX_SIZE)) {
+            next = RTC_STORE_REC_SLOT(index->slot[slot] & RTC_STORE_REC_END_MASK);
+            records--;
+        } else {
+            index->slot[slot] = 0;
+        }
+    }
+    rbuf_data->head_aligned = !index->head_end;
+    store->info.value = info.value;
+}
+
 static esp_err_t rtc_store_rbuf_init(rbuf_data_t *rbuf_data,
                                      data_store_t *rtc_store,
                                      uint8_t *rtc_buf,
-                                     size_t rtc_buf_size)
+                                     size_t rtc_buf_size,
+                                     rec_index_t *index)
 {
     esp_reset_reason_t reset_reason = esp_reset_reason();
 
@@ -478,6 +994,11 @@ static esp_err_t rtc_store_rbuf_init(rbuf_data_t *rbuf_data,
         printf("%s: intergrity_check failed, discarding old data...\n", TAG);
         rtc_store->info.value = 0;
     }
+    rbuf_data->index = index;
+    rbuf_data->head_aligned = true;
+    if (index) {
+        rtc_store_rbuf_recover(rbuf_data);
+    }
     return ESP_OK;
 }
 
@@ -561,10 +1082,14 @@ esp_err_t rtc_store_discard_data(void)
     }
     xSemaphoreTake(s_priv_data.critical.lock, portMAX_DELAY);
     s_rtc_store.critical.store.info.value = 0;
+    s_priv_data.critical.head_aligned = true;
     xSemaphoreGive(s_priv_data.critical.lock);
+    // records still being written are left to their writers
     xSemaphoreTake(s_priv_data.non_critical.lock, portMAX_DELAY);
-    s_rtc_store.non_critical.store.info.value = 0;
+    data_store_info_t info = { .value = data_store_info_load(&s_rtc_store.non_critical.store) };
+    rtc_store_data_release_locked(&s_priv_data.non_critical, rtc_store_committed_len(&s_priv_data.non_critical, info), false);
     xSemaphoreGive(s_priv_data.non_critical.lock);
+    rtc_store_flash_discard();
     return ESP_OK;
 }
 
@@ -588,11 +1113,18 @@ esp_err_t rtc_store_init(void)
     if (s_priv_data.init) {
         return ESP_ERR_INVALID_STATE;
     }
+    /* Nothing in RTC memory can be trusted if it was laid out by another firmware */
+    if (s_rtc_store.layout != RTC_STORE_LAYOUT) {
+        memset(&s_rtc_store, 0, sizeof(s_rtc_store));
+        s_rtc_store.meta_hdr_idx = -1;
+        s_rtc_store.layout = RTC_STORE_LAYOUT;
+    }
     /* Initialize critical RTC rbuf */
     err = rtc_store_rbuf_init(&s_priv_data.critical,
                               &s_rtc_store.critical.store,
                               s_rtc_store.critical.buf,
-                              DIAG_CRITICAL_BUF_SIZE);
+                              DIAG_CRITICAL_BUF_SIZE,
+                              NULL);
     if (err != ESP_OK) {
 #if RTC_STORE_DBG_PRINTS
         printf("rtc_store_rbuf_init(critical) failed\n");
@@ -603,7 +1135,8 @@ esp_err_t rtc_store_init(void)
     err = rtc_store_rbuf_init(&s_priv_data.non_critical,
                               &s_rtc_store.non_critical.store,
                               s_rtc_store.non_critical.buf,
-                              DIAG_NON_CRITICAL_BUF_SIZE);
+                              DIAG_NON_CRITICAL_BUF_SIZE,
+                              &s_rtc_store.non_critical.index);
     if (err != ESP_OK) {
 #if RTC_STORE_DBG_PRINTS
         printf("rtc_store_rbuf_init(non_critical) failed\n");
@@ -622,6 +1155,17 @@ esp_err_t rtc_store_init(void)
     }
     rtc_store_meta_hdr_init();
 
+    /* Flash tier, only if there is a partition for it */
+    s_priv_data.critical.tier = RTC_STORE_FLASH_CRITICAL;
+    s_priv_data.non_critical.tier = RTC_STORE_FLASH_NON_CRITICAL;
+    if (rtc_store_flash_init() == ESP_OK) {
+        if (xTaskCreate(rtc_store_spill_task, "rtc_spill", RTC_STORE_SPILL_TASK_STACK, NULL,
+                        RTC_STORE_SPILL_TASK_PRIO, &s_priv_data.spill_task) != pdPASS) {
+            printf("%s: spill task creation failed, flash tier is read only\n", TAG);
+            s_priv_data.spill_task = NULL;
+        }
+    }
+
     s_priv_data.init = true;
     return ESP_OK;
 }
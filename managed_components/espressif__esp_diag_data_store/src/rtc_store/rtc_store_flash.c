@@ -0,0 +1,623 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <esp_partition.h>
+#include <esp_crc.h>
+#include <esp_app_desc.h>
+
+#include "rtc_store_flash.h"
+
+#define TAG "RTC_STORE"
+
+/**
+ * @brief Log-structured overflow tier in a flash partition
+ *
+ * The partition is a ring of sectors written strictly in order. Each sector starts with a header
+ * carrying an increasing sequence number, and is followed by chunks:
+ *
+ *  | sector_hdr_t | chunk_hdr_t | payload | chunk_hdr_t | payload | ... | 0xFF... |
+ *
+ * A chunk belongs to one stream (critical or non-critical) and never spans sectors. Its state byte
+ * only ever clears bits, so every step is a plain program without an erase:
+ *     ERASED -> WRITING (header written) -> VALID (payload written) -> CONSUMED
+ *
+ * The read cursor of each stream lives in RAM. Releases also record how far into a chunk they got,
+ * in one of a few progress slots of its header, so that a reset resumes on the same record boundary.
+ * Chunks flagged CHUNK_SYNC start on a record boundary; after data got lost (dropped sector, crc
+ * mismatch) the reader skips ahead to one of them.
+ *
+ * @attention uses prints instead of logs, same as rtc_store.c
+ */
+
+#define SECTOR_SIZE         4096
+#define SECTOR_MAGIC        0x31474c44  // "DLG1"
+#define SECTOR_SHA_SIZE     8
+#define CHUNK_ALIGN(len)    (((len) + 3) & ~3)
+
+#define CHUNK_ERASED        0xFF
+#define CHUNK_WRITING       0xFE
+#define CHUNK_VALID         0xFC
+#define CHUNK_CONSUMED      0xF8
+
+#define CHUNK_SYNC          0x01    // cleared bit in `flags`
+#define CHUNK_PROGRESS_SLOTS    3
+#define CHUNK_PROGRESS_NONE     0xFFFF
+
+typedef struct {
+    uint32_t magic;
+    uint32_t seq;                       // increments with every sector started
+    uint32_t base_seq;                  // sectors older than this were discarded
+    uint8_t sha[SECTOR_SHA_SIZE];       // app ELF sha256 prefix, records point into its DROM
+} sector_hdr_t;
+
+typedef struct {
+    uint8_t state;
+    uint8_t type;
+    uint8_t flags;                      // inverted, so that 0xFF means no flags
+    uint8_t reserved;
+    uint16_t len;                       // payload length, without padding
+    uint16_t progress[CHUNK_PROGRESS_SLOTS];    // bytes released, the last written slot counts
+    uint32_t crc;                       // crc32 of the payload
+} chunk_hdr_t;
+
+typedef struct {
+    uint32_t sector;
+    uint32_t off;                       // chunk offset within the sector
+} chunk_pos_t;
+
+#define CHUNK_SPACE_MAX     (SECTOR_SIZE - sizeof(sector_hdr_t) - sizeof(chunk_hdr_t))
+_Static_assert(RTC_STORE_FLASH_CHUNK_MAX <= CHUNK_SPACE_MAX, "chunk does not fit in a sector");
+
+typedef struct {
+    chunk_pos_t pos;                    // oldest chunk with unconsumed data
+    uint16_t len;                       // its payload length
+    uint16_t consumed;                  // bytes consumed from it
+    bool valid;                         // pos points at a chunk
+    size_t pending;                     // unconsumed bytes in flash
+} stream_cursor_t;
+
+static struct {
+    const esp_partition_t *part;
+    SemaphoreHandle_t lock;
+    uint32_t sectors;
+    uint32_t first;                     // oldest sector in use
+    uint32_t used;                      // sectors in use, from `first` up to the write sector
+    uint32_t seq;                       // seq of the write sector
+    uint32_t base_seq;
+    chunk_pos_t wr;                     // append point
+    stream_cursor_t rd[RTC_STORE_FLASH_TYPE_MAX];
+    uint8_t sha[SECTOR_SHA_SIZE];
+} s_flash;
+
+static inline uint32_t sector_next(uint32_t sector)
+{
+    return (sector + 1) % s_flash.sectors;
+}
+
+static inline uint32_t sector_prev(uint32_t sector)
+{
+    return (sector + s_flash.sectors - 1) % s_flash.sectors;
+}
+
+static inline size_t chunk_addr(const chunk_pos_t *pos)
+{
+    return pos->sector * SECTOR_SIZE + pos->off;
+}
+
+static inline bool chunk_same(const chunk_pos_t *a, const chunk_pos_t *b)
+{
+    return a->sector == b->sector && a->off == b->off;
+}
+
+static inline void chunk_skip(chunk_pos_t *pos, uint16_t len)
+{
+    pos->off += sizeof(chunk_hdr_t) + CHUNK_ALIGN(len);
+}
+
+static inline bool chunk_at_end(const chunk_pos_t *pos)
+{
+    return pos->sector == s_flash.wr.sector && pos->off >= s_flash.wr.off;
+}
+
+static uint16_t chunk_progress(const chunk_hdr_t *hdr)
+{
+    for (int i = CHUNK_PROGRESS_SLOTS - 1; i >= 0; i--) {
+        if (hdr->progress[i] != CHUNK_PROGRESS_NONE) {
+            return (hdr->progress[i] < hdr->len) ? hdr->progress[i] : 0;
+        }
+    }
+    return 0;
+}
+
+static esp_err_t sector_hdr_read(uint32_t sector, sector_hdr_t *hdr)
+{
+    return esp_partition_read(s_flash.part, sector * SECTOR_SIZE, hdr, sizeof(*hdr));
+}
+
+static esp_err_t chunk_hdr_read(const chunk_pos_t *pos, chunk_hdr_t *hdr)
+{
+    return esp_partition_read(s_flash.part, chunk_addr(pos), hdr, sizeof(*hdr));
+}
+
+static esp_err_t chunk_set_state(const chunk_pos_t *pos, uint8_t state)
+{
+    return esp_partition_write(s_flash.part, chunk_addr(pos), &state, sizeof(state));
+}
+
+/* Records a release position in the first free progress slot. With all slots used up, a reset
+ * resumes from the last recorded one, an earlier record boundary, and some records are sent twice.
+ */
+static void chunk_set_progress(const chunk_pos_t *pos, uint16_t consumed)
+{
+    chunk_hdr_t hdr;
+    if (chunk_hdr_read(pos, &hdr) != ESP_OK) {
+        return;
+    }
+    for (int i = 0; i < CHUNK_PROGRESS_SLOTS; i++) {
+        if (hdr.progress[i] == CHUNK_PROGRESS_NONE) {
+            esp_partition_write(s_flash.part, chunk_addr(pos) + offsetof(chunk_hdr_t, progress[i]),
+                                &consumed, sizeof(consumed));
+            return;
+        }
+    }
+}
+
+/* Finds the first VALID chunk of `type` at or after *pos, before the append point */
+static bool chunk_find(rtc_store_flash_type_t type, chunk_pos_t *pos, chunk_hdr_t *hdr)
+{
+    while (!chunk_at_end(pos)) {
+        if (pos->off + sizeof(*hdr) > SECTOR_SIZE ||
+                chunk_hdr_read(pos, hdr) != ESP_OK ||
+                hdr->state == CHUNK_ERASED || hdr->len > CHUNK_SPACE_MAX) {
+            if (pos->sector == s_flash.wr.sector) {
+                return false;
+            }
+            pos->sector = sector_next(pos->sector);
+            pos->off = sizeof(sector_hdr_t);
+            continue;
+        }
+        if (hdr->state == CHUNK_VALID && hdr->type == type) {
+            return true;
+        }
+        chunk_skip(pos, hdr->len);
+    }
+    return false;
+}
+
+static bool chunk_verify(const chunk_pos_t *pos, const chunk_hdr_t *hdr)
+{
+    uint8_t buf[64];
+    uint32_t crc = 0;
+    size_t addr = chunk_addr(pos) + sizeof(*hdr);
+
+    for (size_t off = 0; off < hdr->len; off += sizeof(buf)) {
+        size_t n = (hdr->len - off < sizeof(buf)) ? hdr->len - off : sizeof(buf);
+        if (esp_partition_read(s_flash.part, addr + off, buf, n) != ESP_OK) {
+            return false;
+        }
+        crc = esp_crc32_le(crc, buf, n);
+    }
+    return crc == hdr->crc;
+}
+
+/* Unconsumed bytes from the cursor up to the append point */
+static size_t stream_pending(rtc_store_flash_type_t type)
+{
+    stream_cursor_t *rd = &s_flash.rd[type];
+    chunk_pos_t pos = rd->pos;
+    chunk_hdr_t hdr;
+    size_t pending = 0;
+
+    if (!rd->valid) {
+        return 0;
+    }
+    while (chunk_find(type, &pos, &hdr)) {
+        pending += hdr.len;
+        chunk_skip(&pos, hdr.len);
+    }
+    return pending - rd->consumed;
+}
+
+/* Points the cursor at the first good chunk from pos. Chunks are read in full once, to check their
+ * crc, when the cursor gets to them. With `resync`, data before pos was lost, so chunks are skipped
+ * until one which starts on a record boundary, or has a recorded release position.
+ */
+static void cursor_seek(rtc_store_flash_type_t type, chunk_pos_t pos, bool resync)
+{
+    stream_cursor_t *rd = &s_flash.rd[type];
+    chunk_hdr_t hdr;
+
+    rd->valid = false;
+    rd->consumed = 0;
+    while (chunk_find(type, &pos, &hdr)) {
+        uint16_t progress = chunk_progress(&hdr);
+        if (!chunk_verify(&pos, &hdr)) {
+            printf("%s: flash chunk crc mismatch, dropping %u bytes\n", TAG, hdr.len);
+            resync = true;
+        } else if (!resync || !(hdr.flags & CHUNK_SYNC) || progress) {
+            rd->pos = pos;
+            rd->len = hdr.len;
+            rd->consumed = progress;
+            rd->valid = true;
+            break;
+        }
+        chunk_set_state(&pos, CHUNK_CONSUMED);
+        chunk_skip(&pos, hdr.len);
+    }
+    rd->pending = stream_pending(type);
+}
+
+/* The oldest sector is about to be erased, move cursors past it */
+static void sector_drop(uint32_t sector)
+{
+    for (int t = 0; t < RTC_STORE_FLASH_TYPE_MAX; t++) {
+        stream_cursor_t *rd = &s_flash.rd[t];
+        if (!rd->valid || rd->pos.sector != sector) {
+            continue;
+        }
+        size_t pending = rd->pending;
+        cursor_seek(t, (chunk_pos_t) { .sector = sector_next(sector), .off = sizeof(sector_hdr_t) }, true);
+        printf("%s: flash log full, dropped %u bytes of %s data\n", TAG, pending - rd->pending,
+               t == RTC_STORE_FLASH_CRITICAL ? "critical" : "non critical");
+    }
+}
+
+static esp_err_t sector_start(uint32_t sector)
+{
+    if (s_flash.used == s_flash.sectors) {
+        sector_drop(s_flash.first);
+        s_flash.first = sector_next(s_flash.first);
+        s_flash.used--;
+    }
+    if (s_flash.used == 0) {
+        s_flash.first = sector;
+    }
+    esp_err_t err = esp_partition_erase_range(s_flash.part, sector * SECTOR_SIZE, SECTOR_SIZE);
+    if (err != ESP_OK) {
+        return err;
+    }
+    sector_hdr_t hdr = {
+        .magic = SECTOR_MAGIC,
+        .seq = s_flash.seq + 1,
+        .base_seq = s_flash.base_seq,
+    };
+    memcpy(hdr.sha, s_flash.sha, sizeof(hdr.sha));
+    err = esp_partition_write(s_flash.part, sector * SECTOR_SIZE, &hdr, sizeof(hdr));
+    if (err != ESP_OK) {
+        return err;
+    }
+    s_flash.seq = hdr.seq;
+    s_flash.wr.sector = sector;
+    s_flash.wr.off = sizeof(hdr);
+    s_flash.used++;
+    return ESP_OK;
+}
+
+/* Starts over in a new sector, whose base_seq hides all older sectors from recovery */
+static esp_err_t flash_reset(void)
+{
+    memset(s_flash.rd, 0, sizeof(s_flash.rd));
+    s_flash.used = 0;
+    s_flash.base_seq = s_flash.seq + 1;
+    return sector_start(sector_next(s_flash.wr.sector));
+}
+
+static esp_err_t flash_recover(void)
+{
+    sector_hdr_t hdr;
+    uint32_t newest = 0;
+    bool found = false;
+
+    for (uint32_t i = 0; i < s_flash.sectors; i++) {
+        if (sector_hdr_read(i, &hdr) != ESP_OK || hdr.magic != SECTOR_MAGIC) {
+            continue;
+        }
+        if (!found || hdr.seq > s_flash.seq) {
+            s_flash.seq = hdr.seq;
+            newest = i;
+            found = true;
+        }
+    }
+    s_flash.wr.sector = newest;
+    if (!found) {
+        s_flash.seq = 0;
+        s_flash.wr.sector = s_flash.sectors - 1;
+        return flash_reset();
+    }
+    sector_hdr_read(newest, &hdr);
+    if (memcmp(hdr.sha, s_flash.sha, sizeof(hdr.sha)) != 0) {
+        // non-critical records point into the DROM of the app that wrote them
+        printf("%s: flash log is from another app, discarding it...\n", TAG);
+        return flash_reset();
+    }
+    s_flash.base_seq = hdr.base_seq;
+
+    // sectors in use are the ones with consecutive seqs just before the newest
+    s_flash.first = newest;
+    s_flash.used = 1;
+    uint32_t seq = s_flash.seq;
+    while (s_flash.used < s_flash.sectors && seq > s_flash.base_seq) {
+        uint32_t prev = sector_prev(s_flash.first);
+        if (sector_hdr_read(prev, &hdr) != ESP_OK || hdr.magic != SECTOR_MAGIC || hdr.seq != seq - 1) {
+            break;
+        }
+        s_flash.first = prev;
+        s_flash.used++;
+        seq--;
+    }
+
+    // append point: first erased chunk header in the newest sector
+    chunk_hdr_t chunk;
+    s_flash.wr.off = sizeof(sector_hdr_t);
+    while (s_flash.wr.off + sizeof(chunk) <= SECTOR_SIZE) {
+        if (chunk_hdr_read(&s_flash.wr, &chunk) != ESP_OK || chunk.state == CHUNK_ERASED) {
+            break;
+        }
+        if (chunk.len > CHUNK_SPACE_MAX) {
+            s_flash.wr.off = SECTOR_SIZE; // garbage, leave the rest of the sector alone
+            break;
+        }
+        if (chunk.state == CHUNK_WRITING) {
+            chunk_set_state(&s_flash.wr, CHUNK_CONSUMED); // interrupted by the reset
+        }
+        chunk_skip(&s_flash.wr, chunk.len);
+    }
+
+    // a chunk the reader was in the middle of resumes at its last recorded release position
+    for (int t = 0; t < RTC_STORE_FLASH_TYPE_MAX; t++) {
+        cursor_seek(t, (chunk_pos_t) { .sector = s_flash.first, .off = sizeof(sector_hdr_t) }, true);
+    }
+    if (s_flash.rd[RTC_STORE_FLASH_CRITICAL].pending || s_flash.rd[RTC_STORE_FLASH_NON_CRITICAL].pending) {
+        printf("%s: flash log holds %u critical, %u non critical bytes\n", TAG,
+               s_flash.rd[RTC_STORE_FLASH_CRITICAL].pending, s_flash.rd[RTC_STORE_FLASH_NON_CRITICAL].pending);
+    }
+    return ESP_OK;
+}
+
+esp_err_t rtc_store_flash_init(void)
+{
+    if (s_flash.part) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    const esp_partition_t *part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY,
+                                                           RTC_STORE_FLASH_PARTITION_LABEL);
+    if (!part) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (part->size < 2 * SECTOR_SIZE || part->encrypted) {
+        printf("%s: partition %s unusable for the flash log (size %" PRIu32 ", encrypted %d)\n",
+               TAG, RTC_STORE_FLASH_PARTITION_LABEL, part->size, part->encrypted);
+        return ESP_ERR_INVALID_SIZE;
+    }
+    s_flash.lock = xSemaphoreCreateMutex();
+    if (!s_flash.lock) {
+        return ESP_ERR_NO_MEM;
+    }
+    s_flash.part = part;
+    s_flash.sectors = part->size / SECTOR_SIZE;
+    memcpy(s_flash.sha, esp_app_get_description()->app_elf_sha256, sizeof(s_flash.sha));
+
+    esp_err_t err = flash_recover();
+    if (err != ESP_OK) {
+        printf("%s: flash log recovery failed, err %d\n", TAG, err);
+        rtc_store_flash_deinit();
+    }
+    return err;
+}
+
+void rtc_store_flash_deinit(void)
+{
+    if (s_flash.lock) {
+        vSemaphoreDelete(s_flash.lock);
+    }
+    memset(&s_flash, 0, sizeof(s_flash));
+}
+
+bool rtc_store_flash_enabled(void)
+{
+    return s_flash.part != NULL;
+}
+
+esp_err_t rtc_store_flash_prepare(void)
+{
+    if (!s_flash.part) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    esp_err_t err = ESP_OK;
+    xSemaphoreTake(s_flash.lock, portMAX_DELAY);
+    if (SECTOR_SIZE - s_flash.wr.off < sizeof(chunk_hdr_t) + RTC_STORE_FLASH_CHUNK_MAX) {
+        err = sector_start(sector_next(s_flash.wr.sector));
+    }
+    xSemaphoreGive(s_flash.lock);
+    return err;
+}
+
+size_t rtc_store_flash_append(rtc_store_flash_type_t type, bool sync,
+                              const void *data1, size_t len1, const void *data2, size_t len2)
+{
+    if (!s_flash.part || type >= RTC_STORE_FLASH_TYPE_MAX) {
+        return 0;
+    }
+    xSemaphoreTake(s_flash.lock, portMAX_DELAY);
+
+    size_t space = 0;
+    if (s_flash.wr.off + sizeof(chunk_hdr_t) < SECTOR_SIZE) {
+        space = (SECTOR_SIZE - s_flash.wr.off - sizeof(chunk_hdr_t)) & ~3;
+    }
+    size_t len = len1 + len2;
+    if (len > RTC_STORE_FLASH_CHUNK_MAX) {
+        len = RTC_STORE_FLASH_CHUNK_MAX;
+    }
+    if (len > space) {
+        len = space;
+    }
+    if (len1 > len) {
+        len1 = len;
+    }
+    len2 = len - len1;
+    if (!len) {
+        xSemaphoreGive(s_flash.lock);
+        return 0;
+    }
+
+    chunk_pos_t pos = s_flash.wr;
+    size_t addr = chunk_addr(&pos);
+    chunk_hdr_t hdr = {
+        .state = CHUNK_WRITING,
+        .type = type,
+        .flags = sync ? (uint8_t) ~CHUNK_SYNC : 0xFF,
+        .reserved = 0xFF,
+        .len = len,
+        .progress = { CHUNK_PROGRESS_NONE, CHUNK_PROGRESS_NONE, CHUNK_PROGRESS_NONE },
+        .crc = esp_crc32_le(esp_crc32_le(0, data1, len1), data2, len2),
+    };
+    // the append point moves on even if a write fails, the chunk is then never VALID
+    chunk_skip(&s_flash.wr, len);
+    esp_err_t err = esp_partition_write(s_flash.part, addr, &hdr, sizeof(hdr));
+    if (err == ESP_OK) {
+        err = esp_partition_write(s_flash.part, addr + sizeof(hdr), data1, len1);
+    }
+    if (err == ESP_OK && len2) {
+        err = esp_partition_write(s_flash.part, addr + sizeof(hdr) + len1, data2, len2);
+    }
+    if (err == ESP_OK) {
+        err = chunk_set_state(&pos, CHUNK_VALID);
+    }
+    if (err != ESP_OK) {
+        printf("%s: flash log write failed, err %d\n", TAG, err);
+        xSemaphoreGive(s_flash.lock);
+        return 0;
+    }
+
+    stream_cursor_t *rd = &s_flash.rd[type];
+    if (!rd->valid) {
+        rd->pos = pos;
+        rd->len = len;
+        rd->consumed = 0;
+        rd->valid = true;
+    }
+    rd->pending += len;
+    xSemaphoreGive(s_flash.lock);
+    return len;
+}
+
+size_t rtc_store_flash_pending(rtc_store_flash_type_t type)
+{
+    if (!s_flash.part || type >= RTC_STORE_FLASH_TYPE_MAX) {
+        return 0;
+    }
+    return __atomic_load_n(&s_flash.rd[type].pending, __ATOMIC_RELAXED);
+}
+
+size_t rtc_store_flash_read(rtc_store_flash_type_t type, uint8_t *buf, size_t size)
+{
+    if (!s_flash.part || type >= RTC_STORE_FLASH_TYPE_MAX) {
+        return 0;
+    }
+    xSemaphoreTake(s_flash.lock, portMAX_DELAY);
+    stream_cursor_t *rd = &s_flash.rd[type];
+    chunk_pos_t pos = rd->pos;
+    chunk_hdr_t hdr = { .len = rd->len };
+    size_t consumed = rd->consumed;
+    size_t copied = 0;
+    bool valid = rd->valid;
+
+    // chunks after the cursor are only crc checked once the cursor gets to them
+    while (valid && copied < size) {
+        size_t n = hdr.len - consumed;
+        if (n > size - copied) {
+            n = size - copied;
+        }
+        if (esp_partition_read(s_flash.part, chunk_addr(&pos) + sizeof(hdr) + consumed, buf + copied, n) != ESP_OK) {
+            break;
+        }
+        copied += n;
+        consumed += n;
+        if (consumed == hdr.len) {
+            pos.off += sizeof(hdr) + CHUNK_ALIGN(hdr.len);
+            valid = chunk_find(type, &pos, &hdr);
+            consumed = 0;
+        }
+    }
+    xSemaphoreGive(s_flash.lock);
+    return copied;
+}
+
+size_t rtc_store_flash_release(rtc_store_flash_type_t type, size_t size)
+{
+    if (!s_flash.part || type >= RTC_STORE_FLASH_TYPE_MAX) {
+        return 0;
+    }
+    xSemaphoreTake(s_flash.lock, portMAX_DELAY);
+    stream_cursor_t *rd = &s_flash.rd[type];
+    chunk_pos_t pos = rd->pos;
+    chunk_hdr_t hdr = { .len = rd->len };
+    size_t consumed = rd->consumed;
+    size_t released = 0;
+    bool valid = rd->valid;
+
+    // find where the reader ends up
+    while (valid && released < size) {
+        size_t n = hdr.len - consumed;
+        if (n > size - released) {
+            n = size - released;
+        }
+        released += n;
+        consumed += n;
+        if (consumed == hdr.len) {
+            chunk_skip(&pos, hdr.len);
+            valid = chunk_find(type, &pos, &hdr);
+            consumed = 0;
+        }
+    }
+    if (!released) {
+        xSemaphoreGive(s_flash.lock);
+        return 0;
+    }
+
+    // record the new position first, then retire the chunks before it
+    if (valid && consumed) {
+        chunk_set_progress(&pos, consumed);
+    }
+    chunk_pos_t done = rd->pos;
+    chunk_hdr_t done_hdr;
+    while (chunk_find(type, &done, &done_hdr) && !(valid && chunk_same(&done, &pos))) {
+        chunk_set_state(&done, CHUNK_CONSUMED);
+        chunk_skip(&done, done_hdr.len);
+    }
+
+    if (!valid) {
+        memset(rd, 0, sizeof(*rd));
+    } else if (chunk_same(&rd->pos, &pos)) {
+        rd->consumed = consumed;
+        rd->pending -= released;
+    } else {
+        cursor_seek(type, pos, false);
+        if (rd->valid && chunk_same(&rd->pos, &pos) && rd->consumed < consumed) {
+            rd->pending -= consumed - rd->consumed;
+            rd->consumed = consumed;
+        }
+    }
+    xSemaphoreGive(s_flash.lock);
+    return released;
+}
+
+void rtc_store_flash_discard(void)
+{
+    if (!s_flash.part) {
+        return;
+    }
+    xSemaphoreTake(s_flash.lock, portMAX_DELAY);
+    if (flash_reset() != ESP_OK) {
+        printf("%s: flash log discard failed\n", TAG);
+    }
+    xSemaphoreGive(s_flash.lock);
+}
@@ -0,0 +1,104 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <esp_err.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Flash overflow tier for the RTC store
+ *
+ * When the RTC buffers run full (typically while the device is offline), their oldest data is
+ * spilled into a log-structured flash partition. Each data type stays a single byte stream: older
+ * bytes live in flash, newer ones in RTC memory, and readers drain flash first.
+ *
+ * The tier is enabled when a partition with label RTC_STORE_FLASH_PARTITION_LABEL exists, e.g.
+ *     diag_log,   data, 0x40,  , 64K,
+ * The partition must not be encrypted. Sectors are used round robin, so every sector gets erased
+ * once per pass over the partition. When it is full, the oldest sector is dropped.
+ */
+
+#ifndef RTC_STORE_FLASH_PARTITION_LABEL
+#define RTC_STORE_FLASH_PARTITION_LABEL     "diag_log"
+#endif
+
+/* Most bytes moved to flash in one chunk, also bounds how long a spill holds the critical lock */
+#define RTC_STORE_FLASH_CHUNK_MAX           1024
+
+typedef enum {
+    RTC_STORE_FLASH_CRITICAL = 0,
+    RTC_STORE_FLASH_NON_CRITICAL,
+    RTC_STORE_FLASH_TYPE_MAX,
+} rtc_store_flash_type_t;
+
+/**
+ * @brief Finds the partition and recovers the log
+ *
+ * @return ESP_OK on success, ESP_ERR_NOT_FOUND if there is no partition (tier stays disabled)
+ */
+esp_err_t rtc_store_flash_init(void);
+
+void rtc_store_flash_deinit(void);
+
+bool rtc_store_flash_enabled(void);
+
+/**
+ * @brief Makes sure the current sector can take a full chunk, erasing the next one if needed
+ *
+ * Call before taking any RTC store lock, erasing a sector takes tens of milliseconds.
+ */
+esp_err_t rtc_store_flash_prepare(void);
+
+/**
+ * @brief Appends up to two spans to the stream of `type` as one chunk
+ *
+ * Writes as much as fits into the current sector, at most RTC_STORE_FLASH_CHUNK_MAX bytes. After
+ * rtc_store_flash_prepare() a full chunk always fits.
+ *
+ * @param[in] sync  the chunk starts on a record boundary; after data was lost the reader skips
+ *                  ahead to such a chunk
+ *
+ * @return number of bytes written, 0 if nothing could be written
+ */
+size_t rtc_store_flash_append(rtc_store_flash_type_t type, bool sync,
+                              const void *data1, size_t len1, const void *data2, size_t len2);
+
+/**
+ * @brief Unread bytes of `type` in flash
+ */
+size_t rtc_store_flash_pending(rtc_store_flash_type_t type);
+
+/**
+ * @brief Copies up to `size` bytes from the head of the stream of `type`, without consuming them
+ *
+ * @return number of bytes copied
+ */
+size_t rtc_store_flash_read(rtc_store_flash_type_t type, uint8_t *buf, size_t size);
+
+/**
+ * @brief Consumes up to `size` bytes from the head of the stream of `type`
+ *
+ * `size` should end on a record boundary, the position is persisted so that a reset resumes there.
+ *
+ * @return number of bytes consumed, which is less than `size` once flash has run dry
+ */
+size_t rtc_store_flash_release(rtc_store_flash_type_t type, size_t size);
+
+/**
+ * @brief Drops everything stored in flash
+ */
+void rtc_store_flash_discard(void);
+
+#ifdef __cplusplus
+}
+#endif
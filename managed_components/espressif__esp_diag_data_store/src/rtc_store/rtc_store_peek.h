@@ -0,0 +1,68 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <esp_err.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Zero-copy access to the RTC store
+ *
+ * A peek hands out the oldest data as (up to) two spans pointing straight into the ring buffer;
+ * the second one is only used when the data wraps around the end of the buffer. The data stays in
+ * place until the matching commit, so it can be consumed without copying it out first.
+ *
+ * Only one peek per store can be outstanding. Keep it short: while it is, data is not spilled to
+ * the flash tier, and with CONFIG_RTC_STORE_OVERWRITE_NON_CRITICAL_DATA non-critical writes which
+ * would need to evict records fail with ESP_ERR_NO_MEM.
+ */
+
+typedef struct {
+    const uint8_t *data;
+    size_t len;
+} rtc_store_span_t;
+
+/**
+ * @brief Peeks at up to `size` bytes of critical data
+ *
+ * @param[out] spans  two spans, oldest data first; unused ones have len 0
+ * @param[in]  size   most bytes to return
+ *
+ * @return ESP_OK on success (also when there is no data),
+ *         ESP_ERR_NOT_SUPPORTED if the oldest data is in the flash tier, use rtc_store_critical_data_read(),
+ *         ESP_ERR_INVALID_STATE if a peek is outstanding already or the store is not initialized
+ */
+esp_err_t rtc_store_critical_data_peek(rtc_store_span_t spans[2], size_t size);
+
+/**
+ * @brief Ends a critical data peek
+ *
+ * @param[in] size  bytes to release from the start of the peeked data, 0 keeps all of it for a
+ *                  later rtc_store_critical_data_release()
+ */
+esp_err_t rtc_store_critical_data_commit(size_t size);
+
+/**
+ * @brief Peeks at up to `size` bytes of non-critical data
+ *
+ * Same as rtc_store_critical_data_peek()
+ */
+esp_err_t rtc_store_non_critical_data_peek(rtc_store_span_t spans[2], size_t size);
+
+/**
+ * @brief Ends a non-critical data peek, releasing `size` bytes
+ */
+esp_err_t rtc_store_non_critical_data_commit(size_t size);
+
+#ifdef __cplusplus
+}
+#endif
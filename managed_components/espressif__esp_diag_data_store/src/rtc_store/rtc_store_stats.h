@@ -0,0 +1,48 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <esp_err.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Fill level and write activity of one RTC store
+ *
+ * Sampling `written` periodically gives the rate at which data comes in, and together with
+ * `size` and `filled`, when the store will run full.
+ */
+typedef struct {
+    size_t size;            /*!< Capacity of the RTC ring buffer */
+    size_t filled;          /*!< Bytes in the ring, including records which are still being written */
+    size_t flash_pending;   /*!< Bytes waiting in the flash tier, 0 without one */
+    uint32_t written;       /*!< Bytes accepted since init, wraps around */
+} rtc_store_stats_t;
+
+/**
+ * @brief Gets the stats of the critical store
+ *
+ * Lock-free, can be called from any task.
+ *
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if the store is not initialized
+ */
+esp_err_t rtc_store_critical_data_stats(rtc_store_stats_t *stats);
+
+/**
+ * @brief Gets the stats of the non-critical store
+ *
+ * Same as rtc_store_critical_data_stats()
+ */
+esp_err_t rtc_store_non_critical_data_stats(rtc_store_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
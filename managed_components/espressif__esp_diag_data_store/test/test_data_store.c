@@ -5,14 +5,19 @@
  */
 
 #include <string.h>
+#include <inttypes.h>
 #include <esp_err.h>
 #include <esp_log.h>
 #include <nvs_flash.h>
 #include <unity.h>
 #include <rtc_store.h>
+#include <rtc_store_peek.h>
+#include <rtc_store_stats.h>
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
 #include <esp_random.h>
+#include <esp_timer.h>
+#include <esp_partition.h>
 
 #if CONFIG_APP_TEST_DATA_STORE
 
@@ -410,5 +415,325 @@ static void read_critical_data_in_rtc(void)
 
 TEST_CASE_MULTIPLE_STAGES("data store validate data in RTC after crash", "[data-store][data-store-rtc]",
                           write_critical_data_in_rtc_and_reset, read_critical_data_in_rtc);
+
+#define STRESS_WRITERS          4
+#define STRESS_RECORDS          5000
+#define STRESS_MAX_PAYLOAD      32
+
+typedef struct {
+    uint8_t writer;
+    uint8_t len;
+    uint16_t seq;
+    uint8_t fill[STRESS_MAX_PAYLOAD];
+} stress_rec_t;
+
+static uint32_t s_stress_ok[STRESS_WRITERS];
+static uint32_t s_stress_no_mem[STRESS_WRITERS];
+static uint32_t s_stress_fail;
+static volatile uint32_t s_stress_done;
+
+static void stress_writer_task(void *arg)
+{
+    uint8_t id = (uint32_t) arg;
+    stress_rec_t rec = { .writer = id };
+
+    for (uint16_t i = 0; i < STRESS_RECORDS; i++) {
+        rec.seq = i;
+        rec.len = (i + id) % STRESS_MAX_PAYLOAD;
+        memset(rec.fill, (uint8_t) (i + id), rec.len);
+        esp_err_t err;
+        while ((err = rtc_store_non_critical_data_write("stress", &rec, 4 + rec.len)) == ESP_ERR_NO_MEM) {
+            s_stress_no_mem[id]++;
+            vTaskDelay(1); // let the reader drain
+        }
+        if (err == ESP_OK) {
+            s_stress_ok[id]++;
+        } else {
+            s_stress_fail++;
+        }
+    }
+    __atomic_add_fetch(&s_stress_done, 1, __ATOMIC_RELEASE);
+    vTaskDelete(NULL);
+}
+
+/* Consumes whole records from the non-critical store, checking content and per-writer order */
+static uint32_t stress_drain(int32_t *last_seq)
+{
+    rtc_store_non_critical_data_hdr_t header;
+    stress_rec_t rec;
+    uint32_t records = 0;
+    size_t off = 0;
+
+    int len = rtc_store_non_critical_data_read(data, sizeof(data));
+    while (len > 0 && off + 1 + sizeof(header) <= len) {
+        memcpy(&header, data + off + 1, sizeof(header));
+        size_t rec_len = 1 + sizeof(header) + header.len;
+        if (off + rec_len > len) {
+            break;
+        }
+        memcpy(&rec, data + off + 1 + sizeof(header), header.len);
+        TEST_ASSERT(rec.writer < STRESS_WRITERS);
+        TEST_ASSERT(header.len == 4 + rec.len);
+        TEST_ASSERT(rec.seq > last_seq[rec.writer]);
+        for (int j = 0; j < rec.len; j++) {
+            TEST_ASSERT(rec.fill[j] == (uint8_t) (rec.seq + rec.writer));
+        }
+        last_seq[rec.writer] = rec.seq;
+        off += rec_len;
+        records++;
+    }
+    if (off) {
+        TEST_ASSERT(rtc_store_non_critical_data_release(off) == ESP_OK);
+    }
+    return records;
+}
+
+TEST_CASE("data store non critical multi task write stress", "[data-store][data-store-rtc]")
+{
+    int32_t last_seq[STRESS_WRITERS];
+    uint32_t read = 0, written = 0, no_mem = 0;
+
+    init_nvs_flash();
+    TEST_ASSERT(rtc_store_init() == ESP_OK);
+    rtc_store_discard_data();
+    memset(s_stress_ok, 0, sizeof(s_stress_ok));
+    memset(s_stress_no_mem, 0, sizeof(s_stress_no_mem));
+    s_stress_fail = 0;
+    s_stress_done = 0;
+    for (int i = 0; i < STRESS_WRITERS; i++) {
+        last_seq[i] = -1;
+    }
+
+    int64_t start = esp_timer_get_time();
+    for (uint32_t i = 0; i < STRESS_WRITERS; i++) {
+        // mixed priorities, so writers preempt each other mid-record
+        TEST_ASSERT(xTaskCreate(stress_writer_task, "stress_wr", 3072, (void *) i,
+                                uxTaskPriorityGet(NULL) + 1 + (i % 2), NULL) == pdPASS);
+    }
+    while (__atomic_load_n(&s_stress_done, __ATOMIC_ACQUIRE) < STRESS_WRITERS) {
+        read += stress_drain(last_seq);
+        vTaskDelay(1);
+    }
+    read += stress_drain(last_seq);
+    int64_t elapsed_us = esp_timer_get_time() - start;
+
+    for (int i = 0; i < STRESS_WRITERS; i++) {
+        written += s_stress_ok[i];
+        no_mem += s_stress_no_mem[i];
+    }
+    ESP_LOGI(TAG, "%" PRIu32 " records from %d tasks in %" PRId64 " us, %" PRIu32 " full-buffer retries",
+             written, STRESS_WRITERS, elapsed_us, no_mem);
+
+    /* Writers never contend on a lock, so nothing is dropped */
+    TEST_ASSERT(s_stress_fail == 0);
+#if !CONFIG_RTC_STORE_OVERWRITE_NON_CRITICAL_DATA
+    TEST_ASSERT(written == STRESS_WRITERS * STRESS_RECORDS);
+    TEST_ASSERT(read == written);
+#endif
+
+    rtc_store_deinit();
+    nvs_flash_deinit();
+}
+
+#if CONFIG_RTC_STORE_OVERWRITE_NON_CRITICAL_DATA
+TEST_CASE("data store non critical large record evicts small records", "[data-store][data-store-rtc]")
+{
+    rtc_store_non_critical_data_hdr_t header;
+    static uint8_t large[1024];
+    uint32_t small = 0;
+    int64_t start, worst_us = 0;
+
+    init_nvs_flash();
+    TEST_ASSERT(rtc_store_init() == ESP_OK);
+    rtc_store_discard_data();
+
+    /* Fill the store with tiny records; once full, each write evicts one of them */
+    for (uint32_t i = 0; i < 1000; i++) {
+        TEST_ASSERT(rtc_store_non_critical_data_write("small", &i, sizeof(i)) == ESP_OK);
+    }
+    /* One write has to drop dozens of them at once */
+    memset(large, 0x5a, sizeof(large));
+    for (int i = 0; i < 4; i++) {
+        start = esp_timer_get_time();
+        TEST_ASSERT(rtc_store_non_critical_data_write("large", large, sizeof(large)) == ESP_OK);
+        int64_t us = esp_timer_get_time() - start;
+        worst_us = (us > worst_us) ? us : worst_us;
+        TEST_ASSERT(rtc_store_non_critical_data_write("small", &small, sizeof(small)) == ESP_OK);
+    }
+    ESP_LOGI(TAG, "worst large write with eviction: %" PRId64 " us", worst_us);
+
+    /* Whatever is left still starts on a record boundary */
+    int len = rtc_store_non_critical_data_read(data, sizeof(data));
+    TEST_ASSERT(len > 0);
+    memcpy(&header, data + 1, sizeof(header));
+    TEST_ASSERT(header.len == sizeof(small) || header.len == sizeof(large));
+
+    rtc_store_deinit();
+    nvs_flash_deinit();
+}
+#endif /* CONFIG_RTC_STORE_OVERWRITE_NON_CRITICAL_DATA */
+
+TEST_CASE("data store non critical fills up with the smallest records", "[data-store][data-store-rtc]")
+{
+    rtc_store_non_critical_data_hdr_t header;
+    rtc_store_stats_t stats;
+    size_t rec = 1 + sizeof(header) + 1;
+    uint32_t next = 0;
+    uint8_t val;
+
+    init_nvs_flash();
+    TEST_ASSERT(rtc_store_init() == ESP_OK);
+    rtc_store_discard_data();
+
+    /* As many records as fit in the buffer, none of them is dropped or refused */
+    TEST_ASSERT(rtc_store_non_critical_data_stats(&stats) == ESP_OK);
+    uint32_t records = stats.size / rec;
+    for (uint32_t i = 0; i < records; i++) {
+        val = i;
+        TEST_ASSERT(rtc_store_non_critical_data_write("small", &val, sizeof(val)) == ESP_OK);
+    }
+
+    /* The flash tier, if any, first and then RTC memory, read as one stream */
+    int len;
+    while ((len = rtc_store_non_critical_data_read(data, sizeof(data))) > 0) {
+        size_t off = 0;
+        while (len - off >= rec) {
+            memcpy(&header, data + off + 1, sizeof(header));
+            TEST_ASSERT_EQUAL(sizeof(val), header.len);
+            TEST_ASSERT_EQUAL_UINT8((uint8_t) next, data[off + 1 + sizeof(header)]);
+            next++;
+            off += rec;
+        }
+        TEST_ASSERT(rtc_store_non_critical_data_release(off) == ESP_OK);
+    }
+    TEST_ASSERT_EQUAL_UINT32(records, next);
+
+    rtc_store_deinit();
+    nvs_flash_deinit();
+}
+
+#if !CONFIG_RTC_STORE_OVERWRITE_NON_CRITICAL_DATA
+TEST_CASE("data store peek spans match read", "[data-store][data-store-rtc]")
+{
+    static uint8_t peeked[READ_DATA_SIZE];
+    rtc_store_span_t spans[2], busy[2];
+    rtc_store_stats_t stats;
+    size_t rec = 1 + sizeof(rtc_store_non_critical_data_hdr_t) + sizeof(uint32_t);
+    uint32_t seq = 0;
+    bool wrapped = false;
+
+    if (esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, "diag_log")) {
+        TEST_IGNORE_MESSAGE("diag_log partition, spills to flash would move the data");
+    }
+    init_nvs_flash();
+    TEST_ASSERT(rtc_store_init() == ESP_OK);
+    rtc_store_discard_data();
+    TEST_ASSERT(rtc_store_non_critical_data_stats(&stats) == ESP_OK);
+
+    /* Keep the ring half full while it goes around a few times, so that some peeks wrap: each
+     * round adds a quarter of the ring and drops half of what is there
+     */
+    for (int round = 0; round < 64; round++) {
+        for (uint32_t i = 0; i < stats.size / rec / 4; i++, seq++) {
+            TEST_ASSERT(rtc_store_non_critical_data_write("peek", &seq, sizeof(seq)) == ESP_OK);
+        }
+        TEST_ASSERT(rtc_store_non_critical_data_peek(spans, sizeof(peeked)) == ESP_OK);
+        TEST_ASSERT(rtc_store_non_critical_data_peek(busy, sizeof(peeked)) == ESP_ERR_INVALID_STATE);
+        int len = rtc_store_non_critical_data_read(data, sizeof(data));
+        TEST_ASSERT_EQUAL(len, spans[0].len + spans[1].len);
+        memcpy(peeked, spans[0].data, spans[0].len);
+        memcpy(peeked + spans[0].len, spans[1].data, spans[1].len);
+        TEST_ASSERT_EQUAL_MEMORY(data, peeked, len);
+        wrapped |= spans[1].len > 0;
+        /* Drop the older half, on a record boundary */
+        TEST_ASSERT(rtc_store_non_critical_data_commit((len / rec / 2) * rec) == ESP_OK);
+    }
+    TEST_ASSERT(wrapped);
+    TEST_ASSERT(rtc_store_non_critical_data_commit(0) == ESP_ERR_INVALID_STATE);
+
+    rtc_store_deinit();
+    nvs_flash_deinit();
+}
+#endif /* !CONFIG_RTC_STORE_OVERWRITE_NON_CRITICAL_DATA */
+
+TEST_CASE("data store stats count written bytes", "[data-store][data-store-rtc]")
+{
+    rtc_store_stats_t before, after;
+    uint32_t val = 0;
+
+    init_nvs_flash();
+    TEST_ASSERT(rtc_store_init() == ESP_OK);
+    rtc_store_discard_data();
+
+    TEST_ASSERT(rtc_store_critical_data_stats(&before) == ESP_OK);
+    TEST_ASSERT_EQUAL(0, before.filled);
+    TEST_ASSERT(rtc_store_critical_data_write(&val, sizeof(val)) == ESP_OK);
+    TEST_ASSERT(rtc_store_critical_data_stats(&after) == ESP_OK);
+    TEST_ASSERT_EQUAL(sizeof(val) + 1, after.written - before.written);
+    TEST_ASSERT_EQUAL(sizeof(val) + 1, after.filled);
+
+    TEST_ASSERT(rtc_store_non_critical_data_stats(&before) == ESP_OK);
+    TEST_ASSERT(rtc_store_non_critical_data_write("stats", &val, sizeof(val)) == ESP_OK);
+    TEST_ASSERT(rtc_store_non_critical_data_stats(&after) == ESP_OK);
+    TEST_ASSERT_EQUAL(1 + sizeof(rtc_store_non_critical_data_hdr_t) + sizeof(val), after.written - before.written);
+    TEST_ASSERT_EQUAL(after.filled, after.written - before.written);
+
+    /* Releasing frees space, but does not change the count */
+    TEST_ASSERT(rtc_store_non_critical_data_release(after.filled) == ESP_OK);
+    TEST_ASSERT(rtc_store_non_critical_data_stats(&before) == ESP_OK);
+    TEST_ASSERT_EQUAL(0, before.filled);
+    TEST_ASSERT_EQUAL(after.written, before.written);
+
+    rtc_store_deinit();
+    nvs_flash_deinit();
+}
+
+#define SPILL_RECORDS   1000
+
+typedef struct {
+    uint32_t seq;
+    char buf[12];
+} spill_rec_t;
+
+TEST_CASE("data store critical spills to flash and drains in order", "[data-store][data-store-rtc]")
+{
+    spill_rec_t rec;
+    uint32_t next = 0;
+
+    if (!esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, "diag_log")) {
+        TEST_IGNORE_MESSAGE("no diag_log partition, flash tier disabled");
+    }
+    init_nvs_flash();
+    TEST_ASSERT(rtc_store_init() == ESP_OK);
+    rtc_store_discard_data();
+
+    /* Several times what fits in RTC memory; the spill task moves the overflow to flash */
+    memset(rec.buf, 'x', sizeof(rec.buf));
+    for (rec.seq = 0; rec.seq < SPILL_RECORDS; rec.seq++) {
+        int retries = 100;
+        while (rtc_store_critical_data_write(&rec, sizeof(rec)) == ESP_ERR_NO_MEM && --retries) {
+            vTaskDelay(10 / portTICK_PERIOD_MS);
+        }
+        TEST_ASSERT(retries);
+    }
+
+    /* Flash first, then RTC memory, reads as one stream */
+    int len;
+    while ((len = rtc_store_critical_data_read(data, READ_DATA_SIZE)) > 0) {
+        size_t off = 0;
+        while (len - off >= 1 + sizeof(rec)) {
+            memcpy(&rec, data + off + 1, sizeof(rec));
+            TEST_ASSERT_EQUAL_UINT32(next, rec.seq);
+            next++;
+            off += 1 + sizeof(rec);
+        }
+        TEST_ASSERT(off > 0);
+        TEST_ASSERT(rtc_store_critical_data_release(off) == ESP_OK);
+    }
+    TEST_ASSERT_EQUAL_UINT32(SPILL_RECORDS, next);
+
+    rtc_store_deinit();
+    nvs_flash_deinit();
+}
 #endif /* CONFIG_DIAG_DATA_STORE_FLASH */
 #endif /* CONFIG_APP_TEST_DATA_STORE */
@@ -0,0 +1,159 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <esp_err.h>
+#include <esp_log.h>
+#include <esp_diagnostics.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * @brief Typed argument for a structured diagnostics event
+ *
+ * Built at compile time by ESP_DIAG_ARG(), so the argument type is known without
+ * parsing the format string on the device.
+ */
+typedef struct {
+    uint8_t type;       /*!< One of esp_diag_arg_type_t */
+    uint8_t len;        /*!< Size of the value in bytes, string length for ARG_TYPE_STR */
+    union {
+        int i;
+        unsigned int u;
+        long l;
+        unsigned long ul;
+        long long ll;
+        unsigned long long ull;
+        double d;
+        const char *str;
+    } v;                /*!< Argument value */
+} esp_diag_event_arg_t;
+
+/**
+ * @brief Record a structured event
+ *
+ * Writes the same record as esp_diag_log_event(), with the TLV argument block
+ * copied directly from args instead of being derived from the format string.
+ * The format string is only stored as a pointer, which the cloud resolves from
+ * the ELF; it acts as the event's compile-time ID.
+ *
+ * Prefer the ESP_DIAG_EVENT_FAST() macro over calling this directly.
+ *
+ * @note Only available with CONFIG_DIAG_LOG_MSG_ARG_FORMAT_TLV.
+ *
+ * @param[in] tag    Event tag
+ * @param[in] format Format string; must match the types of args
+ * @param[in] args   Array of typed arguments, may be NULL if n_args is 0
+ * @param[in] n_args Number of arguments
+ *
+ * @return ESP_OK if successful, appropriate error code otherwise.
+ */
+esp_err_t esp_diag_log_event_typed(const char *tag, const char *format,
+                                   const esp_diag_event_arg_t *args, size_t n_args);
+
+/** @cond **/
+static inline esp_diag_event_arg_t esp_diag_arg_int(int x)
+{
+    return (esp_diag_event_arg_t) { .type = ARG_TYPE_INT, .len = sizeof(int), .v.i = x };
+}
+static inline esp_diag_event_arg_t esp_diag_arg_uint(unsigned int x)
+{
+    return (esp_diag_event_arg_t) { .type = ARG_TYPE_UINT, .len = sizeof(unsigned int), .v.u = x };
+}
+static inline esp_diag_event_arg_t esp_diag_arg_l(long x)
+{
+    return (esp_diag_event_arg_t) { .type = ARG_TYPE_L, .len = sizeof(long), .v.l = x };
+}
+static inline esp_diag_event_arg_t esp_diag_arg_ul(unsigned long x)
+{
+    return (esp_diag_event_arg_t) { .type = ARG_TYPE_UL, .len = sizeof(unsigned long), .v.ul = x };
+}
+static inline esp_diag_event_arg_t esp_diag_arg_ll(long long x)
+{
+    return (esp_diag_event_arg_t) { .type = ARG_TYPE_LL, .len = sizeof(long long), .v.ll = x };
+}
+static inline esp_diag_event_arg_t esp_diag_arg_ull(unsigned long long x)
+{
+    return (esp_diag_event_arg_t) { .type = ARG_TYPE_ULL, .len = sizeof(unsigned long long), .v.ull = x };
+}
+/* float is promoted to double, same as when passed through printf varargs */
+static inline esp_diag_event_arg_t esp_diag_arg_double(double x)
+{
+    return (esp_diag_event_arg_t) { .type = ARG_TYPE_DOUBLE, .len = sizeof(double), .v.d = x };
+}
+/* len is filled in by esp_diag_log_event_typed() */
+static inline esp_diag_event_arg_t esp_diag_arg_str(const char *x)
+{
+    return (esp_diag_event_arg_t) { .type = ARG_TYPE_STR, .len = 0, .v.str = x };
+}
+
+#define ESP_DIAG_ARG(x) _Generic((x),                    \
+        char *: esp_diag_arg_str,                        \
+        const char *: esp_diag_arg_str,                  \
+        float: esp_diag_arg_double,                      \
+        double: esp_diag_arg_double,                     \
+        unsigned int: esp_diag_arg_uint,                 \
+        long: esp_diag_arg_l,                            \
+        unsigned long: esp_diag_arg_ul,                  \
+        long long: esp_diag_arg_ll,                      \
+        unsigned long long: esp_diag_arg_ull,            \
+        default: esp_diag_arg_int)(x)
+
+#define _DIAG_EVT_NARGS(...)  _DIAG_EVT_NARGS_(_, ##__VA_ARGS__, 4, 3, 2, 1, 0)
+#define _DIAG_EVT_NARGS_(_, a, b, c, d, N, ...) N
+#define _DIAG_EVT_CAT(a, b)   _DIAG_EVT_CAT_(a, b)
+#define _DIAG_EVT_CAT_(a, b)  a##b
+
+/* Same format and leading arguments as ESP_DIAG_EVENT(), so that the records are the same */
+#define _DIAG_EVT_FMT(fmt)      "EV (%" PRIu32 ") %s: " fmt
+#define _DIAG_EVT_PREFIX(tag)   ESP_DIAG_ARG((uint32_t)esp_log_timestamp()), ESP_DIAG_ARG((const char *)(tag))
+
+#define _DIAG_EVT_0(tag, fmt) \
+    esp_diag_log_event_typed(tag, _DIAG_EVT_FMT(fmt), (const esp_diag_event_arg_t[]) { _DIAG_EVT_PREFIX(tag) }, 2)
+#define _DIAG_EVT_1(tag, fmt, a) \
+    esp_diag_log_event_typed(tag, _DIAG_EVT_FMT(fmt), (const esp_diag_event_arg_t[]) { _DIAG_EVT_PREFIX(tag), \
+                                                                                       ESP_DIAG_ARG(a) }, 3)
+#define _DIAG_EVT_2(tag, fmt, a, b) \
+    esp_diag_log_event_typed(tag, _DIAG_EVT_FMT(fmt), (const esp_diag_event_arg_t[]) { _DIAG_EVT_PREFIX(tag), \
+                                                                                       ESP_DIAG_ARG(a), ESP_DIAG_ARG(b) }, 4)
+#define _DIAG_EVT_3(tag, fmt, a, b, c) \
+    esp_diag_log_event_typed(tag, _DIAG_EVT_FMT(fmt), (const esp_diag_event_arg_t[]) { _DIAG_EVT_PREFIX(tag), \
+                                                                                       ESP_DIAG_ARG(a), ESP_DIAG_ARG(b), \
+                                                                                       ESP_DIAG_ARG(c) }, 5)
+#define _DIAG_EVT_4(tag, fmt, a, b, c, d) \
+    esp_diag_log_event_typed(tag, _DIAG_EVT_FMT(fmt), (const esp_diag_event_arg_t[]) { _DIAG_EVT_PREFIX(tag), \
+                                                                                       ESP_DIAG_ARG(a), ESP_DIAG_ARG(b), \
+                                                                                       ESP_DIAG_ARG(c), ESP_DIAG_ARG(d) }, 6)
+/** @endcond **/
+
+#if CONFIG_DIAG_LOG_MSG_ARG_FORMAT_TLV
+/**
+ * @brief Record a structured event with up to four arguments
+ *
+ * Drop-in for ESP_DIAG_EVENT() on hot paths. Argument types are resolved at compile time,
+ * so recording an event costs a few stores and a memcpy instead of a format string parse.
+ * The record is the one ESP_DIAG_EVENT() writes, "EV (<timestamp>) <tag>: " prefix included.
+ * Unlike ESP_DIAG_EVENT(), the event is not printed to the console.
+ *
+ * @note Arguments must match the format's conversions (e.g. "%d" for int, "%s" for strings).
+ */
+#define ESP_DIAG_EVENT_FAST(tag, format, ...) \
+    _DIAG_EVT_CAT(_DIAG_EVT_, _DIAG_EVT_NARGS(__VA_ARGS__))(tag, format, ##__VA_ARGS__)
+#else
+/* String format needs vsnprintf anyway, fall back to the regular event */
+#define ESP_DIAG_EVENT_FAST(tag, format, ...) ESP_DIAG_EVENT(tag, format, ##__VA_ARGS__)
+#endif /* CONFIG_DIAG_LOG_MSG_ARG_FORMAT_TLV */
+
+#ifdef __cplusplus
+}
+#endif
@@ -56,6 +56,75 @@ esp_err_t esp_diag_heap_metrics_dump(void);
 
 #endif /* CONFIG_DIAG_ENABLE_HEAP_METRICS */
 
+#if CONFIG_DIAG_ENABLE_HEAP_PROFILER
+
+/**
+ * @brief Allocations from one call site, as estimated by the heap profiler
+ *
+ * Counts are scaled up from the sampled allocations by CONFIG_DIAG_HEAP_PROFILER_SAMPLE_PERIOD.
+ */
+typedef struct {
+    uintptr_t pc;               /*!< Return address of the allocating call */
+    uint32_t allocs;            /*!< Allocations */
+    uint32_t bytes;             /*!< Bytes allocated */
+    uint32_t live;              /*!< Allocations not freed yet */
+    uint32_t live_bytes;        /*!< Bytes not freed yet */
+    uint32_t max_size;          /*!< Largest sampled allocation */
+    uint32_t avg_lifetime_ms;   /*!< Average time from allocation to free, of the freed ones */
+} esp_diag_heap_site_t;
+
+/**
+ * @brief Initialize the heap profiler
+ *
+ * Samples about one in CONFIG_DIAG_HEAP_PROFILER_SAMPLE_PERIOD calls to malloc(), calloc(),
+ * realloc(), strdup() and strndup() and adds them up per call site, together with their
+ * lifetime. The call sites which allocated the most bytes are reported as events every
+ * CONFIG_DIAG_HEAP_PROFILER_REPORT_INTERVAL seconds.
+ *
+ * Allocations made with heap_caps_malloc() and friends directly are not seen.
+ *
+ * @return ESP_OK if successful, appropriate error code otherwise.
+ */
+esp_err_t esp_diag_heap_profiler_init(void);
+
+/**
+ * @brief Deinitialize the heap profiler
+ *
+ * @return ESP_OK if successful, appropriate error code otherwise.
+ */
+esp_err_t esp_diag_heap_profiler_deinit(void);
+
+/**
+ * @brief Get the call sites which allocated the most bytes
+ *
+ * @param[out] sites Call sites, the one with the most bytes first
+ * @param[in]  max   Size of sites
+ *
+ * @return Number of call sites written to sites
+ */
+size_t esp_diag_heap_profiler_top(esp_diag_heap_site_t *sites, size_t max);
+
+/**
+ * @brief Clear the collected call sites
+ */
+void esp_diag_heap_profiler_reset(void);
+
+/**
+ * @brief Dumps the top call sites, prints them to the console and reports them as events.
+ *
+ * @return ESP_OK if successful, appropriate error code otherwise.
+ */
+esp_err_t esp_diag_heap_profiler_dump(void);
+
+/**
+ * @brief Register the "heap-prof" console command
+ *
+ * @return ESP_OK if successful, appropriate error code otherwise.
+ */
+esp_err_t esp_diag_heap_profiler_register_cmd(void);
+
+#endif /* CONFIG_DIAG_ENABLE_HEAP_PROFILER */
+
 #if CONFIG_DIAG_ENABLE_WIFI_METRICS
 
 /**
@@ -99,6 +168,52 @@ void esp_diag_wifi_metrics_reset_interval(uint32_t period);
 
 #endif /* CONFIG_DIAG_ENABLE_WIFI_METRICS */
 
+#if CONFIG_DIAG_ENABLE_CPU_METRICS
+
+/**
+ * @brief Initialize the CPU metrics
+ *
+ * FreeRTOS run time stats are sampled periodically and the CPU time each task used since the
+ * previous sample is worked out. The total CPU load and the share of the CONFIG_DIAG_CPU_METRICS_TOP_N
+ * busiest tasks are reported, in percent of the CPU time of all cores.
+ *
+ * The periodic interval is configurable through CONFIG_DIAG_CPU_POLLING_INTERVAL Kconfig option.
+ * Default is 60 seconds and can be changed with esp_diag_cpu_metrics_reset_interval() at runtime.
+ * Valid range is from 30 seconds to 1 hour (3600 seconds).
+ *
+ * @return ESP_OK if successful, appropriate error code otherwise.
+ */
+esp_err_t esp_diag_cpu_metrics_init(void);
+
+/**
+ * @brief Deinitialize the CPU metrics
+ *
+ * @return ESP_OK if successful, appropriate error code otherwise.
+ */
+esp_err_t esp_diag_cpu_metrics_deinit(void);
+
+/**
+ * @brief Dumps the CPU metrics and prints them to the console.
+ *
+ * This API reports the CPU usage since the previous call, or since the previous periodic sample.
+ *
+ * @return ESP_OK if successful, appropriate error code otherwise.
+ */
+esp_err_t esp_diag_cpu_metrics_dump(void);
+
+/**
+ * @brief Reset the periodic interval
+ *
+ * By default, CPU metrics are collected based on CONFIG_DIAG_CPU_POLLING_INTERVAL Kconfig option.
+ * This function can be used to change the interval at runtime.
+ * If the interval is set to 0, CPU metrics collection is disabled.
+ *
+ * @param[in] period Period interval in seconds, at most 3600 with a 32-bit run time counter
+ */
+void esp_diag_cpu_metrics_reset_interval(uint32_t period);
+
+#endif /* CONFIG_DIAG_ENABLE_CPU_METRICS */
+
 #ifdef __cplusplus
 }
 #endif
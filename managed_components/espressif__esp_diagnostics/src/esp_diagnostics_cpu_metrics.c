@@ -0,0 +1,269 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include <esp_log.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "sdkconfig.h"
+
+#include <esp_rmaker_work_queue.h>
+#include <esp_diagnostics_metrics.h>
+#include "esp_diagnostics_internal.h"
+
+#define LOG_TAG            "cpu_metrics"
+#define METRICS_TAG        "cpu"
+#define METRICS_UNIT       "%"
+#define KEY_LOAD           "load"
+
+#define PATH_CPU           "cpu"
+#define PATH_CPU_TASKS     "cpu.tasks"
+
+/* Use configurable polling interval with default fallback */
+#ifdef CONFIG_DIAG_CPU_POLLING_INTERVAL
+#define DEFAULT_POLLING_INTERVAL CONFIG_DIAG_CPU_POLLING_INTERVAL
+#else
+#define DEFAULT_POLLING_INTERVAL 60 /* 60 seconds */
+#endif
+
+#define CPU_TOP_N          CONFIG_DIAG_CPU_METRICS_TOP_N
+/* Tasks which get a metric of their own. A task which shows up in the top N after that many
+ * tasks did is only logged, so that short lived tasks cannot use up all metrics.
+ */
+#define CPU_MAX_TASKS      CONFIG_DIAG_CPU_METRICS_MAX_TASKS
+/* Spare entries for tasks created between counting and sampling them */
+#define CPU_SAMPLE_SPARE   4
+
+typedef configRUN_TIME_COUNTER_TYPE run_time_t;
+
+/* Run time of a task as of the previous sample */
+typedef struct {
+    UBaseType_t task_number;
+    run_time_t run_time;
+} cpu_prev_t;
+
+/* A task with a metric, the key is its name */
+typedef struct {
+    char name[configMAX_TASK_NAME_LEN];
+} cpu_slot_t;
+
+typedef struct {
+    TaskStatus_t *task;
+    run_time_t delta;
+} cpu_usage_t;
+
+typedef struct {
+    bool init;
+    esp_rmaker_work_timer_handle_t handle;
+    run_time_t prev_total;
+    cpu_prev_t *prev;
+    UBaseType_t prev_count;
+    cpu_slot_t slot[CPU_MAX_TASKS];
+    uint8_t slot_count;
+} cpu_diag_priv_data_t;
+
+static cpu_diag_priv_data_t s_priv_data;
+
+static esp_err_t cpu_metric_report(const char *key, float value)
+{
+#ifndef CONFIG_ESP_INSIGHTS_META_VERSION_10
+    return esp_diag_metrics_report_float(METRICS_TAG, key, value);
+#else
+    return esp_diag_metrics_add_float(key, value);
+#endif
+}
+
+/* Returns the metric key of a task, registering one if there is a slot left */
+static const char *cpu_slot_get(const char *name)
+{
+    for (int i = 0; i < s_priv_data.slot_count; i++) {
+        if (strncmp(s_priv_data.slot[i].name, name, configMAX_TASK_NAME_LEN) == 0) {
+            return s_priv_data.slot[i].name;
+        }
+    }
+    if (s_priv_data.slot_count == CPU_MAX_TASKS) {
+        return NULL;
+    }
+    cpu_slot_t *slot = &s_priv_data.slot[s_priv_data.slot_count];
+    strlcpy(slot->name, name, sizeof(slot->name));
+    if (esp_diag_metrics_register(METRICS_TAG, slot->name, slot->name, PATH_CPU_TASKS, ESP_DIAG_DATA_TYPE_FLOAT) != ESP_OK) {
+        return NULL;
+    }
+#ifndef CONFIG_ESP_INSIGHTS_META_VERSION_10
+    esp_diag_metrics_add_unit(METRICS_TAG, slot->name, METRICS_UNIT);
+#else
+    esp_diag_metrics_add_unit(slot->name, METRICS_UNIT);
+#endif
+    s_priv_data.slot_count++;
+    return slot->name;
+}
+
+static void cpu_slots_unregister(void)
+{
+    for (int i = 0; i < s_priv_data.slot_count; i++) {
+#ifdef CONFIG_ESP_INSIGHTS_META_VERSION_10
+        esp_diag_metrics_unregister(s_priv_data.slot[i].name);
+#else
+        esp_diag_metrics_unregister(METRICS_TAG, s_priv_data.slot[i].name);
+#endif
+    }
+    s_priv_data.slot_count = 0;
+}
+
+/* Run time of a task as of the previous sample, 0 for a task created since then */
+static run_time_t cpu_prev_run_time(UBaseType_t task_number)
+{
+    for (UBaseType_t i = 0; i < s_priv_data.prev_count; i++) {
+        if (s_priv_data.prev[i].task_number == task_number) {
+            return s_priv_data.prev[i].run_time;
+        }
+    }
+    return 0;
+}
+
+/* Keeps the N largest deltas in `top`, largest first */
+static void cpu_top_insert(cpu_usage_t *top, int *count, TaskStatus_t *task, run_time_t delta)
+{
+    int i = (*count < CPU_TOP_N) ? (*count)++ : CPU_TOP_N;
+    for (; i > 0 && top[i - 1].delta < delta; i--) {
+        if (i < CPU_TOP_N) {
+            top[i] = top[i - 1];
+        }
+    }
+    if (i < CPU_TOP_N) {
+        top[i].task = task;
+        top[i].delta = delta;
+    }
+}
+
+esp_err_t esp_diag_cpu_metrics_dump(void)
+{
+    if (!s_priv_data.init) {
+        ESP_LOGW(LOG_TAG, "CPU metrics not initialized");
+        return ESP_ERR_INVALID_STATE;
+    }
+    UBaseType_t max = uxTaskGetNumberOfTasks() + CPU_SAMPLE_SPARE;
+    TaskStatus_t *tasks = malloc(max * sizeof(TaskStatus_t));
+    cpu_prev_t *prev = malloc(max * sizeof(cpu_prev_t));
+    if (!tasks || !prev) {
+        free(tasks);
+        free(prev);
+        return ESP_ERR_NO_MEM;
+    }
+    run_time_t total;
+    UBaseType_t count = uxTaskGetSystemState(tasks, max, &total);
+    if (!count) {
+        free(tasks);
+        free(prev);
+        return ESP_FAIL;
+    }
+
+    /* Every core adds run time to its tasks at the same rate as the counter */
+    run_time_t elapsed = (total - s_priv_data.prev_total) * portNUM_PROCESSORS;
+    bool first = (s_priv_data.prev == NULL);
+    cpu_usage_t top[CPU_TOP_N];
+    int top_count = 0;
+    run_time_t idle = 0;
+
+    for (UBaseType_t i = 0; i < count; i++) {
+        run_time_t delta = tasks[i].ulRunTimeCounter - cpu_prev_run_time(tasks[i].xTaskNumber);
+        prev[i].task_number = tasks[i].xTaskNumber;
+        prev[i].run_time = tasks[i].ulRunTimeCounter;
+        if (tasks[i].uxCurrentPriority == tskIDLE_PRIORITY && strncmp(tasks[i].pcTaskName, "IDLE", 4) == 0) {
+            idle += delta;
+            continue;
+        }
+        cpu_top_insert(top, &top_count, &tasks[i], delta);
+    }
+
+    free(s_priv_data.prev);
+    s_priv_data.prev = prev;
+    s_priv_data.prev_count = count;
+    s_priv_data.prev_total = total;
+
+    esp_err_t err = ESP_OK;
+    if (first || !elapsed) {
+        goto done; // the first sample only sets the baseline
+    }
+    float load = (idle < elapsed) ? 100.0f * (elapsed - idle) / elapsed : 0.0f;
+    if (cpu_metric_report(KEY_LOAD, load) != ESP_OK) {
+        ESP_LOGW(LOG_TAG, "Failed to add cpu metric key:" KEY_LOAD);
+        err = ESP_FAIL;
+    }
+    ESP_LOGI(LOG_TAG, KEY_LOAD ":%.1f%%", load);
+    for (int i = 0; i < top_count; i++) {
+        float pct = 100.0f * top[i].delta / elapsed;
+        const char *key = cpu_slot_get(top[i].task->pcTaskName);
+        ESP_LOGI(LOG_TAG, "#%d %s:%.1f%%", i + 1, top[i].task->pcTaskName, pct);
+        if (key && cpu_metric_report(key, pct) != ESP_OK) {
+            ESP_LOGW(LOG_TAG, "Failed to add cpu metric key:%s", key);
+            err = ESP_FAIL;
+        }
+    }
+done:
+    free(tasks);
+    return err;
+}
+
+static void cpu_metrics_dump_cb(void *arg)
+{
+    esp_diag_cpu_metrics_dump();
+}
+
+esp_err_t esp_diag_cpu_metrics_init(void)
+{
+    if (s_priv_data.init) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    esp_diag_metrics_register(METRICS_TAG, KEY_LOAD, "CPU load", PATH_CPU, ESP_DIAG_DATA_TYPE_FLOAT);
+#ifndef CONFIG_ESP_INSIGHTS_META_VERSION_10
+    esp_diag_metrics_add_unit(METRICS_TAG, KEY_LOAD, METRICS_UNIT);
+#else
+    esp_diag_metrics_add_unit(KEY_LOAD, METRICS_UNIT);
+#endif
+    if (esp_rmaker_work_queue_add_periodic(cpu_metrics_dump_cb, NULL, ESP_RMAKER_WORK_PRIO_BACKGROUND,
+                                           DEFAULT_POLLING_INTERVAL * 1000, &s_priv_data.handle) != ESP_OK) {
+        ESP_LOGW(LOG_TAG, "Failed to create cpu metric timer");
+    }
+    s_priv_data.init = true;
+
+    // Take the baseline, usage is reported from the next interval on
+    esp_diag_cpu_metrics_dump();
+
+    return ESP_OK;
+}
+
+esp_err_t esp_diag_cpu_metrics_deinit(void)
+{
+    if (!s_priv_data.init) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (esp_rmaker_work_queue_timer_delete(s_priv_data.handle) != ESP_OK) {
+        ESP_LOGW(LOG_TAG, "Failed to delete cpu metric timer");
+    }
+#ifdef CONFIG_ESP_INSIGHTS_META_VERSION_10
+    esp_diag_metrics_unregister(KEY_LOAD);
+#else
+    esp_diag_metrics_unregister(METRICS_TAG, KEY_LOAD);
+#endif
+    cpu_slots_unregister();
+    free(s_priv_data.prev);
+    memset(&s_priv_data, 0, sizeof(s_priv_data));
+    return ESP_OK;
+}
+
+void esp_diag_cpu_metrics_reset_interval(uint32_t period)
+{
+    if (!s_priv_data.init) {
+        return;
+    }
+    if (period == 0) {
+        esp_rmaker_work_queue_timer_stop(s_priv_data.handle);
+        return;
+    }
+    esp_rmaker_work_queue_timer_change_period(s_priv_data.handle, period * 1000);
+}
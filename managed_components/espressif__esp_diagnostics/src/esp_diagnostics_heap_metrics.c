@@ -8,7 +8,6 @@
 #include <esp_heap_caps.h>
 #include <esp_idf_version.h>
 #include <freertos/FreeRTOS.h>
-#include <freertos/timers.h>
 #include "sdkconfig.h"
 
 #include <esp_rmaker_work_queue.h>
@@ -42,7 +41,7 @@
 
 typedef struct {
     bool init;
-    TimerHandle_t handle;
+    esp_rmaker_work_timer_handle_t handle;
 } heap_diag_priv_data_t;
 
 static heap_diag_priv_data_t s_priv_data;
@@ -111,11 +110,6 @@ static void heap_metrics_dump_cb(void *arg)
     esp_diag_heap_metrics_dump();
 }
 
-static void heap_timer_cb(TimerHandle_t handle)
-{
-    esp_rmaker_work_queue_add_task(heap_metrics_dump_cb, NULL);
-}
-
 static void alloc_failed_hook(size_t size, uint32_t caps, const char *func)
 {
     esp_diag_heap_metrics_dump();
@@ -171,10 +165,9 @@ esp_err_t esp_diag_heap_metrics_init(void)
     esp_diag_metrics_add_unit(KEY_LFB, METRICS_UNIT);
     esp_diag_metrics_add_unit(KEY_MIN_FREE, METRICS_UNIT);
 #endif
-    s_priv_data.handle = xTimerCreate("heap_metrics", SEC2TICKS(DEFAULT_POLLING_INTERVAL),
-                                      pdTRUE, NULL, heap_timer_cb);
-    if (s_priv_data.handle) {
-        xTimerStart(s_priv_data.handle, 0);
+    if (esp_rmaker_work_queue_add_periodic(heap_metrics_dump_cb, NULL, ESP_RMAKER_WORK_PRIO_BACKGROUND,
+                                           DEFAULT_POLLING_INTERVAL * 1000, &s_priv_data.handle) != ESP_OK) {
+        ESP_LOGW(LOG_TAG, "Failed to create heap metric timer");
     }
     s_priv_data.init = true;
 
@@ -189,8 +182,7 @@ esp_err_t esp_diag_heap_metrics_deinit(void)
     if (!s_priv_data.init) {
         return ESP_ERR_INVALID_STATE;
     }
-    /* Try to delete timer with 10 ticks wait time */
-    if (xTimerDelete(s_priv_data.handle, 10) == pdFALSE) {
+    if (esp_rmaker_work_queue_timer_delete(s_priv_data.handle) != ESP_OK) {
         ESP_LOGW(LOG_TAG, "Failed to delete heap metric timer");
     }
 #ifdef CONFIG_ESP_INSIGHTS_META_VERSION_10
@@ -224,8 +216,8 @@ void esp_diag_heap_metrics_reset_interval(uint32_t period)
         return;
     }
     if (period == 0) {
-        xTimerStop(s_priv_data.handle, 0);
+        esp_rmaker_work_queue_timer_stop(s_priv_data.handle);
         return;
     }
-    xTimerChangePeriod(s_priv_data.handle, SEC2TICKS(period), 0);
+    esp_rmaker_work_queue_timer_change_period(s_priv_data.handle, period * 1000);
 }
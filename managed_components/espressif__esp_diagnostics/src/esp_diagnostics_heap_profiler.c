@@ -0,0 +1,415 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include <esp_log.h>
+#include <esp_heap_caps.h>
+#include <esp_timer.h>
+#include <esp_console.h>
+#include <freertos/FreeRTOS.h>
+#include "sdkconfig.h"
+
+#include <esp_rmaker_work_queue.h>
+#include <esp_diagnostics.h>
+#include <esp_diagnostics_system_metrics.h>
+#include "esp_diagnostics_internal.h"
+
+/* Allocations are sampled in the linker wrappers of malloc() and friends (see CMakeLists.txt), so
+ * that the caller's PC is the return address of the wrapper. For every sampled allocation the
+ * site it came from, its size and the time are kept in the live table until it is freed, and the
+ * site table adds them up per call site.
+ */
+
+#define LOG_TAG            "heap_prof"
+#define EVENT_TAG          "heap"
+
+#define SAMPLE_PERIOD      CONFIG_DIAG_HEAP_PROFILER_SAMPLE_PERIOD
+#define MAX_SITES          CONFIG_DIAG_HEAP_PROFILER_MAX_SITES
+#define MAX_LIVE           CONFIG_DIAG_HEAP_PROFILER_MAX_LIVE
+#define REPORT_INTERVAL    CONFIG_DIAG_HEAP_PROFILER_REPORT_INTERVAL
+#define REPORT_TOP_N       CONFIG_DIAG_HEAP_PROFILER_TOP_N
+
+#define NO_SITE            0xFFFF
+
+/* Sampled allocations from one call site */
+typedef struct {
+    uintptr_t pc;
+    uint32_t allocs;
+    uint32_t bytes;
+    uint32_t frees;
+    uint32_t live;
+    uint32_t live_bytes;
+    uint32_t max_size;
+    uint64_t lifetime_ms;       /* Summed up over the freed ones */
+} prof_site_t;
+
+/* A sampled allocation which is not freed yet */
+typedef struct {
+    void *ptr;
+    uint32_t size;
+    uint32_t t_ms;
+    uint16_t site;
+} prof_live_t;
+
+typedef struct {
+    bool enabled;
+    uint32_t countdown;
+    uint32_t rand;
+    uint32_t sampled;
+    uint32_t dropped;
+    uint16_t site_count;
+    uint16_t live_count;
+    prof_site_t site[MAX_SITES];
+    prof_live_t live[MAX_LIVE];
+    esp_rmaker_work_timer_handle_t handle;
+} heap_prof_priv_data_t;
+
+static heap_prof_priv_data_t s_prof;
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t n, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void __real_free(void *ptr);
+char *__real_strdup(const char *s);
+char *__real_strndup(const char *s, size_t n);
+
+static inline uint32_t prof_hash(uintptr_t v, uint32_t size)
+{
+    return ((v >> 2) * 2654435761U) % size;
+}
+
+/* Allocations between two samples, random so that periodic patterns do not alias with it.
+ * Averages SAMPLE_PERIOD. Called with s_lock held.
+ */
+static uint32_t prof_next_countdown(void)
+{
+    if (SAMPLE_PERIOD <= 1) {
+        return 1;
+    }
+    uint32_t x = s_prof.rand;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    s_prof.rand = x;
+    return 1 + x % (2 * SAMPLE_PERIOD - 1);
+}
+
+/* Called with s_lock held */
+static uint16_t prof_site_get(uintptr_t pc)
+{
+    uint32_t i = prof_hash(pc, MAX_SITES);
+    for (uint32_t n = 0; n < MAX_SITES; n++, i = (i + 1) % MAX_SITES) {
+        if (s_prof.site[i].pc == pc) {
+            return i;
+        }
+        if (!s_prof.site[i].pc) {
+            s_prof.site[i].pc = pc;
+            s_prof.site_count++;
+            return i;
+        }
+    }
+    return NO_SITE;
+}
+
+/* Slot of ptr in the live table, or of the empty entry ending its probe sequence.
+ * Called with s_lock held; the table always keeps one entry empty.
+ */
+static uint32_t prof_live_find(void *ptr)
+{
+    uint32_t i = prof_hash((uintptr_t) ptr, MAX_LIVE);
+    while (s_prof.live[i].ptr && s_prof.live[i].ptr != ptr) {
+        i = (i + 1) % MAX_LIVE;
+    }
+    return i;
+}
+
+/* Removes an entry and moves later entries of the same probe sequence up, so that lookups never
+ * need tombstones. Called with s_lock held.
+ */
+static void prof_live_remove(uint32_t i)
+{
+    uint32_t j = i;
+    while (true) {
+        j = (j + 1) % MAX_LIVE;
+        if (!s_prof.live[j].ptr) {
+            break;
+        }
+        uint32_t home = prof_hash((uintptr_t) s_prof.live[j].ptr, MAX_LIVE);
+        // the entry at j stays if its home slot lies cyclically in (i, j]
+        bool stays = (i <= j) ? (i < home && home <= j) : (i < home || home <= j);
+        if (!stays) {
+            s_prof.live[i] = s_prof.live[j];
+            i = j;
+        }
+    }
+    s_prof.live[i].ptr = NULL;
+    s_prof.live_count--;
+}
+
+/* Called with s_lock held */
+static void prof_release(uint32_t i, uint32_t now_ms)
+{
+    prof_live_t *live = &s_prof.live[i];
+    prof_site_t *site = &s_prof.site[live->site];
+    site->frees++;
+    site->live--;
+    site->live_bytes -= live->size;
+    site->lifetime_ms += now_ms - live->t_ms;
+    prof_live_remove(i);
+}
+
+static void prof_alloc(void *ptr, size_t size, void *caller)
+{
+    if (!s_prof.enabled || !ptr || __atomic_sub_fetch(&s_prof.countdown, 1, __ATOMIC_RELAXED) != 0) {
+        return;
+    }
+    uint32_t now_ms = esp_timer_get_time() / 1000;
+    portENTER_CRITICAL_SAFE(&s_lock);
+    s_prof.countdown = prof_next_countdown();
+    s_prof.sampled++;
+    uint32_t i = prof_live_find(ptr);
+    if (s_prof.live[i].ptr) {
+        // freed behind our back, e.g. with heap_caps_free()
+        prof_release(i, now_ms);
+        i = prof_live_find(ptr);
+    }
+    uint16_t site = (s_prof.live_count < MAX_LIVE - 1) ? prof_site_get((uintptr_t) caller) : NO_SITE;
+    if (site == NO_SITE) {
+        s_prof.dropped++;
+        portEXIT_CRITICAL_SAFE(&s_lock);
+        return;
+    }
+    prof_site_t *s = &s_prof.site[site];
+    s->allocs++;
+    s->bytes += size;
+    s->live++;
+    s->live_bytes += size;
+    if (size > s->max_size) {
+        s->max_size = size;
+    }
+    s_prof.live[i] = (prof_live_t) {
+        .ptr = ptr,
+        .size = size,
+        .t_ms = now_ms,
+        .site = site,
+    };
+    s_prof.live_count++;
+    portEXIT_CRITICAL_SAFE(&s_lock);
+}
+
+static void prof_free(void *ptr)
+{
+    if (!s_prof.enabled || !ptr) {
+        return;
+    }
+    portENTER_CRITICAL_SAFE(&s_lock);
+    uint32_t i = prof_live_find(ptr);
+    if (s_prof.live[i].ptr) {
+        prof_release(i, esp_timer_get_time() / 1000);
+    }
+    portEXIT_CRITICAL_SAFE(&s_lock);
+}
+
+void *__wrap_malloc(size_t size)
+{
+    void *ptr = __real_malloc(size);
+    prof_alloc(ptr, size, __builtin_return_address(0));
+    return ptr;
+}
+
+void *__wrap_calloc(size_t n, size_t size)
+{
+    void *ptr = __real_calloc(n, size);
+    prof_alloc(ptr, n * size, __builtin_return_address(0));
+    return ptr;
+}
+
+void *__wrap_realloc(void *ptr, size_t size)
+{
+    void *new_ptr = __real_realloc(ptr, size);
+    // a failed realloc leaves the old block as it is
+    if (new_ptr || !size) {
+        prof_free(ptr);
+    }
+    prof_alloc(new_ptr, size, __builtin_return_address(0));
+    return new_ptr;
+}
+
+void __wrap_free(void *ptr)
+{
+    // before the block can be handed out (and sampled) again
+    prof_free(ptr);
+    __real_free(ptr);
+}
+
+char *__wrap_strdup(const char *s)
+{
+    char *ptr = __real_strdup(s);
+    prof_alloc(ptr, ptr ? strlen(ptr) + 1 : 0, __builtin_return_address(0));
+    return ptr;
+}
+
+char *__wrap_strndup(const char *s, size_t n)
+{
+    char *ptr = __real_strndup(s, n);
+    prof_alloc(ptr, ptr ? strlen(ptr) + 1 : 0, __builtin_return_address(0));
+    return ptr;
+}
+
+size_t esp_diag_heap_profiler_top(esp_diag_heap_site_t *sites, size_t max)
+{
+    if (!sites || !max) {
+        return 0;
+    }
+    size_t count = 0;
+    portENTER_CRITICAL_SAFE(&s_lock);
+    for (uint32_t i = 0; i < MAX_SITES; i++) {
+        const prof_site_t *s = &s_prof.site[i];
+        if (!s->pc) {
+            continue;
+        }
+        // insertion into the list of the max sites with the most bytes so far
+        size_t j = (count < max) ? count++ : max;
+        for (; j > 0 && sites[j - 1].bytes < s->bytes * SAMPLE_PERIOD; j--) {
+            if (j < max) {
+                sites[j] = sites[j - 1];
+            }
+        }
+        if (j == max) {
+            continue;
+        }
+        sites[j] = (esp_diag_heap_site_t) {
+            .pc = s->pc,
+            .allocs = s->allocs * SAMPLE_PERIOD,
+            .bytes = s->bytes * SAMPLE_PERIOD,
+            .live = s->live * SAMPLE_PERIOD,
+            .live_bytes = s->live_bytes * SAMPLE_PERIOD,
+            .max_size = s->max_size,
+            .avg_lifetime_ms = s->frees ? s->lifetime_ms / s->frees : 0,
+        };
+    }
+    portEXIT_CRITICAL_SAFE(&s_lock);
+    return count;
+}
+
+void esp_diag_heap_profiler_reset(void)
+{
+    portENTER_CRITICAL_SAFE(&s_lock);
+    memset(s_prof.site, 0, sizeof(s_prof.site));
+    memset(s_prof.live, 0, sizeof(s_prof.live));
+    s_prof.site_count = 0;
+    s_prof.live_count = 0;
+    s_prof.sampled = 0;
+    s_prof.dropped = 0;
+    portEXIT_CRITICAL_SAFE(&s_lock);
+}
+
+/* Fragmentation of the internal heap: the share of free memory outside the largest free block */
+static uint32_t heap_frag_percent(void)
+{
+    size_t free = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+    size_t lfb = heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL);
+    return free ? 100 - (uint64_t) lfb * 100 / free : 0;
+}
+
+esp_err_t esp_diag_heap_profiler_dump(void)
+{
+    if (!s_prof.enabled) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    esp_diag_heap_site_t top[REPORT_TOP_N];
+    size_t count = esp_diag_heap_profiler_top(top, REPORT_TOP_N);
+    uint32_t frag = heap_frag_percent();
+
+    ESP_LOGI(LOG_TAG, "sampled:%" PRIu32 " dropped:%" PRIu32 " sites:%u frag:%" PRIu32 "%%",
+             s_prof.sampled, s_prof.dropped, s_prof.site_count, frag);
+    ESP_DIAG_EVENT(EVENT_TAG, "hotspots sampled:%" PRIu32 " dropped:%" PRIu32 " frag:%" PRIu32,
+                   s_prof.sampled, s_prof.dropped, frag);
+    for (size_t i = 0; i < count; i++) {
+        ESP_LOGI(LOG_TAG, "#%u pc:0x%08" PRIxPTR " allocs:%" PRIu32 " bytes:%" PRIu32 " live_bytes:%" PRIu32
+                 " life_ms:%" PRIu32, (unsigned) i + 1, top[i].pc, top[i].allocs, top[i].bytes,
+                 top[i].live_bytes, top[i].avg_lifetime_ms);
+        ESP_DIAG_EVENT(EVENT_TAG, "hotspot pc:0x%08" PRIxPTR " allocs:%" PRIu32 " bytes:%" PRIu32
+                       " live_bytes:%" PRIu32 " life_ms:%" PRIu32, top[i].pc, top[i].allocs, top[i].bytes,
+                       top[i].live_bytes, top[i].avg_lifetime_ms);
+    }
+    return ESP_OK;
+}
+
+static void heap_prof_dump_cb(void *arg)
+{
+    esp_diag_heap_profiler_dump();
+}
+
+esp_err_t esp_diag_heap_profiler_init(void)
+{
+    if (s_prof.enabled) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (esp_rmaker_work_queue_add_periodic(heap_prof_dump_cb, NULL, ESP_RMAKER_WORK_PRIO_BACKGROUND,
+                                           REPORT_INTERVAL * 1000, &s_prof.handle) != ESP_OK) {
+        ESP_LOGW(LOG_TAG, "Failed to create heap profiler timer");
+    }
+    s_prof.rand = (uint32_t) esp_timer_get_time() | 1;
+    s_prof.countdown = prof_next_countdown();
+    s_prof.enabled = true;
+    return ESP_OK;
+}
+
+esp_err_t esp_diag_heap_profiler_deinit(void)
+{
+    if (!s_prof.enabled) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (esp_rmaker_work_queue_timer_delete(s_prof.handle) != ESP_OK) {
+        ESP_LOGW(LOG_TAG, "Failed to delete heap profiler timer");
+    }
+    s_prof.handle = NULL;
+    s_prof.enabled = false;
+    esp_diag_heap_profiler_reset();
+    return ESP_OK;
+}
+
+static int heap_prof_cli_handler(int argc, char *argv[])
+{
+    if (!s_prof.enabled) {
+        printf("%s: Heap profiler not initialized\n", LOG_TAG);
+        return -1;
+    }
+    if (argc > 1) {
+        if (strcmp(argv[1], "reset") != 0) {
+            printf("%s: Invalid argument:%s:\n", LOG_TAG, argv[1]);
+            return -1;
+        }
+        esp_diag_heap_profiler_reset();
+        return 0;
+    }
+    esp_diag_heap_site_t top[16];
+    size_t count = esp_diag_heap_profiler_top(top, sizeof(top) / sizeof(top[0]));
+    printf("%s: sampled:%" PRIu32 " (1 in %d) dropped:%" PRIu32 " sites:%u frag:%" PRIu32 "%%\n", LOG_TAG,
+           s_prof.sampled, SAMPLE_PERIOD, s_prof.dropped, s_prof.site_count, heap_frag_percent());
+    printf("%10s %8s %10s %6s %10s %8s %10s\n", "pc", "allocs", "bytes", "live", "live_bytes", "max", "life_ms");
+    for (size_t i = 0; i < count; i++) {
+        printf("0x%08" PRIxPTR " %8" PRIu32 " %10" PRIu32 " %6" PRIu32 " %10" PRIu32 " %8" PRIu32 " %10" PRIu32 "\n",
+               top[i].pc, top[i].allocs, top[i].bytes, top[i].live, top[i].live_bytes, top[i].max_size,
+               top[i].avg_lifetime_ms);
+    }
+    printf("%s: Counts are estimates; resolve pc with addr2line -pfiaC -e build/<app>.elf\n", LOG_TAG);
+    return 0;
+}
+
+esp_err_t esp_diag_heap_profiler_register_cmd(void)
+{
+    const esp_console_cmd_t cmd = {
+        .command = "heap-prof",
+        .help = "Show the call sites which allocate the most. Usage: heap-prof [reset]",
+        .func = heap_prof_cli_handler,
+    };
+    return esp_console_cmd_register(&cmd);
+}
@@ -0,0 +1,81 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <inttypes.h>
+#include "esp_diagnostics_histogram.h"
+
+void diag_hist_merge(diag_hist_t *dst, const diag_hist_t *src)
+{
+    for (int i = 0; i < DIAG_HIST_BUCKETS; i++) {
+        uint32_t sum = dst->count[i] + src->count[i];
+        dst->count[i] = (sum < UINT16_MAX) ? sum : UINT16_MAX;
+    }
+}
+
+bool diag_hist_is_empty(const diag_hist_t *hist)
+{
+    for (int i = 0; i < DIAG_HIST_BUCKETS; i++) {
+        if (hist->count[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static size_t digits(uint32_t v)
+{
+    size_t n = 1;
+    while (v >= 10) {
+        v /= 10;
+        n++;
+    }
+    return n;
+}
+
+size_t diag_hist_encode(const diag_hist_t *hist, char *buf, size_t size)
+{
+    int first = 0, last = DIAG_HIST_BUCKETS - 1;
+    while (first <= last && !hist->count[first]) {
+        first++;
+    }
+    while (last >= first && !hist->count[last]) {
+        last--;
+    }
+    if (!size) {
+        return 0;
+    }
+    buf[0] = '\0';
+    if (first > last) {
+        return 0;
+    }
+    uint32_t tail = 0;
+    for (int i = first; i <= last; i++) {
+        tail += hist->count[i];
+    }
+    int len = snprintf(buf, size, "%d:", first);
+    if (len < 0 || (size_t) len >= size) {
+        buf[0] = '\0';
+        return 0;
+    }
+    size_t pos = len;
+    for (int i = first; i <= last; i++) {
+        size_t sep = (i > first) ? 1 : 0;
+        uint32_t rest = tail - hist->count[i];
+        // write this count only if the sum of the ones after it would still fit behind it
+        size_t need = sep + digits(hist->count[i]) + ((i < last) ? 1 + digits(rest) + 1 : 0);
+        if (pos + need >= size) {
+            if (pos + sep + digits(tail) + 1 >= size) {
+                break; // only if size is too small for even the first sum
+            }
+            pos += snprintf(buf + pos, size - pos, "%s%" PRIu32 "+", sep ? "," : "", tail);
+            break;
+        }
+        pos += snprintf(buf + pos, size - pos, "%s%u", sep ? "," : "", hist->count[i]);
+        tail = rest;
+    }
+    return pos;
+}
@@ -0,0 +1,68 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Streaming histogram with a fixed number of buckets. The caller maps values to buckets, usually
+ * with diag_hist_log2_bucket(), and ships the counts of a whole interval as one short string.
+ */
+
+#define DIAG_HIST_BUCKETS       20
+
+/* Fits a string metric value */
+#define DIAG_HIST_STR_LEN       32
+
+typedef struct {
+    uint16_t count[DIAG_HIST_BUCKETS];
+} diag_hist_t;
+
+/* Bucket 0 holds 0, bucket n holds [2^(n-1), 2^n), the last one everything above */
+static inline uint8_t diag_hist_log2_bucket(uint32_t value)
+{
+    uint8_t b = value ? 32 - __builtin_clz(value) : 0;
+    return (b < DIAG_HIST_BUCKETS) ? b : DIAG_HIST_BUCKETS - 1;
+}
+
+/* Bucket of value in steps of width from base downwards, e.g. dBm values below -30 in 5 dB steps */
+static inline uint8_t diag_hist_linear_bucket(int32_t value, int32_t base, int32_t width)
+{
+    int32_t b = (value >= base) ? 0 : (base - value) / width;
+    return (b < DIAG_HIST_BUCKETS) ? b : DIAG_HIST_BUCKETS - 1;
+}
+
+static inline void diag_hist_add(diag_hist_t *hist, uint8_t bucket)
+{
+    if (hist->count[bucket] != UINT16_MAX) {
+        hist->count[bucket]++;
+    }
+}
+
+/* Adds the counts of src to dst */
+void diag_hist_merge(diag_hist_t *dst, const diag_hist_t *src);
+
+bool diag_hist_is_empty(const diag_hist_t *hist);
+
+/**
+ * Encodes the buckets from the first to the last non-empty one as "<first>:<count>,<count>,...",
+ * e.g. "3:1,0,12,4" for 1 value in bucket 3, none in 4, 12 in 5 and 4 in 6. If the counts do not
+ * fit into size, the ones which do not fit are added up into the last one written, and the
+ * string ends with '+'.
+ *
+ * @return length of the string
+ */
+size_t diag_hist_encode(const diag_hist_t *hist, char *buf, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
@@ -8,6 +8,7 @@
 #include "string.h"
 #include "esp_log.h"
 #include "esp_diagnostics.h"
+#include "esp_diagnostics_event.h"
 #include "soc/soc_memory_layout.h"
 #include "esp_idf_version.h"
 #include <freertos/FreeRTOS.h>
@@ -357,6 +358,48 @@ esp_err_t esp_diag_log_event(const char *tag, const char *format, ...)
     return err;
 }
 
+#ifdef CONFIG_DIAG_LOG_MSG_ARG_FORMAT_TLV
+/**
+ * Same record as esp_diag_log_event(), but the argument types were resolved at compile time,
+ * so the TLV block is copied as-is and the format string is never parsed.
+ */
+esp_err_t esp_diag_log_event_typed(const char *tag, const char *format,
+                                   const esp_diag_event_arg_t *args, size_t n_args)
+{
+    esp_diag_log_data_t log;
+    uint8_t out_size = 0;
+    char *task_name = NULL;
+
+    if (!IS_LOG_TYPE_ENABLED(ESP_DIAG_LOG_TYPE_EVENT)) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    memset(&log, 0, sizeof(log));
+    log.type = ESP_DIAG_LOG_TYPE_EVENT;
+    log.pc = esp_cpu_process_stack_pc((uint32_t)__builtin_return_address(0));
+    log.timestamp = esp_diag_timestamp_get();
+    strlcpy(log.tag, tag, sizeof(log.tag));
+    log.msg_ptr = (void *)format;
+    for (size_t i = 0; i < n_args; i++) {
+        const void *value = &args[i].v;
+        uint8_t len = args[i].len;
+        if (args[i].type == ARG_TYPE_STR) {
+            value = args[i].v.str;
+            len = value ? strnlen(value, sizeof(log.msg_args)) : 0;
+        }
+        if (append_arg(log.msg_args, &out_size, sizeof(log.msg_args), args[i].type, len, (void *)value) != ESP_OK) {
+            break;
+        }
+    }
+    log.msg_args_len = out_size;
+    task_name = pcTaskGetName(NULL);
+    if (task_name) {
+        strlcpy(log.task_name, task_name, sizeof(log.task_name));
+    }
+    return write_data(&log, sizeof(log));
+}
+#endif /* CONFIG_DIAG_LOG_MSG_ARG_FORMAT_TLV */
+
 void esp_diag_log_hook_enable(uint32_t type)
 {
     s_priv_data.enabled_log_type |= type;
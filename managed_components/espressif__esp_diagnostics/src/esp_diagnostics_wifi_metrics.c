@@ -4,17 +4,19 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <stdio.h>
 #include <string.h>
 #include <esp_idf_version.h>
 #include <esp_log.h>
 #include <freertos/FreeRTOS.h>
-#include <freertos/timers.h>
 #include <esp_wifi.h>
 #include "sdkconfig.h"
 
 #include <esp_rmaker_work_queue.h>
+#include <esp_rmaker_common_events.h>
 #include <esp_diagnostics_metrics.h>
 #include "esp_diagnostics_internal.h"
+#include "esp_diagnostics_histogram.h"
 
 #define LOG_TAG            "wifi_metrics"
 #define METRICS_TAG        "wifi"
@@ -22,8 +24,13 @@
 #define KEY_RSSI           "rssi"
 #define KEY_MIN_RSSI       "min_rssi_ever"
 #define KEY_STATUS         "conn_status"
+#define KEY_RSSI_HIST      "rssi_hist"
+#define KEY_DISC_REASONS   "disc_reasons"
+#define KEY_RECONN_HIST    "reconn_hist"
+#define KEY_PUB_RTT_HIST   "pub_rtt_hist"
 
 #define PATH_WIFI_STATION  "Wi-Fi.Station"
+#define PATH_MQTT          "Wi-Fi.MQTT"
 
 /* Use configurable polling interval with default fallback */
 #ifdef CONFIG_DIAG_WIFI_POLLING_INTERVAL
@@ -35,17 +42,49 @@
 /* start reporting minimum ever rssi when rssi reaches -50 dbm */
 #define WIFI_RSSI_THRESHOLD      -50
 
+#if CONFIG_DIAG_WIFI_HISTOGRAMS
+/* RSSI buckets are 5 dB wide from -30 dBm down, which is a log scale of the signal power.
+ * Reconnect times and publish latencies go to log2 buckets of milliseconds.
+ */
+#define HIST_RSSI_BASE           -30
+#define HIST_RSSI_WIDTH          5
+/* Disconnect reasons are counted by reason code, the most frequent ones with a count each */
+#define DISC_REASONS_MAX         4
+
+typedef struct {
+    uint8_t reason;
+    uint16_t count;
+} disc_reason_count_t;
+
+typedef struct {
+    diag_hist_t rssi;
+    diag_hist_t reconnect;
+    diag_hist_t pub_rtt;
+    disc_reason_count_t reasons[DISC_REASONS_MAX];
+    uint16_t other_reasons;
+} wifi_hist_t;
+#endif /* CONFIG_DIAG_WIFI_HISTOGRAMS */
+
 typedef struct {
     bool init;
     bool wifi_connected;
     bool status_sent;
     uint32_t period;
-    TimerHandle_t handle;
+    esp_rmaker_work_timer_handle_t handle;
     int32_t prev_rssi;
     int32_t min_rssi;
+#if CONFIG_DIAG_WIFI_HISTOGRAMS
+    wifi_hist_t hist;
+    TickType_t disconnected_at;     /* 0 while connected, or before the first connection */
+    TickType_t hist_sent_at;
+#endif
 } wifi_diag_priv_data_t;
 
 static wifi_diag_priv_data_t s_priv_data;
+#if CONFIG_DIAG_WIFI_HISTOGRAMS
+/* Histograms are filled from the event task and reported from the work queue */
+static portMUX_TYPE s_hist_lock = portMUX_INITIALIZER_UNLOCKED;
+#endif
 
 static void update_min_rssi(int32_t rssi)
 {
@@ -61,6 +100,135 @@ static void update_min_rssi(int32_t rssi)
     }
 }
 
+#if CONFIG_DIAG_WIFI_HISTOGRAMS
+static void hist_add_rssi(int32_t rssi)
+{
+    portENTER_CRITICAL(&s_hist_lock);
+    diag_hist_add(&s_priv_data.hist.rssi, diag_hist_linear_bucket(rssi, HIST_RSSI_BASE, HIST_RSSI_WIDTH));
+    portEXIT_CRITICAL(&s_hist_lock);
+}
+
+static void hist_add_disconnect(uint8_t reason)
+{
+    TickType_t now = xTaskGetTickCount();
+    portENTER_CRITICAL(&s_hist_lock);
+    if (s_priv_data.wifi_connected) {
+        // ticks of 0 mean connected, so start one tick later in the rare case of a wrap to 0
+        s_priv_data.disconnected_at = now ? now : 1;
+    }
+    disc_reason_count_t *reasons = s_priv_data.hist.reasons;
+    int i;
+    for (i = 0; i < DISC_REASONS_MAX && reasons[i].count && reasons[i].reason != reason; i++) {
+    }
+    if (i == DISC_REASONS_MAX) {
+        s_priv_data.hist.other_reasons++;
+    } else {
+        reasons[i].reason = reason;
+        reasons[i].count++;
+        // keep the most frequent first
+        for (; i > 0 && reasons[i - 1].count < reasons[i].count; i--) {
+            disc_reason_count_t tmp = reasons[i - 1];
+            reasons[i - 1] = reasons[i];
+            reasons[i] = tmp;
+        }
+    }
+    portEXIT_CRITICAL(&s_hist_lock);
+}
+
+static void hist_add_connect(void)
+{
+    TickType_t now = xTaskGetTickCount();
+    portENTER_CRITICAL(&s_hist_lock);
+    if (s_priv_data.disconnected_at) {
+        uint32_t ms = pdTICKS_TO_MS(now - s_priv_data.disconnected_at);
+        diag_hist_add(&s_priv_data.hist.reconnect, diag_hist_log2_bucket(ms));
+        s_priv_data.disconnected_at = 0;
+    }
+    portEXIT_CRITICAL(&s_hist_lock);
+}
+
+static void mqtt_evt_handler(void *arg, esp_event_base_t evt_base, int32_t evt_id, void *evt_data)
+{
+    if (evt_id != RMAKER_MQTT_EVENT_PUBLISHED) {
+        return;
+    }
+    esp_rmaker_mqtt_published_t *data = evt_data;
+    if (data->latency_ms == ESP_RMAKER_MQTT_LATENCY_UNKNOWN) {
+        return;
+    }
+    portENTER_CRITICAL(&s_hist_lock);
+    diag_hist_add(&s_priv_data.hist.pub_rtt, diag_hist_log2_bucket(data->latency_ms));
+    portEXIT_CRITICAL(&s_hist_lock);
+}
+
+/* Encodes as "<reason>:<count>,...", with "*:<count>" for all the other reasons */
+static void disc_reasons_encode(const wifi_hist_t *hist, char *buf, size_t size)
+{
+    size_t pos = 0;
+    buf[0] = '\0';
+    for (int i = 0; i < DISC_REASONS_MAX && hist->reasons[i].count; i++) {
+        int n = snprintf(buf + pos, size - pos, "%s%u:%u", pos ? "," : "",
+                         hist->reasons[i].reason, hist->reasons[i].count);
+        if (n < 0 || pos + n >= size) {
+            buf[pos] = '\0';
+            return;
+        }
+        pos += n;
+    }
+    if (hist->other_reasons) {
+        int n = snprintf(buf + pos, size - pos, "%s*:%u", pos ? "," : "", hist->other_reasons);
+        if (n < 0 || pos + n >= size) {
+            buf[pos] = '\0';
+        }
+    }
+}
+
+static esp_err_t wifi_metrics_report_str(const char *key, const char *str)
+{
+#ifndef CONFIG_ESP_INSIGHTS_META_VERSION_10
+    return esp_diag_metrics_report_str(METRICS_TAG, key, str);
+#else
+    return esp_diag_metrics_add_str(key, str);
+#endif
+}
+
+/* Reports the histograms of the interval which ended as one string metric each */
+static void hist_report(void)
+{
+    wifi_hist_t hist;
+    portENTER_CRITICAL(&s_hist_lock);
+    hist = s_priv_data.hist;
+    memset(&s_priv_data.hist, 0, sizeof(s_priv_data.hist));
+    portEXIT_CRITICAL(&s_hist_lock);
+
+    char buf[DIAG_HIST_STR_LEN];
+    wifi_hist_t unsent = {0};
+    if (diag_hist_encode(&hist.rssi, buf, sizeof(buf)) && wifi_metrics_report_str(KEY_RSSI_HIST, buf) != ESP_OK) {
+        unsent.rssi = hist.rssi;
+    }
+    if (diag_hist_encode(&hist.reconnect, buf, sizeof(buf)) && wifi_metrics_report_str(KEY_RECONN_HIST, buf) != ESP_OK) {
+        unsent.reconnect = hist.reconnect;
+    }
+    if (diag_hist_encode(&hist.pub_rtt, buf, sizeof(buf)) && wifi_metrics_report_str(KEY_PUB_RTT_HIST, buf) != ESP_OK) {
+        unsent.pub_rtt = hist.pub_rtt;
+    }
+    disc_reasons_encode(&hist, buf, sizeof(buf));
+    if (buf[0] && wifi_metrics_report_str(KEY_DISC_REASONS, buf) != ESP_OK) {
+        ESP_LOGW(LOG_TAG, "Failed to add Wi-Fi metrics key:" KEY_DISC_REASONS);
+    }
+    if (diag_hist_is_empty(&unsent.rssi) && diag_hist_is_empty(&unsent.reconnect) && diag_hist_is_empty(&unsent.pub_rtt)) {
+        return;
+    }
+    // fold what could not be sent into the next interval
+    ESP_LOGW(LOG_TAG, "Failed to add Wi-Fi histograms, retrying with the next interval");
+    portENTER_CRITICAL(&s_hist_lock);
+    diag_hist_merge(&s_priv_data.hist.rssi, &unsent.rssi);
+    diag_hist_merge(&s_priv_data.hist.reconnect, &unsent.reconnect);
+    diag_hist_merge(&s_priv_data.hist.pub_rtt, &unsent.pub_rtt);
+    portEXIT_CRITICAL(&s_hist_lock);
+}
+#endif /* CONFIG_DIAG_WIFI_HISTOGRAMS */
+
 static void wifi_evt_handler(void *arg, esp_event_base_t evt_base, int32_t evt_id, void *evt_data)
 {
     switch (evt_id) {
@@ -68,10 +236,16 @@ static void wifi_evt_handler(void *arg, esp_event_base_t evt_base, int32_t evt_i
         {
             wifi_event_bss_rssi_low_t *data = evt_data;
             update_min_rssi(data->rssi);
+#if CONFIG_DIAG_WIFI_HISTOGRAMS
+            hist_add_rssi(data->rssi);
+#endif
         }
         break;
         case WIFI_EVENT_STA_CONNECTED:
         {
+#if CONFIG_DIAG_WIFI_HISTOGRAMS
+            hist_add_connect();
+#endif
             s_priv_data.wifi_connected = true;
             s_priv_data.status_sent = false;
 #ifndef CONFIG_ESP_INSIGHTS_META_VERSION_10
@@ -88,6 +262,10 @@ static void wifi_evt_handler(void *arg, esp_event_base_t evt_base, int32_t evt_i
         }
         case WIFI_EVENT_STA_DISCONNECTED:
         {
+#if CONFIG_DIAG_WIFI_HISTOGRAMS
+            wifi_event_sta_disconnected_t *data = evt_data;
+            hist_add_disconnect(data->reason);
+#endif
             if (s_priv_data.wifi_connected) {
                 s_priv_data.wifi_connected = false;
                 s_priv_data.status_sent = false;
@@ -140,7 +318,16 @@ esp_err_t esp_diag_wifi_metrics_dump(void)
 #endif
         s_priv_data.prev_rssi = rssi;
         ESP_LOGI(LOG_TAG, "%s:%" PRIi32 " %s:%" PRIi32, KEY_RSSI, rssi, KEY_MIN_RSSI, s_priv_data.min_rssi);
+#if CONFIG_DIAG_WIFI_HISTOGRAMS
+        hist_add_rssi(rssi);
+#endif
+    }
+#if CONFIG_DIAG_WIFI_HISTOGRAMS
+    if (xTaskGetTickCount() - s_priv_data.hist_sent_at >= SEC2TICKS(CONFIG_DIAG_WIFI_HIST_INTERVAL)) {
+        s_priv_data.hist_sent_at = xTaskGetTickCount();
+        hist_report();
     }
+#endif
     if (!s_priv_data.status_sent) {
         // if for some reason we were not able to add the status, try again
 #ifndef CONFIG_ESP_INSIGHTS_META_VERSION_10
@@ -161,11 +348,6 @@ static void wifi_metrics_dump_cb(void *arg)
     esp_diag_wifi_metrics_dump();
 }
 
-static void wifi_timer_cb(TimerHandle_t handle)
-{
-    esp_rmaker_work_queue_add_task(wifi_metrics_dump_cb, NULL);
-}
-
 esp_err_t esp_diag_wifi_metrics_init(void)
 {
     if (s_priv_data.init) {
@@ -176,6 +358,13 @@ esp_err_t esp_diag_wifi_metrics_init(void)
     if (err != ESP_OK) {
         return err;
     }
+#if CONFIG_DIAG_WIFI_HISTOGRAMS
+    err = esp_event_handler_register(RMAKER_COMMON_EVENT, RMAKER_MQTT_EVENT_PUBLISHED, mqtt_evt_handler, NULL);
+    if (err != ESP_OK) {
+        esp_event_handler_unregister(WIFI_EVENT, ESP_EVENT_ANY_ID, wifi_evt_handler);
+        return err;
+    }
+#endif
     err = esp_wifi_set_rssi_threshold(WIFI_RSSI_THRESHOLD);
     if (err != ESP_OK) {
         ESP_LOGW(LOG_TAG, "Failed to set rssi threshold value");
@@ -189,12 +378,18 @@ esp_err_t esp_diag_wifi_metrics_init(void)
 #else
     esp_diag_metrics_add_unit(KEY_RSSI, METRICS_UNIT);
     esp_diag_metrics_add_unit(KEY_MIN_RSSI, METRICS_UNIT);
+#endif
+#if CONFIG_DIAG_WIFI_HISTOGRAMS
+    esp_diag_metrics_register(METRICS_TAG, KEY_RSSI_HIST, "Wi-Fi RSSI histogram", PATH_WIFI_STATION, ESP_DIAG_DATA_TYPE_STR);
+    esp_diag_metrics_register(METRICS_TAG, KEY_DISC_REASONS, "Wi-Fi disconnect reasons", PATH_WIFI_STATION, ESP_DIAG_DATA_TYPE_STR);
+    esp_diag_metrics_register(METRICS_TAG, KEY_RECONN_HIST, "Wi-Fi reconnect time histogram", PATH_WIFI_STATION, ESP_DIAG_DATA_TYPE_STR);
+    esp_diag_metrics_register(METRICS_TAG, KEY_PUB_RTT_HIST, "MQTT publish latency histogram", PATH_MQTT, ESP_DIAG_DATA_TYPE_STR);
+    s_priv_data.hist_sent_at = xTaskGetTickCount();
 #endif
     s_priv_data.min_rssi = WIFI_RSSI_THRESHOLD;
-    s_priv_data.handle = xTimerCreate("wifi_metrics", SEC2TICKS(DEFAULT_POLLING_INTERVAL),
-                                      pdTRUE, NULL, wifi_timer_cb);
-    if (s_priv_data.handle) {
-        xTimerStart(s_priv_data.handle, 0);
+    if (esp_rmaker_work_queue_add_periodic(wifi_metrics_dump_cb, NULL, ESP_RMAKER_WORK_PRIO_BACKGROUND,
+                                           DEFAULT_POLLING_INTERVAL * 1000, &s_priv_data.handle) != ESP_OK) {
+        ESP_LOGW(LOG_TAG, "Failed to create wifi metric timer");
     }
     s_priv_data.init = true;
     /* Record RSSI at start */
@@ -208,18 +403,32 @@ esp_err_t esp_diag_wifi_metrics_deinit(void)
         return ESP_ERR_INVALID_STATE;
     }
     esp_event_handler_unregister(WIFI_EVENT, ESP_EVENT_ANY_ID, wifi_evt_handler);
-    /* Try to delete timer with 10 ticks wait time */
-    if (xTimerDelete(s_priv_data.handle, 10) == pdFALSE) {
+#if CONFIG_DIAG_WIFI_HISTOGRAMS
+    esp_event_handler_unregister(RMAKER_COMMON_EVENT, RMAKER_MQTT_EVENT_PUBLISHED, mqtt_evt_handler);
+#endif
+    if (esp_rmaker_work_queue_timer_delete(s_priv_data.handle) != ESP_OK) {
         ESP_LOGW(LOG_TAG, "Failed to delete heap metric timer");
     }
 #ifdef CONFIG_ESP_INSIGHTS_META_VERSION_10
     esp_diag_metrics_unregister(KEY_RSSI);
     esp_diag_metrics_unregister(KEY_MIN_RSSI);
     esp_diag_metrics_unregister(KEY_STATUS);
+#if CONFIG_DIAG_WIFI_HISTOGRAMS
+    esp_diag_metrics_unregister(KEY_RSSI_HIST);
+    esp_diag_metrics_unregister(KEY_DISC_REASONS);
+    esp_diag_metrics_unregister(KEY_RECONN_HIST);
+    esp_diag_metrics_unregister(KEY_PUB_RTT_HIST);
+#endif
 #else
     esp_diag_metrics_unregister(METRICS_TAG, KEY_RSSI);
     esp_diag_metrics_unregister(METRICS_TAG, KEY_MIN_RSSI);
     esp_diag_metrics_unregister(METRICS_TAG, KEY_STATUS);
+#if CONFIG_DIAG_WIFI_HISTOGRAMS
+    esp_diag_metrics_unregister(METRICS_TAG, KEY_RSSI_HIST);
+    esp_diag_metrics_unregister(METRICS_TAG, KEY_DISC_REASONS);
+    esp_diag_metrics_unregister(METRICS_TAG, KEY_RECONN_HIST);
+    esp_diag_metrics_unregister(METRICS_TAG, KEY_PUB_RTT_HIST);
+#endif
 #endif
     memset(&s_priv_data, 0, sizeof(s_priv_data));
     return ESP_OK;
@@ -231,8 +440,8 @@ void esp_diag_wifi_metrics_reset_interval(uint32_t period)
         return;
     }
     if (period == 0) {
-        xTimerStop(s_priv_data.handle, 0);
+        esp_rmaker_work_queue_timer_stop(s_priv_data.handle);
         return;
     }
-    xTimerChangePeriod(s_priv_data.handle, SEC2TICKS(period), 0);
+    esp_rmaker_work_queue_timer_change_period(s_priv_data.handle, period * 1000);
 }
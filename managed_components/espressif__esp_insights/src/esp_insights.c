@@ -12,6 +12,7 @@
 #include <esp_log.h>
 #include <esp_wifi.h>
 #include <esp_core_dump.h>
+#include <esp_timer.h>
 
 #include <nvs.h>
 #include <esp_crc.h>
@@ -30,6 +31,11 @@
 #include "esp_insights_client_data.h"
 #include "esp_insights_encoder.h"
 #include "esp_insights_cbor_decoder.h"
+#include "esp_insights_compress.h"
+#if CONFIG_DIAG_DATA_STORE_RTC
+#include <rtc_store_peek.h>
+#include <rtc_store_stats.h>
+#endif
 
 #ifdef CONFIG_ESP_INSIGHTS_CMD_RESP_ENABLED
 #define INSIGHTS_CMD_RESP 1
@@ -68,11 +74,32 @@
 
 #define INSIGHTS_READ_BUF_SIZE  (1024)  // read this much data from data store in one go
 
+#if CONFIG_DIAG_DATA_STORE_RTC
+/* Data is encoded straight out of RTC memory; read_buf is only needed while data comes from flash */
+#define INSIGHTS_ZERO_COPY          1
+/* Records which wrap around the end of the ring are put together here, larger than any record */
+#define INSIGHTS_STITCH_BUF_SIZE    (256)
+#endif
+
+#if CONFIG_ESP_INSIGHTS_COMPRESS
+#define INSIGHTS_COMPRESS   1
+/* Workspace first, so that it is aligned, then the compressed message */
+#define INSIGHTS_COMPRESS_BUF_SIZE  (ESP_INSIGHTS_COMPRESS_WORKSPACE_SIZE + INSIGHTS_DATA_MAX_SIZE)
+#endif
+
+#if CONFIG_ESP_INSIGHTS_ADAPTIVE_INTERVAL
+#define INSIGHTS_ADAPTIVE_INTERVAL  1
+#define INSIGHTS_TARGET_FILL_PERCENT    CONFIG_ESP_INSIGHTS_ADAPTIVE_TARGET_FILL_PERCENT
+#endif
+
 #define SEND_INSIGHTS_META (CONFIG_DIAG_ENABLE_METRICS || CONFIG_DIAG_ENABLE_VARIABLES)
 
 /* TAG for reporting generic miscellaneous insights. Different from ESP_LOGx tag */
 #define TAG_DIAG            "diag"
 #define KEY_LOG_WR_FAIL     "log_wr_fail"
+#define KEY_RPT_STATE       "rpt_state"
+#define KEY_RPT_INTERVAL    "rpt_interval"
+#define KEY_INGEST_RATE     "ingest_rate"
 
 #define DIAG_DATA_STORE_CRC_KEY "rtc_buf_sha"
 #define INSIGHTS_NVS_NAMESPACE  "storage"
@@ -85,7 +112,7 @@ static const char *TAG = "esp_insights"; /* tag for ESP_LOGx */
 
 typedef struct esp_insights_entry {
     esp_rmaker_work_fn_t work_fn;
-    TimerHandle_t timer;
+    esp_rmaker_work_timer_handle_t timer;
     uint32_t min_seconds;
     uint32_t max_seconds;
     uint32_t cur_seconds;
@@ -94,7 +121,11 @@ typedef struct esp_insights_entry {
 
 typedef struct {
     uint8_t *scratch_buf;
-    uint8_t *read_buf;      // buffer to hold data read from RTC buf
+    uint8_t *read_buf;      // buffer to hold data read from RTC buf, allocated on first use
+    bool alloc_ext_ram;     // allocate buffers in external RAM
+#if INSIGHTS_COMPRESS
+    uint8_t *compress_buf;  // compression workspace and output, allocated on first use
+#endif
     int data_msg_id;
     uint32_t data_msg_len;
     SemaphoreHandle_t data_lock;
@@ -122,20 +153,51 @@ typedef struct {
 } esp_insights_data_t;
 
 static esp_insights_data_t s_insights_data;
+
+#if INSIGHTS_ADAPTIVE_INTERVAL
+/* Rates are kept in 1/16 bytes per second, so that a trickle of data still counts */
+#define INSIGHTS_RATE_SHIFT     4
+/* A falling rate is followed with weight 1/4 per tick, a rising one right away */
+#define INSIGHTS_RATE_DECAY     2
+
+typedef enum {
+    INSIGHTS_CTL_IDLE = 0,      /* nothing recorded lately, posting at the max interval */
+    INSIGHTS_CTL_TRACKING,      /* interval follows the ingest rate */
+    INSIGHTS_CTL_SATURATED,     /* data comes in faster than the min interval can keep up with */
+    INSIGHTS_CTL_DRAINING,      /* backlog in the flash tier, posting at the min interval */
+} insights_ctl_state_t;
+
+typedef struct {
+    TickType_t last_tick;       /* tick of the last estimate */
+    uint32_t written[2];        /* write counters of the critical and non-critical store then */
+    uint32_t rate[2];           /* estimated ingest rates, << INSIGHTS_RATE_SHIFT */
+    insights_ctl_state_t state;
+    uint32_t seconds;           /* interval picked last */
+    uint32_t reported[3];       /* state, interval and rate as reported last */
+} insights_ctl_t;
+
+static insights_ctl_t s_insights_ctl;
+#endif /* INSIGHTS_ADAPTIVE_INTERVAL */
 static esp_insights_entry_t *s_periodic_insights_entry;
 
 extern esp_err_t esp_insights_cmd_resp_init(void);
 
+/* All Insights work is background work, so that encoding and sending never holds up param reports */
+static inline esp_err_t insights_work_add(esp_rmaker_work_fn_t work_fn, void *priv_data)
+{
+    return esp_rmaker_work_queue_add_task_with_prio(work_fn, priv_data, ESP_RMAKER_WORK_PRIO_BACKGROUND, 0);
+}
+
 static void esp_insights_first_call(void *priv_data)
 {
     if (!priv_data) {
         return;
     }
     esp_insights_entry_t *entry = (esp_insights_entry_t *)priv_data;
-    esp_rmaker_work_queue_add_task(entry->work_fn, entry->priv_data);
+    insights_work_add(entry->work_fn, entry->priv_data);
     /* Start timer here so that the function is called periodically */
     ESP_LOGI(TAG, "Scheduling Insights timer for %" PRIu32 " seconds.", entry->cur_seconds);
-    xTimerStart(entry->timer, 0);
+    esp_rmaker_work_queue_timer_change_period(entry->timer, entry->cur_seconds * 1000);
 }
 
 /* Returns true if wifi is connected and insights is enabled, false otherwise */
@@ -154,6 +216,104 @@ static bool is_wifi_connected(void)
     return wifi_connected;
 }
 
+#if INSIGHTS_ADAPTIVE_INTERVAL
+static bool insights_ctl_sample(rtc_store_stats_t stats[2])
+{
+    return rtc_store_critical_data_stats(&stats[0]) == ESP_OK &&
+           rtc_store_non_critical_data_stats(&stats[1]) == ESP_OK;
+}
+
+static void insights_ctl_init(void)
+{
+    rtc_store_stats_t stats[2];
+
+    memset(&s_insights_ctl, 0, sizeof(s_insights_ctl));
+    s_insights_ctl.last_tick = xTaskGetTickCount();
+    memset(s_insights_ctl.reported, 0xff, sizeof(s_insights_ctl.reported));
+    if (insights_ctl_sample(stats)) {
+        s_insights_ctl.written[0] = stats[0].written;
+        s_insights_ctl.written[1] = stats[1].written;
+    }
+}
+
+/* Updates the ingest rate estimates and returns the number of seconds until the first store
+ * reaches its target fill. The targets together fit into one data message, so that every post
+ * goes out close to INSIGHTS_DATA_MAX_SIZE. `sending` tells that a post was just queued, which
+ * takes up to a target's worth of data out of each store.
+ */
+static uint32_t insights_ctl_next_seconds(esp_insights_entry_t *entry, bool sending)
+{
+    insights_ctl_t *ctl = &s_insights_ctl;
+    rtc_store_stats_t stats[2];
+    uint32_t seconds = entry->max_seconds;
+    bool backlog = false;
+    uint32_t rate = 0;
+
+    if (!insights_ctl_sample(stats)) {
+        return entry->max_seconds;
+    }
+    TickType_t now = xTaskGetTickCount();
+    uint32_t elapsed_ms = pdTICKS_TO_MS(now - ctl->last_tick);
+    ctl->last_tick = now;
+
+    size_t target[2];
+    size_t target_sum = 0;
+    for (int i = 0; i < 2; i++) {
+        target[i] = stats[i].size * INSIGHTS_TARGET_FILL_PERCENT / 100;
+        target_sum += target[i];
+    }
+    for (int i = 0; i < 2; i++) {
+        if (target_sum > INSIGHTS_DATA_MAX_SIZE) {
+            target[i] = (uint64_t) target[i] * INSIGHTS_DATA_MAX_SIZE / target_sum;
+        }
+        uint32_t bytes = stats[i].written - ctl->written[i];
+        ctl->written[i] = stats[i].written;
+        if (elapsed_ms) {
+            uint32_t inst = ((uint64_t) bytes * 1000 << INSIGHTS_RATE_SHIFT) / elapsed_ms;
+            if (inst >= ctl->rate[i]) {
+                ctl->rate[i] = inst;
+            } else {
+                // rounded up, so that the rate gets down to inst, and to 0 once nothing is written
+                ctl->rate[i] -= ((ctl->rate[i] - inst - 1) >> INSIGHTS_RATE_DECAY) + 1;
+            }
+        }
+        rate += ctl->rate[i];
+        backlog |= stats[i].flash_pending > 0;
+        if (!ctl->rate[i]) {
+            continue;
+        }
+        size_t filled = stats[i].filled;
+        if (sending) {
+            filled = (filled > target[i]) ? filled - target[i] : 0;
+        }
+        size_t room = (filled < target[i]) ? target[i] - filled : 0;
+        uint64_t fill_seconds = ((uint64_t) room << INSIGHTS_RATE_SHIFT) / ctl->rate[i];
+        if (fill_seconds < seconds) {
+            seconds = fill_seconds;
+        }
+    }
+
+    if (backlog) {
+        ctl->state = INSIGHTS_CTL_DRAINING;
+        seconds = entry->min_seconds;
+    } else if (!rate) {
+        ctl->state = INSIGHTS_CTL_IDLE;
+    } else if (seconds < entry->min_seconds) {
+        /* the stores' watermark events trigger posts in between */
+        ctl->state = INSIGHTS_CTL_SATURATED;
+        seconds = entry->min_seconds;
+    } else {
+        ctl->state = INSIGHTS_CTL_TRACKING;
+    }
+    ctl->seconds = seconds;
+#if INSIGHTS_DEBUG_ENABLED
+    ESP_LOGI(TAG, "ingest %" PRIu32 "/%" PRIu32 " B/s, state %d, next post in %" PRIu32 " sec",
+             ctl->rate[0] >> INSIGHTS_RATE_SHIFT, ctl->rate[1] >> INSIGHTS_RATE_SHIFT, ctl->state, seconds);
+#endif
+    return seconds;
+}
+#endif /* INSIGHTS_ADAPTIVE_INTERVAL */
+
 /* This executes in the context of timer task.
  *
  * There is a dynamic logic to decide the next instance when the insights
@@ -164,10 +324,13 @@ static bool is_wifi_connected(void)
  * into too frquent publishes.
  * The period will keep changing between CLOUD_REPORTING_PERIOD_MIN_SEC and
  * CLOUD_REPORTING_PERIOD_MAX_SEC
+ *
+ * With INSIGHTS_ADAPTIVE_INTERVAL, the period is derived from the rate at which the data stores
+ * fill up instead, see insights_ctl_next_seconds().
  */
-static void esp_insights_common_cb(TimerHandle_t handle)
+static void esp_insights_common_cb(void *priv_data)
 {
-    esp_insights_entry_t *entry = (esp_insights_entry_t *)pvTimerGetTimerID(handle);
+    esp_insights_entry_t *entry = (esp_insights_entry_t *)priv_data;
     /* Check if any data was sent during the previous time out */
     xSemaphoreTake(s_insights_data.data_lock, portMAX_DELAY);
     bool l_data_sent = s_insights_data.data_sent;
@@ -175,9 +338,15 @@ static void esp_insights_common_cb(TimerHandle_t handle)
     xSemaphoreGive(s_insights_data.data_lock);
 
     if (entry) {
-        if (is_insights_active() == true) {
-            esp_rmaker_work_queue_add_task(entry->work_fn, entry->priv_data);
+        bool active = is_insights_active();
+        if (active) {
+            /* Already on the background lane of the work queue */
+            entry->work_fn(entry->priv_data);
         }
+#if INSIGHTS_ADAPTIVE_INTERVAL
+        (void) l_data_sent;
+        entry->cur_seconds = insights_ctl_next_seconds(entry, active);
+#else
         /* If data was sent during previous timer interval, double the period */
         if (l_data_sent) {
             entry->cur_seconds <<= 1; /* Double the period */
@@ -191,8 +360,8 @@ static void esp_insights_common_cb(TimerHandle_t handle)
                 entry->cur_seconds = entry->min_seconds;
             }
         }
-        xTimerChangePeriod(handle, (entry->cur_seconds * 1000)/ portTICK_PERIOD_MS, 100);
-        xTimerStart(handle, 0);
+#endif /* INSIGHTS_ADAPTIVE_INTERVAL */
+        esp_rmaker_work_queue_timer_change_period(entry->timer, entry->cur_seconds * 1000);
     }
 }
 
@@ -200,12 +369,8 @@ static esp_err_t esp_insights_unregister_periodic_handler(void)
 {
     if (s_periodic_insights_entry) {
         if (s_periodic_insights_entry->timer) {
-            ESP_LOGI(TAG, "Stopping the periodic timer");
-            if (xTimerIsTimerActive(s_periodic_insights_entry->timer) == pdTRUE) {
-                xTimerStop(s_periodic_insights_entry->timer, portMAX_DELAY);
-             }
             ESP_LOGI(TAG, "Deleting the periodic timer");
-            xTimerDelete(s_periodic_insights_entry->timer, portMAX_DELAY);
+            esp_rmaker_work_queue_timer_delete(s_periodic_insights_entry->timer);
             s_periodic_insights_entry->timer = NULL;
         }
 
@@ -240,18 +405,26 @@ static esp_err_t esp_insights_register_periodic_handler(esp_rmaker_work_fn_t wor
     s_periodic_insights_entry->min_seconds = min_seconds;
     s_periodic_insights_entry->max_seconds = max_seconds;
     s_periodic_insights_entry->cur_seconds = min_seconds;
-    s_periodic_insights_entry->timer = xTimerCreate("test", (s_periodic_insights_entry->cur_seconds * 1000)/ portTICK_PERIOD_MS,
-                                                    pdFALSE, (void *)s_periodic_insights_entry, esp_insights_common_cb);
-    if (!s_periodic_insights_entry->timer) {
+#if INSIGHTS_ADAPTIVE_INTERVAL
+    insights_ctl_init();
+#endif
+    esp_err_t ret = esp_rmaker_work_queue_add_periodic(esp_insights_common_cb, s_periodic_insights_entry,
+                                                       ESP_RMAKER_WORK_PRIO_BACKGROUND,
+                                                       s_periodic_insights_entry->cur_seconds * 1000,
+                                                       &s_periodic_insights_entry->timer);
+    if (ret != ESP_OK) {
         ESP_LOGI(TAG, "timer creation failed, line %d", __LINE__);
         free(s_periodic_insights_entry);
+        s_periodic_insights_entry = NULL;
         return ESP_FAIL;
     }
+    /* Held until esp_insights_first_call() */
+    esp_rmaker_work_queue_timer_stop(s_periodic_insights_entry->timer);
     /* Rainmaker work queue execution start after MQTT connection is established,
      * esp_insights_first_call() will be executed after MQTT connection is established.
      * It add the work_fn to the queue and start the periodic timer.
      */
-    esp_err_t ret = esp_rmaker_work_queue_add_task(esp_insights_first_call, s_periodic_insights_entry);
+    ret = insights_work_add(esp_insights_first_call, s_periodic_insights_entry);
     if (ret != ESP_OK) {
         ESP_LOGI(TAG, "failed to enqueue insights_first_call, line %d", __LINE__);
     }
@@ -371,6 +544,47 @@ static void insights_dbg_dump(uint8_t *data, uint32_t len)
 }
 #endif /* INSIGHTS_DEBUG_ENABLED */
 
+#if INSIGHTS_COMPRESS
+/* Compresses the message in scratch_buf, returns what to send: the compressed message, or
+ * scratch_buf if it does not get smaller
+ */
+static uint8_t *insights_compress(uint16_t *len)
+{
+    if (!s_insights_data.compress_buf) {
+        s_insights_data.compress_buf = s_insights_data.alloc_ext_ram ? MEM_ALLOC_EXTRAM(INSIGHTS_COMPRESS_BUF_SIZE) :
+                                       malloc(INSIGHTS_COMPRESS_BUF_SIZE);
+        if (!s_insights_data.compress_buf) {
+            ESP_LOGE(TAG, "Failed to allocate memory for compress_buf");
+            return s_insights_data.scratch_buf;
+        }
+    }
+    uint8_t *out = s_insights_data.compress_buf + ESP_INSIGHTS_COMPRESS_WORKSPACE_SIZE;
+#if INSIGHTS_DEBUG_ENABLED
+    int64_t start = esp_timer_get_time();
+#endif
+    size_t n = esp_insights_compress_msg(s_insights_data.scratch_buf, *len, out, INSIGHTS_DATA_MAX_SIZE,
+                                         s_insights_data.compress_buf);
+#if INSIGHTS_DEBUG_ENABLED
+    ESP_LOGI(TAG, "Compressed %d bytes to %d in %" PRId64 " us", *len, (int) n, esp_timer_get_time() - start);
+#endif
+    if (!n) {
+        return s_insights_data.scratch_buf;
+    }
+    *len = n;
+    return out;
+}
+#endif /* INSIGHTS_COMPRESS */
+
+/* Hands the encoded message in scratch_buf over to the transport */
+static int insights_msg_send(uint16_t len)
+{
+    uint8_t *msg = s_insights_data.scratch_buf;
+#if INSIGHTS_COMPRESS
+    msg = insights_compress(&len);
+#endif
+    return esp_insights_transport_data_send(msg, len);
+}
+
 static void send_boottime_data(void)
 {
     uint16_t len = 0;
@@ -385,7 +599,7 @@ static void send_boottime_data(void)
     ESP_LOGI(TAG, "Sending boottime data of length: %d", len);
     insights_dbg_dump(s_insights_data.scratch_buf, len);
 #endif
-    int msg_id = esp_insights_transport_data_send(s_insights_data.scratch_buf, len);
+    int msg_id = insights_msg_send(len);
     s_insights_data.boot_msg_id = msg_id;
     if (msg_id > 0) {
         return;
@@ -440,7 +654,7 @@ static void send_insights_meta(void)
     ESP_LOGI(TAG, "Insights meta data length %d", len);
     insights_dbg_dump(s_insights_data.scratch_buf, len);
 #endif
-    int msg_id = esp_insights_transport_data_send(s_insights_data.scratch_buf, len);
+    int msg_id = insights_msg_send(len);
     if (msg_id > 0) {
         xSemaphoreTake(s_insights_data.data_lock, portMAX_DELAY);
         s_insights_data.meta_msg_pending = true;
@@ -473,7 +687,7 @@ static void send_insights_conf_meta(void)
     ESP_LOGI(TAG, "Insights conf meta data length %d", len);
     insights_dbg_dump(s_insights_data.scratch_buf, len);
 #endif
-    int msg_id = esp_insights_transport_data_send(s_insights_data.scratch_buf, len);
+    int msg_id = insights_msg_send(len);
     if (msg_id > 0) {
         xSemaphoreTake(s_insights_data.data_lock, portMAX_DELAY);
         s_insights_data.conf_meta_msg_pending = true;
@@ -494,12 +708,123 @@ static void send_insights_conf_meta(void)
  * In short, there is the possibility of data duplication, so cloud should be able to handle it.
  */
 
+#if CONFIG_DIAG_ENABLE_VARIABLES && INSIGHTS_ADAPTIVE_INTERVAL
+static void insights_report_uint(const char *key, uint32_t *reported, uint32_t val)
+{
+    if (*reported == val) {
+        return;
+    }
+    *reported = val;
+#ifdef CONFIG_ESP_INSIGHTS_META_VERSION_10
+    esp_diag_variable_add_uint(key, val);
+#else
+    esp_diag_variable_report_uint(TAG_DIAG, key, val);
+#endif
+}
+
+/* Reports the controller's state along with the data, whenever it changed */
+static void insights_ctl_report(void)
+{
+    insights_ctl_t *ctl = &s_insights_ctl;
+
+    insights_report_uint(KEY_RPT_STATE, &ctl->reported[0], ctl->state);
+    insights_report_uint(KEY_RPT_INTERVAL, &ctl->reported[1], ctl->seconds);
+    insights_report_uint(KEY_INGEST_RATE, &ctl->reported[2], (ctl->rate[0] + ctl->rate[1]) >> INSIGHTS_RATE_SHIFT);
+}
+#endif /* CONFIG_DIAG_ENABLE_VARIABLES && INSIGHTS_ADAPTIVE_INTERVAL */
+
+typedef size_t (*insights_encode_fn_t)(const void *data, size_t data_size);
+
+static uint8_t *insights_read_buf_get(void)
+{
+    if (!s_insights_data.read_buf) {
+        s_insights_data.read_buf = s_insights_data.alloc_ext_ram ? MEM_ALLOC_EXTRAM(INSIGHTS_READ_BUF_SIZE) :
+                                   malloc(INSIGHTS_READ_BUF_SIZE);
+        if (!s_insights_data.read_buf) {
+            ESP_LOGE(TAG, "Failed to allocate memory for read_buf");
+        }
+    }
+    return s_insights_data.read_buf;
+}
+
+#if INSIGHTS_ZERO_COPY
+/* Encodes the peeked spans, returns the bytes consumed. The encoder only takes whole records, so a
+ * record split by the end of the ring is copied together into the stitch buffer.
+ */
+static size_t insights_encode_spans(insights_encode_fn_t encode, const rtc_store_span_t spans[2])
+{
+    static uint8_t stitch[INSIGHTS_STITCH_BUF_SIZE];
+    size_t consumed = spans[0].len ? encode(spans[0].data, spans[0].len) : 0;
+    size_t left = spans[0].len - consumed;
+
+    if (!spans[1].len || left >= sizeof(stitch)) {
+        return consumed;
+    }
+    size_t n = sizeof(stitch) - left;
+    if (n > spans[1].len) {
+        n = spans[1].len;
+    }
+    memcpy(stitch, spans[0].data + consumed, left);
+    memcpy(stitch + left, spans[1].data, n);
+    size_t stitched = encode(stitch, left + n);
+    consumed += stitched;
+    if (stitched <= left) {
+        return consumed; // out of space, or the record did not fit
+    }
+    size_t off = stitched - left;
+    if (off < spans[1].len) {
+        consumed += encode(spans[1].data + off, spans[1].len - off);
+    }
+    return consumed;
+}
+#endif /* INSIGHTS_ZERO_COPY */
+
+/* Encodes data from the head of the critical or non-critical store, returns the bytes consumed.
+ * Non-critical data is released right away, critical data once the cloud has acknowledged it.
+ */
+static size_t insights_encode_store(bool critical)
+{
+    insights_encode_fn_t encode = critical ? esp_insights_encode_critical_data : esp_insights_encode_non_critical_data;
+    size_t consumed = 0;
+
+#if INSIGHTS_ZERO_COPY
+    rtc_store_span_t spans[2];
+    /* No copy to size for, the encoder takes as much as still fits into the message */
+    esp_err_t err = critical ? rtc_store_critical_data_peek(spans, INSIGHTS_DATA_MAX_SIZE) :
+                    rtc_store_non_critical_data_peek(spans, INSIGHTS_DATA_MAX_SIZE);
+    if (err == ESP_OK) {
+        consumed = insights_encode_spans(encode, spans);
+        if (critical) {
+            rtc_store_critical_data_commit(0);
+        } else {
+            rtc_store_non_critical_data_commit(consumed);
+        }
+        return consumed;
+    }
+    if (err != ESP_ERR_NOT_SUPPORTED) {
+        return 0;
+    }
+    // backlog in the flash tier, it has to be copied out
+#endif /* INSIGHTS_ZERO_COPY */
+    uint8_t *buf = insights_read_buf_get();
+    if (!buf) {
+        return 0;
+    }
+    int size = critical ? esp_diag_data_store_critical_read(buf, INSIGHTS_READ_BUF_SIZE) :
+               esp_diag_data_store_non_critical_read(buf, INSIGHTS_READ_BUF_SIZE);
+    if (size > 0) {
+        consumed = encode(buf, size);
+        if (!critical) {
+            esp_diag_data_store_non_critical_release(consumed);
+        }
+    }
+    return consumed;
+}
+
 /* This encodes and sends insights data */
 static void send_insights_data(void)
 {
     uint16_t len = 0;
-    size_t critical_data_size = 0;
-    size_t non_critical_data_size = 0;
     size_t critical_consumed = 0;
     size_t non_critical_consumed = 0;
 
@@ -515,20 +840,15 @@ static void send_insights_data(void)
         esp_diag_variable_report_uint(TAG_DIAG, KEY_LOG_WR_FAIL, prev_log_write_fail_cnt);
 #endif
     }
+#if INSIGHTS_ADAPTIVE_INTERVAL
+    insights_ctl_report();
+#endif
 #endif /* CONFIG_DIAG_ENABLE_VARIABLES */
 
     esp_insights_encode_data_begin(s_insights_data.scratch_buf, INSIGHTS_DATA_MAX_SIZE);
 
-    critical_data_size = esp_diag_data_store_critical_read(s_insights_data.read_buf, INSIGHTS_READ_BUF_SIZE);
-    if (critical_data_size > 0) {
-        critical_consumed = esp_insights_encode_critical_data(s_insights_data.read_buf, critical_data_size);
-    }
-
-    non_critical_data_size = esp_diag_data_store_non_critical_read(s_insights_data.read_buf, INSIGHTS_READ_BUF_SIZE);
-    if (non_critical_data_size > 0) {
-        non_critical_consumed = esp_insights_encode_non_critical_data(s_insights_data.read_buf, non_critical_data_size);
-        esp_diag_data_store_non_critical_release(non_critical_consumed);
-    }
+    critical_consumed = insights_encode_store(true);
+    non_critical_consumed = insights_encode_store(false);
     len = esp_insights_encode_data_end(s_insights_data.scratch_buf);
     if (!critical_consumed && !non_critical_consumed) {
         len = 0; // just ignore the encoded data
@@ -544,7 +864,7 @@ static void send_insights_data(void)
     ESP_LOGI(TAG, "Sending data of length: %d", len);
     insights_dbg_dump(s_insights_data.scratch_buf, len);
 #endif
-    int msg_id = esp_insights_transport_data_send(s_insights_data.scratch_buf, len);
+    int msg_id = insights_msg_send(len);
     if (msg_id > 0) {
         xSemaphoreTake(s_insights_data.data_lock, portMAX_DELAY);
         s_insights_data.data_msg_len = critical_consumed;
@@ -620,7 +940,7 @@ esp_err_t esp_insights_send_data(void)
 {
     if (is_wifi_connected() == true) {
         ESP_LOGI(TAG, "Sending data to cloud");
-        return esp_rmaker_work_queue_add_task(insights_periodic_handler, NULL);
+        return insights_work_add(insights_periodic_handler, NULL);
     }
     ESP_LOGW(TAG, "Wi-Fi not in connected state");
     return ESP_FAIL;
@@ -633,7 +953,7 @@ void esp_insights_report_config_update(void)
     if (is_wifi_connected() == true) {
         /* if wifi is connected, immediately send the report */
         /* if not, this will be reported from periodic handler */
-        esp_rmaker_work_queue_add_task(__insights_report_config_update, NULL);
+        insights_work_add(__insights_report_config_update, NULL);
     }
 }
 #else
@@ -658,7 +978,7 @@ static void data_store_event_handler(void* arg, esp_event_base_t event_base,
                     event_id == ESP_DIAG_DATA_STORE_EVENT_CRITICAL_DATA_LOW_MEM ? "" : "NON_");
 #endif
             if (is_insights_active() == true) {
-                esp_rmaker_work_queue_add_task(insights_periodic_handler, NULL);
+                insights_work_add(insights_periodic_handler, NULL);
             }
             break;
         }
@@ -718,6 +1038,12 @@ static void metrics_init(void)
         if (ret != ESP_OK) {
             ESP_LOGW(TAG, "Failed to initialize heap metrics");
         }
+#if CONFIG_DIAG_ENABLE_HEAP_PROFILER
+        ret = esp_diag_heap_profiler_init();
+        if (ret != ESP_OK) {
+            ESP_LOGW(TAG, "Failed to initialize heap profiler");
+        }
+#endif /* CONFIG_DIAG_ENABLE_HEAP_PROFILER */
 #endif /* CONFIG_DIAG_ENABLE_HEAP_METRICS */
 #if CONFIG_DIAG_ENABLE_WIFI_METRICS
         ret = esp_diag_wifi_metrics_init();
@@ -725,6 +1051,12 @@ static void metrics_init(void)
             ESP_LOGW(TAG, "Failed to initialize wifi metrics");
         }
 #endif /* CONFIG_DIAG_ENABLE_WIFI_METRICS */
+#if CONFIG_DIAG_ENABLE_CPU_METRICS
+        ret = esp_diag_cpu_metrics_init();
+        if (ret != ESP_OK) {
+            ESP_LOGW(TAG, "Failed to initialize cpu metrics");
+        }
+#endif /* CONFIG_DIAG_ENABLE_CPU_METRICS */
         return;
     }
     ESP_LOGE(TAG, "Failed to initialize metrics.");
@@ -734,9 +1066,15 @@ static void metrics_deinit(void)
 {
 #if CONFIG_DIAG_ENABLE_HEAP_METRICS
     esp_diag_heap_metrics_deinit();
+#if CONFIG_DIAG_ENABLE_HEAP_PROFILER
+    esp_diag_heap_profiler_deinit();
+#endif
 #endif
 #if CONFIG_DIAG_ENABLE_WIFI_METRICS
     esp_diag_wifi_metrics_deinit();
+#endif
+#if CONFIG_DIAG_ENABLE_CPU_METRICS
+    esp_diag_cpu_metrics_deinit();
 #endif
     esp_diag_metrics_deinit();
 }
@@ -764,6 +1102,11 @@ static void variables_init(void)
         }
 #endif /* CONFIG_DIAG_ENABLE_NETWORK_VARIABLES */
         esp_diag_variable_register(TAG_DIAG, KEY_LOG_WR_FAIL, "Log write fail count", "Diagnostics.Log", ESP_DIAG_DATA_TYPE_UINT);
+#if INSIGHTS_ADAPTIVE_INTERVAL
+        esp_diag_variable_register(TAG_DIAG, KEY_RPT_STATE, "Reporting state", "Diagnostics.Reporting", ESP_DIAG_DATA_TYPE_UINT);
+        esp_diag_variable_register(TAG_DIAG, KEY_RPT_INTERVAL, "Reporting interval (sec)", "Diagnostics.Reporting", ESP_DIAG_DATA_TYPE_UINT);
+        esp_diag_variable_register(TAG_DIAG, KEY_INGEST_RATE, "Data ingest rate (B/s)", "Diagnostics.Reporting", ESP_DIAG_DATA_TYPE_UINT);
+#endif
         return;
     }
     ESP_LOGE(TAG, "Failed to initialize param-values.");
@@ -790,6 +1133,16 @@ static void esp_insights_disable_internal(void *priv_data)
         free(s_insights_data.scratch_buf);
         s_insights_data.scratch_buf = NULL;
     }
+    if (s_insights_data.read_buf) {
+        free(s_insights_data.read_buf);
+        s_insights_data.read_buf = NULL;
+    }
+#if INSIGHTS_COMPRESS
+    if (s_insights_data.compress_buf) {
+        free(s_insights_data.compress_buf);
+        s_insights_data.compress_buf = NULL;
+    }
+#endif
     if (s_insights_data.data_send_timer) {
         xTimerDelete(s_insights_data.data_send_timer, portMAX_DELAY);
         s_insights_data.data_send_timer = NULL;
@@ -823,7 +1176,7 @@ void esp_insights_disable(void)
 
     /* Let the existing Insights work to complete and then delete the semaphores */
     ESP_LOGI(TAG, "Adding task to delete the semaphores");
-    esp_rmaker_work_queue_add_task(esp_insights_disable_internal, NULL);
+    insights_work_add(esp_insights_disable_internal, NULL);
 }
 
 void esp_insights_deinit(void)
@@ -925,24 +1278,25 @@ esp_err_t esp_insights_enable(esp_insights_config_t *config)
         ESP_LOGE(TAG, "Failed to set node id");
         goto enable_err;
     }
+    s_insights_data.alloc_ext_ram = config->alloc_ext_ram;
     if (config->alloc_ext_ram) {
         s_insights_data.scratch_buf = MEM_ALLOC_EXTRAM(INSIGHTS_DATA_MAX_SIZE);
-        s_insights_data.read_buf = MEM_ALLOC_EXTRAM(INSIGHTS_READ_BUF_SIZE);
     } else {
         s_insights_data.scratch_buf = malloc(INSIGHTS_DATA_MAX_SIZE);
-        s_insights_data.read_buf = malloc(INSIGHTS_READ_BUF_SIZE);
     }
     if (!s_insights_data.scratch_buf) {
         ESP_LOGE(TAG, "Failed to allocate memory for scratch buffer.");
         err = ESP_ERR_NO_MEM;
         goto enable_err;
     }
-    if (!s_insights_data.read_buf) {
-        ESP_LOGE(TAG, "Failed to allocate memory for read_buf");
+#if !INSIGHTS_ZERO_COPY
+    if (!insights_read_buf_get()) {
         free(s_insights_data.scratch_buf);
+        s_insights_data.scratch_buf = NULL;
         err = ESP_ERR_NO_MEM;
         goto enable_err;
     }
+#endif
 
     /* Get sha256 */
     esp_diag_device_info_t device_info;
@@ -0,0 +1,275 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdbool.h>
+#include <string.h>
+#include "esp_insights_compress.h"
+
+#define LZ_MIN_MATCH        4
+#define LZ_HASH_BITS        10
+#define LZ_NO_POS           0xFFFF
+#define LZ_MAX_OFFSET       0xFFFF
+#define LZ_RUN_MASK         15
+/* LZ4 block rules: the last 5 bytes are literals, and no match starts in the last 12 bytes */
+#define LZ_LAST_LITERALS    5
+#define LZ_MF_LIMIT         12
+
+/* Strings which show up in most messages: CBOR encoded map keys and tags, and pieces of log
+ * messages. The decoder needs the very same bytes, so never change this in place; a different
+ * dictionary needs a different message flag.
+ */
+static const char s_dict[] =
+    "Failed to " " failed" "disconnected" "connected" "timeout" "error" "0x%x" "%d" "%s"
+    "\x63" "ver" "\x66" "sha256" "\x67" "node_id" "\x64" "diag" "\x64" "boot" "\x6c" "reset_reason"
+    "\x69" "core_dump" "\x64" "meta" "\x64" "data" "\x66" "params" "\x69" "variables"
+    "\x67" "metrics" "\x64" "logs" "\x66" "errors" "\x68" "warnings" "\x66" "events" "\x63" "tag"
+    "\x63" "msg" "\x64" "args" "\x62" "pc" "\x62" "bt" "\x66" "reason" "\x63" "cid" "\x64" "type"
+    "\x63" "key" "\x65" "label" "\x64" "path" "\x65" "value" "\x64" "heap" "\x64" "free"
+    "\x63" "lfb" "\x68" "min_free" "\x64" "wifi" "\x64" "rssi" "\x68" "min_rssi" "\x65" "bssid"
+    "\x62" "ip" "\x63" "sta" "\x64" "mqtt" "\x6c" "esp_insights" "\x6f" "esp_rmaker_mqtt"
+    "\x75" "esp_rmaker_work_queue" "\x72" "esp_netif_handlers" "\x69" "wifi_init"
+    "\x6b" "Diagnostics" "\x6f" "Diagnostics.Log" "\x75" "Diagnostics.Reporting"
+    "\x6b" "log_wr_fail" "\x69" "rpt_state" "\x6c" "rpt_interval" "\x6b" "ingest_rate"
+    /* timestamps are microseconds since the epoch, their top bytes rarely change */
+    "\x62" "ts" "\x1b\x00\x06";
+
+#define LZ_DICT_LEN         (sizeof(s_dict) - 1)
+
+const uint8_t *esp_insights_compress_dict(size_t *len)
+{
+    *len = LZ_DICT_LEN;
+    return (const uint8_t *) s_dict;
+}
+
+static inline uint32_t lz_read32(const uint8_t *p)
+{
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint32_t lz_hash(uint32_t v)
+{
+    return (v * 2654435761U) >> (32 - LZ_HASH_BITS);
+}
+
+/* Writes the part of a length beyond the token's nibble */
+static uint8_t *lz_put_len(uint8_t *op, size_t len)
+{
+    for (; len >= 255; len -= 255) {
+        *op++ = 255;
+    }
+    *op++ = len;
+    return op;
+}
+
+/* Writes one sequence, mlen 0 for the last one. Returns NULL if it does not fit. */
+static uint8_t *lz_put_seq(uint8_t *op, const uint8_t *oend, const uint8_t *lit, size_t lit_len,
+                           size_t offset, size_t mlen)
+{
+    size_t worst = 1 + lit_len / 255 + 1 + lit_len + 2 + mlen / 255 + 1;
+    if (worst > (size_t) (oend - op)) {
+        return NULL;
+    }
+    uint8_t *token = op++;
+    *token = ((lit_len < LZ_RUN_MASK) ? lit_len : LZ_RUN_MASK) << 4;
+    if (lit_len >= LZ_RUN_MASK) {
+        op = lz_put_len(op, lit_len - LZ_RUN_MASK);
+    }
+    memcpy(op, lit, lit_len);
+    op += lit_len;
+    if (!mlen) {
+        return op;
+    }
+    *op++ = offset & 0xFF;
+    *op++ = offset >> 8;
+    mlen -= LZ_MIN_MATCH;
+    *token |= (mlen < LZ_RUN_MASK) ? mlen : LZ_RUN_MASK;
+    if (mlen >= LZ_RUN_MASK) {
+        op = lz_put_len(op, mlen - LZ_RUN_MASK);
+    }
+    return op;
+}
+
+/* Greedy LZ77 over the dictionary followed by src. Positions are kept in that combined space,
+ * a match either lies in the dictionary or in src, it never spans both.
+ */
+static size_t lz_compress_block(const uint8_t *src, size_t len, uint8_t *dst, size_t dst_size, uint16_t *table)
+{
+    const uint8_t *dict = (const uint8_t *) s_dict;
+    uint8_t *op = dst;
+    const uint8_t *oend = dst + dst_size;
+    size_t ip = 0, anchor = 0;
+
+    if (LZ_DICT_LEN + len >= LZ_NO_POS) {
+        return 0;
+    }
+    memset(table, 0xFF, ESP_INSIGHTS_COMPRESS_WORKSPACE_SIZE);
+    for (size_t i = 0; i + LZ_MIN_MATCH <= LZ_DICT_LEN; i++) {
+        table[lz_hash(lz_read32(dict + i))] = i;
+    }
+
+    size_t mf_limit = (len > LZ_MF_LIMIT) ? len - LZ_MF_LIMIT : 0;
+    size_t match_limit = (len > LZ_LAST_LITERALS) ? len - LZ_LAST_LITERALS : 0;
+    while (ip < mf_limit) {
+        uint32_t seq = lz_read32(src + ip);
+        uint32_t h = lz_hash(seq);
+        size_t cand = table[h];
+        table[h] = LZ_DICT_LEN + ip;
+        if (cand == LZ_NO_POS) {
+            ip++;
+            continue;
+        }
+        const uint8_t *mp;
+        size_t max = match_limit - ip;
+        if (cand < LZ_DICT_LEN) {
+            mp = dict + cand;
+            if (LZ_DICT_LEN - cand < max) {
+                max = LZ_DICT_LEN - cand;
+            }
+        } else {
+            mp = src + cand - LZ_DICT_LEN;
+        }
+        size_t offset = LZ_DICT_LEN + ip - cand;
+        if (max < LZ_MIN_MATCH || offset > LZ_MAX_OFFSET || lz_read32(mp) != seq) {
+            ip++;
+            continue;
+        }
+        size_t mlen = LZ_MIN_MATCH;
+        while (mlen < max && mp[mlen] == src[ip + mlen]) {
+            mlen++;
+        }
+        op = lz_put_seq(op, oend, src + anchor, ip - anchor, offset, mlen);
+        if (!op) {
+            return 0;
+        }
+        ip += mlen;
+        anchor = ip;
+        if (ip >= 2 && ip - 2 + LZ_MIN_MATCH <= len) {
+            table[lz_hash(lz_read32(src + ip - 2))] = LZ_DICT_LEN + ip - 2;
+        }
+    }
+    op = lz_put_seq(op, oend, src + anchor, len - anchor, 0, 0);
+    return op ? op - dst : 0;
+}
+
+/* Reads the part of a length beyond the token's nibble, returns false if src ends first */
+static bool lz_get_len(const uint8_t *src, size_t len, size_t *ip, size_t *out)
+{
+    uint8_t b;
+    do {
+        if (*ip >= len) {
+            return false;
+        }
+        b = src[(*ip)++];
+        *out += b;
+    } while (b == 255);
+    return true;
+}
+
+static size_t lz_decompress_block(const uint8_t *src, size_t len, uint8_t *dst, size_t dst_size)
+{
+    const uint8_t *dict = (const uint8_t *) s_dict;
+    size_t ip = 0, op = 0;
+
+    while (ip < len) {
+        uint8_t token = src[ip++];
+        size_t lit_len = token >> 4;
+        if (lit_len == LZ_RUN_MASK && !lz_get_len(src, len, &ip, &lit_len)) {
+            return 0;
+        }
+        if (lit_len > len - ip || lit_len > dst_size - op) {
+            return 0;
+        }
+        memcpy(dst + op, src + ip, lit_len);
+        ip += lit_len;
+        op += lit_len;
+        if (ip == len) {
+            break; // the last sequence has no match
+        }
+        if (len - ip < 2) {
+            return 0;
+        }
+        size_t offset = src[ip] | (src[ip + 1] << 8);
+        ip += 2;
+        size_t mlen = token & LZ_RUN_MASK;
+        if (mlen == LZ_RUN_MASK && !lz_get_len(src, len, &ip, &mlen)) {
+            return 0;
+        }
+        mlen += LZ_MIN_MATCH;
+        if (!offset || offset > LZ_DICT_LEN + op || mlen > dst_size - op) {
+            return 0;
+        }
+        // byte by byte: the match may overlap its own output, or run from the dictionary into dst
+        size_t from = LZ_DICT_LEN + op - offset;
+        for (size_t i = 0; i < mlen; i++, from++) {
+            dst[op++] = (from < LZ_DICT_LEN) ? dict[from] : dst[from - LZ_DICT_LEN];
+        }
+    }
+    return op;
+}
+
+size_t esp_insights_compress_msg(const uint8_t *msg, size_t len, uint8_t *out, size_t out_size, void *workspace)
+{
+    if (!msg || !out || !workspace || len <= ESP_INSIGHTS_COMPRESS_HDR_LEN || len > 0xFFFF) {
+        return 0;
+    }
+    if (msg[0] & ESP_INSIGHTS_MSG_COMPRESSED) {
+        return 0;
+    }
+    // only worth it if it saves something
+    if (out_size >= len) {
+        out_size = len - 1;
+    }
+    if (out_size <= ESP_INSIGHTS_COMPRESS_HDR_LEN) {
+        return 0;
+    }
+    size_t value_len = len - ESP_INSIGHTS_MSG_HDR_LEN;
+    size_t block = lz_compress_block(msg + ESP_INSIGHTS_MSG_HDR_LEN, value_len,
+                                     out + ESP_INSIGHTS_COMPRESS_HDR_LEN, out_size - ESP_INSIGHTS_COMPRESS_HDR_LEN,
+                                     (uint16_t *) workspace);
+    if (!block) {
+        return 0;
+    }
+    size_t tlv_len = block + 2;
+    out[0] = msg[0] | ESP_INSIGHTS_MSG_COMPRESSED;
+    out[1] = tlv_len & 0xFF;
+    out[2] = tlv_len >> 8;
+    out[3] = value_len & 0xFF;
+    out[4] = value_len >> 8;
+    return ESP_INSIGHTS_COMPRESS_HDR_LEN + block;
+}
+
+size_t esp_insights_decompress_msg(const uint8_t *msg, size_t len, uint8_t *out, size_t out_size)
+{
+    if (!msg || !out || len < ESP_INSIGHTS_MSG_HDR_LEN) {
+        return 0;
+    }
+    if (!(msg[0] & ESP_INSIGHTS_MSG_COMPRESSED)) {
+        if (len > out_size) {
+            return 0;
+        }
+        memcpy(out, msg, len);
+        return len;
+    }
+    if (len < ESP_INSIGHTS_COMPRESS_HDR_LEN) {
+        return 0;
+    }
+    size_t tlv_len = msg[1] | (msg[2] << 8);
+    size_t value_len = msg[3] | (msg[4] << 8);
+    if (tlv_len < 2 || ESP_INSIGHTS_MSG_HDR_LEN + tlv_len > len || ESP_INSIGHTS_MSG_HDR_LEN + value_len > out_size) {
+        return 0;
+    }
+    size_t n = lz_decompress_block(msg + ESP_INSIGHTS_COMPRESS_HDR_LEN, tlv_len - 2,
+                                   out + ESP_INSIGHTS_MSG_HDR_LEN, value_len);
+    if (n != value_len) {
+        return 0;
+    }
+    out[0] = msg[0] & ~ESP_INSIGHTS_MSG_COMPRESSED;
+    out[1] = value_len & 0xFF;
+    out[2] = value_len >> 8;
+    return ESP_INSIGHTS_MSG_HDR_LEN + value_len;
+}
@@ -0,0 +1,71 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Compression of Insights messages
+ *
+ * Insights messages are TLVs: a type byte, the little-endian length of the value and the CBOR
+ * encoded value. Most of a value is made of the same map keys, tags and format strings over and
+ * over, so it is compressed with LZ77 against a dictionary of such strings which both ends know.
+ *
+ * A compressed message stays a TLV, so that it can still be framed by the transport:
+ *
+ *     | type | ESP_INSIGHTS_MSG_COMPRESSED | len (2) | value len (2) | LZ4 block |
+ *
+ * where `len` covers the original value length and the block. The block is in the LZ4 block
+ * format, compressed with esp_insights_compress_dict() as external dictionary, so any LZ4 decoder
+ * which takes a dictionary can expand it.
+ *
+ * This file is plain C, it is also built on the host by tools/insights_lz.c.
+ */
+
+/** Set in the type byte of a compressed message */
+#define ESP_INSIGHTS_MSG_COMPRESSED         0x80
+
+/** Header of a TLV message, and the extra header of a compressed one */
+#define ESP_INSIGHTS_MSG_HDR_LEN            3
+#define ESP_INSIGHTS_COMPRESS_HDR_LEN       (ESP_INSIGHTS_MSG_HDR_LEN + 2)
+
+/** Size of the workspace esp_insights_compress_msg() needs */
+#define ESP_INSIGHTS_COMPRESS_WORKSPACE_SIZE    (sizeof(uint16_t) << 10)
+
+/**
+ * @brief Returns the pre-shared dictionary
+ */
+const uint8_t *esp_insights_compress_dict(size_t *len);
+
+/**
+ * @brief Compresses a message
+ *
+ * @param[in]  msg        encoded message, header included
+ * @param[in]  len        length of msg
+ * @param[out] out        compressed message
+ * @param[in]  out_size   size of out; compression gives up once it would not be smaller than msg
+ * @param[in]  workspace  ESP_INSIGHTS_COMPRESS_WORKSPACE_SIZE bytes, aligned for uint16_t
+ *
+ * @return length of the compressed message, 0 if it would not be smaller than msg
+ */
+size_t esp_insights_compress_msg(const uint8_t *msg, size_t len, uint8_t *out, size_t out_size, void *workspace);
+
+/**
+ * @brief Expands a compressed message, uncompressed ones are copied as they are
+ *
+ * @return length of the expanded message, 0 if it is malformed or does not fit into out_size
+ */
+size_t esp_insights_decompress_msg(const uint8_t *msg, size_t len, uint8_t *out, size_t out_size);
+
+#ifdef __cplusplus
+}
+#endif
@@ -43,9 +43,14 @@ typedef enum {
     /** Command : 2 bytes*/
     ESP_RMAKER_TLV_TYPE_CMD,
     /** Data : Variable length */
-    ESP_RMAKER_TLV_TYPE_DATA
+    ESP_RMAKER_TLV_TYPE_DATA,
+    /** Flags : 1 byte, for batches of commands */
+    ESP_RMAKER_TLV_TYPE_FLAGS
 } esp_rmaker_tlv_type_t;
 
+/** Batch flag: do not run the commands after one which did not succeed */
+#define ESP_RMAKER_CMD_BATCH_STOP_ON_ERROR  (1 << 0)
+
 /* RainMaker Command Response Status */
 typedef enum {
     /** Success */
@@ -75,6 +80,15 @@ typedef struct {
 typedef enum {
     /** Standard command: Set Parameters */
     ESP_RMAKER_CMD_TYPE_SET_PARAMS = 1,
+    /** Standard command: Batch of commands, run by the framework in order.
+     *
+     * The request data is a sequence of commands, each a Command TLV followed by its Data TLV,
+     * if it has data. The request can have a Flags TLV with ESP_RMAKER_CMD_BATCH_STOP_ON_ERROR.
+     * The response data has a Command, Status and, on success, Data TLV for every command run,
+     * in the same order. The response status is success only if every command was run and
+     * succeeded. Batches cannot be nested.
+     */
+    ESP_RMAKER_CMD_TYPE_BATCH = 0xff0,
     /** Last Standard command */
     ESP_RMAKER_CMD_STANDARD_LAST = 0xfff,
     /** Custom commands can start from here */
@@ -185,6 +199,27 @@ esp_err_t esp_rmaker_cmd_resp_test_send(const char *req_id, uint8_t role, uint16
  */
 esp_err_t esp_rmaker_cmd_resp_parse_response(const void *response, size_t response_len, void *priv);
 
+/** Encode TLV payload for command or response into a buffer
+ *
+ * Same as esp_rmaker_cmd_resp_prepare_response_payload(), into a buffer of the caller, so that
+ * nothing is allocated.
+ *
+ * @param[in] req_id      NULL terminated request id of max 32 characters.
+ * @param[in] role        User Role flag.
+ * @param[in] cmd         Command Identifier.
+ * @param[in] data        Pointer to data for the command.
+ * @param[in] data_size   Size of the data.
+ * @param[out] buf        Buffer for the payload. Can be NULL, to get the length needed.
+ * @param[in] buf_size    Size of the buffer.
+ * @param[out] output_len Length of the payload, written or needed.
+ *
+ * @return ESP_OK on success.
+ * @return ESP_ERR_INVALID_SIZE if the payload does not fit, in which case nothing is written.
+ */
+esp_err_t esp_rmaker_cmd_resp_encode_payload(const char *req_id, uint8_t role, uint16_t cmd,
+                                             const void *data, size_t data_size,
+                                             void *buf, size_t buf_size, size_t *output_len);
+
 /** Prepare TLV payload for command or response
  *
  * @param[in] req_id      NULL terminated request id of max 32 characters.
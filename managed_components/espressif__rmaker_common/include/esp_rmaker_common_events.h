@@ -36,7 +36,8 @@ typedef enum {
     /** Disconnected from MQTT Broker */
     RMAKER_MQTT_EVENT_DISCONNECTED,
     /** MQTT message published successfully.
-     * Event data will contain the message ID (integer) of published message.
+     * Event data will contain the message ID (integer) of published message, followed by
+     * the time it took to get acknowledged (see esp_rmaker_mqtt_published_t).
      */
     RMAKER_MQTT_EVENT_PUBLISHED,
     /** POSIX Timezone Changed. Associated data would be NULL terminated POSIX Timezone
@@ -51,10 +52,24 @@ typedef enum {
     /**
      * MQTT message deleted from the outbox if the message couldn't have been sent and acknowledged.
      * Event data will contain the message ID (integer) of deleted message.
-     * Valid only if CONFIG_MQTT_REPORT_DELETED_MESSAGES is enabled.
+     * Triggered for messages not published or acknowledged within CONFIG_ESP_RMAKER_MQTT_PUBLISH_TIMEOUT,
+     * and for the ones the MQTT client deletes if CONFIG_MQTT_REPORT_DELETED_MESSAGES is enabled.
      */
     RMAKER_MQTT_EVENT_MSG_DELETED,
 } esp_rmaker_common_event_t;
+
+/** Event data of RMAKER_MQTT_EVENT_PUBLISHED.
+ * Starts with the message ID, so that it can also be read as a plain integer.
+ */
+typedef struct {
+    /** Message ID of the published message */
+    int msg_id;
+    /** Milliseconds from handing the message to the MQTT client until it was acknowledged,
+     * ESP_RMAKER_MQTT_LATENCY_UNKNOWN if the publish time was not recorded. */
+    uint32_t latency_ms;
+} esp_rmaker_mqtt_published_t;
+
+#define ESP_RMAKER_MQTT_LATENCY_UNKNOWN     UINT32_MAX
 #ifdef __cplusplus
 }
 #endif
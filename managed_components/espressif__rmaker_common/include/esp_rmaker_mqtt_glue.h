@@ -166,6 +166,37 @@ typedef struct {
  */
 esp_err_t esp_rmaker_mqtt_glue_setup(esp_rmaker_mqtt_config_t *mqtt_config);
 
+/** Statistics of the MQTT publish queue of the ESP-MQTT glue */
+typedef struct {
+    /** Messages queued. */
+    uint32_t queued;
+    /** Messages which replaced a queued one on the same topic. */
+    uint32_t coalesced;
+    /** Messages which could not be queued as the queue was full. */
+    uint32_t rejected;
+    /** Messages handed to the MQTT client. */
+    uint32_t sent;
+    /** QoS 1 messages acknowledged. */
+    uint32_t acked;
+    /** Messages dropped for not being sent or acknowledged in time. */
+    uint32_t expired;
+    /** Bytes queued right now. */
+    uint32_t bytes;
+    /** Most bytes queued at a time. */
+    uint32_t max_bytes;
+    /** QoS 1 messages not acknowledged right now. */
+    uint8_t inflight;
+} esp_rmaker_mqtt_publish_stats_t;
+
+/** Get the statistics of the MQTT publish queue
+ *
+ * @param[out] stats Statistics.
+ *
+ * @return ESP_OK on success.
+ * @return ESP_ERR_INVALID_STATE if MQTT is not initialised.
+ */
+esp_err_t esp_rmaker_mqtt_glue_get_publish_stats(esp_rmaker_mqtt_publish_stats_t *stats);
+
 /* Get the ESP AWS PPI String
  *
  * @return pointer to a NULL terminated PPI string on success.
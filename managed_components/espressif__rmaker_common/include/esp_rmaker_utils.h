@@ -152,6 +152,33 @@ esp_err_t esp_rmaker_time_wait_for_sync(uint32_t ticks_to_wait);
  */
 esp_err_t esp_rmaker_time_convert_iso8601_to_epoch(const char *str, int len, time_t *out_epoch);
 
+/** Get the local time of a UTC time
+ *
+ * Same as localtime_r(), but the timezone set with esp_rmaker_time_set_timezone_posix() or
+ * esp_rmaker_time_set_timezone() (or the TZ environment variable) is parsed only once, and the
+ * daylight saving transitions of a few years around the current time are cached. This makes it
+ * cheap enough to be called for every schedule evaluation or log line.
+ *
+ * @param[in] utc Epoch seconds (UTC)
+ * @param[out] local Broken-down local time
+ *
+ * @return ESP_OK on success
+ * @return error on failure
+ */
+esp_err_t esp_rmaker_time_localtime(time_t utc, struct tm *local);
+
+/** Get the UTC time of a local time
+ *
+ * Same as mktime(), with the timezone cached as for esp_rmaker_time_localtime().
+ * The fields of local are normalized. If tm_isdst is negative, a local time which happens twice
+ * when the clocks go back is taken as the first one.
+ *
+ * @param[in,out] local Broken-down local time
+ *
+ * @return Epoch seconds (UTC), or (time_t)-1 on failure
+ */
+time_t esp_rmaker_time_mktime(struct tm *local);
+
 /** Set POSIX timezone
  *
  * Set the timezone (TZ environment variable) as per the POSIX format
@@ -15,6 +15,7 @@
 #include <stdint.h>
 #include <esp_err.h>
 #include <esp_event.h>
+#include <freertos/FreeRTOS.h>
 #ifdef __cplusplus
 extern "C"
 {
@@ -25,6 +26,44 @@ extern "C"
  */
 typedef void (*esp_rmaker_work_fn_t)(void *priv_data);
 
+/** Work Queue priorities
+ *
+ * Each priority has a queue of its own. Queued work runs highest priority first,
+ * and in the order it was queued within a priority.
+ */
+typedef enum {
+    /** Work the user waits for, like param reports. */
+    ESP_RMAKER_WORK_PRIO_URGENT = 0,
+    /** Default priority, used by esp_rmaker_work_queue_add_task(). */
+    ESP_RMAKER_WORK_PRIO_NORMAL,
+    /** Work which can wait, like diagnostics reporting. Runs in a task of its own with
+     * CONFIG_ESP_RMAKER_WORK_QUEUE_BACKGROUND_WORKER.
+     */
+    ESP_RMAKER_WORK_PRIO_BACKGROUND,
+    ESP_RMAKER_WORK_PRIO_MAX,
+} esp_rmaker_work_prio_t;
+
+/** Handle of a periodic work function */
+typedef struct esp_rmaker_work_timer *esp_rmaker_work_timer_handle_t;
+
+/** Statistics of one Work Queue priority */
+typedef struct {
+    /** Work functions queued. */
+    uint32_t queued;
+    /** Work functions which could not be queued as the queue was full. */
+    uint32_t dropped;
+    /** Work functions executed. */
+    uint32_t executed;
+    /** Work functions waiting right now. */
+    uint16_t depth;
+    /** Most work functions waiting at a time. */
+    uint16_t max_depth;
+    /** Average time from queueing to execution, in milliseconds. */
+    uint32_t avg_wait_ms;
+    /** Longest time from queueing to execution, in milliseconds. */
+    uint32_t max_wait_ms;
+} esp_rmaker_work_queue_stats_t;
+
 /** Initializes the Work Queue
  *
  * This initializes the work queue, which is basically a mechanism to run
@@ -67,7 +106,8 @@ esp_err_t esp_rmaker_work_queue_stop(void);
 
 /** Queue execution of a function in the Work Queue's context
  *
- * This API queues a work function for execution in the Work Queue Task's context.
+ * This API queues a work function for execution in the Work Queue Task's context,
+ * with ESP_RMAKER_WORK_PRIO_NORMAL. It does not wait if the queue is full.
  *
  * @param[in] work_fn The Work function to be queued.
  * @param[in] priv_data Private data to be passed to the work function.
@@ -77,6 +117,111 @@ esp_err_t esp_rmaker_work_queue_stop(void);
  */
 esp_err_t esp_rmaker_work_queue_add_task(esp_rmaker_work_fn_t work_fn, void *priv_data);
 
+/** Queue execution of a function in the Work Queue's context with a priority
+ *
+ * If the queue of the priority is full, this waits up to timeout ticks for room.
+ * From a work function, it never waits, as that could wait for the caller itself.
+ *
+ * @param[in] work_fn The Work function to be queued.
+ * @param[in] priv_data Private data to be passed to the work function.
+ * @param[in] prio Priority of the work function.
+ * @param[in] timeout Ticks to wait for room in the queue, 0 to fail right away.
+ *
+ * @return ESP_OK on success.
+ * @return ESP_ERR_TIMEOUT if the queue stayed full.
+ * @return error in case of other failures.
+ */
+esp_err_t esp_rmaker_work_queue_add_task_with_prio(esp_rmaker_work_fn_t work_fn, void *priv_data,
+                                                   esp_rmaker_work_prio_t prio, TickType_t timeout);
+
+/** Queue execution of a function after a delay
+ *
+ * The function is queued with the given priority once the delay has passed, counting
+ * from this call. All delayed and periodic work shares a single timer wheel run by the
+ * Work Queue Task, so the function is only queued once the Work Queue has been started,
+ * and may run later than the delay if the Work Queue Task is busy. If the lane of the
+ * priority is full then, queuing is tried again on the next tick.
+ *
+ * @param[in] work_fn The Work function to be queued.
+ * @param[in] priv_data Private data to be passed to the work function.
+ * @param[in] prio Priority of the work function.
+ * @param[in] delay_ms Delay in milliseconds.
+ *
+ * @return ESP_OK on success.
+ * @return error in case of failure.
+ */
+esp_err_t esp_rmaker_work_queue_add_delayed(esp_rmaker_work_fn_t work_fn, void *priv_data,
+                                            esp_rmaker_work_prio_t prio, uint32_t delay_ms);
+
+/** Queue execution of a function periodically
+ *
+ * The function is queued with the given priority every period_ms, the first time
+ * period_ms after this call. Periods are not made up for: one which comes up while
+ * the lane of the priority is full is skipped, and runs can queue up behind each
+ * other if the lane is not full but the function takes longer than the period.
+ *
+ * @param[in] work_fn The Work function to be queued.
+ * @param[in] priv_data Private data to be passed to the work function.
+ * @param[in] prio Priority of the work function.
+ * @param[in] period_ms Period in milliseconds.
+ * @param[out] handle Handle to change the period of, stop or delete the periodic work.
+ *                    esp_rmaker_work_queue_deinit() stops it, but it stays valid until
+ *                    esp_rmaker_work_queue_timer_delete().
+ *
+ * @return ESP_OK on success.
+ * @return error in case of failure.
+ */
+esp_err_t esp_rmaker_work_queue_add_periodic(esp_rmaker_work_fn_t work_fn, void *priv_data,
+                                             esp_rmaker_work_prio_t prio, uint32_t period_ms,
+                                             esp_rmaker_work_timer_handle_t *handle);
+
+/** Change the period of periodic work
+ *
+ * This also restarts stopped work. The next run is period_ms from now.
+ *
+ * @param[in] handle Handle from esp_rmaker_work_queue_add_periodic().
+ * @param[in] period_ms New period in milliseconds.
+ *
+ * @return ESP_OK on success.
+ * @return error in case of failure.
+ */
+esp_err_t esp_rmaker_work_queue_timer_change_period(esp_rmaker_work_timer_handle_t handle, uint32_t period_ms);
+
+/** Stop periodic work
+ *
+ * A run which is already queued still happens.
+ *
+ * @param[in] handle Handle from esp_rmaker_work_queue_add_periodic().
+ *
+ * @return ESP_OK on success.
+ * @return error in case of failure.
+ */
+esp_err_t esp_rmaker_work_queue_timer_stop(esp_rmaker_work_timer_handle_t handle);
+
+/** Stop and delete periodic work
+ *
+ * A run which is already queued still happens.
+ *
+ * @param[in] handle Handle from esp_rmaker_work_queue_add_periodic().
+ *
+ * @return ESP_OK on success.
+ * @return error in case of failure.
+ */
+esp_err_t esp_rmaker_work_queue_timer_delete(esp_rmaker_work_timer_handle_t handle);
+
+/** Get the statistics of a Work Queue priority
+ *
+ * @param[in] prio The priority.
+ * @param[out] stats The statistics since init or the last esp_rmaker_work_queue_reset_stats().
+ *
+ * @return ESP_OK on success.
+ * @return error in case of failure.
+ */
+esp_err_t esp_rmaker_work_queue_get_stats(esp_rmaker_work_prio_t prio, esp_rmaker_work_queue_stats_t *stats);
+
+/** Reset the statistics of all Work Queue priorities */
+void esp_rmaker_work_queue_reset_stats(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -10,8 +10,10 @@
 #include <esp_log.h>
 #include <esp_rmaker_cmd_resp.h>
 #include <esp_rmaker_utils.h>
+#include "cmd_resp_tlv.h"
 
 #define RMAKER_MAX_CMD  CONFIG_ESP_RMAKER_MAX_COMMANDS
+#define CMD_BATCH_MAX   CONFIG_ESP_RMAKER_CMD_BATCH_MAX_ENTRIES
 
 static const char *TAG = "esp_rmaker_common_cmd_resp";
 
@@ -23,13 +25,25 @@ typedef struct {
     void *priv;
 } esp_rmaker_cmd_info_t;
 
-typedef struct {
-    uint8_t *bufptr;
-    int bufsize;
-    int curlen;
-} esp_rmaker_tlv_data_t;
-
-static esp_rmaker_cmd_info_t *esp_rmaker_cmd_list[RMAKER_MAX_CMD];
+/* Commands are kept in an open addressing table with linear probing, at most half full, so that
+ * finding one takes a probe or two. Command 0 is not valid, and marks the free slots.
+ */
+#if RMAKER_MAX_CMD <= 8
+#define CMD_TABLE_BITS  4
+#elif RMAKER_MAX_CMD <= 16
+#define CMD_TABLE_BITS  5
+#elif RMAKER_MAX_CMD <= 32
+#define CMD_TABLE_BITS  6
+#elif RMAKER_MAX_CMD <= 64
+#define CMD_TABLE_BITS  7
+#else
+#define CMD_TABLE_BITS  8
+#endif
+#define CMD_TABLE_SIZE  (1 << CMD_TABLE_BITS)
+#define CMD_TABLE_MASK  (CMD_TABLE_SIZE - 1)
+
+static esp_rmaker_cmd_info_t esp_rmaker_cmd_table[CMD_TABLE_SIZE];
+static int esp_rmaker_cmd_count;
 
 /* Get uint16 from Little Endian data buffer */
 static uint16_t get_u16_le(const void *val_ptr)
@@ -52,122 +66,6 @@ static void put_u16_le(void *val_ptr, const uint16_t val)
     p[1] = (uint8_t)(val >> 8) & 0xff;
 }
 
-/* Initialise TLV Data */
-static void esp_rmaker_tlv_data_init(esp_rmaker_tlv_data_t *tlv_data, uint8_t *buf, int buf_size)
-{
-    tlv_data->bufptr = buf;
-    tlv_data->bufsize = buf_size;
-    tlv_data->curlen = 0;
-}
-
-/* Get length of data, for given type.
- *
- * Returns length of data on success and -1 if the TLV was not found
- */
-static int esp_rmaker_get_tlv_length(const uint8_t *buf, int buflen, uint8_t type)
-{
-    if (!buf ) {
-        return -1;
-    }
-    int curlen = 0;
-    int val_len = 0;
-    bool found = false;
-    while (buflen > 0) {
-        if (buf[curlen] == type) {
-            uint8_t len = buf[curlen + 1];
-            if ((buflen - len) < 2) {
-                return -1;
-            }
-            val_len += len;
-            if (len < 255) {
-                return val_len;
-            } else {
-                found = true;
-            }
-
-        } else if (found) {
-            return val_len;
-        }
-
-        /* buf[curlen +1] will give the Length */
-        buflen -= (2 + buf[curlen + 1]);
-        curlen += (2 + buf[curlen + 1]);
-    }
-    if (found) {
-        return val_len;
-    }
-    return -1;
-}
-
-/* Get the value for the given type.
- *
- * Returns length of data on success and -1 if the TLV was not found
- */
-static int esp_rmaker_get_value_from_tlv(const uint8_t *buf, int buflen, uint8_t type, void *val, int val_size)
-{
-    if (!buf || !val) {
-        return -1;
-    }
-    int curlen = 0;
-    int val_len = 0;
-    bool found = false;
-    while (buflen > 0) {
-        if (buf[curlen] == type) {
-            uint8_t len = buf[curlen + 1];
-            if ((val_size < len) || ((buflen - len) < 2)) {
-                return -1;
-            }
-            memcpy(val + val_len, &buf[curlen + 2], len);
-            val_len += len;
-            val_size -= len;
-            if (len < 255) {
-                return val_len;
-            } else {
-                found = true;
-            }
-
-        } else if (found) {
-            return val_len;
-        }
-
-        /* buf[curlen +1] will give the Length */
-        buflen -= (2 + buf[curlen + 1]);
-        curlen += (2 + buf[curlen + 1]);
-    }
-    if (found) {
-        return val_len;
-    }
-    return -1;
-}
-
-/* Add a TLV to the TLV buffer */
-static int esp_rmaker_add_tlv(esp_rmaker_tlv_data_t *tlv_data, uint8_t type, int len, const void *val)
-{
-    if (!tlv_data->bufptr || ((len + 2) > (tlv_data->bufsize - tlv_data->curlen))) {
-        return -1;
-    }
-    if (len > 0 && val == NULL) {
-        return -1;
-    }
-    uint8_t *buf_ptr = (uint8_t *)val;
-    int orig_len = tlv_data->curlen;
-    do {
-        tlv_data->bufptr[tlv_data->curlen++] = type;
-        int tmp_len;
-        if (len > 255) {
-            tmp_len = 255;
-        } else {
-            tmp_len = len;
-        }
-        tlv_data->bufptr[tlv_data->curlen++] = tmp_len;
-        memcpy(&tlv_data->bufptr[tlv_data->curlen], buf_ptr, tmp_len);
-        tlv_data->curlen += tmp_len;
-        buf_ptr += tmp_len;
-        len -= tmp_len;
-    } while (len);
-    return tlv_data->curlen - orig_len;
-}
-
 /* Get user role string from flag. Useful for printing */
 const char *esp_rmaker_get_user_role_string(uint8_t user_role)
 {
@@ -185,6 +83,58 @@ const char *esp_rmaker_get_user_role_string(uint8_t user_role)
     }
 }
 
+/* No status field, for commands */
+#define CMD_NO_STATUS   -1
+
+/* Encode the fields of a command or response into buf, skipping a NULL request id, a role of 0,
+ * CMD_NO_STATUS and empty data.
+ *
+ * Returns the length of the encoding. If that is more than buf_size, nothing is written.
+ */
+static size_t esp_rmaker_cmd_encode(void *buf, size_t buf_size, const char *req_id, uint8_t role, int status,
+                                    uint16_t cmd, const void *data, size_t data_size)
+{
+    size_t req_id_len = req_id ? strlen(req_id) : 0;
+    if (!data) {
+        data_size = 0;
+    }
+    size_t size = esp_rmaker_tlv_encoded_size(sizeof(cmd));
+    if (req_id) {
+        size += esp_rmaker_tlv_encoded_size(req_id_len);
+    }
+    if (role != 0) {
+        size += esp_rmaker_tlv_encoded_size(sizeof(role));
+    }
+    if (status != CMD_NO_STATUS) {
+        size += esp_rmaker_tlv_encoded_size(sizeof(uint8_t));
+    }
+    if (data_size != 0) {
+        size += esp_rmaker_tlv_encoded_size(data_size);
+    }
+    if (!buf || size > buf_size) {
+        return size;
+    }
+    esp_rmaker_tlv_writer_t writer;
+    esp_rmaker_tlv_writer_init(&writer, buf, buf_size);
+    if (req_id) {
+        esp_rmaker_tlv_put(&writer, ESP_RMAKER_TLV_TYPE_REQ_ID, req_id, req_id_len);
+    }
+    if (role != 0) {
+        esp_rmaker_tlv_put(&writer, ESP_RMAKER_TLV_TYPE_USER_ROLE, &role, sizeof(role));
+    }
+    if (status != CMD_NO_STATUS) {
+        uint8_t status_buf = status;
+        esp_rmaker_tlv_put(&writer, ESP_RMAKER_TLV_TYPE_STATUS, &status_buf, sizeof(status_buf));
+    }
+    uint8_t cmd_buf[2];
+    put_u16_le(cmd_buf, cmd);
+    esp_rmaker_tlv_put(&writer, ESP_RMAKER_TLV_TYPE_CMD, cmd_buf, sizeof(cmd_buf));
+    if (data_size != 0) {
+        esp_rmaker_tlv_put(&writer, ESP_RMAKER_TLV_TYPE_DATA, data, data_size);
+    }
+    return size;
+}
+
 /* Prepare the response TLV8 which includes
  *
  * Request Id
@@ -194,111 +144,293 @@ const char *esp_rmaker_get_user_role_string(uint8_t user_role)
  */
 static esp_err_t esp_rmaker_cmd_prepare_response(esp_rmaker_cmd_ctx_t *cmd_ctx, uint8_t status, void *response, size_t response_size, void **output, size_t *output_len)
 {
-    size_t publish_size = response_size + 100; /* +100 for rest of metadata. TODO: Do exact calculation */
-    void *publish_data = MEM_CALLOC_EXTRAM(1, publish_size);
+    const char *req_id = strlen(cmd_ctx->req_id) ? cmd_ctx->req_id : NULL;
+    size_t publish_size = esp_rmaker_cmd_encode(NULL, 0, req_id, 0, status, cmd_ctx->cmd, response, response_size);
+    void *publish_data = MEM_ALLOC_EXTRAM(publish_size);
     if (!publish_data) {
-        ESP_LOGE(TAG, "Failed to allocate buffer of size %d for response.", response_size + 100);
+        ESP_LOGE(TAG, "Failed to allocate buffer of size %zu for response.", publish_size);
         return ESP_ERR_NO_MEM;
     }
-    esp_rmaker_tlv_data_t tlv_data;
-    esp_rmaker_tlv_data_init(&tlv_data, publish_data, publish_size);
-    if (strlen(cmd_ctx->req_id)) {
-        esp_rmaker_add_tlv(&tlv_data, ESP_RMAKER_TLV_TYPE_REQ_ID, strlen(cmd_ctx->req_id), cmd_ctx->req_id);
-    }
-    esp_rmaker_add_tlv(&tlv_data, ESP_RMAKER_TLV_TYPE_STATUS, sizeof(status), &status);
-    uint8_t cmd_buf[2];
-    put_u16_le(cmd_buf, cmd_ctx->cmd);
-    esp_rmaker_add_tlv(&tlv_data, ESP_RMAKER_TLV_TYPE_CMD, sizeof(cmd_buf), cmd_buf);
-    if (response != NULL && response_size != 0) {
-        esp_rmaker_add_tlv(&tlv_data, ESP_RMAKER_TLV_TYPE_DATA, response_size, response);
-    }
-    ESP_LOGD(TAG, "Generated response of size %d for cmd %d", tlv_data.curlen, cmd_ctx->cmd);
+    esp_rmaker_cmd_encode(publish_data, publish_size, req_id, 0, status, cmd_ctx->cmd, response, response_size);
+    ESP_LOGD(TAG, "Generated response of size %zu for cmd %d", publish_size, cmd_ctx->cmd);
     *output = publish_data;
-    *output_len = tlv_data.curlen;
+    *output_len = publish_size;
     return ESP_OK;
 }
 
 esp_err_t esp_rmaker_cmd_prepare_empty_response(void **output, size_t *output_len)
 {
     size_t publish_size = 6; /* unit16 cmd = 0 (4 bytes in TLV), req_id = empty (2 bytes) */
-    void *publish_data = MEM_CALLOC_EXTRAM(1, publish_size);
+    void *publish_data = MEM_ALLOC_EXTRAM(publish_size);
     if (!publish_data) {
         return ESP_ERR_NO_MEM;
     }
-    esp_rmaker_tlv_data_t tlv_data;
-    esp_rmaker_tlv_data_init(&tlv_data, publish_data, publish_size);
-    esp_rmaker_add_tlv(&tlv_data, ESP_RMAKER_TLV_TYPE_REQ_ID, 0, NULL);
-    uint8_t cmd_buf[2];
-    put_u16_le(cmd_buf, 0);
-    esp_rmaker_add_tlv(&tlv_data, ESP_RMAKER_TLV_TYPE_CMD, sizeof(cmd_buf), cmd_buf);
+    *output_len = esp_rmaker_cmd_encode(publish_data, publish_size, "", 0, CMD_NO_STATUS, 0, NULL, 0);
     *output = publish_data;
-    *output_len = tlv_data.curlen;
     ESP_LOGD(TAG, "Generated empty response for requesting pending commands.");
     return ESP_OK;
 }
 
+/* Home slot of a command: Fibonacci hashing, the top bits of the 16 bit product */
+static inline uint32_t esp_rmaker_cmd_slot(uint16_t cmd)
+{
+    return (uint16_t)(cmd * 40503u) >> (16 - CMD_TABLE_BITS);
+}
+
+/* Find the command info for given command
+ *
+ * Returns pointer to the info if found and NULL otherwise
+ */
+static esp_rmaker_cmd_info_t *esp_rmaker_get_cmd_info(uint16_t cmd)
+{
+    for (uint32_t i = esp_rmaker_cmd_slot(cmd); esp_rmaker_cmd_table[i].cmd; i = (i + 1) & CMD_TABLE_MASK) {
+        if (esp_rmaker_cmd_table[i].cmd == cmd) {
+            return &esp_rmaker_cmd_table[i];
+        }
+    }
+    return NULL;
+}
+
 /* Register a new command with its handler
  */
 esp_err_t esp_rmaker_cmd_register(uint16_t cmd, uint8_t access, esp_rmaker_cmd_handler_t handler, bool free_on_return, void *priv)
 {
-    int i;
-    for (i = 0; i < RMAKER_MAX_CMD; i++) {
-        if (esp_rmaker_cmd_list[i] && (esp_rmaker_cmd_list[i]->cmd == cmd)) {
-            ESP_LOGE(TAG, "Handler for command %d already exists.", cmd);
-            return ESP_FAIL;
+    if (cmd == 0) {
+        ESP_LOGE(TAG, "Command id cannot be 0.");
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (esp_rmaker_get_cmd_info(cmd)) {
+        ESP_LOGE(TAG, "Handler for command %d already exists.", cmd);
+        return ESP_FAIL;
+    }
+    if (esp_rmaker_cmd_count >= RMAKER_MAX_CMD) {
+        ESP_LOGE(TAG, "No space to add command %d", cmd);
+        return ESP_ERR_NO_MEM;
+    }
+    uint32_t i = esp_rmaker_cmd_slot(cmd);
+    while (esp_rmaker_cmd_table[i].cmd) {
+        i = (i + 1) & CMD_TABLE_MASK;
+    }
+    esp_rmaker_cmd_table[i] = (esp_rmaker_cmd_info_t) {
+        .cmd = cmd,
+        .access = access,
+        .free_on_return = free_on_return,
+        .handler = handler,
+        .priv = priv,
+    };
+    esp_rmaker_cmd_count++;
+    ESP_LOGI(TAG, "Registered command %d", cmd);
+    return ESP_OK;
+}
+
+/* De-register given command */
+esp_err_t esp_rmaker_cmd_deregister(uint16_t cmd)
+{
+    esp_rmaker_cmd_info_t *cmd_info = esp_rmaker_get_cmd_info(cmd);
+    if (!cmd_info) {
+        ESP_LOGE(TAG, "Cannot unregister command %d as it wasn't registered.", cmd);
+        return ESP_ERR_INVALID_ARG;
+    }
+    /* Move the commands after it back into the hole, if that is not before their home slot,
+     * so that none of them is behind a free slot.
+     */
+    uint32_t hole = cmd_info - esp_rmaker_cmd_table;
+    for (uint32_t i = (hole + 1) & CMD_TABLE_MASK; esp_rmaker_cmd_table[i].cmd; i = (i + 1) & CMD_TABLE_MASK) {
+        uint32_t home = esp_rmaker_cmd_slot(esp_rmaker_cmd_table[i].cmd);
+        if (((i - home) & CMD_TABLE_MASK) >= ((i - hole) & CMD_TABLE_MASK)) {
+            esp_rmaker_cmd_table[hole] = esp_rmaker_cmd_table[i];
+            hole = i;
         }
     }
-    for (i = 0; i < RMAKER_MAX_CMD; i++) {
-        if (!esp_rmaker_cmd_list[i]) {
-            esp_rmaker_cmd_info_t *cmd_info = calloc(1, sizeof(esp_rmaker_cmd_info_t));
-            if (!cmd_info) {
-                ESP_LOGE(TAG, "Could not allocate memory for cmd %d", cmd);
-                return ESP_ERR_NO_MEM;
-            }
-            cmd_info->cmd = cmd;
-            cmd_info->access = access;
-            cmd_info->free_on_return = free_on_return;
-            cmd_info->handler = handler;
-            cmd_info->priv = priv;
-            esp_rmaker_cmd_list[i] = cmd_info;
-            ESP_LOGI(TAG, "Registered command %d", cmd);
-            return ESP_OK;
+    memset(&esp_rmaker_cmd_table[hole], 0, sizeof(esp_rmaker_cmd_info_t));
+    esp_rmaker_cmd_count--;
+    return ESP_OK;
+}
+
+/* Outcome of a command, run on its own or in a batch */
+typedef struct {
+    uint8_t status;
+    void *response;
+    size_t response_size;
+    bool free_response;
+} esp_rmaker_cmd_result_t;
+
+typedef struct {
+    uint16_t cmd;
+    esp_rmaker_tlv_field_t data;
+    esp_rmaker_cmd_result_t result;
+} esp_rmaker_cmd_batch_entry_t;
+
+/* Find the handler for the command in the context and run it on the data found in the request.
+ *
+ * The response is kept in the result, and is to be freed with esp_rmaker_cmd_free_result()
+ */
+static void esp_rmaker_cmd_execute(esp_rmaker_cmd_ctx_t *cmd_ctx, const esp_rmaker_tlv_field_t *data_field,
+                                   esp_rmaker_cmd_result_t *result)
+{
+    memset(result, 0, sizeof(esp_rmaker_cmd_result_t));
+    esp_rmaker_cmd_info_t *found = esp_rmaker_get_cmd_info(cmd_ctx->cmd);
+    if (!found) {
+        ESP_LOGD(TAG, "No handler found for command %d.", cmd_ctx->cmd);
+        result->status = ESP_RMAKER_CMD_STATUS_NOT_FOUND;
+        return;
+    }
+    /* A copy, as the handler may deregister commands, which moves them in the table */
+    esp_rmaker_cmd_info_t cmd_info = *found;
+    if (!(cmd_info.access & cmd_ctx->user_role)) {
+        result->status = ESP_RMAKER_CMD_STATUS_AUTH_FAIL;
+        return;
+    }
+    const void *data = NULL;
+    void *data_buf = NULL;
+    size_t data_size = data_field->len;
+    if (data_field->records > 1) {
+        /* Data longer than a record is put together, shorter data is used in place */
+        data_buf = MEM_ALLOC_EXTRAM(data_size);
+        if (!data_buf) {
+            ESP_LOGE(TAG, "Failed to allocate buffer of size %zu for data.", data_size);
+            result->status = ESP_RMAKER_CMD_STATUS_FAILED;
+            return;
         }
+        esp_rmaker_tlv_copy(data_field, data_buf, data_size);
+        data = data_buf;
+    } else if (data_size > 0) {
+        data = data_field->value;
+    } else {
+        /* It is not mandatory to have data for a given command */
+        ESP_LOGD(TAG, "No data received for the command.");
+    }
+    esp_err_t err = cmd_info.handler(data, data_size, &result->response, &result->response_size, cmd_ctx, cmd_info.priv);
+    free(data_buf);
+    result->status = (err == ESP_OK) ? ESP_RMAKER_CMD_STATUS_SUCCESS : ESP_RMAKER_CMD_STATUS_FAILED;
+    result->free_response = cmd_info.free_on_return;
+}
+
+static void esp_rmaker_cmd_free_result(esp_rmaker_cmd_result_t *result)
+{
+    if (result->response && result->free_response) {
+        ESP_LOGD(TAG, "Freeing response buffer.");
+        free(result->response);
     }
-    ESP_LOGE(TAG, "No space to add command %d", cmd);
-    return ESP_ERR_NO_MEM;
+    result->response = NULL;
 }
 
-/* Find the command infor for given command
+/* Read the commands of a batch, each a command TLV and the data TLV which follows it, if any.
  *
- * Returns pointer to the info if found and NULL on error
+ * Returns the number of commands, or -1 if the batch is malformed, has too many commands, or
+ * has a batch in it.
  */
-static esp_rmaker_cmd_info_t *esp_rmaker_get_cmd_info(uint16_t cmd)
+static int esp_rmaker_cmd_parse_batch(const void *batch, size_t batch_len, esp_rmaker_cmd_batch_entry_t *entries)
 {
-    int i;
-    for (i = 0; i < RMAKER_MAX_CMD; i++) {
-        if (esp_rmaker_cmd_list[i] && (esp_rmaker_cmd_list[i]->cmd == cmd)) {
-            ESP_LOGI(TAG, "Handler found for command %d.", cmd);
-            return esp_rmaker_cmd_list[i];
+    esp_rmaker_tlv_cursor_t cursor;
+    esp_rmaker_tlv_cursor_init(&cursor, batch, batch_len);
+    uint8_t type;
+    esp_rmaker_tlv_field_t field;
+    int count = 0;
+    int ret;
+    while ((ret = esp_rmaker_tlv_next(&cursor, &type, &field)) > 0) {
+        if (type == ESP_RMAKER_TLV_TYPE_CMD) {
+            if (count == CMD_BATCH_MAX || field.len != sizeof(uint16_t)) {
+                return -1;
+            }
+            uint16_t cmd = get_u16_le(field.value);
+            if (cmd == 0 || cmd == ESP_RMAKER_CMD_TYPE_BATCH) {
+                return -1;
+            }
+            entries[count++].cmd = cmd;
+        } else if (type == ESP_RMAKER_TLV_TYPE_DATA && count > 0 && !entries[count - 1].data.value) {
+            entries[count - 1].data = field;
+        } else {
+            return -1;
         }
     }
-    ESP_LOGE(TAG, "No handler found for command %d.", cmd);
-    return NULL;
+    return (ret < 0) ? -1 : count;
 }
 
-/* De-register given command */
-esp_err_t esp_rmaker_cmd_deregister(uint16_t cmd)
+/* Run the commands of a batch in order, and prepare one response with the outcome of each */
+static esp_err_t esp_rmaker_cmd_handle_batch(esp_rmaker_cmd_ctx_t *cmd_ctx, const esp_rmaker_tlv_index_t *tlv,
+                                             void **output, size_t *output_len)
 {
-    int i;
-    for (i = 0; i < RMAKER_MAX_CMD; i++) {
-        if (esp_rmaker_cmd_list[i] && (esp_rmaker_cmd_list[i]->cmd == cmd)) {
-            free(esp_rmaker_cmd_list[i]);
-            esp_rmaker_cmd_list[i] = NULL;
-            return ESP_OK;
+    uint8_t flags = 0;
+    esp_rmaker_tlv_copy(&tlv->fields[ESP_RMAKER_TLV_TYPE_FLAGS], &flags, sizeof(flags));
+    const esp_rmaker_tlv_field_t *batch_field = &tlv->fields[ESP_RMAKER_TLV_TYPE_DATA];
+    const void *batch = batch_field->value;
+    void *batch_buf = NULL;
+    void *resp_buf = NULL;
+    esp_err_t err = ESP_ERR_NO_MEM;
+    esp_rmaker_cmd_batch_entry_t *entries = MEM_CALLOC_EXTRAM(CMD_BATCH_MAX, sizeof(esp_rmaker_cmd_batch_entry_t));
+    if (!entries) {
+        ESP_LOGE(TAG, "Failed to allocate batch of %d commands.", CMD_BATCH_MAX);
+        return ESP_ERR_NO_MEM;
+    }
+    if (batch_field->records > 1) {
+        /* The cursor reads the batch in one piece */
+        batch_buf = MEM_ALLOC_EXTRAM(batch_field->len);
+        if (!batch_buf) {
+            ESP_LOGE(TAG, "Failed to allocate buffer of size %zu for batch.", batch_field->len);
+            goto exit;
+        }
+        esp_rmaker_tlv_copy(batch_field, batch_buf, batch_field->len);
+        batch = batch_buf;
+    }
+    /* All the commands are read first, so that none runs if the batch is not valid */
+    int count = esp_rmaker_cmd_parse_batch(batch, batch_field->len, entries);
+    if (count <= 0) {
+        ESP_LOGE(TAG, "Invalid batch of commands.");
+        err = esp_rmaker_cmd_prepare_response(cmd_ctx, ESP_RMAKER_CMD_STATUS_CMD_INVALID, NULL, 0, output, output_len);
+        goto exit;
+    }
+    ESP_LOGD(TAG, "Running batch of %d commands.", count);
+
+    uint8_t status = ESP_RMAKER_CMD_STATUS_SUCCESS;
+    int run = 0;
+    size_t resp_size = 0;
+    while (run < count) {
+        esp_rmaker_cmd_batch_entry_t *entry = &entries[run++];
+        esp_rmaker_cmd_ctx_t entry_ctx = *cmd_ctx;
+        entry_ctx.cmd = entry->cmd;
+        esp_rmaker_cmd_execute(&entry_ctx, &entry->data, &entry->result);
+        resp_size += esp_rmaker_tlv_encoded_size(sizeof(entry->cmd)) + esp_rmaker_tlv_encoded_size(sizeof(status));
+        if (entry->result.status != ESP_RMAKER_CMD_STATUS_SUCCESS) {
+            status = ESP_RMAKER_CMD_STATUS_FAILED;
+            if (flags & ESP_RMAKER_CMD_BATCH_STOP_ON_ERROR) {
+                break;
+            }
+        } else if (entry->result.response && entry->result.response_size) {
+            resp_size += esp_rmaker_tlv_encoded_size(entry->result.response_size);
+        }
+    }
+    if (run < count) {
+        ESP_LOGD(TAG, "Batch stopped after %d of %d commands.", run, count);
+    }
+
+    resp_buf = MEM_ALLOC_EXTRAM(resp_size);
+    if (!resp_buf) {
+        ESP_LOGE(TAG, "Failed to allocate buffer of size %zu for batch response.", resp_size);
+        goto exit;
+    }
+    esp_rmaker_tlv_writer_t writer;
+    esp_rmaker_tlv_writer_init(&writer, resp_buf, resp_size);
+    for (int i = 0; i < run; i++) {
+        const esp_rmaker_cmd_batch_entry_t *entry = &entries[i];
+        uint8_t cmd_buf[2];
+        put_u16_le(cmd_buf, entry->cmd);
+        esp_rmaker_tlv_put(&writer, ESP_RMAKER_TLV_TYPE_CMD, cmd_buf, sizeof(cmd_buf));
+        esp_rmaker_tlv_put(&writer, ESP_RMAKER_TLV_TYPE_STATUS, &entry->result.status, sizeof(entry->result.status));
+        if (entry->result.status == ESP_RMAKER_CMD_STATUS_SUCCESS && entry->result.response && entry->result.response_size) {
+            esp_rmaker_tlv_put(&writer, ESP_RMAKER_TLV_TYPE_DATA, entry->result.response, entry->result.response_size);
         }
     }
-    ESP_LOGE(TAG, "Cannot unregister command %d as it wasn't registered.", cmd);
-    return ESP_ERR_INVALID_ARG;
+    err = esp_rmaker_cmd_prepare_response(cmd_ctx, status, resp_buf, writer.len, output, output_len);
+
+exit:
+    for (int i = 0; i < CMD_BATCH_MAX; i++) {
+        esp_rmaker_cmd_free_result(&entries[i].result);
+    }
+    free(entries);
+    free(batch_buf);
+    free(resp_buf);
+    return err;
 }
 
 /* Main command response handling function.
@@ -311,56 +443,38 @@ esp_err_t esp_rmaker_cmd_response_handler(const void *input, size_t input_len, v
     esp_rmaker_cmd_ctx_t cmd_ctx = {0};
 
     /* Read request id, user role and command, since these are mandatory fields */
-    esp_rmaker_get_value_from_tlv(input, input_len, ESP_RMAKER_TLV_TYPE_REQ_ID, &cmd_ctx.req_id, sizeof(cmd_ctx.req_id));
-    esp_rmaker_get_value_from_tlv(input, input_len, ESP_RMAKER_TLV_TYPE_USER_ROLE, &cmd_ctx.user_role, sizeof(cmd_ctx.user_role));
-    uint8_t cmd_buf[2] = {0};
-    esp_rmaker_get_value_from_tlv(input, input_len, ESP_RMAKER_TLV_TYPE_CMD, cmd_buf, sizeof(cmd_buf));
-    cmd_ctx.cmd = get_u16_le(cmd_buf);
+    esp_rmaker_tlv_index_t tlv;
+    if (esp_rmaker_tlv_index(&tlv, input, input_len) == 0) {
+        /* Leaving room for the NULL termination */
+        esp_rmaker_tlv_copy(&tlv.fields[ESP_RMAKER_TLV_TYPE_REQ_ID], cmd_ctx.req_id, sizeof(cmd_ctx.req_id) - 1);
+        esp_rmaker_tlv_copy(&tlv.fields[ESP_RMAKER_TLV_TYPE_USER_ROLE], &cmd_ctx.user_role, sizeof(cmd_ctx.user_role));
+        uint8_t cmd_buf[2] = {0};
+        esp_rmaker_tlv_copy(&tlv.fields[ESP_RMAKER_TLV_TYPE_CMD], cmd_buf, sizeof(cmd_buf));
+        cmd_ctx.cmd = get_u16_le(cmd_buf);
+    } else {
+        ESP_LOGE(TAG, "Malformed TLV data of length %zu.", input_len);
+    }
 
     if (strlen(cmd_ctx.req_id) == 0 || cmd_ctx.user_role == 0 || cmd_ctx.cmd == 0) {
         ESP_LOGE(TAG, "Request id, user role or command id cannot be 0");
         return esp_rmaker_cmd_prepare_response(&cmd_ctx, ESP_RMAKER_CMD_STATUS_CMD_INVALID, NULL, 0, output, output_len);
     }
-    ESP_LOGI(TAG, "Got Req. Id: %s, Role = %s, Cmd = %d", cmd_ctx.req_id,
+    ESP_LOGD(TAG, "Got Req. Id: %s, Role = %s, Cmd = %d", cmd_ctx.req_id,
              esp_rmaker_get_user_role_string(cmd_ctx.user_role), cmd_ctx.cmd);
 
-    /* Search for the command info and handle it if found */
-    esp_rmaker_cmd_info_t *cmd_info = esp_rmaker_get_cmd_info(cmd_ctx.cmd);
-    if (cmd_info) {
-        if (cmd_info->access & cmd_ctx.user_role) {
-            void *data = NULL;
-            int data_size = esp_rmaker_get_tlv_length(input, input_len, ESP_RMAKER_TLV_TYPE_DATA);
-            if (data_size > 0) {
-                /* TODO: If data size < 255, can just use the pointer to input */
-                data = MEM_CALLOC_EXTRAM(1, data_size);
-                if (!data) {
-                    ESP_LOGE(TAG, "Failed to allocate buffer of size %d for data.", data_size);
-                    return ESP_ERR_NO_MEM;
-                }
-                esp_rmaker_get_value_from_tlv(input, input_len, ESP_RMAKER_TLV_TYPE_DATA, data, data_size);
-            } else {
-                /* It is not mandatory to have data for a given command. So, just throwing a warning */
-                ESP_LOGW(TAG, "No data received for the command.");
-                data_size = 0;
-            }
-            void *response;
-            size_t response_size = 0;
-            esp_err_t err = cmd_info->handler(data, data_size, &response, &response_size, &cmd_ctx, cmd_info->priv);
-            if (err == ESP_OK) {
-                err = esp_rmaker_cmd_prepare_response(&cmd_ctx, ESP_RMAKER_CMD_STATUS_SUCCESS, response, response_size, output, output_len);
-            } else {
-                err = esp_rmaker_cmd_prepare_response(&cmd_ctx, ESP_RMAKER_CMD_STATUS_FAILED, NULL, 0, output, output_len);
-            }
-            if (response && cmd_info->free_on_return) {
-                ESP_LOGI(TAG, "Freeing response buffer.");
-                free(response);
-            }
-            return err;
-        } else {
-            return esp_rmaker_cmd_prepare_response(&cmd_ctx, ESP_RMAKER_CMD_STATUS_AUTH_FAIL, NULL, 0, output, output_len);
-        }
+    if (cmd_ctx.cmd == ESP_RMAKER_CMD_TYPE_BATCH) {
+        return esp_rmaker_cmd_handle_batch(&cmd_ctx, &tlv, output, output_len);
+    }
+    esp_rmaker_cmd_result_t result;
+    esp_rmaker_cmd_execute(&cmd_ctx, &tlv.fields[ESP_RMAKER_TLV_TYPE_DATA], &result);
+    esp_err_t err;
+    if (result.status == ESP_RMAKER_CMD_STATUS_SUCCESS) {
+        err = esp_rmaker_cmd_prepare_response(&cmd_ctx, result.status, result.response, result.response_size, output, output_len);
+    } else {
+        err = esp_rmaker_cmd_prepare_response(&cmd_ctx, result.status, NULL, 0, output, output_len);
     }
-    return esp_rmaker_cmd_prepare_response(&cmd_ctx, ESP_RMAKER_CMD_STATUS_NOT_FOUND, NULL, 0, output, output_len);
+    esp_rmaker_cmd_free_result(&result);
+    return err;
 }
 
 /****************************************** Testing Functions ******************************************/
@@ -381,48 +495,27 @@ esp_err_t esp_rmaker_cmd_resp_test_send(const char *req_id, uint8_t role, uint16
         return ESP_ERR_INVALID_ARG;
     }
     uint8_t cmd_data[200];
-    esp_rmaker_tlv_data_t tlv_data;
-    esp_rmaker_tlv_data_init(&tlv_data, cmd_data, sizeof(cmd_data));
-    if (req_id) {
-        esp_rmaker_add_tlv(&tlv_data, ESP_RMAKER_TLV_TYPE_REQ_ID, strlen(req_id), req_id);
-    }
-    esp_rmaker_add_tlv(&tlv_data, ESP_RMAKER_TLV_TYPE_USER_ROLE, sizeof(role), &role);
-    uint8_t cmd_buf[2];
-    put_u16_le(cmd_buf, cmd);
-    esp_rmaker_add_tlv(&tlv_data, ESP_RMAKER_TLV_TYPE_CMD, sizeof(cmd_buf), cmd_buf);
-    if (data != NULL && data_size != 0) {
-        esp_rmaker_add_tlv(&tlv_data, ESP_RMAKER_TLV_TYPE_DATA, data_size, data);
+    size_t cmd_len = esp_rmaker_cmd_encode(cmd_data, sizeof(cmd_data), req_id, role, CMD_NO_STATUS, cmd, data, data_size);
+    if (cmd_len > sizeof(cmd_data)) {
+        ESP_LOGE(TAG, "Command of size %zu too long to send.", cmd_len);
+        return ESP_ERR_INVALID_SIZE;
     }
-    ESP_LOGI(TAG, "Sending command of size %d for cmd %d", tlv_data.curlen, cmd);
-    return cmd_send(cmd_data, tlv_data.curlen, priv_data);
+    ESP_LOGI(TAG, "Sending command of size %zu for cmd %d", cmd_len, cmd);
+    return cmd_send(cmd_data, cmd_len, priv_data);
 }
 
-// Calculate size of TLV payload for a given length of data.
-// This can be called multiple times to calculate the total size of the TLV payload
-// for multiple TLV entries that will be sent in a single command or response.
-static size_t esp_rmaker_get_tlv_encoded_size(size_t len)
+esp_err_t esp_rmaker_cmd_resp_encode_payload(const char *req_id, uint8_t role, uint16_t cmd_id,
+                                             const void *data, size_t data_size,
+                                             void *buf, size_t buf_size, size_t *output_len)
 {
-    // For L < 255
-    // T -> 1 byte
-    // L -> 1 byte
-    // V -> L bytes
-
-    // For L >= 255
-    // T -> 1 byte
-    // L -> 1 bytes
-    // V -> 255 bytes
-    // T -> 1 byte
-    // L -> 1 bytes
-    // V -> 255 bytes
-    // ...
-    // T -> 1 byte
-    // L -> 1 bytes
-    // V -> len % 255 bytes
-
-    size_t required_packets = (len / 255) + 1;
-    size_t TL_size = (2 * required_packets);
-    size_t V_size = ((required_packets - 1) * 255) + (len % 255);
-    return (TL_size + V_size);
+    if (!output_len) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *output_len = esp_rmaker_cmd_encode(buf, buf_size, req_id, role, CMD_NO_STATUS, cmd_id, data, data_size);
+    if (!buf || *output_len > buf_size) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    return ESP_OK;
 }
 
 esp_err_t esp_rmaker_cmd_resp_prepare_response_payload(const char *req_id, uint8_t role, uint16_t cmd_id,
@@ -433,101 +526,52 @@ esp_err_t esp_rmaker_cmd_resp_prepare_response_payload(const char *req_id, uint8
         return ESP_ERR_INVALID_ARG;
     }
 
-    esp_rmaker_tlv_data_t tlv_data;
-    size_t payload_size = 0;
+    size_t payload_size = esp_rmaker_cmd_encode(NULL, 0, req_id, role, CMD_NO_STATUS, cmd_id, data, data_size);
+    ESP_LOGD(TAG, "Calculated payload size: %zu", payload_size);
 
-    if (req_id) {
-        payload_size += esp_rmaker_get_tlv_encoded_size(strlen(req_id));
-    }
-    if (role != 0) {
-        payload_size += esp_rmaker_get_tlv_encoded_size(sizeof(role));
-    }
-    payload_size += esp_rmaker_get_tlv_encoded_size(sizeof(cmd_id));
-    if (data != NULL && data_size != 0) {
-        payload_size += esp_rmaker_get_tlv_encoded_size(data_size);
-    }
-
-    ESP_LOGD(TAG, "Calculated payload size: %u", payload_size);
-
-    uint8_t *payload_buffer = MEM_CALLOC_EXTRAM(1, payload_size);
+    uint8_t *payload_buffer = MEM_ALLOC_EXTRAM(payload_size);
     if (!payload_buffer) {
         return ESP_ERR_NO_MEM;
     }
-
-    esp_rmaker_tlv_data_init(&tlv_data, payload_buffer, payload_size);
-
-    // tracks the length of the encoded TLV data
-    int encoded_len = -1;
-    if (req_id) {
-        encoded_len = esp_rmaker_add_tlv(&tlv_data, ESP_RMAKER_TLV_TYPE_REQ_ID, strlen(req_id), req_id);
-        if (encoded_len < 0) {
-            ESP_LOGE(TAG, "Failed to add TLV for Request Id.");
-            goto exit;
-        }
-    }
-
-    if (role != 0) {
-        encoded_len = esp_rmaker_add_tlv(&tlv_data, ESP_RMAKER_TLV_TYPE_USER_ROLE, sizeof(role), &role);
-        if (encoded_len < 0) {
-            ESP_LOGE(TAG, "Failed to add TLV for User Role.");
-            goto exit;
-        }
-    }
-
-    uint8_t cmd_buf[2];
-    put_u16_le(cmd_buf, cmd_id);
-    encoded_len = esp_rmaker_add_tlv(&tlv_data, ESP_RMAKER_TLV_TYPE_CMD, sizeof(cmd_buf), cmd_buf);
-    if (encoded_len < 0) {
-        ESP_LOGE(TAG, "Failed to add TLV for Command.");
-        goto exit;
-    }
-
-    if (data != NULL && data_size != 0) {
-        encoded_len = esp_rmaker_add_tlv(&tlv_data, ESP_RMAKER_TLV_TYPE_DATA, data_size, data);
-        if (encoded_len < 0) {
-            ESP_LOGE(TAG, "Failed to add TLV for Data.");
-            goto exit;
-        }
-    }
-
-exit:
-    if (encoded_len < 0) {
-        free(payload_buffer);
-        return ESP_FAIL;
-    }
-
+    esp_rmaker_cmd_encode(payload_buffer, payload_size, req_id, role, CMD_NO_STATUS, cmd_id, data, data_size);
     *output = payload_buffer;
-    *output_len = tlv_data.curlen;
-    ESP_LOGD(TAG, "Actual payload length: %d", tlv_data.curlen);
+    *output_len = payload_size;
     return ESP_OK;
 }
 
 /* Parse response */
 esp_err_t esp_rmaker_cmd_resp_parse_response(const void *response, size_t response_len, void *priv_data)
 {
+    (void)priv_data;
     if (!response) {
         ESP_LOGE(TAG, "NULL response. Cannot parse.");
         return ESP_ERR_INVALID_ARG;
     }
+    esp_rmaker_tlv_index_t tlv;
+    if (esp_rmaker_tlv_index(&tlv, response, response_len) != 0) {
+        ESP_LOGE(TAG, "Malformed response of length %zu.", response_len);
+        return ESP_ERR_INVALID_ARG;
+    }
     char req_id[REQ_ID_LEN] = {0};
-    if (esp_rmaker_get_value_from_tlv(response, response_len, ESP_RMAKER_TLV_TYPE_REQ_ID, req_id, sizeof(req_id)) > 0) {
+    if (esp_rmaker_tlv_copy(&tlv.fields[ESP_RMAKER_TLV_TYPE_REQ_ID], req_id, sizeof(req_id) - 1) > 0) {
         ESP_LOGI(TAG, "RESP: Request Id: %s", req_id);
     }
 
     uint16_t cmd;
     uint8_t cmd_buf[2];
-    if (esp_rmaker_get_value_from_tlv(response, response_len, ESP_RMAKER_TLV_TYPE_CMD, cmd_buf, sizeof(cmd_buf)) > 0) {
+    if (esp_rmaker_tlv_copy(&tlv.fields[ESP_RMAKER_TLV_TYPE_CMD], cmd_buf, sizeof(cmd_buf)) == sizeof(cmd_buf)) {
         cmd = get_u16_le(cmd_buf);
         ESP_LOGI(TAG, "RESP: Command: %" PRIu16, cmd);
     }
 
     uint8_t status;
-    if (esp_rmaker_get_value_from_tlv(response, response_len, ESP_RMAKER_TLV_TYPE_STATUS, &status, sizeof(status)) > 0) {
-        ESP_LOGI(TAG, "RESP: Status: %" PRIu8 ": %s", status, cmd_status[status]);
+    if (esp_rmaker_tlv_copy(&tlv.fields[ESP_RMAKER_TLV_TYPE_STATUS], &status, sizeof(status)) > 0) {
+        ESP_LOGI(TAG, "RESP: Status: %" PRIu8 ": %s", status,
+                 status < ESP_RMAKER_CMD_STATUS_MAX ? cmd_status[status] : "Unknown");
     }
 
     char resp_data[200];
-    int resp_size = esp_rmaker_get_value_from_tlv(response, response_len, ESP_RMAKER_TLV_TYPE_DATA, resp_data, sizeof(resp_data));
+    int resp_size = esp_rmaker_tlv_copy(&tlv.fields[ESP_RMAKER_TLV_TYPE_DATA], resp_data, sizeof(resp_data) - 1);
     if (resp_size > 0) {
         resp_data[resp_size] = 0;
         ESP_LOGI(TAG, "RESP: Data: %s", resp_data);
@@ -0,0 +1,119 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include "cmd_resp_tlv.h"
+
+/* Longest value in a record, which a record of the same type continues */
+#define TLV_RECORD_MAX  255
+
+void esp_rmaker_tlv_cursor_init(esp_rmaker_tlv_cursor_t *cursor, const void *buf, size_t len)
+{
+    cursor->next = buf;
+    cursor->end = buf ? cursor->next + len : NULL;
+}
+
+int esp_rmaker_tlv_next(esp_rmaker_tlv_cursor_t *cursor, uint8_t *type, esp_rmaker_tlv_field_t *field)
+{
+    const uint8_t *p = cursor->next;
+    const uint8_t *end = cursor->end;
+    if (p == end) {
+        return 0;
+    }
+    *type = p[0];
+    field->value = p + 2;
+    field->len = 0;
+    field->records = 0;
+    uint8_t record_len;
+    do {
+        if (end - p < 2 || end - p - 2 < p[1]) {
+            return -1;
+        }
+        record_len = p[1];
+        field->len += record_len;
+        field->records++;
+        p += 2 + record_len;
+        /* A full record is continued by the next one of the same type */
+    } while (record_len == TLV_RECORD_MAX && p < end && p[0] == *type);
+    cursor->next = p;
+    return 1;
+}
+
+int esp_rmaker_tlv_index(esp_rmaker_tlv_index_t *index, const void *buf, size_t len)
+{
+    memset(index, 0, sizeof(*index));
+    if (!buf) {
+        return len ? -1 : 0;
+    }
+    esp_rmaker_tlv_cursor_t cursor;
+    esp_rmaker_tlv_cursor_init(&cursor, buf, len);
+    uint8_t type;
+    esp_rmaker_tlv_field_t field;
+    int ret;
+    while ((ret = esp_rmaker_tlv_next(&cursor, &type, &field)) > 0) {
+        if (type <= ESP_RMAKER_TLV_MAX_TYPE && !index->fields[type].value) {
+            index->fields[type] = field;
+        }
+    }
+    return ret;
+}
+
+int esp_rmaker_tlv_copy(const esp_rmaker_tlv_field_t *field, void *dst, size_t size)
+{
+    if (!field->value || field->len > size) {
+        return -1;
+    }
+    /* The records follow each other, all of them full but the last */
+    const uint8_t *src = field->value;
+    uint8_t *out = dst;
+    size_t left = field->len;
+    while (left > TLV_RECORD_MAX) {
+        memcpy(out, src, TLV_RECORD_MAX);
+        out += TLV_RECORD_MAX;
+        src += TLV_RECORD_MAX + 2;
+        left -= TLV_RECORD_MAX;
+    }
+    if (left) {
+        memcpy(out, src, left);
+    }
+    return field->len;
+}
+
+size_t esp_rmaker_tlv_encoded_size(size_t len)
+{
+    size_t records = len ? (len + TLV_RECORD_MAX - 1) / TLV_RECORD_MAX : 1;
+    return 2 * records + len;
+}
+
+void esp_rmaker_tlv_writer_init(esp_rmaker_tlv_writer_t *writer, void *buf, size_t size)
+{
+    writer->buf = buf;
+    writer->size = buf ? size : 0;
+    writer->len = 0;
+}
+
+int esp_rmaker_tlv_put(esp_rmaker_tlv_writer_t *writer, uint8_t type, const void *value, size_t len)
+{
+    size_t encoded = esp_rmaker_tlv_encoded_size(len);
+    if ((len && !value) || encoded > writer->size - writer->len) {
+        return -1;
+    }
+    uint8_t *out = writer->buf + writer->len;
+    const uint8_t *src = value;
+    do {
+        size_t record_len = len > TLV_RECORD_MAX ? TLV_RECORD_MAX : len;
+        out[0] = type;
+        out[1] = record_len;
+        if (record_len) {
+            memcpy(out + 2, src, record_len);
+            src += record_len;
+        }
+        out += 2 + record_len;
+        len -= record_len;
+    } while (len);
+    writer->len += encoded;
+    return encoded;
+}
@@ -0,0 +1,100 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*
+ * TLV8 of the command-response framework: a type byte, a length byte and the value. Values
+ * longer than 254 bytes are split into records of 255 bytes of the same type, the last one
+ * shorter, unless the value fills it.
+ *
+ * A buffer is indexed in one pass, which checks every record against the end of the buffer
+ * and notes where each type starts, so that reading the fields does not scan it again. Buffers
+ * of repeated types, like batches of commands, are read in order with a cursor instead.
+ * Values in a single record are read in place. Encoding writes into a buffer given by the
+ * caller, whose size can be worked out beforehand with esp_rmaker_tlv_encoded_size().
+ *
+ * Plain C, so that it can be built on the host by tools/cmd_resp_fuzz.c and
+ * tools/cmd_resp_tlv_bench.c.
+ */
+
+/* Types indexed, the ones above are skipped */
+#define ESP_RMAKER_TLV_MAX_TYPE     7
+
+typedef struct {
+    const uint8_t *value;       /* First record's value, NULL if the type is not in the buffer */
+    size_t len;                 /* Of the whole value */
+    size_t records;
+} esp_rmaker_tlv_field_t;
+
+typedef struct {
+    esp_rmaker_tlv_field_t fields[ESP_RMAKER_TLV_MAX_TYPE + 1];
+} esp_rmaker_tlv_index_t;
+
+typedef struct {
+    const uint8_t *next;
+    const uint8_t *end;
+} esp_rmaker_tlv_cursor_t;
+
+typedef struct {
+    uint8_t *buf;
+    size_t size;
+    size_t len;
+} esp_rmaker_tlv_writer_t;
+
+void esp_rmaker_tlv_cursor_init(esp_rmaker_tlv_cursor_t *cursor, const void *buf, size_t len);
+
+/**
+ * @brief Reads the next value, for buffers where types come more than once, in an order which matters
+ *
+ * @param[out] type Type of the value
+ * @param[out] field The value, with the records it takes put together
+ *
+ * @return 1 if a value was read, 0 at the end of the buffer, -1 if a record runs past it
+ */
+int esp_rmaker_tlv_next(esp_rmaker_tlv_cursor_t *cursor, uint8_t *type, esp_rmaker_tlv_field_t *field);
+
+/**
+ * @brief Indexes the records of a buffer
+ *
+ * If a type comes more than once, the first value is kept, as it was by the former parser.
+ *
+ * @return 0 on success, -1 if a record runs past the end of the buffer
+ */
+int esp_rmaker_tlv_index(esp_rmaker_tlv_index_t *index, const void *buf, size_t len);
+
+/**
+ * @brief Copies a value, putting its records together
+ *
+ * @return the length copied, -1 if the type is not in the buffer or the value is longer than size
+ */
+int esp_rmaker_tlv_copy(const esp_rmaker_tlv_field_t *field, void *dst, size_t size);
+
+/**
+ * @brief Bytes a value of the given length takes once encoded
+ */
+size_t esp_rmaker_tlv_encoded_size(size_t len);
+
+void esp_rmaker_tlv_writer_init(esp_rmaker_tlv_writer_t *writer, void *buf, size_t size);
+
+/**
+ * @brief Encodes a value after the ones already written
+ *
+ * @return the bytes written, -1 if the value does not fit, in which case nothing is written
+ */
+int esp_rmaker_tlv_put(esp_rmaker_tlv_writer_t *writer, uint8_t type, const void *value, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
@@ -25,6 +25,8 @@
 #endif
 
 #include <esp_rmaker_utils.h>
+#include <esp_rmaker_work_queue.h>
+#include <esp_rmaker_mqtt_glue.h>
 
 
 static const char *TAG = "rmaker_common_cmds";
@@ -100,6 +102,40 @@ static int mem_dump_cli_handler(int argc, char *argv[])
     return 0;
 }
 
+static int work_queue_cli_handler(int argc, char *argv[])
+{
+    if (argc > 1 && strcmp(argv[1], "reset") == 0) {
+        esp_rmaker_work_queue_reset_stats();
+        return 0;
+    }
+    static const char *prio_names[ESP_RMAKER_WORK_PRIO_MAX] = { "urgent", "normal", "background" };
+    printf("%s: \tPriority\tDepth\tMaxDepth\tQueued\tDropped\tExecuted\tAvgWait(ms)\tMaxWait(ms)\n", TAG);
+    for (int prio = 0; prio < ESP_RMAKER_WORK_PRIO_MAX; prio++) {
+        esp_rmaker_work_queue_stats_t stats;
+        if (esp_rmaker_work_queue_get_stats(prio, &stats) != ESP_OK) {
+            continue;
+        }
+        printf("%16s\t%u\t%u\t%" PRIu32 "\t%" PRIu32 "\t%" PRIu32 "\t%" PRIu32 "\t%" PRIu32 "\n",
+               prio_names[prio], stats.depth, stats.max_depth, stats.queued, stats.dropped,
+               stats.executed, stats.avg_wait_ms, stats.max_wait_ms);
+    }
+    return 0;
+}
+
+static int mqtt_publish_cli_handler(int argc, char *argv[])
+{
+    esp_rmaker_mqtt_publish_stats_t stats;
+    if (esp_rmaker_mqtt_glue_get_publish_stats(&stats) != ESP_OK) {
+        printf("%s: MQTT not initialised\n", TAG);
+        return 0;
+    }
+    printf("%s: Queued\tCoalesced\tRejected\tSent\tAcked\tExpired\tBytes\tMaxBytes\tInflight\n", TAG);
+    printf("%" PRIu32 "\t%" PRIu32 "\t%" PRIu32 "\t%" PRIu32 "\t%" PRIu32 "\t%" PRIu32 "\t%" PRIu32 "\t%" PRIu32 "\t%u\n",
+           stats.queued, stats.coalesced, stats.rejected, stats.sent, stats.acked, stats.expired,
+           stats.bytes, stats.max_bytes, stats.inflight);
+    return 0;
+}
+
 static int sock_dump_cli_handler(int argc, char *argv[])
 {
 #if LWIP_IPV4
@@ -253,6 +289,16 @@ static int register_generic_debug_commands()
             .help = "Get the CPU utilisation by all the runninng tasks.",
             .func = cpu_dump_cli_handler,
         },
+        {
+            .command = "work-queue",
+            .help = "Get the RainMaker Work Queue statistics. Usage: work-queue [reset]",
+            .func = work_queue_cli_handler,
+        },
+        {
+            .command = "mqtt-publish",
+            .help = "Get the MQTT publish queue statistics.",
+            .func = mqtt_publish_cli_handler,
+        },
         {
             .command = "sock-dump",
             .help = "Get the list of all the active sockets.",
@@ -18,13 +18,18 @@
 #include <sdkconfig.h>
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
+#include <freertos/semphr.h>
 #include <esp_log.h>
+#include <esp_timer.h>
 #include <mqtt_client.h>
 #include <esp_event.h>
 #include <esp_rmaker_common_events.h>
 #include <esp_rmaker_mqtt_glue.h>
 #include <esp_idf_version.h>
 #include <esp_rmaker_utils.h>
+#include <esp_rmaker_work_queue.h>
+#include "esp-mqtt-topics.h"
+#include "esp-mqtt-outbox.h"
 #ifdef CONFIG_ESP_RMAKER_MQTT_PORT_443
 #define ESP_RMAKER_MQTT_USE_PORT_443
 #endif
@@ -36,8 +41,6 @@
 
 static const char *TAG = "esp_mqtt_glue";
 
-#define MAX_MQTT_SUBSCRIPTIONS      CONFIG_ESP_RMAKER_MAX_MQTT_SUBSCRIPTIONS
-
 /* Subscription states for tracking subscription lifecycle */
 typedef enum {
     MQTT_SUB_STATE_NONE = 0,        /* Not subscribed */
@@ -46,97 +49,190 @@ typedef enum {
     MQTT_SUB_STATE_FAILED           /* Subscription failed */
 } mqtt_subscription_state_t;
 
-typedef struct {
+typedef struct esp_mqtt_glue_subscription {
+    esp_mqtt_topic_entry_t entry;   /* In the topic tree, entry.next is the next subscription on the same topic */
     char *topic;
     esp_rmaker_mqtt_subscribe_cb_t cb;
     void *priv;
     mqtt_subscription_state_t state;
     int msg_id;                     /* Message ID from last subscribe request */
     uint8_t qos;                    /* QoS level for this subscription */
+    struct esp_mqtt_glue_subscription *next;    /* Next subscription, in the order they were added */
 } esp_mqtt_glue_subscription_t;
 
 typedef struct {
     esp_mqtt_client_handle_t mqtt_client;
     esp_rmaker_mqtt_conn_params_t *conn_params;
-    esp_mqtt_glue_subscription_t *subscriptions[MAX_MQTT_SUBSCRIPTIONS];
+    esp_mqtt_glue_subscription_t *subscriptions;
+    esp_mqtt_topics_t topics;       /* Subscriptions by topic, for the dispatch of messages */
+    SemaphoreHandle_t subs_lock;    /* Recursive, for the above, held while dispatching a message */
 } esp_mqtt_glue_data_t;
 esp_mqtt_glue_data_t *mqtt_data;
 
+/* Topics as received, pointing into the MQTT buffer and not NULL terminated */
 typedef struct {
-    char *data;
-    char *topic;
+    const char *name;
+    int len;
+} esp_mqtt_glue_topic_t;
+
+/* Topics are made NULL terminated on the stack, or on the heap if they are longer than this */
+#define MQTT_TOPIC_BUF_SIZE         128
+
+#define MQTT_RX_BUF_SIZE            CONFIG_ESP_RMAKER_MQTT_RX_BUF_SIZE
+
+/* Message longer than the MQTT buffer, being put together from its fragments.
+ * esp-mqtt hands over the fragments of one message at a time, so there is only one of these.
+ */
+typedef struct {
+    char *data;                     /* NULL if no message is being put together */
+    int total_len;
+    char topic[MQTT_TOPIC_BUF_SIZE];
+    char *topic_str;                /* topic, or an allocation for topics which do not fit into it */
 } esp_mqtt_glue_long_data_t;
 
+static esp_mqtt_glue_long_data_t s_long_data;
+
+/* Subscriptions removed from a callback are freed, and the topic tree is pruned, once the message
+ * has been handed to all of them. Under subs_lock, which the dispatching task holds meanwhile.
+ */
+static bool s_dispatching;
+static bool s_prune_pending;
+static esp_mqtt_glue_subscription_t *s_removed_subscriptions;
+/* Kept for all messages which fit, allocated on first use */
+static char *s_rx_buf;
+
+#define PUBLISH_TIMEOUT_US          ((int64_t)CONFIG_ESP_RMAKER_MQTT_PUBLISH_TIMEOUT * 1000000)
+
+/* Messages are published from the queue by one task at a time: the work queue, after a publish,
+ * or the MQTT task, once there is room in the window or the connection is back.
+ */
+typedef struct {
+    esp_mqtt_outbox_t outbox;
+    SemaphoreHandle_t lock;
+    bool connected;
+    bool draining;              /* A task is publishing from the queue, and takes what is queued meanwhile */
+    bool drain_queued;          /* On the work queue */
+    esp_mqtt_topics_t coalesce_topics;
+    esp_mqtt_topic_entry_t *coalesce_entries;
+    int num_coalesce_entries;
+} esp_mqtt_glue_publish_queue_t;
+
+static esp_mqtt_glue_publish_queue_t s_publish;
+
 static void esp_mqtt_glue_deinit(void);
 
-/**
- * @brief Check if an MQTT topic matches a subscription pattern with wildcards
- * 
- * Supports MQTT single-level wildcard:
- * - '+' matches a single level (e.g., "node/+/params" matches "node/device1/params")
- * 
- * @param topic_filter The subscription pattern (may contain '+' wildcards)
- * @param topic_name The actual topic name to match
- * @param topic_len Length of the topic name
- * @return true if the topic matches the filter, false otherwise
+/* The lock is not held while calling into the MQTT client, as the MQTT task holds the client's
+ * lock while it dispatches messages. Only the MQTT task itself, from its events and from the
+ * subscription callbacks, calls the client under it.
  */
-static bool mqtt_topic_matches(const char *topic_filter, const char *topic_name, int topic_len)
-{
-    const char *filter_pos = topic_filter;
-    const char *topic_pos = topic_name;
-    int topic_consumed = 0;
-
-    while (*filter_pos && topic_consumed < topic_len) {
-        if (*filter_pos == '+') {
-            // Single-level wildcard - skip to next '/' or end of topic
-            while (topic_consumed < topic_len && *topic_pos != '/') {
-                topic_pos++;
-                topic_consumed++;
-            }
-            filter_pos++;
-        } else if (*filter_pos == *topic_pos) {
-            // Characters match, advance both
-            filter_pos++;
-            topic_pos++;
-            topic_consumed++;
-        } else {
-            // Characters don't match
-            return false;
-        }
-    }
+static inline void esp_mqtt_glue_lock_subscriptions(void)
+{
+    xSemaphoreTakeRecursive(mqtt_data->subs_lock, portMAX_DELAY);
+}
 
-    // Both strings must be fully consumed
-    return (*filter_pos == '\0' && topic_consumed == topic_len);
+static inline void esp_mqtt_glue_unlock_subscriptions(void)
+{
+    xSemaphoreGiveRecursive(mqtt_data->subs_lock);
 }
 
 /* Helper function to reset all subscription states */
 static void esp_mqtt_glue_reset_subscription_states(void)
 {
-    for (int i = 0; i < MAX_MQTT_SUBSCRIPTIONS; i++) {
-        if (mqtt_data->subscriptions[i]) {
-            mqtt_data->subscriptions[i]->state = MQTT_SUB_STATE_NONE;
-        }
+    for (esp_mqtt_glue_subscription_t *sub = mqtt_data->subscriptions; sub; sub = sub->next) {
+        sub->state = MQTT_SUB_STATE_NONE;
     }
 }
 
-static void esp_mqtt_glue_subscribe_callback(const char *topic, int topic_len, const char *data, int data_len)
+/* First subscription on the same topic as sub, possibly sub itself */
+static inline esp_mqtt_glue_subscription_t *esp_mqtt_glue_topic_subscriptions(esp_mqtt_glue_subscription_t *sub)
 {
-    esp_mqtt_glue_subscription_t **subscriptions = mqtt_data->subscriptions;
-    int i;
-    for (i = 0; i < MAX_MQTT_SUBSCRIPTIONS; i++) {
-        if (subscriptions[i]) {
-            if ((mqtt_topic_matches(subscriptions[i]->topic, topic, topic_len))) {
-                char *actual_topic = strndup(topic, topic_len);
-                if (!actual_topic) {
-                    ESP_LOGE(TAG, "Failed to allocate memory for actual topic");
-                    return;
-                }
-                /* send the actual topic to the callback */
-                subscriptions[i]->cb(actual_topic, (void *)data, data_len, subscriptions[i]->priv);
-                free(actual_topic);
-            }
+    return (esp_mqtt_glue_subscription_t *)sub->entry.node->entries;
+}
+
+static inline esp_mqtt_glue_subscription_t *esp_mqtt_glue_next_on_topic(esp_mqtt_glue_subscription_t *sub)
+{
+    return (esp_mqtt_glue_subscription_t *)sub->entry.next;
+}
+
+static void esp_mqtt_glue_free_subscription(esp_mqtt_glue_subscription_t *subscription)
+{
+    free(subscription->topic);
+    free(subscription);
+}
+
+static void esp_mqtt_glue_prune_topics(void)
+{
+    if (s_dispatching) {
+        s_prune_pending = true;
+        return;
+    }
+    s_prune_pending = false;
+    esp_mqtt_topics_prune(&mqtt_data->topics);
+}
+
+/* Copies the topic to buf as a NULL terminated string, or to an allocation if it doesn't fit */
+static char *esp_mqtt_glue_topic_str(esp_mqtt_glue_topic_t topic, char *buf, size_t buf_size)
+{
+    if ((size_t)topic.len < buf_size) {
+        memcpy(buf, topic.name, topic.len);
+        buf[topic.len] = '\0';
+        return buf;
+    }
+    return strndup(topic.name, topic.len);
+}
+
+typedef struct {
+    esp_mqtt_glue_topic_t topic;
+    char *topic_str;
+    char buf[MQTT_TOPIC_BUF_SIZE];
+    const char *data;
+    int data_len;
+} esp_mqtt_glue_message_t;
+
+static void esp_mqtt_glue_deliver(esp_mqtt_topic_entry_t *entry, void *arg)
+{
+    esp_mqtt_glue_subscription_t *subscription = (esp_mqtt_glue_subscription_t *)entry;
+    esp_mqtt_glue_message_t *msg = arg;
+    if (!msg->topic_str) {
+        msg->topic_str = esp_mqtt_glue_topic_str(msg->topic, msg->buf, sizeof(msg->buf));
+        if (!msg->topic_str) {
+            ESP_LOGE(TAG, "Failed to allocate memory for actual topic");
+            return;
         }
     }
+    /* send the actual topic to the callback */
+    subscription->cb(msg->topic_str, (void *)msg->data, msg->data_len, subscription->priv);
+}
+
+/* topic_str is the NULL terminated topic, if the caller already has it. Else, it is made only
+ * once a subscription matches, and only once for all the matching subscriptions.
+ */
+static void esp_mqtt_glue_subscribe_callback(esp_mqtt_glue_topic_t topic, char *topic_str,
+        const char *data, int data_len)
+{
+    esp_mqtt_glue_message_t msg = {
+        .topic = topic,
+        .topic_str = topic_str,
+        .data = data,
+        .data_len = data_len,
+    };
+    esp_mqtt_glue_lock_subscriptions();
+    s_dispatching = true;
+    esp_mqtt_topics_match(&mqtt_data->topics, topic.name, topic.len, esp_mqtt_glue_deliver, &msg);
+    s_dispatching = false;
+
+    while (s_removed_subscriptions) {
+        esp_mqtt_glue_subscription_t *subscription = s_removed_subscriptions;
+        s_removed_subscriptions = subscription->next;
+        esp_mqtt_glue_free_subscription(subscription);
+    }
+    if (s_prune_pending) {
+        esp_mqtt_glue_prune_topics();
+    }
+    esp_mqtt_glue_unlock_subscriptions();
+    if (msg.topic_str != topic_str && msg.topic_str != msg.buf) {
+        free(msg.topic_str);
+    }
 }
 
 /*
@@ -154,32 +250,51 @@ static inline int _esp_mqtt_client_subscribe(esp_mqtt_client_handle_t client, co
 #endif
 }
 
+/* Subscription of cb on topic, if it is still there. Under subs_lock. */
+static esp_mqtt_glue_subscription_t *esp_mqtt_glue_find_subscription(const char *topic, esp_rmaker_mqtt_subscribe_cb_t cb)
+{
+    esp_mqtt_topic_node_t *node = esp_mqtt_topics_get(&mqtt_data->topics, topic, false);
+    for (esp_mqtt_topic_entry_t *entry = node ? node->entries : NULL; entry; entry = entry->next) {
+        esp_mqtt_glue_subscription_t *sub = (esp_mqtt_glue_subscription_t *)entry;
+        if (sub->cb == cb) {
+            return sub;
+        }
+    }
+    return NULL;
+}
+
 static esp_err_t esp_mqtt_glue_subscribe(const char *topic, esp_rmaker_mqtt_subscribe_cb_t cb, uint8_t qos, void *priv_data)
 {
     if (!mqtt_data || !topic || !cb) {
         return ESP_FAIL;
     }
 
+    if (!esp_mqtt_topics_filter_valid(topic)) {
+        ESP_LOGE(TAG, "Invalid topic filter: %s", topic);
+        return ESP_FAIL;
+    }
+    esp_mqtt_glue_lock_subscriptions();
+    esp_mqtt_topic_node_t *node = esp_mqtt_topics_get(&mqtt_data->topics, topic, true);
+    if (!node) {
+        ESP_LOGE(TAG, "Failed to allocate memory for topic: %s", topic);
+        esp_mqtt_glue_prune_topics();
+        esp_mqtt_glue_unlock_subscriptions();
+        return ESP_FAIL;
+    }
+
     esp_mqtt_glue_subscription_t *existing_entry = NULL;
     bool topic_has_active_subscription = false;
-    int empty_slot = -1;
-
-    /* Single pass: gather all the info we need */
-    for (int i = 0; i < MAX_MQTT_SUBSCRIPTIONS; i++) {
-        if (mqtt_data->subscriptions[i]) {
-            if (strcmp(topic, mqtt_data->subscriptions[i]->topic) == 0) {
-                /* Same topic found */
-                if (cb == mqtt_data->subscriptions[i]->cb) {
-                    /* Same callback too - this is an update */
-                    existing_entry = mqtt_data->subscriptions[i];
-                }
-                /* Check if this topic has an active subscription */
-                if (mqtt_data->subscriptions[i]->state == MQTT_SUB_STATE_ACKNOWLEDGED) {
-                    topic_has_active_subscription = true;
-                }
-            }
-        } else if (empty_slot == -1) {
-            empty_slot = i;
+
+    /* Single pass over the subscriptions on the same topic: gather all the info we need */
+    for (esp_mqtt_topic_entry_t *entry = node->entries; entry; entry = entry->next) {
+        esp_mqtt_glue_subscription_t *sub = (esp_mqtt_glue_subscription_t *)entry;
+        if (cb == sub->cb) {
+            /* Same callback too - this is an update */
+            existing_entry = sub;
+        }
+        /* Check if this topic has an active subscription */
+        if (sub->state == MQTT_SUB_STATE_ACKNOWLEDGED) {
+            topic_has_active_subscription = true;
         }
     }
 
@@ -197,32 +312,33 @@ static esp_err_t esp_mqtt_glue_subscribe(const char *topic, esp_rmaker_mqtt_subs
             need_resubscribe = true;
             ESP_LOGD(TAG, "QoS upgrade requested for topic: %s (%d->%d)", topic, existing_entry->qos, qos);
         }
+        esp_mqtt_glue_unlock_subscriptions();
 
         if (need_resubscribe) {
             int ret = _esp_mqtt_client_subscribe(mqtt_data->mqtt_client, topic, qos);
-            if (ret >= 0) {
+            /* It may have been unsubscribed meanwhile */
+            esp_mqtt_glue_lock_subscriptions();
+            existing_entry = esp_mqtt_glue_find_subscription(topic, cb);
+            if (existing_entry && ret >= 0) {
                 existing_entry->msg_id = ret;
                 existing_entry->state = MQTT_SUB_STATE_REQUESTED;
                 existing_entry->qos = qos;
                 ESP_LOGD(TAG, "Re-subscribing to topic: %s (msg_id: %d, QoS: %d)", topic, ret, qos);
-            } else {
+            } else if (existing_entry) {
                 existing_entry->state = MQTT_SUB_STATE_FAILED;
                 ESP_LOGW(TAG, "Failed to re-subscribe to topic: %s", topic);
             }
+            esp_mqtt_glue_unlock_subscriptions();
         }
         return ESP_OK;
     }
 
-    /* Need to create new entry */
-    if (empty_slot == -1) {
-        ESP_LOGE(TAG, "No space for new subscription to topic: %s", topic);
-        return ESP_FAIL;
-    }
-
     /* Create and populate new subscription */
     esp_mqtt_glue_subscription_t *subscription = calloc(1, sizeof(esp_mqtt_glue_subscription_t));
     if (!subscription) {
         ESP_LOGE(TAG, "Failed to allocate memory for subscription");
+        esp_mqtt_glue_prune_topics();
+        esp_mqtt_glue_unlock_subscriptions();
         return ESP_FAIL;
     }
 
@@ -230,6 +346,8 @@ static esp_err_t esp_mqtt_glue_subscribe(const char *topic, esp_rmaker_mqtt_subs
     if (!subscription->topic) {
         free(subscription);
         ESP_LOGE(TAG, "Failed to allocate memory for topic string");
+        esp_mqtt_glue_prune_topics();
+        esp_mqtt_glue_unlock_subscriptions();
         return ESP_FAIL;
     }
 
@@ -239,19 +357,28 @@ static esp_err_t esp_mqtt_glue_subscribe(const char *topic, esp_rmaker_mqtt_subs
     subscription->state = topic_has_active_subscription ? MQTT_SUB_STATE_ACKNOWLEDGED : MQTT_SUB_STATE_NONE;
 
     /* Add to database first */
-    mqtt_data->subscriptions[empty_slot] = subscription;
+    esp_mqtt_topics_add(node, &subscription->entry);
+    esp_mqtt_glue_subscription_t **link = &mqtt_data->subscriptions;
+    while (*link) {
+        link = &(*link)->next;
+    }
+    *link = subscription;
+    esp_mqtt_glue_unlock_subscriptions();
 
     /* Send MQTT subscribe only if needed */
     if (!topic_has_active_subscription) {
         int ret = _esp_mqtt_client_subscribe(mqtt_data->mqtt_client, topic, qos);
-        if (ret >= 0) {
+        esp_mqtt_glue_lock_subscriptions();
+        subscription = esp_mqtt_glue_find_subscription(topic, cb);
+        if (subscription && ret >= 0) {
             subscription->msg_id = ret;
             subscription->state = MQTT_SUB_STATE_REQUESTED;
             ESP_LOGD(TAG, "Subscribed to topic: %s (msg_id: %d)", topic, ret);
-        } else {
+        } else if (subscription) {
             subscription->state = MQTT_SUB_STATE_FAILED;
             ESP_LOGW(TAG, "MQTT subscribe failed for topic: %s, keeping in DB for retry", topic);
         }
+        esp_mqtt_glue_unlock_subscriptions();
     } else {
         ESP_LOGD(TAG, "Added callback for already-subscribed topic: %s", topic);
     }
@@ -259,34 +386,52 @@ static esp_err_t esp_mqtt_glue_subscribe(const char *topic, esp_rmaker_mqtt_subs
     return ESP_OK;
 }
 
-static void unsubscribe_helper(esp_mqtt_glue_subscription_t **subscription)
+/* Takes the subscription out, under subs_lock. Returns its topic if it was the last one on it,
+ * for the caller to unsubscribe from with esp_mqtt_glue_client_unsubscribe() once unlocked.
+ */
+static char *unsubscribe_helper(esp_mqtt_glue_subscription_t *subscription)
 {
-    if (subscription && *subscription) {
-        /* Only send MQTT unsubscribe if this is the last subscription for this topic */
-        bool other_subscription_exists = false;
-        for (int i = 0; i < MAX_MQTT_SUBSCRIPTIONS; i++) {
-            if (mqtt_data->subscriptions[i] &&
-                mqtt_data->subscriptions[i] != *subscription &&
-                strcmp(mqtt_data->subscriptions[i]->topic, (*subscription)->topic) == 0) {
-                other_subscription_exists = true;
-                break;
-            }
-        }
+    /* Only send MQTT unsubscribe if this is the last subscription for this topic */
+    bool other_subscription_exists = esp_mqtt_glue_topic_subscriptions(subscription) != subscription ||
+                                     esp_mqtt_glue_next_on_topic(subscription);
+    char *topic = NULL;
 
-        if (!other_subscription_exists) {
-            if (esp_mqtt_client_unsubscribe(mqtt_data->mqtt_client, (*subscription)->topic) < 0) {
-                ESP_LOGW(TAG, "Could not unsubscribe from topic: %s", (*subscription)->topic);
-            } else {
-                ESP_LOGD(TAG, "Unsubscribed from topic: %s", (*subscription)->topic);
-            }
-        } else {
-            ESP_LOGD(TAG, "Not unsubscribing from topic %s - other callbacks still exist", (*subscription)->topic);
-        }
+    if (!other_subscription_exists) {
+        topic = subscription->topic;
+        subscription->topic = NULL;
+    } else {
+        ESP_LOGD(TAG, "Not unsubscribing from topic %s - other callbacks still exist", subscription->topic);
+    }
+
+    esp_mqtt_topics_remove(&subscription->entry);
+    esp_mqtt_glue_subscription_t **link = &mqtt_data->subscriptions;
+    while (*link != subscription) {
+        link = &(*link)->next;
+    }
+    *link = subscription->next;
+
+    if (s_dispatching) {
+        /* Called from a subscription callback, which may be this one's */
+        subscription->next = s_removed_subscriptions;
+        s_removed_subscriptions = subscription;
+    } else {
+        esp_mqtt_glue_free_subscription(subscription);
+    }
+    esp_mqtt_glue_prune_topics();
+    return topic;
+}
 
-        free((*subscription)->topic);
-        free(*subscription);
-        *subscription = NULL;
+static void esp_mqtt_glue_client_unsubscribe(char *topic)
+{
+    if (!topic) {
+        return;
+    }
+    if (esp_mqtt_client_unsubscribe(mqtt_data->mqtt_client, topic) < 0) {
+        ESP_LOGW(TAG, "Could not unsubscribe from topic: %s", topic);
+    } else {
+        ESP_LOGD(TAG, "Unsubscribed from topic: %s", topic);
     }
+    free(topic);
 }
 
 static esp_err_t esp_mqtt_glue_unsubscribe(const char *topic)
@@ -294,17 +439,126 @@ static esp_err_t esp_mqtt_glue_unsubscribe(const char *topic)
     if (!mqtt_data || !topic) {
         return ESP_FAIL;
     }
-    esp_mqtt_glue_subscription_t **subscriptions = mqtt_data->subscriptions;
-    int i;
-    for (i = 0; i < MAX_MQTT_SUBSCRIPTIONS; i++) {
-        if (subscriptions[i]) {
-            if (strncmp(topic, subscriptions[i]->topic, strlen(topic)) == 0) {
-                unsubscribe_helper(&subscriptions[i]);
-                return ESP_OK;
-            }
+    esp_mqtt_glue_lock_subscriptions();
+    esp_mqtt_topic_node_t *node = esp_mqtt_topics_get(&mqtt_data->topics, topic, false);
+    if (!node || !node->entries) {
+        esp_mqtt_glue_unlock_subscriptions();
+        return ESP_FAIL;
+    }
+    char *unsubscribe_topic = unsubscribe_helper((esp_mqtt_glue_subscription_t *)node->entries);
+    esp_mqtt_glue_unlock_subscriptions();
+    esp_mqtt_glue_client_unsubscribe(unsubscribe_topic);
+    return ESP_OK;
+}
+
+/* Messages dropped, to be reported once the publish queue lock is released */
+#define PUBLISH_EXPIRED_BATCH   8
+
+typedef struct {
+    int msg_ids[PUBLISH_EXPIRED_BATCH];
+    int count;
+} esp_mqtt_glue_expired_t;
+
+static bool esp_mqtt_glue_publish_expired(int msg_id, void *arg)
+{
+    esp_mqtt_glue_expired_t *expired = arg;
+    expired->msg_ids[expired->count++] = msg_id;
+    return expired->count < PUBLISH_EXPIRED_BATCH;
+}
+
+static void esp_mqtt_glue_post_published(int msg_id, int64_t latency_us)
+{
+    esp_rmaker_mqtt_published_t published = {
+        .msg_id = msg_id,
+        .latency_ms = latency_us / 1000,
+    };
+    esp_event_post(RMAKER_COMMON_EVENT, RMAKER_MQTT_EVENT_PUBLISHED, &published, sizeof(published), portMAX_DELAY);
+}
+
+/* Hands the queued messages to the MQTT client, as far as the QoS 1 window allows.
+ * Events are posted without the lock, as their handlers may publish.
+ */
+static void esp_mqtt_glue_drain(void)
+{
+    xSemaphoreTake(s_publish.lock, portMAX_DELAY);
+    if (s_publish.draining) {
+        xSemaphoreGive(s_publish.lock);
+        return;
+    }
+    s_publish.draining = true;
+    esp_mqtt_glue_expired_t expired;
+    do {
+        expired.count = 0;
+        esp_mqtt_outbox_expire(&s_publish.outbox, esp_timer_get_time(), PUBLISH_TIMEOUT_US,
+                               esp_mqtt_glue_publish_expired, &expired);
+        xSemaphoreGive(s_publish.lock);
+        for (int i = 0; i < expired.count; i++) {
+            ESP_LOGW(TAG, "MQTT message %d dropped, not published in time", expired.msg_ids[i]);
+            esp_event_post(RMAKER_COMMON_EVENT, RMAKER_MQTT_EVENT_MSG_DELETED, &expired.msg_ids[i],
+                           sizeof(expired.msg_ids[i]), portMAX_DELAY);
+        }
+        xSemaphoreTake(s_publish.lock, portMAX_DELAY);
+    } while (expired.count == PUBLISH_EXPIRED_BATCH);
+    while (true) {
+        esp_mqtt_outbox_msg_t *msg = s_publish.connected ? esp_mqtt_outbox_pop(&s_publish.outbox) : NULL;
+        if (!msg) {
+            break;
+        }
+        /* Not holding the lock, as the MQTT task takes it for its events */
+        xSemaphoreGive(s_publish.lock);
+        ESP_LOGD(TAG, "Publishing to %s", msg->topic);
+        int64_t now = esp_timer_get_time();
+        int ret = esp_mqtt_client_publish(mqtt_data->mqtt_client, msg->topic, msg->data, msg->len, msg->qos, 0);
+        xSemaphoreTake(s_publish.lock, portMAX_DELAY);
+        int64_t latency_us;
+        int msg_id = esp_mqtt_outbox_sent(&s_publish.outbox, msg, ret, now, &latency_us);
+        if (msg_id > 0) {
+            xSemaphoreGive(s_publish.lock);
+            esp_mqtt_glue_post_published(msg_id, latency_us);
+            xSemaphoreTake(s_publish.lock, portMAX_DELAY);
+        }
+        if (ret < 0) {
+            /* Tried again with the next publish, or MQTT event */
+            ESP_LOGW(TAG, "MQTT Publish failed, will retry");
+            break;
         }
     }
-    return ESP_FAIL;
+    s_publish.draining = false;
+    xSemaphoreGive(s_publish.lock);
+}
+
+static void esp_mqtt_glue_drain_work(void *priv)
+{
+    if (!mqtt_data) {
+        return;
+    }
+    xSemaphoreTake(s_publish.lock, portMAX_DELAY);
+    s_publish.drain_queued = false;
+    xSemaphoreGive(s_publish.lock);
+    esp_mqtt_glue_drain();
+}
+
+/* Gets the queue drained by the work queue, or by the task draining it already */
+static void esp_mqtt_glue_schedule_drain(void)
+{
+    xSemaphoreTake(s_publish.lock, portMAX_DELAY);
+    bool queue = !s_publish.draining && !s_publish.drain_queued;
+    s_publish.drain_queued |= queue;
+    xSemaphoreGive(s_publish.lock);
+
+    if (queue && esp_rmaker_work_queue_add_task_with_prio(esp_mqtt_glue_drain_work, NULL,
+                                                          ESP_RMAKER_WORK_PRIO_URGENT, 0) != ESP_OK) {
+        /* No work queue, or no room in it */
+        xSemaphoreTake(s_publish.lock, portMAX_DELAY);
+        s_publish.drain_queued = false;
+        xSemaphoreGive(s_publish.lock);
+        esp_mqtt_glue_drain();
+    }
+}
+
+static void esp_mqtt_glue_coalesce_match(esp_mqtt_topic_entry_t *entry, void *arg)
+{
+    *(bool *)arg = true;
 }
 
 static esp_err_t esp_mqtt_glue_publish(const char *topic, void *data, size_t data_len, uint8_t qos, int *msg_id)
@@ -312,64 +566,146 @@ static esp_err_t esp_mqtt_glue_publish(const char *topic, void *data, size_t dat
     if (!mqtt_data || !topic || !data) {
         return ESP_FAIL;
     }
-    ESP_LOGD(TAG, "Publishing to %s", topic);
-    int ret = esp_mqtt_client_publish(mqtt_data->mqtt_client, topic, data, data_len, qos, 0);
+    /* As the MQTT client does, QoS 0 messages are not kept while disconnected */
+    if (qos == 0 && !s_publish.connected) {
+        ESP_LOGE(TAG, "MQTT Publish failed, not connected");
+        return ESP_FAIL;
+    }
+    bool coalesce = false;
+    esp_mqtt_topics_match(&s_publish.coalesce_topics, topic, strlen(topic), esp_mqtt_glue_coalesce_match, &coalesce);
+
+    xSemaphoreTake(s_publish.lock, portMAX_DELAY);
+    int ret = esp_mqtt_outbox_push(&s_publish.outbox, topic, data, data_len, qos, coalesce, esp_timer_get_time());
+    xSemaphoreGive(s_publish.lock);
     if (ret < 0) {
-        ESP_LOGE(TAG, "MQTT Publish failed");
+        ESP_LOGE(TAG, "MQTT Publish failed, publish queue full");
         return ESP_FAIL;
     }
+    ESP_LOGD(TAG, "Queued message for %s (msg_id: %d)", topic, ret);
+    esp_mqtt_glue_schedule_drain();
     if (msg_id) {
         *msg_id = ret;
     }
     return ESP_OK;
 }
 
-static esp_mqtt_glue_long_data_t *esp_mqtt_glue_free_long_data(esp_mqtt_glue_long_data_t *long_data)
+/* The acknowledgement, or deletion, of a message by the MQTT client. Returns its ID in the queue. */
+static int esp_mqtt_glue_publish_done(int mqtt_msg_id, int64_t *latency_us)
+{
+    xSemaphoreTake(s_publish.lock, portMAX_DELAY);
+    int msg_id = esp_mqtt_outbox_acked(&s_publish.outbox, mqtt_msg_id, esp_timer_get_time(), latency_us);
+    xSemaphoreGive(s_publish.lock);
+    return msg_id;
+}
+
+/* Topic filters from CONFIG_ESP_RMAKER_MQTT_PUBLISH_COALESCE_TOPICS, space separated */
+static void esp_mqtt_glue_coalesce_init(void)
+{
+    static const char filters[] = CONFIG_ESP_RMAKER_MQTT_PUBLISH_COALESCE_TOPICS;
+    int count = 0;
+    for (const char *c = filters; *c; c++) {
+        if (*c != ' ' && (c == filters || c[-1] == ' ')) {
+            count++;
+        }
+    }
+    if (!count) {
+        return;
+    }
+    s_publish.coalesce_entries = calloc(count, sizeof(esp_mqtt_topic_entry_t));
+    if (!s_publish.coalesce_entries) {
+        ESP_LOGW(TAG, "Failed to allocate memory for the topics to coalesce");
+        return;
+    }
+    s_publish.num_coalesce_entries = count;
+    char filter[MQTT_TOPIC_BUF_SIZE];
+    const char *c = filters;
+    for (int i = 0; i < count; i++) {
+        while (*c == ' ') {
+            c++;
+        }
+        size_t len = strcspn(c, " ");
+        esp_mqtt_glue_topic_t topic = { c, len < sizeof(filter) ? len : sizeof(filter) - 1 };
+        esp_mqtt_glue_topic_str(topic, filter, sizeof(filter));
+        c += len;
+        esp_mqtt_topic_node_t *node = esp_mqtt_topics_filter_valid(filter) ?
+                                      esp_mqtt_topics_get(&s_publish.coalesce_topics, filter, true) : NULL;
+        if (node) {
+            esp_mqtt_topics_add(node, &s_publish.coalesce_entries[i]);
+        } else {
+            ESP_LOGW(TAG, "Not coalescing topic %s", filter);
+        }
+    }
+}
+
+static void esp_mqtt_glue_coalesce_deinit(void)
+{
+    for (int i = 0; i < s_publish.num_coalesce_entries; i++) {
+        esp_mqtt_topics_remove(&s_publish.coalesce_entries[i]);
+    }
+    esp_mqtt_topics_prune(&s_publish.coalesce_topics);
+    free(s_publish.coalesce_entries);
+    s_publish.coalesce_entries = NULL;
+    s_publish.num_coalesce_entries = 0;
+}
+
+static void esp_mqtt_glue_free_long_data(void)
+{
+    if (s_long_data.data && s_long_data.data != s_rx_buf) {
+        free(s_long_data.data);
+    }
+    if (s_long_data.topic_str && s_long_data.topic_str != s_long_data.topic) {
+        free(s_long_data.topic_str);
+    }
+    s_long_data.data = NULL;
+    s_long_data.topic_str = NULL;
+}
+
+static char *esp_mqtt_glue_get_rx_buf(int len)
 {
-    if (long_data) {
-        if (long_data->topic) {
-            free(long_data->topic);
+    if (len <= MQTT_RX_BUF_SIZE) {
+        if (!s_rx_buf) {
+            s_rx_buf = MEM_ALLOC_EXTRAM(MQTT_RX_BUF_SIZE);
         }
-        if (long_data->data) {
-            free(long_data->data);
+        if (s_rx_buf) {
+            return s_rx_buf;
         }
-        free(long_data);
     }
-    return NULL;
+    return MEM_ALLOC_EXTRAM(len);
 }
 
-static esp_mqtt_glue_long_data_t *esp_mqtt_glue_manage_long_data(esp_mqtt_glue_long_data_t *long_data,
-        esp_mqtt_event_handle_t event)
+static void esp_mqtt_glue_manage_long_data(esp_mqtt_event_handle_t event)
 {
     if (event->topic) {
         /* This is new data. Free any earlier data, if present. */
-        esp_mqtt_glue_free_long_data(long_data);
-        long_data = calloc(1, sizeof(esp_mqtt_glue_long_data_t));
-        if (!long_data) {
-            ESP_LOGE(TAG, "Could not allocate memory for esp_mqtt_glue_long_data_t");
-            return NULL;
-        }
-        long_data->data = MEM_CALLOC_EXTRAM(1, event->total_data_len);
-        if (!long_data->data) {
+        esp_mqtt_glue_free_long_data();
+        s_long_data.data = esp_mqtt_glue_get_rx_buf(event->total_data_len);
+        if (!s_long_data.data) {
             ESP_LOGE(TAG, "Could not allocate %d bytes for received data.", event->total_data_len);
-            return esp_mqtt_glue_free_long_data(long_data);
+            return;
         }
-        long_data->topic = strndup(event->topic, event->topic_len);
-        if (!long_data->topic) {
+        s_long_data.total_len = event->total_data_len;
+        esp_mqtt_glue_topic_t topic = { event->topic, event->topic_len };
+        s_long_data.topic_str = esp_mqtt_glue_topic_str(topic, s_long_data.topic, sizeof(s_long_data.topic));
+        if (!s_long_data.topic_str) {
             ESP_LOGE(TAG, "Could not allocate %d bytes for received topic.", event->topic_len);
-            return esp_mqtt_glue_free_long_data(long_data);
+            esp_mqtt_glue_free_long_data();
+            return;
         }
     }
-    if (long_data) {
-        memcpy(long_data->data + event->current_data_offset, event->data, event->data_len);
+    if (s_long_data.data) {
+        if ((event->current_data_offset + event->data_len) > s_long_data.total_len) {
+            ESP_LOGE(TAG, "Received data does not fit into the message.");
+            esp_mqtt_glue_free_long_data();
+            return;
+        }
+        memcpy(s_long_data.data + event->current_data_offset, event->data, event->data_len);
 
-        if ((event->current_data_offset + event->data_len) == event->total_data_len) {
-            esp_mqtt_glue_subscribe_callback(long_data->topic, strlen(long_data->topic),
-                        long_data->data, event->total_data_len);
-            return esp_mqtt_glue_free_long_data(long_data);
+        if ((event->current_data_offset + event->data_len) == s_long_data.total_len) {
+            esp_mqtt_glue_topic_t topic = { s_long_data.topic_str, strlen(s_long_data.topic_str) };
+            esp_mqtt_glue_subscribe_callback(topic, s_long_data.topic_str, s_long_data.data, s_long_data.total_len);
+            esp_mqtt_glue_free_long_data();
         }
     }
-    return long_data;
 }
 
 static void mqtt_event_handler(void *handler_args, esp_event_base_t base, int32_t event_id, void *event_data)
@@ -379,105 +715,111 @@ static void mqtt_event_handler(void *handler_args, esp_event_base_t base, int32_
     switch (event_id) {
         case MQTT_EVENT_CONNECTED:
             ESP_LOGI(TAG, "MQTT Connected");
+            esp_mqtt_glue_lock_subscriptions();
             /* Reset all subscription states on reconnection */
             esp_mqtt_glue_reset_subscription_states();
 
             /* Re-subscribe to unique topics only */
-            for (int i = 0; i < MAX_MQTT_SUBSCRIPTIONS; i++) {
-                if (!mqtt_data->subscriptions[i]) continue;
-
-                /* Skip if we already processed this topic */
-                bool topic_already_processed = false;
-                for (int j = 0; j < i; j++) {
-                    if (mqtt_data->subscriptions[j] &&
-                        strcmp(mqtt_data->subscriptions[i]->topic, mqtt_data->subscriptions[j]->topic) == 0) {
-                        topic_already_processed = true;
-                        break;
-                    }
-                }
-                if (topic_already_processed) continue;
+            for (esp_mqtt_glue_subscription_t *sub = mqtt_data->subscriptions; sub; sub = sub->next) {
+                /* Skip if we already processed this topic, with its first subscription */
+                esp_mqtt_glue_subscription_t *first = esp_mqtt_glue_topic_subscriptions(sub);
+                if (first != sub) continue;
 
                 /* Find highest QoS for this topic */
-                uint8_t max_qos = mqtt_data->subscriptions[i]->qos;
-                for (int j = i + 1; j < MAX_MQTT_SUBSCRIPTIONS; j++) {
-                    if (mqtt_data->subscriptions[j] &&
-                        strcmp(mqtt_data->subscriptions[i]->topic, mqtt_data->subscriptions[j]->topic) == 0 &&
-                        mqtt_data->subscriptions[j]->qos > max_qos) {
-                        max_qos = mqtt_data->subscriptions[j]->qos;
+                uint8_t max_qos = sub->qos;
+                for (esp_mqtt_glue_subscription_t *other = first; other; other = esp_mqtt_glue_next_on_topic(other)) {
+                    if (other->qos > max_qos) {
+                        max_qos = other->qos;
                     }
                 }
 
                 /* Subscribe once with highest QoS */
-                int ret = _esp_mqtt_client_subscribe(event->client, mqtt_data->subscriptions[i]->topic, max_qos);
+                int ret = _esp_mqtt_client_subscribe(event->client, sub->topic, max_qos);
                 mqtt_subscription_state_t new_state = (ret >= 0) ? MQTT_SUB_STATE_REQUESTED : MQTT_SUB_STATE_FAILED;
 
                 /* Update all subscriptions for this topic */
-                for (int j = i; j < MAX_MQTT_SUBSCRIPTIONS; j++) {
-                    if (mqtt_data->subscriptions[j] &&
-                        strcmp(mqtt_data->subscriptions[i]->topic, mqtt_data->subscriptions[j]->topic) == 0) {
-                        mqtt_data->subscriptions[j]->msg_id = (ret >= 0) ? ret : -1;
-                        mqtt_data->subscriptions[j]->state = new_state;
-                    }
+                for (esp_mqtt_glue_subscription_t *other = first; other; other = esp_mqtt_glue_next_on_topic(other)) {
+                    other->msg_id = (ret >= 0) ? ret : -1;
+                    other->state = new_state;
                 }
 
                 if (ret >= 0) {
-                    ESP_LOGD(TAG, "Reconnect: Subscribed to %s (msg_id: %d, QoS: %d)",
-                             mqtt_data->subscriptions[i]->topic, ret, max_qos);
+                    ESP_LOGD(TAG, "Reconnect: Subscribed to %s (msg_id: %d, QoS: %d)", sub->topic, ret, max_qos);
                 } else {
-                    ESP_LOGW(TAG, "Reconnect: Failed to subscribe to %s", mqtt_data->subscriptions[i]->topic);
+                    ESP_LOGW(TAG, "Reconnect: Failed to subscribe to %s", sub->topic);
                 }
             }
+            esp_mqtt_glue_unlock_subscriptions();
+            s_publish.connected = true;
             esp_event_post(RMAKER_COMMON_EVENT, RMAKER_MQTT_EVENT_CONNECTED, NULL, 0, portMAX_DELAY);
+            /* Publish what was queued while disconnected */
+            esp_mqtt_glue_drain();
             break;
         case MQTT_EVENT_DISCONNECTED:
             ESP_LOGW(TAG, "MQTT Disconnected. Will try reconnecting in a while...");
+            s_publish.connected = false;
             /* Mark all subscriptions as disconnected - they'll need re-acknowledgment */
+            esp_mqtt_glue_lock_subscriptions();
             esp_mqtt_glue_reset_subscription_states();
+            esp_mqtt_glue_unlock_subscriptions();
             esp_event_post(RMAKER_COMMON_EVENT, RMAKER_MQTT_EVENT_DISCONNECTED, NULL, 0, portMAX_DELAY);
             break;
 
         case MQTT_EVENT_SUBSCRIBED:
             ESP_LOGD(TAG, "MQTT_EVENT_SUBSCRIBED, msg_id=%d", event->msg_id);
             /* Mark matching subscriptions as acknowledged */
-            for (int i = 0; i < MAX_MQTT_SUBSCRIPTIONS; i++) {
-                if (mqtt_data->subscriptions[i] &&
-                    mqtt_data->subscriptions[i]->msg_id == event->msg_id) {
-                    mqtt_data->subscriptions[i]->state = MQTT_SUB_STATE_ACKNOWLEDGED;
-                    ESP_LOGD(TAG, "Subscription acknowledged for topic: %s", mqtt_data->subscriptions[i]->topic);
+            esp_mqtt_glue_lock_subscriptions();
+            for (esp_mqtt_glue_subscription_t *sub = mqtt_data->subscriptions; sub; sub = sub->next) {
+                if (sub->msg_id == event->msg_id) {
+                    sub->state = MQTT_SUB_STATE_ACKNOWLEDGED;
+                    ESP_LOGD(TAG, "Subscription acknowledged for topic: %s", sub->topic);
                 }
             }
+            esp_mqtt_glue_unlock_subscriptions();
             break;
         case MQTT_EVENT_UNSUBSCRIBED:
             ESP_LOGD(TAG, "MQTT_EVENT_UNSUBSCRIBED, msg_id=%d", event->msg_id);
             break;
-        case MQTT_EVENT_PUBLISHED:
+        case MQTT_EVENT_PUBLISHED: {
             ESP_LOGD(TAG, "MQTT_EVENT_PUBLISHED, msg_id=%d", event->msg_id);
-            esp_event_post(RMAKER_COMMON_EVENT, RMAKER_MQTT_EVENT_PUBLISHED, &event->msg_id, sizeof(event->msg_id), portMAX_DELAY);
+            /* Reported with the ID the message got when it was queued */
+            int64_t latency_us;
+            int msg_id = esp_mqtt_glue_publish_done(event->msg_id, &latency_us);
+            if (msg_id > 0) {
+                esp_mqtt_glue_post_published(msg_id, latency_us);
+            }
+            /* There is room in the window now */
+            esp_mqtt_glue_drain();
             break;
+        }
 #ifdef CONFIG_MQTT_REPORT_DELETED_MESSAGES
-        case MQTT_EVENT_DELETED:
+        case MQTT_EVENT_DELETED: {
             ESP_LOGD(TAG, "MQTT_EVENT_DELETED, msg_id=%d", event->msg_id);
-            esp_event_post(RMAKER_COMMON_EVENT, RMAKER_MQTT_EVENT_MSG_DELETED, &event->msg_id, sizeof(event->msg_id), portMAX_DELAY);
+            int msg_id = esp_mqtt_glue_publish_done(event->msg_id, NULL);
+            if (msg_id > 0) {
+                esp_event_post(RMAKER_COMMON_EVENT, RMAKER_MQTT_EVENT_MSG_DELETED, &msg_id, sizeof(msg_id), portMAX_DELAY);
+            }
+            esp_mqtt_glue_drain();
             break;
+        }
 #endif /* CONFIG_MQTT_REPORT_DELETED_MESSAGES */
         case MQTT_EVENT_DATA: {
             ESP_LOGD(TAG, "MQTT_EVENT_DATA");
-            static esp_mqtt_glue_long_data_t *long_data;
             /* Topic can be NULL, for data longer than the MQTT buffer */
             if (event->topic) {
                 ESP_LOGD(TAG, "TOPIC=%.*s\r\n", event->topic_len, event->topic);
             }
             ESP_LOGD(TAG, "DATA=%.*s\r\n", event->data_len, event->data);
             if (event->data_len == event->total_data_len) {
-                /* If long_data still exists, it means there was some issue getting the
+                /* If long data still exists, it means there was some issue getting the
                  * long data, and so, it needs to be freed up.
                  */
-                if (long_data) {
-                    long_data = esp_mqtt_glue_free_long_data(long_data);
-                }
-                esp_mqtt_glue_subscribe_callback(event->topic, event->topic_len, event->data, event->data_len);
+                esp_mqtt_glue_free_long_data();
+                /* The whole message is in the MQTT buffer, so hand it over from there */
+                esp_mqtt_glue_topic_t topic = { event->topic, event->topic_len };
+                esp_mqtt_glue_subscribe_callback(topic, NULL, event->data, event->data_len);
             } else {
-                long_data = esp_mqtt_glue_manage_long_data(long_data, event);
+                esp_mqtt_glue_manage_long_data(event);
             }
             break;
         }
@@ -506,14 +848,18 @@ static esp_err_t esp_mqtt_glue_connect(void)
 
 static void esp_mqtt_glue_unsubscribe_all(void)
 {
-    if (!mqtt_data) {
+    if (!mqtt_data || !mqtt_data->subs_lock) {
         return;
     }
-    int i;
-    for (i = 0; i < MAX_MQTT_SUBSCRIPTIONS; i++) {
-        if (mqtt_data->subscriptions[i]) {
-            unsubscribe_helper(&(mqtt_data->subscriptions[i]));
+    for (;;) {
+        esp_mqtt_glue_lock_subscriptions();
+        esp_mqtt_glue_subscription_t *subscription = mqtt_data->subscriptions;
+        char *topic = subscription ? unsubscribe_helper(subscription) : NULL;
+        esp_mqtt_glue_unlock_subscriptions();
+        if (!subscription) {
+            break;
         }
+        esp_mqtt_glue_client_unsubscribe(topic);
     }
 }
 
@@ -555,6 +901,21 @@ static esp_err_t esp_mqtt_glue_init(esp_rmaker_mqtt_conn_params_t *conn_params)
         return ESP_ERR_NO_MEM;
     }
     mqtt_data->conn_params = conn_params;
+    mqtt_data->subs_lock = xSemaphoreCreateRecursiveMutex();
+    if (!mqtt_data->subs_lock) {
+        ESP_LOGE(TAG, "Failed to create the subscriptions lock");
+        esp_mqtt_glue_deinit();
+        return ESP_ERR_NO_MEM;
+    }
+    s_publish.lock = xSemaphoreCreateMutex();
+    if (!s_publish.lock) {
+        ESP_LOGE(TAG, "Failed to create the publish queue lock");
+        esp_mqtt_glue_deinit();
+        return ESP_ERR_NO_MEM;
+    }
+    esp_mqtt_outbox_init(&s_publish.outbox, CONFIG_ESP_RMAKER_MQTT_PUBLISH_QUEUE_SIZE,
+                         CONFIG_ESP_RMAKER_MQTT_PUBLISH_WINDOW);
+    esp_mqtt_glue_coalesce_init();
 
     const esp_mqtt_client_config_t mqtt_client_cfg = {
         .broker = {
@@ -616,9 +977,46 @@ static void esp_mqtt_glue_deinit(void)
         esp_mqtt_client_destroy(mqtt_data->mqtt_client);
     }
     if (mqtt_data) {
+        if (mqtt_data->subs_lock) {
+            vSemaphoreDelete(mqtt_data->subs_lock);
+        }
         free(mqtt_data);
         mqtt_data = NULL;
     }
+    esp_mqtt_glue_free_long_data();
+    free(s_rx_buf);
+    s_rx_buf = NULL;
+    esp_mqtt_glue_coalesce_deinit();
+    esp_mqtt_outbox_clear(&s_publish.outbox);
+    if (s_publish.lock) {
+        vSemaphoreDelete(s_publish.lock);
+    }
+    memset(&s_publish, 0, sizeof(s_publish));
+}
+
+esp_err_t esp_rmaker_mqtt_glue_get_publish_stats(esp_rmaker_mqtt_publish_stats_t *stats)
+{
+    if (!stats) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!mqtt_data) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    xSemaphoreTake(s_publish.lock, portMAX_DELAY);
+    const esp_mqtt_outbox_t *outbox = &s_publish.outbox;
+    *stats = (esp_rmaker_mqtt_publish_stats_t) {
+        .queued = outbox->stats.queued,
+        .coalesced = outbox->stats.coalesced,
+        .rejected = outbox->stats.rejected,
+        .sent = outbox->stats.sent,
+        .acked = outbox->stats.acked,
+        .expired = outbox->stats.expired,
+        .bytes = outbox->bytes,
+        .max_bytes = outbox->stats.max_bytes,
+        .inflight = outbox->num_inflight,
+    };
+    xSemaphoreGive(s_publish.lock);
+    return ESP_OK;
 }
 
 esp_err_t esp_rmaker_mqtt_glue_setup(esp_rmaker_mqtt_config_t *mqtt_config)
@@ -0,0 +1,287 @@
+// Copyright 2025 Espressif Systems (Shanghai) PTE LTD
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <stdlib.h>
+#include <string.h>
+#include "esp-mqtt-outbox.h"
+
+static void free_msg(esp_mqtt_outbox_msg_t *msg)
+{
+    free(msg->data);
+    free(msg);
+}
+
+static void free_list(esp_mqtt_outbox_msg_t *msg)
+{
+    while (msg) {
+        esp_mqtt_outbox_msg_t *next = msg->next;
+        free_msg(msg);
+        msg = next;
+    }
+}
+
+static char *copy_data(const void *data, size_t len)
+{
+    /* malloc(0) may return NULL */
+    char *copy = malloc(len ? len : 1);
+    if (copy && len) {
+        memcpy(copy, data, len);
+    }
+    return copy;
+}
+
+static bool fits(const esp_mqtt_outbox_t *outbox, size_t len)
+{
+    return !outbox->head || outbox->bytes + len <= outbox->budget;
+}
+
+static void add_bytes(esp_mqtt_outbox_t *outbox, size_t len)
+{
+    outbox->bytes += len;
+    if (outbox->bytes > outbox->stats.max_bytes) {
+        outbox->stats.max_bytes = outbox->bytes;
+    }
+}
+
+static esp_mqtt_outbox_msg_t *find_coalesced(esp_mqtt_outbox_t *outbox, const char *topic, uint8_t qos)
+{
+    for (esp_mqtt_outbox_msg_t *msg = outbox->head; msg; msg = msg->next) {
+        if (msg->coalesce && msg->qos == qos && strcmp(msg->topic, topic) == 0) {
+            return msg;
+        }
+    }
+    return NULL;
+}
+
+static int next_msg_id(esp_mqtt_outbox_t *outbox)
+{
+    /* 1 to 65535, like MQTT packet identifiers */
+    outbox->last_msg_id = (outbox->last_msg_id == UINT16_MAX) ? 1 : outbox->last_msg_id + 1;
+    return outbox->last_msg_id;
+}
+
+void esp_mqtt_outbox_init(esp_mqtt_outbox_t *outbox, size_t budget, uint8_t window)
+{
+    memset(outbox, 0, sizeof(*outbox));
+    outbox->tail = &outbox->head;
+    outbox->budget = budget;
+    outbox->window = window ? window : 1;
+}
+
+void esp_mqtt_outbox_clear(esp_mqtt_outbox_t *outbox)
+{
+    free_list(outbox->head);
+    free_list(outbox->inflight);
+    outbox->head = NULL;
+    outbox->tail = &outbox->head;
+    outbox->inflight = NULL;
+    outbox->bytes = 0;
+    outbox->num_inflight = 0;
+}
+
+int esp_mqtt_outbox_push(esp_mqtt_outbox_t *outbox, const char *topic, const void *data, size_t len,
+                         uint8_t qos, bool coalesce, int64_t now)
+{
+    esp_mqtt_outbox_msg_t *queued = coalesce ? find_coalesced(outbox, topic, qos) : NULL;
+    if (queued) {
+        if (len > queued->len && !fits(outbox, len - queued->len)) {
+            outbox->stats.rejected++;
+            return -1;
+        }
+        char *copy = copy_data(data, len);
+        if (!copy) {
+            return -1;
+        }
+        free(queued->data);
+        outbox->bytes -= queued->len;
+        add_bytes(outbox, len);
+        queued->data = copy;
+        queued->len = len;
+        outbox->stats.coalesced++;
+        return queued->msg_id;
+    }
+
+    if (!fits(outbox, len)) {
+        outbox->stats.rejected++;
+        return -1;
+    }
+    size_t topic_len = strlen(topic);
+    esp_mqtt_outbox_msg_t *msg = calloc(1, sizeof(esp_mqtt_outbox_msg_t) + topic_len + 1);
+    if (!msg) {
+        return -1;
+    }
+    msg->data = copy_data(data, len);
+    if (!msg->data) {
+        free(msg);
+        return -1;
+    }
+    memcpy(msg->topic, topic, topic_len + 1);
+    msg->len = len;
+    msg->qos = qos;
+    msg->coalesce = coalesce;
+    msg->time = now;
+    msg->msg_id = qos ? next_msg_id(outbox) : 0;
+
+    *outbox->tail = msg;
+    outbox->tail = &msg->next;
+    add_bytes(outbox, len);
+    outbox->stats.queued++;
+    return msg->msg_id;
+}
+
+esp_mqtt_outbox_msg_t *esp_mqtt_outbox_pop(esp_mqtt_outbox_t *outbox)
+{
+    esp_mqtt_outbox_msg_t *msg = outbox->head;
+    if (!msg || (msg->qos && outbox->num_inflight >= outbox->window)) {
+        return NULL;
+    }
+    outbox->head = msg->next;
+    if (!outbox->head) {
+        outbox->tail = &outbox->head;
+    }
+    msg->next = NULL;
+    outbox->bytes -= msg->len;
+    if (msg->qos) {
+        outbox->num_inflight++;
+    }
+    outbox->num_sending++;
+    return msg;
+}
+
+static bool take_early_ack(esp_mqtt_outbox_t *outbox, int mqtt_msg_id, int64_t *time)
+{
+    bool found = false;
+    for (int i = 0; i < ESP_MQTT_OUTBOX_EARLY_ACKS; i++) {
+        esp_mqtt_outbox_ack_t *ack = &outbox->early_acks[i];
+        if (!found && ack->mqtt_msg_id == mqtt_msg_id && mqtt_msg_id > 0) {
+            *time = ack->time;
+            ack->mqtt_msg_id = 0;
+            found = true;
+        }
+        /* Once nothing is being handed over, the others were for messages not known at all */
+        if (outbox->num_sending == 0) {
+            ack->mqtt_msg_id = 0;
+        }
+    }
+    return found;
+}
+
+int esp_mqtt_outbox_sent(esp_mqtt_outbox_t *outbox, esp_mqtt_outbox_msg_t *msg, int mqtt_msg_id, int64_t now,
+                         int64_t *latency_us)
+{
+    outbox->num_sending--;
+    if (mqtt_msg_id < 0) {
+        /* Back to the front, over the budget if need be, as it was taken in already */
+        msg->next = outbox->head;
+        outbox->head = msg;
+        if (!msg->next) {
+            outbox->tail = &msg->next;
+        }
+        add_bytes(outbox, msg->len);
+        if (msg->qos) {
+            outbox->num_inflight--;
+        }
+        take_early_ack(outbox, 0, NULL);
+        return -1;
+    }
+    outbox->stats.sent++;
+    int64_t ack_time = 0;
+    bool acked = take_early_ack(outbox, mqtt_msg_id, &ack_time);
+    if (!msg->qos || mqtt_msg_id == 0 || acked) {
+        int msg_id = -1;
+        if (msg->qos) {
+            outbox->num_inflight--;
+        }
+        if (msg->qos && acked) {
+            msg_id = msg->msg_id;
+            outbox->stats.acked++;
+            if (latency_us) {
+                *latency_us = ack_time - now;
+            }
+        }
+        free_msg(msg);
+        return msg_id;
+    }
+    /* The MQTT client has its own copy */
+    free(msg->data);
+    msg->data = NULL;
+    msg->mqtt_msg_id = mqtt_msg_id;
+    msg->time = now;
+    msg->next = outbox->inflight;
+    outbox->inflight = msg;
+    return -1;
+}
+
+int esp_mqtt_outbox_acked(esp_mqtt_outbox_t *outbox, int mqtt_msg_id, int64_t now, int64_t *latency_us)
+{
+    for (esp_mqtt_outbox_msg_t **link = &outbox->inflight; *link; link = &(*link)->next) {
+        esp_mqtt_outbox_msg_t *msg = *link;
+        if (msg->mqtt_msg_id != mqtt_msg_id) {
+            continue;
+        }
+        int msg_id = msg->msg_id;
+        if (latency_us) {
+            *latency_us = now - msg->time;
+        }
+        *link = msg->next;
+        outbox->num_inflight--;
+        outbox->stats.acked++;
+        free_msg(msg);
+        return msg_id;
+    }
+    if (outbox->num_sending) {
+        outbox->early_acks[outbox->next_early_ack] = (esp_mqtt_outbox_ack_t) {
+            .mqtt_msg_id = mqtt_msg_id,
+            .time = now,
+        };
+        outbox->next_early_ack = (outbox->next_early_ack + 1) % ESP_MQTT_OUTBOX_EARLY_ACKS;
+    }
+    return -1;
+}
+
+void esp_mqtt_outbox_expire(esp_mqtt_outbox_t *outbox, int64_t now, int64_t timeout_us,
+                            esp_mqtt_outbox_expired_cb_t cb, void *arg)
+{
+    /* The acknowledgement may never come, if the MQTT client dropped the message */
+    for (esp_mqtt_outbox_msg_t **link = &outbox->inflight; *link;) {
+        esp_mqtt_outbox_msg_t *msg = *link;
+        if (now - msg->time < timeout_us) {
+            link = &msg->next;
+            continue;
+        }
+        *link = msg->next;
+        outbox->num_inflight--;
+        outbox->stats.expired++;
+        bool more = !cb || cb(msg->msg_id, arg);
+        free_msg(msg);
+        if (!more) {
+            return;
+        }
+    }
+    /* Queued in order, so the oldest are at the front */
+    while (outbox->head && now - outbox->head->time >= timeout_us) {
+        esp_mqtt_outbox_msg_t *msg = outbox->head;
+        outbox->head = msg->next;
+        if (!outbox->head) {
+            outbox->tail = &outbox->head;
+        }
+        outbox->bytes -= msg->len;
+        outbox->stats.expired++;
+        bool more = !cb || !msg->msg_id || cb(msg->msg_id, arg);
+        free_msg(msg);
+        if (!more) {
+            return;
+        }
+    }
+}
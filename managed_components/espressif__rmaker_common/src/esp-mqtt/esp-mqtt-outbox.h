@@ -0,0 +1,156 @@
+// Copyright 2025 Espressif Systems (Shanghai) PTE LTD
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*
+ * Queue of the messages the MQTT glue publishes, so that publishing does not wait for the
+ * MQTT client. Messages are copied in, within a budget of bytes, and taken out in order to
+ * be handed to the client, with at most a window of QoS 1 messages not acknowledged yet.
+ *
+ * A message can replace the payload of a queued one on the same topic, if that one has not
+ * been handed over yet, for topics which always carry the full state.
+ *
+ * Messages get their ID from the queue, as they are not handed to the client right away.
+ * The queue does not lock, and is plain C, so that it can be built on the host by
+ * tools/mqtt_outbox_bench.c.
+ */
+
+typedef struct esp_mqtt_outbox_msg {
+    struct esp_mqtt_outbox_msg *next;
+    char *data;                 /* Freed once handed over */
+    size_t len;
+    int64_t time;               /* When it was queued, or handed over once it was */
+    int msg_id;                 /* Given to the publisher, 0 for QoS 0 */
+    int mqtt_msg_id;            /* Given by the MQTT client */
+    uint8_t qos;
+    bool coalesce;
+    char topic[];
+} esp_mqtt_outbox_msg_t;
+
+typedef struct {
+    uint32_t queued;            /* Messages accepted */
+    uint32_t coalesced;         /* Messages which replaced a queued one */
+    uint32_t rejected;          /* Messages over the budget */
+    uint32_t sent;              /* Messages handed over */
+    uint32_t acked;             /* QoS 1 messages acknowledged, or deleted by the MQTT client */
+    uint32_t expired;           /* Messages dropped for taking too long */
+    uint32_t max_bytes;         /* Most bytes queued at a time */
+} esp_mqtt_outbox_stats_t;
+
+/* Acknowledgements which came before the message was known to be sent */
+#define ESP_MQTT_OUTBOX_EARLY_ACKS  4
+
+typedef struct {
+    int mqtt_msg_id;
+    int64_t time;
+} esp_mqtt_outbox_ack_t;
+
+typedef struct {
+    esp_mqtt_outbox_msg_t *head;        /* Waiting to be handed over */
+    esp_mqtt_outbox_msg_t **tail;
+    esp_mqtt_outbox_msg_t *inflight;    /* QoS 1, handed over and not acknowledged */
+    size_t bytes;                       /* Payload queued */
+    size_t budget;
+    uint8_t window;
+    uint8_t num_inflight;               /* Including the ones being handed over */
+    uint8_t num_sending;                /* Being handed over */
+    uint8_t next_early_ack;
+    uint16_t last_msg_id;
+    esp_mqtt_outbox_ack_t early_acks[ESP_MQTT_OUTBOX_EARLY_ACKS];
+    esp_mqtt_outbox_stats_t stats;
+} esp_mqtt_outbox_t;
+
+/* Called for every message the queue gives up on, returns false to give up on no more for now */
+typedef bool (*esp_mqtt_outbox_expired_cb_t)(int msg_id, void *arg);
+
+/**
+ * @param budget Bytes of payload which can be queued. A message is always taken into an
+ *               empty queue, so that any message can go out.
+ * @param window QoS 1 messages which can be unacknowledged at a time, at least 1
+ */
+void esp_mqtt_outbox_init(esp_mqtt_outbox_t *outbox, size_t budget, uint8_t window);
+
+/**
+ * @brief Frees all the messages
+ */
+void esp_mqtt_outbox_clear(esp_mqtt_outbox_t *outbox);
+
+/**
+ * @brief Queues a copy of a message
+ *
+ * @param coalesce Replace the payload of a queued message with the same topic, QoS and flag,
+ *                 which then keeps its place and its ID
+ * @param now Time in microseconds
+ *
+ * @return the message ID, 0 for QoS 0, -1 if over the budget or out of memory
+ */
+int esp_mqtt_outbox_push(esp_mqtt_outbox_t *outbox, const char *topic, const void *data, size_t len,
+                         uint8_t qos, bool coalesce, int64_t now);
+
+/**
+ * @brief Takes the first message out of the queue to be handed over
+ *
+ * @return NULL if the queue is empty, or the first message is QoS 1 and the window is full
+ */
+esp_mqtt_outbox_msg_t *esp_mqtt_outbox_pop(esp_mqtt_outbox_t *outbox);
+
+/**
+ * @brief Tells how handing over a message from esp_mqtt_outbox_pop() went
+ *
+ * The acknowledgement can come before this is called, as the MQTT client runs on its own.
+ * It is then remembered by esp_mqtt_outbox_acked(), and the message is freed here.
+ *
+ * @param mqtt_msg_id What the MQTT client returned. If negative, the message goes back to the
+ *                    front of the queue. QoS 1 messages wait for esp_mqtt_outbox_acked(),
+ *                    the others are freed.
+ * @param now When the message was handed over, which latencies are measured from
+ * @param latency_us Set to the time until the acknowledgement, if it came already
+ *
+ * @return the message ID given by esp_mqtt_outbox_push(), if it was acknowledged already,
+ *         else -1
+ */
+int esp_mqtt_outbox_sent(esp_mqtt_outbox_t *outbox, esp_mqtt_outbox_msg_t *msg, int mqtt_msg_id, int64_t now,
+                         int64_t *latency_us);
+
+/**
+ * @brief Frees the message acknowledged by the MQTT client
+ *
+ * @param latency_us Set to the time from handing it over, if not NULL
+ *
+ * @return the message ID given by esp_mqtt_outbox_push(), -1 if the message is not known,
+ *         or not known yet as it is being handed over
+ */
+int esp_mqtt_outbox_acked(esp_mqtt_outbox_t *outbox, int mqtt_msg_id, int64_t now, int64_t *latency_us);
+
+/**
+ * @brief Drops the messages queued, or handed over and not acknowledged, for longer than timeout
+ *
+ * cb is called with the ID of each message dropped, and returning false stops at that message.
+ */
+void esp_mqtt_outbox_expire(esp_mqtt_outbox_t *outbox, int64_t now, int64_t timeout_us,
+                            esp_mqtt_outbox_expired_cb_t cb, void *arg);
+
+#ifdef __cplusplus
+}
+#endif
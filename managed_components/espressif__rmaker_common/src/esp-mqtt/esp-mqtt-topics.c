@@ -0,0 +1,283 @@
+// Copyright 2025 Espressif Systems (Shanghai) PTE LTD
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <stdlib.h>
+#include <string.h>
+#include "esp-mqtt-topics.h"
+
+#define BUCKETS_MIN     16
+
+static bool level_is(const char *level, size_t len, char wildcard)
+{
+    return len == 1 && level[0] == wildcard;
+}
+
+static uint32_t level_hash(const esp_mqtt_topic_node_t *parent, const char *level, size_t len)
+{
+    /* FNV-1a over the level, seeded with the parent */
+    uint32_t hash = 2166136261u ^ (uint32_t)(uintptr_t)parent;
+    for (size_t i = 0; i < len; i++) {
+        hash = (hash ^ (uint8_t)level[i]) * 16777619u;
+    }
+    return hash;
+}
+
+static esp_mqtt_topic_node_t **bucket_of(esp_mqtt_topics_t *topics, const esp_mqtt_topic_node_t *parent,
+                                         const char *level, size_t len)
+{
+    return &topics->buckets[level_hash(parent, level, len) & (topics->num_buckets - 1)];
+}
+
+static void bucket_insert(esp_mqtt_topics_t *topics, esp_mqtt_topic_node_t *node)
+{
+    esp_mqtt_topic_node_t **bucket = bucket_of(topics, node->parent, node->level, node->len);
+    node->bucket_next = *bucket;
+    *bucket = node;
+}
+
+static void bucket_insert_children(esp_mqtt_topics_t *topics, esp_mqtt_topic_node_t *parent)
+{
+    for (esp_mqtt_topic_node_t *node = parent->children; node; node = node->sibling) {
+        bucket_insert(topics, node);
+        bucket_insert_children(topics, node);
+    }
+}
+
+static void bucket_remove(esp_mqtt_topics_t *topics, esp_mqtt_topic_node_t *node)
+{
+    esp_mqtt_topic_node_t **link = bucket_of(topics, node->parent, node->level, node->len);
+    while (*link && *link != node) {
+        link = &(*link)->bucket_next;
+    }
+    if (*link) {
+        *link = node->bucket_next;
+    }
+}
+
+/* Keeps the hash table bigger than the number of nodes. If it cannot grow, the old one keeps working,
+ * and without any, children are looked up in the list of their parent.
+ *
+ * Returns true if the table was made anew, with all the nodes in it.
+ */
+static bool grow_buckets(esp_mqtt_topics_t *topics)
+{
+    if (topics->buckets && topics->num_nodes < topics->num_buckets) {
+        return false;
+    }
+    uint32_t num_buckets = topics->buckets ? topics->num_buckets * 2 : BUCKETS_MIN;
+    while (num_buckets <= topics->num_nodes) {
+        num_buckets *= 2;
+    }
+    esp_mqtt_topic_node_t **buckets = calloc(num_buckets, sizeof(esp_mqtt_topic_node_t *));
+    if (!buckets) {
+        return false;
+    }
+    free(topics->buckets);
+    topics->buckets = buckets;
+    topics->num_buckets = num_buckets;
+    bucket_insert_children(topics, &topics->root);
+    return true;
+}
+
+static esp_mqtt_topic_node_t *find_child(esp_mqtt_topics_t *topics, const esp_mqtt_topic_node_t *parent,
+                                         const char *level, size_t len)
+{
+    if (!topics->buckets) {
+        esp_mqtt_topic_node_t *node = parent->children;
+        while (node && (node->len != len || memcmp(node->level, level, len) != 0)) {
+            node = node->sibling;
+        }
+        return node;
+    }
+    esp_mqtt_topic_node_t *node = *bucket_of(topics, parent, level, len);
+    while (node && (node->parent != parent || node->len != len || memcmp(node->level, level, len) != 0)) {
+        node = node->bucket_next;
+    }
+    return node;
+}
+
+bool esp_mqtt_topics_filter_valid(const char *filter)
+{
+    for (const char *c = filter; *c; c++) {
+        if (*c != '+' && *c != '#') {
+            continue;
+        }
+        /* Wildcards are whole levels */
+        if ((c != filter && c[-1] != '/') || (c[1] != '\0' && c[1] != '/')) {
+            return false;
+        }
+        /* '#' is the last level */
+        if (*c == '#' && c[1] != '\0') {
+            return false;
+        }
+    }
+    return true;
+}
+
+esp_mqtt_topic_node_t *esp_mqtt_topics_get(esp_mqtt_topics_t *topics, const char *filter, bool create)
+{
+    esp_mqtt_topic_node_t *parent = &topics->root;
+    const char *level = filter;
+    while (true) {
+        const char *end = strchr(level, '/');
+        size_t len = end ? (size_t)(end - level) : strlen(level);
+        esp_mqtt_topic_node_t *node = find_child(topics, parent, level, len);
+        if (!node) {
+            if (!create || len > UINT16_MAX) {
+                return NULL;
+            }
+            node = calloc(1, sizeof(esp_mqtt_topic_node_t) + len);
+            if (!node) {
+                return NULL;
+            }
+            memcpy(node + 1, level, len);
+            node->level = (const char *)(node + 1);
+            node->len = len;
+            node->parent = parent;
+            /* Added at the front, so that a match in progress doesn't see it */
+            node->sibling = parent->children;
+            parent->children = node;
+            if (level_is(level, len, '+')) {
+                parent->plus = node;
+            } else if (level_is(level, len, '#')) {
+                parent->multi = node;
+            }
+            topics->num_nodes++;
+            if (!grow_buckets(topics) && topics->buckets) {
+                bucket_insert(topics, node);
+            }
+        }
+        if (!end) {
+            return node;
+        }
+        parent = node;
+        level = end + 1;
+    }
+}
+
+void esp_mqtt_topics_add(esp_mqtt_topic_node_t *node, esp_mqtt_topic_entry_t *entry)
+{
+    esp_mqtt_topic_entry_t **link = &node->entries;
+    while (*link) {
+        link = &(*link)->next;
+    }
+    entry->node = node;
+    entry->next = NULL;
+    *link = entry;
+}
+
+void esp_mqtt_topics_remove(esp_mqtt_topic_entry_t *entry)
+{
+    if (!entry->node) {
+        return;
+    }
+    esp_mqtt_topic_entry_t **link = &entry->node->entries;
+    while (*link && *link != entry) {
+        link = &(*link)->next;
+    }
+    if (*link) {
+        *link = entry->next;
+    }
+    entry->node = NULL;
+}
+
+static void prune_children(esp_mqtt_topics_t *topics, esp_mqtt_topic_node_t *parent)
+{
+    esp_mqtt_topic_node_t **link = &parent->children;
+    while (*link) {
+        esp_mqtt_topic_node_t *node = *link;
+        prune_children(topics, node);
+        if (node->entries || node->children) {
+            link = &node->sibling;
+            continue;
+        }
+        *link = node->sibling;
+        if (parent->plus == node) {
+            parent->plus = NULL;
+        } else if (parent->multi == node) {
+            parent->multi = NULL;
+        }
+        if (topics->buckets) {
+            bucket_remove(topics, node);
+        }
+        topics->num_nodes--;
+        free(node);
+    }
+}
+
+void esp_mqtt_topics_prune(esp_mqtt_topics_t *topics)
+{
+    prune_children(topics, &topics->root);
+    if (!topics->num_nodes) {
+        free(topics->buckets);
+        topics->buckets = NULL;
+        topics->num_buckets = 0;
+    }
+}
+
+static void match_entries(esp_mqtt_topic_node_t *node, esp_mqtt_topics_match_cb_t cb, void *arg)
+{
+    /* The callback may remove this entry or the next ones, which keep their next but lose their node */
+    for (esp_mqtt_topic_entry_t *entry = node->entries; entry; entry = entry->next) {
+        if (entry->node) {
+            cb(entry, arg);
+        }
+    }
+}
+
+static void match_level(esp_mqtt_topics_t *topics, esp_mqtt_topic_node_t *parent, const char *level,
+                        const char *end, esp_mqtt_topics_match_cb_t cb, void *arg);
+
+/* node matched the level before sep, or the last one if sep is NULL */
+static void match_next(esp_mqtt_topics_t *topics, esp_mqtt_topic_node_t *node, const char *sep,
+                       const char *end, esp_mqtt_topics_match_cb_t cb, void *arg)
+{
+    if (sep) {
+        match_level(topics, node, sep + 1, end, cb, arg);
+        return;
+    }
+    match_entries(node, cb, arg);
+    /* "a/#" also matches "a" */
+    if (node->multi) {
+        match_entries(node->multi, cb, arg);
+    }
+}
+
+static void match_level(esp_mqtt_topics_t *topics, esp_mqtt_topic_node_t *parent, const char *level,
+                        const char *end, esp_mqtt_topics_match_cb_t cb, void *arg)
+{
+    const char *sep = memchr(level, '/', end - level);
+    size_t len = (sep ? sep : end) - level;
+    /* Wildcards do not match topics starting with '$' */
+    bool wildcards = !(parent == &topics->root && len && level[0] == '$');
+
+    if (wildcards && parent->multi) {
+        match_entries(parent->multi, cb, arg);
+    }
+    if (wildcards && parent->plus) {
+        match_next(topics, parent->plus, sep, end, cb, arg);
+    }
+    esp_mqtt_topic_node_t *node = find_child(topics, parent, level, len);
+    if (node && node != parent->plus && node != parent->multi) {
+        match_next(topics, node, sep, end, cb, arg);
+    }
+}
+
+void esp_mqtt_topics_match(esp_mqtt_topics_t *topics, const char *topic, int len,
+                           esp_mqtt_topics_match_cb_t cb, void *arg)
+{
+    if (topic && len >= 0) {
+        match_level(topics, &topics->root, topic, topic + len, cb, arg);
+    }
+}
@@ -0,0 +1,112 @@
+// Copyright 2025 Espressif Systems (Shanghai) PTE LTD
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*
+ * Tree of MQTT topic filters, with a node per topic level, for the MQTT glue to find the
+ * subscriptions a message is for. Children are found by their parent and level in a hash table,
+ * and every node links its '+' and '#' children, so matching a topic costs in the depth of the
+ * topic rather than in the number of subscriptions.
+ *
+ * Entries are embedded into the structure of the caller, any number of them can be added
+ * to a topic filter. The tree does not lock, and is plain C, so that it can be built on the
+ * host by tools/mqtt_topics_bench.c.
+ */
+
+struct esp_mqtt_topic_node;
+
+typedef struct esp_mqtt_topic_entry {
+    struct esp_mqtt_topic_node *node;           /* Node of the topic filter, NULL if not added */
+    struct esp_mqtt_topic_entry *next;          /* Next entry on the same topic filter */
+} esp_mqtt_topic_entry_t;
+
+typedef struct esp_mqtt_topic_node {
+    struct esp_mqtt_topic_node *parent;
+    struct esp_mqtt_topic_node *children;
+    struct esp_mqtt_topic_node *sibling;
+    struct esp_mqtt_topic_node *plus;           /* Child for '+' */
+    struct esp_mqtt_topic_node *multi;          /* Child for '#' */
+    struct esp_mqtt_topic_node *bucket_next;    /* Next node in the same bucket of the hash table */
+    esp_mqtt_topic_entry_t *entries;            /* Entries on the topic filter which ends here */
+    const char *level;                          /* Allocated with the node, not NULL terminated */
+    uint16_t len;
+} esp_mqtt_topic_node_t;
+
+typedef struct {
+    esp_mqtt_topic_node_t root;                 /* Parent of the nodes of the first level */
+    esp_mqtt_topic_node_t **buckets;            /* NULL while empty, or if it could not be allocated */
+    uint32_t num_buckets;
+    uint32_t num_nodes;
+} esp_mqtt_topics_t;
+
+typedef void (*esp_mqtt_topics_match_cb_t)(esp_mqtt_topic_entry_t *entry, void *arg);
+
+/**
+ * @return true if '+' and '#' only appear as whole levels, and '#' only as the last one
+ */
+bool esp_mqtt_topics_filter_valid(const char *filter);
+
+/**
+ * @brief Gets the node of a topic filter
+ *
+ * @param create Create the missing levels. If that fails, some of them may be left empty,
+ *               until the next esp_mqtt_topics_prune().
+ *
+ * @return the node, NULL if it does not exist or could not be created
+ */
+esp_mqtt_topic_node_t *esp_mqtt_topics_get(esp_mqtt_topics_t *topics, const char *filter, bool create);
+
+/**
+ * @brief Adds an entry to the end of the entries of a node
+ */
+void esp_mqtt_topics_add(esp_mqtt_topic_node_t *node, esp_mqtt_topic_entry_t *entry);
+
+/**
+ * @brief Removes an entry from its node
+ *
+ * entry->next is left as it is, so that a match in progress can go on past the entry.
+ * Empty nodes are only freed by esp_mqtt_topics_prune().
+ */
+void esp_mqtt_topics_remove(esp_mqtt_topic_entry_t *entry);
+
+/**
+ * @brief Frees the nodes without entries and without children with entries
+ *
+ * The hash table is freed too, once there are no nodes left.
+ */
+void esp_mqtt_topics_prune(esp_mqtt_topics_t *topics);
+
+/**
+ * @brief Calls cb for every entry on a topic filter which matches the topic
+ *
+ * Entries can be removed by the callback, but nodes must not be pruned until the match is over.
+ *
+ * @param topic Topic of a message, not NULL terminated
+ * @param len Length of the topic
+ */
+void esp_mqtt_topics_match(esp_mqtt_topics_t *topics, const char *topic, int len,
+                           esp_mqtt_topics_match_cb_t cb, void *arg);
+
+#ifdef __cplusplus
+}
+#endif
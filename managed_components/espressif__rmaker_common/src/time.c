@@ -15,6 +15,7 @@
 #include <esp_sntp.h>
 
 #include <string.h>
+#include <stdlib.h>
 #include <time.h>
 #include <inttypes.h>
 #include <esp_log.h>
@@ -22,6 +23,8 @@
 #include <esp_rmaker_utils.h>
 #include <esp_rmaker_common_events.h>
 #include <esp_idf_version.h>
+#include <freertos/FreeRTOS.h>
+#include "time_tz.h"
 
 static const char *TAG = "esp_rmaker_time";
 
@@ -42,13 +45,86 @@ int esp_setenv(const char *name, const char *value, int rewrite)
     return setenv(name, value, rewrite);
 }
 
+/* Local time is worked out from the rule of the TZ string, with its transitions cached, rather
+ * than by the C library. If TZ is not valid, the C library is used.
+ */
+typedef enum {
+    TZ_CACHE_UNSET = 0,
+    TZ_CACHE_READY,
+    TZ_CACHE_LIBC,
+} esp_rmaker_tz_cache_state_t;
+
+static esp_rmaker_tz_cache_t s_tz_cache;
+static esp_rmaker_tz_cache_state_t s_tz_cache_state;
+static portMUX_TYPE s_tz_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static void esp_rmaker_time_cache_tz(const char *tz_posix)
+{
+    esp_rmaker_tz_rule_t rule;
+    /* No TZ is UTC */
+    bool valid = esp_rmaker_tz_parse(tz_posix ? tz_posix : "UTC0", &rule) == 0;
+    if (!valid) {
+        ESP_LOGW(TAG, "Timezone %s not cached, using the C library.", tz_posix);
+    }
+    portENTER_CRITICAL(&s_tz_lock);
+    if (valid) {
+        esp_rmaker_tz_cache_init(&s_tz_cache, &rule, time(NULL));
+    }
+    s_tz_cache_state = valid ? TZ_CACHE_READY : TZ_CACHE_LIBC;
+    portEXIT_CRITICAL(&s_tz_lock);
+}
+
+static void esp_rmaker_time_apply_tz(const char *tz_posix)
+{
+    esp_setenv("TZ", tz_posix, 1);
+    tzset();
+    esp_rmaker_time_cache_tz(tz_posix);
+}
+
+/* TZ may have been set by the application rather than through these APIs */
+static bool esp_rmaker_time_tz_cached(void)
+{
+    if (s_tz_cache_state == TZ_CACHE_UNSET) {
+        esp_rmaker_time_cache_tz(getenv("TZ"));
+    }
+    return s_tz_cache_state == TZ_CACHE_READY;
+}
+
+esp_err_t esp_rmaker_time_localtime(time_t utc, struct tm *local)
+{
+    if (!local) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!esp_rmaker_time_tz_cached()) {
+        return localtime_r(&utc, local) ? ESP_OK : ESP_FAIL;
+    }
+    portENTER_CRITICAL(&s_tz_lock);
+    esp_rmaker_tz_localtime(&s_tz_cache, utc, local);
+    portEXIT_CRITICAL(&s_tz_lock);
+    return ESP_OK;
+}
+
+time_t esp_rmaker_time_mktime(struct tm *local)
+{
+    if (!local) {
+        return (time_t)-1;
+    }
+    if (!esp_rmaker_time_tz_cached()) {
+        return mktime(local);
+    }
+    portENTER_CRITICAL(&s_tz_lock);
+    time_t utc = esp_rmaker_tz_mktime(&s_tz_cache, local);
+    portEXIT_CRITICAL(&s_tz_lock);
+    return utc;
+}
+
 esp_err_t esp_rmaker_get_local_time_str(char *buf, size_t buf_len)
 {
     struct tm timeinfo;
     char strftime_buf[64];
     time_t now;
     time(&now);
-    localtime_r(&now, &timeinfo);
+    esp_rmaker_time_localtime(now, &timeinfo);
     strftime(strftime_buf, sizeof(strftime_buf), "%c %z[%Z]", &timeinfo);
     size_t print_size = snprintf(buf, buf_len, "%s, DST: %s", strftime_buf, timeinfo.tm_isdst ? "Yes" : "No");
     if (print_size >= buf_len) {
@@ -118,8 +194,7 @@ esp_err_t esp_rmaker_time_set_timezone_posix(const char *tz_posix)
 {
     esp_err_t err = __esp_rmaker_time_set_nvs(ESP_RMAKER_TZ_POSIX_NVS_NAME, tz_posix);
     if (err == ESP_OK) {
-        esp_setenv("TZ", tz_posix, 1);
-        tzset();
+        esp_rmaker_time_apply_tz(tz_posix);
         esp_event_post(RMAKER_COMMON_EVENT, RMAKER_EVENT_TZ_POSIX_CHANGED,
                 (void *)tz_posix, strlen(tz_posix) + 1, portMAX_DELAY);
         esp_rmaker_print_current_time();
@@ -146,15 +221,13 @@ esp_err_t esp_rmaker_timezone_enable(void)
 {
     char *tz_posix = esp_rmaker_time_get_timezone_posix();
     if (tz_posix) {
-        esp_setenv("TZ", tz_posix, 1);
-        tzset();
+        esp_rmaker_time_apply_tz(tz_posix);
         free(tz_posix);
     } else {
         if (strlen(ESP_RMAKER_DEF_TZ) > 0) {
             const char *tz_def = esp_rmaker_tz_db_get_posix_str(ESP_RMAKER_DEF_TZ);
             if (tz_def) {
-                esp_setenv("TZ", tz_def, 1);
-                tzset();
+                esp_rmaker_time_apply_tz(tz_def);
                 return ESP_OK;
             } else {
                 ESP_LOGE(TAG, "Invalid Timezone %s specified.", ESP_RMAKER_DEF_TZ);
@@ -208,93 +281,15 @@ bool esp_rmaker_time_check(void)
 }
 
 
-#include <stdio.h>
-#include <string.h>
-#include <time.h>
-#include <stdlib.h>
-#include <stdint.h>
-
-/* ---- UTC converter with no setenv/timegm dependency ---- */
-static inline int is_leap(int y) {
-    return ((y % 4 == 0) && (y % 100 != 0)) || (y % 400 == 0);
-}
-
-/* Interprets tm as UTC and returns epoch seconds */
-static inline time_t rmaker_timegm(struct tm *tm)
-{
-    /* Normalize month to [0,11] */
-    int year  = tm->tm_year + 1900;
-    int month = tm->tm_mon;
-    if (month < 0) { year += (month - 11) / 12; month = 12 + (month % 12); }
-    else if (month > 11) { year += month / 12; month %= 12; }
-
-    static const int mdays_cum[12] = {0,31,59,90,120,151,181,212,243,273,304,334};
-
-    int64_t days = 0;
-    if (year >= 1970) for (int y = 1970; y < year; ++y) days += 365 + is_leap(y);
-    else              for (int y = year;  y < 1970; ++y) days -= 365 + is_leap(y);
-
-    days += mdays_cum[month];
-    if (month > 1 && is_leap(year)) days += 1;
-    days += (tm->tm_mday - 1);
-
-    int64_t seconds = days * 86400LL
-                    + (int64_t)tm->tm_hour * 3600
-                    + (int64_t)tm->tm_min  * 60
-                    + (int64_t)tm->tm_sec;
-
-    return (time_t)seconds;
-}
-
 /* Supports "YYYY-MM-DDTHH:MM:SSZ" and "YYYY-MM-DDTHH:MM:SS[+-]HH:MM" */
-time_t iso8601_to_epoch(const char *iso_string) {
-    struct tm tm_info = {0};
-    int year, month, day, hour, minute, second;
-    int tz_hour = 0, tz_minute = 0;
-    char tz_sign = '+';
-
-    if (sscanf(iso_string, "%d-%d-%dT%d:%d:%d%c%d:%d",
-               &year, &month, &day, &hour, &minute, &second,
-               &tz_sign, &tz_hour, &tz_minute) == 9) {
-        /* parsed with offset */
-    } else if (sscanf(iso_string, "%d-%d-%dT%d:%d:%dZ",
-                      &year, &month, &day, &hour, &minute, &second) == 6) {
-        tz_hour = 0; tz_minute = 0; tz_sign = '+';
-    } else {
-        ESP_LOGE(TAG, "Error: Invalid ISO 8601 format.\n");
-        return (time_t)-1;
-    }
-
-    tm_info.tm_year  = year - 1900;
-    tm_info.tm_mon   = month - 1;
-    tm_info.tm_mday  = day;
-    tm_info.tm_hour  = hour;
-    tm_info.tm_min   = minute;
-    tm_info.tm_sec   = second;
-    tm_info.tm_isdst = -1; /* let system decide DST for this broken-down time */
-
-    /* Interpret parsed wall-clock as system-local */
-    time_t local_epoch = mktime(&tm_info);
-    if (local_epoch == (time_t)-1) {
-        ESP_LOGE(TAG, "Error: mktime() failed.\n");
+time_t iso8601_to_epoch(const char *iso_string)
+{
+    time_t epoch;
+    if (!iso_string || esp_rmaker_time_parse_iso8601(iso_string, strlen(iso_string), &epoch) != 0) {
+        ESP_LOGE(TAG, "Error: Invalid ISO 8601 format.");
         return (time_t)-1;
     }
-
-    /* Compute system offset (local - UTC) at that instant WITHOUT touching TZ */
-    struct tm tmp_local;
-    localtime_r(&local_epoch, &tmp_local);
-    tmp_local.tm_isdst = -1;                   /* recompute DST if needed */
-    /* Treat the same wall-clock fields as if they were UTC: */
-    time_t utc_from_local_as_utc = rmaker_timegm(&tmp_local);
-    int64_t sys_offset = (int64_t)utc_from_local_as_utc - (int64_t)local_epoch;
-
-    /* parsed offset (timestamp's zone) */
-    int64_t parsed_offset = (int64_t)tz_hour * 3600 + (int64_t)tz_minute * 60;
-    if (tz_sign == '-') parsed_offset = -parsed_offset;
-
-    /* FINAL: Add the system-local offset and the parsed offset (timezone offset) */
-    int64_t final_epoch64 = (int64_t)local_epoch + sys_offset - parsed_offset;
-    return (time_t)final_epoch64;
+    return epoch;
 }
 
 esp_err_t esp_rmaker_time_convert_iso8601_to_epoch(const char *str, int len, time_t *out_epoch)
@@ -302,73 +297,11 @@ esp_err_t esp_rmaker_time_convert_iso8601_to_epoch(const char *str, int len, tim
     if (!str || !out_epoch) {
         return ESP_FAIL;
     }
-
-    char buf[64];
-    int copy_len = 0;
-    if (len > 0) {
-        copy_len = (len < (int)sizeof(buf) - 1) ? len : (int)sizeof(buf) - 1;
-    } else {
-        size_t str_len = strlen(str);
-        copy_len = (str_len < sizeof(buf) - 1) ? (int)str_len : (int)sizeof(buf) - 1;
-    }
-    memcpy(buf, str, copy_len);
-    buf[copy_len] = '\0';
-
-    struct tm tm_utc = {0};
-    int year, month, day, hour, minute, second;
-    int tz_hour = 0, tz_minute = 0;
-    char tz_sign = '+';
-
-    /* Number of fields expected for each format */
-    #define ISO8601_WITH_TIMEZONE_FIELDS    9  /* year, month, day, hour, minute, second, tz_sign, tz_hour, tz_minute */
-    #define ISO8601_UTC_FIELDS              6  /* year, month, day, hour, minute, second */
-
-    /* Try parsing with timezone offset: "YYYY-MM-DDTHH:MM:SS[+-]HH:MM" */
-    if (sscanf(buf, "%d-%d-%dT%d:%d:%d%c%d:%d",
-               &year, &month, &day, &hour, &minute, &second,
-               &tz_sign, &tz_hour, &tz_minute) == ISO8601_WITH_TIMEZONE_FIELDS) {
-        /* Timezone offset format parsed successfully */
-    } else if (sscanf(buf, "%d-%d-%dT%d:%d:%dZ",
-                      &year, &month, &day, &hour, &minute, &second) == ISO8601_UTC_FIELDS) {
-        /* UTC format - validate that 'Z' is present at position 19 */
-        size_t buf_len = strlen(buf);
-        if (buf_len < 20 || buf[19] != 'Z') {
-            ESP_LOGE(TAG, "Invalid ISO 8601 format: '%s' (missing Z suffix)", buf);
-            return ESP_FAIL;
-        }
-        tz_hour = 0;
-        tz_minute = 0;
-        tz_sign = '+';
-    } else {
-        ESP_LOGE(TAG, "Invalid ISO 8601 format: '%s'", buf);
+    size_t str_len = (len > 0) ? (size_t)len : strlen(str);
+    if (esp_rmaker_time_parse_iso8601(str, str_len, out_epoch) != 0) {
+        ESP_LOGE(TAG, "Invalid ISO 8601 format: '%.*s'", (int)str_len, str);
         return ESP_FAIL;
     }
-
-    /* Fill tm structure with parsed values */
-    tm_utc.tm_year = year - 1900;
-    tm_utc.tm_mon = month - 1;
-    tm_utc.tm_mday = day;
-    tm_utc.tm_hour = hour;
-    tm_utc.tm_min = minute;
-    tm_utc.tm_sec = second;
-    tm_utc.tm_isdst = 0; /* No DST in UTC */
-
-    /* Calculate timezone offset in seconds */
-    int total_offset_seconds = (tz_hour * 3600) + (tz_minute * 60);
-    if (tz_sign == '-') {
-        total_offset_seconds = -total_offset_seconds;
-    }
-
-    /* Convert to epoch time using timezone-independent rmaker_timegm */
-    time_t utc_epoch = rmaker_timegm(&tm_utc);
-    if (utc_epoch == (time_t)-1) {
-        ESP_LOGE(TAG, "rmaker_timegm failed");
-        return ESP_FAIL;
-    }
-
-    /* Adjust for timezone offset to get true epoch time */
-    *out_epoch = utc_epoch - total_offset_seconds;
-
     return ESP_OK;
 }
 
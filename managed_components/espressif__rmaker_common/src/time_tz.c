@@ -0,0 +1,402 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include "time_tz.h"
+
+#define SECS_PER_DAY    86400
+#define SECS_PER_HOUR   3600
+/* 1970-01-01 was a Thursday */
+#define EPOCH_WDAY      4
+
+static inline bool is_digit(char c)
+{
+    return (unsigned)(c - '0') <= 9;
+}
+
+static inline bool is_alpha(char c)
+{
+    return (unsigned)((c | 0x20) - 'a') <= 'z' - 'a';
+}
+
+static inline bool is_leap(int64_t year)
+{
+    return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+}
+
+static int month_days(int64_t year, int month)
+{
+    static const uint8_t days[12] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+    return days[month - 1] + (month == 2 && is_leap(year));
+}
+
+/* Floor division, as days before the epoch count down */
+static inline int64_t floor_div(int64_t a, int64_t b)
+{
+    return a / b - (a % b < 0);
+}
+
+/* Days in 400 year eras starting on March 1st, so that the leap day is the last of the year */
+int64_t esp_rmaker_time_days_from_civil(int64_t year, int month, int day)
+{
+    year -= month <= 2;
+    int64_t era = floor_div(year, 400);
+    int64_t year_of_era = year - era * 400;
+    int64_t day_of_year = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    int64_t day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+    return era * 146097 + day_of_era - 719468;
+}
+
+static void civil_from_days(int64_t days, int64_t *year, int *month, int *day)
+{
+    days += 719468;
+    int64_t era = floor_div(days, 146097);
+    int64_t day_of_era = days - era * 146097;
+    int64_t year_of_era = (day_of_era - day_of_era / 1460 + day_of_era / 36524 - day_of_era / 146096) / 365;
+    int64_t day_of_year = day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+    int64_t mp = (5 * day_of_year + 2) / 153;
+    *day = day_of_year - (153 * mp + 2) / 5 + 1;
+    *month = mp < 10 ? mp + 3 : mp - 9;
+    *year = year_of_era + era * 400 + (*month <= 2);
+}
+
+void esp_rmaker_time_gmtime(time_t utc, struct tm *tm)
+{
+    int64_t days = floor_div(utc, SECS_PER_DAY);
+    int64_t secs = utc - days * SECS_PER_DAY;
+    int64_t year;
+    int month, day;
+    civil_from_days(days, &year, &month, &day);
+    memset(tm, 0, sizeof(struct tm));
+    tm->tm_year = year - 1900;
+    tm->tm_mon = month - 1;
+    tm->tm_mday = day;
+    tm->tm_hour = secs / SECS_PER_HOUR;
+    tm->tm_min = secs / 60 % 60;
+    tm->tm_sec = secs % 60;
+    tm->tm_wday = (days + EPOCH_WDAY) - floor_div(days + EPOCH_WDAY, 7) * 7;
+    tm->tm_yday = days - esp_rmaker_time_days_from_civil(year, 1, 1);
+}
+
+/* Zone name, letters or <...> quoted */
+static const char *tz_parse_name(const char *p)
+{
+    const char *start = p;
+    if (*p == '<') {
+        start = ++p;
+        while (is_alpha(*p) || is_digit(*p) || *p == '+' || *p == '-') {
+            p++;
+        }
+        return (*p == '>' && p - start >= 3) ? p + 1 : NULL;
+    }
+    while (is_alpha(*p)) {
+        p++;
+    }
+    return (p - start >= 3) ? p : NULL;
+}
+
+/* [+-]hh[:mm[:ss]], hours up to max_hours */
+static const char *tz_parse_time(const char *p, int max_hours, int32_t *secs)
+{
+    int sign = 1;
+    if (*p == '+' || *p == '-') {
+        sign = (*p++ == '-') ? -1 : 1;
+    }
+    int32_t value = 0;
+    int32_t unit = SECS_PER_HOUR;
+    for (int part = 0; part < 3; part++) {
+        if (part > 0) {
+            if (*p != ':') {
+                break;
+            }
+            p++;
+        }
+        if (!is_digit(*p)) {
+            return NULL;
+        }
+        int n = 0, digits = 0;
+        while (is_digit(*p) && digits < 3) {
+            n = n * 10 + (*p++ - '0');
+            digits++;
+        }
+        if ((part == 0 && n > max_hours) || (part > 0 && (digits > 2 || n > 59))) {
+            return NULL;
+        }
+        value += n * unit;
+        unit /= 60;
+    }
+    *secs = sign * value;
+    return p;
+}
+
+static const char *tz_parse_number(const char *p, int min, int max, int *n)
+{
+    if (!is_digit(*p)) {
+        return NULL;
+    }
+    int value = 0;
+    while (is_digit(*p)) {
+        value = value * 10 + (*p++ - '0');
+        if (value > max) {
+            return NULL;
+        }
+    }
+    *n = value;
+    return (value >= min) ? p : NULL;
+}
+
+/* Jn, n or Mm.w.d, then an optional /time */
+static const char *tz_parse_date(const char *p, esp_rmaker_tz_date_t *date)
+{
+    int n = 0;
+    memset(date, 0, sizeof(esp_rmaker_tz_date_t));
+    if (*p == 'J') {
+        date->kind = 'J';
+        p = tz_parse_number(p + 1, 1, 365, &n);
+        date->day = n;
+    } else if (*p == 'M') {
+        int month = 0, week = 0, wday = 0;
+        date->kind = 'M';
+        p = tz_parse_number(p + 1, 1, 12, &month);
+        if (p && *p++ == '.' && (p = tz_parse_number(p, 1, 5, &week)) && *p++ == '.') {
+            p = tz_parse_number(p, 0, 6, &wday);
+        } else {
+            p = NULL;
+        }
+        date->month = month;
+        date->week = week;
+        date->day = wday;
+    } else {
+        date->kind = 'n';
+        p = tz_parse_number(p, 0, 365, &n);
+        date->day = n;
+    }
+    date->time = 2 * SECS_PER_HOUR;
+    if (p && *p == '/') {
+        p = tz_parse_time(p + 1, 167, &date->time);
+    }
+    return p;
+}
+
+int esp_rmaker_tz_parse(const char *posix, esp_rmaker_tz_rule_t *rule)
+{
+    memset(rule, 0, sizeof(esp_rmaker_tz_rule_t));
+    if (!posix) {
+        return -1;
+    }
+    const char *p = tz_parse_name(posix);
+    int32_t offset;
+    if (!p || !(p = tz_parse_time(p, 24, &offset))) {
+        return -1;
+    }
+    rule->std_offset = -offset;
+    if (*p == '\0') {
+        return 0;
+    }
+    if (!(p = tz_parse_name(p))) {
+        return -1;
+    }
+    rule->has_dst = true;
+    rule->dst_offset = rule->std_offset + SECS_PER_HOUR;
+    if (*p != '\0' && *p != ',') {
+        if (!(p = tz_parse_time(p, 24, &offset))) {
+            return -1;
+        }
+        rule->dst_offset = -offset;
+    }
+    if (*p == '\0') {
+        /* The US rules, M3.2.0,M11.1.0 */
+        rule->start = (esp_rmaker_tz_date_t) { 'M', 0, 3, 2, 2 * SECS_PER_HOUR };
+        rule->end = (esp_rmaker_tz_date_t) { 'M', 0, 11, 1, 2 * SECS_PER_HOUR };
+        return 0;
+    }
+    if (*p != ',' || !(p = tz_parse_date(p + 1, &rule->start)) || *p != ',' ||
+            !(p = tz_parse_date(p + 1, &rule->end)) || *p != '\0') {
+        return -1;
+    }
+    return 0;
+}
+
+/* Seconds since the epoch of the local time of a transition, as if it were UTC */
+static time_t tz_date_local(const esp_rmaker_tz_date_t *date, int64_t year)
+{
+    int64_t days;
+    if (date->kind == 'J') {
+        /* February 29th is not counted */
+        days = esp_rmaker_time_days_from_civil(year, 1, 1) + date->day - 1 + (is_leap(year) && date->day >= 60);
+    } else if (date->kind == 'n') {
+        days = esp_rmaker_time_days_from_civil(year, 1, 1) + date->day;
+    } else {
+        int64_t first = esp_rmaker_time_days_from_civil(year, date->month, 1);
+        int first_wday = (first + EPOCH_WDAY) - floor_div(first + EPOCH_WDAY, 7) * 7;
+        int day = 1 + (date->day - first_wday + 7) % 7 + (date->week - 1) * 7;
+        /* Week 5 is the last one */
+        if (day > month_days(year, date->month)) {
+            day -= 7;
+        }
+        days = first + day - 1;
+    }
+    return days * SECS_PER_DAY + date->time;
+}
+
+void esp_rmaker_tz_cache_init(esp_rmaker_tz_cache_t *cache, const esp_rmaker_tz_rule_t *rule, time_t around)
+{
+    if (&cache->rule != rule) {
+        cache->rule = *rule;
+    }
+    /* From the year before, so that times a little in the past are cached too */
+    int64_t year;
+    int month, day;
+    civil_from_days(floor_div(around, SECS_PER_DAY), &year, &month, &day);
+    year--;
+    for (int i = 0; i < ESP_RMAKER_TZ_CACHE_YEARS; i++, year++) {
+        esp_rmaker_tz_year_t *entry = &cache->years[i];
+        entry->year_start = esp_rmaker_time_days_from_civil(year, 1, 1) * SECS_PER_DAY;
+        if (!rule->has_dst) {
+            entry->dst_start = entry->dst_end = entry->year_start;
+            continue;
+        }
+        /* The start is given in standard time and the end in daylight saving time */
+        entry->dst_start = tz_date_local(&rule->start, year) - rule->std_offset;
+        entry->dst_end = tz_date_local(&rule->end, year) - rule->dst_offset;
+    }
+    cache->until = esp_rmaker_time_days_from_civil(year, 1, 1) * SECS_PER_DAY;
+}
+
+int32_t esp_rmaker_tz_offset(esp_rmaker_tz_cache_t *cache, time_t utc, bool *is_dst)
+{
+    const esp_rmaker_tz_rule_t *rule = &cache->rule;
+    bool dst = false;
+    if (rule->has_dst) {
+        if (utc < cache->years[0].year_start || utc >= cache->until) {
+            esp_rmaker_tz_cache_init(cache, rule, utc);
+        }
+        /* Last year started by then */
+        size_t lo = 0, hi = ESP_RMAKER_TZ_CACHE_YEARS;
+        while (hi - lo > 1) {
+            size_t mid = (lo + hi) / 2;
+            if (cache->years[mid].year_start <= utc) {
+                lo = mid;
+            } else {
+                hi = mid;
+            }
+        }
+        const esp_rmaker_tz_year_t *entry = &cache->years[lo];
+        if (entry->dst_start < entry->dst_end) {
+            dst = utc >= entry->dst_start && utc < entry->dst_end;
+        } else {
+            dst = utc < entry->dst_end || utc >= entry->dst_start;
+        }
+    }
+    if (is_dst) {
+        *is_dst = dst;
+    }
+    return dst ? rule->dst_offset : rule->std_offset;
+}
+
+void esp_rmaker_tz_localtime(esp_rmaker_tz_cache_t *cache, time_t utc, struct tm *local)
+{
+    bool is_dst;
+    int32_t offset = esp_rmaker_tz_offset(cache, utc, &is_dst);
+    esp_rmaker_time_gmtime(utc + offset, local);
+    local->tm_isdst = is_dst;
+}
+
+time_t esp_rmaker_tz_mktime(esp_rmaker_tz_cache_t *cache, struct tm *local)
+{
+    /* Months out of range carry into the years, the other fields add up as seconds */
+    int64_t year = (int64_t)local->tm_year + 1900 + floor_div(local->tm_mon, 12);
+    int month = local->tm_mon - floor_div(local->tm_mon, 12) * 12 + 1;
+    time_t wall = (esp_rmaker_time_days_from_civil(year, month, 1) + local->tm_mday - 1) * SECS_PER_DAY +
+                  (int64_t)local->tm_hour * SECS_PER_HOUR + (int64_t)local->tm_min * 60 + local->tm_sec;
+    const esp_rmaker_tz_rule_t *rule = &cache->rule;
+    time_t utc = wall - rule->std_offset;
+    if (rule->has_dst) {
+        time_t as_std = wall - rule->std_offset;
+        time_t as_dst = wall - rule->dst_offset;
+        bool std_dst, dst_dst;
+        esp_rmaker_tz_offset(cache, as_std, &std_dst);
+        esp_rmaker_tz_offset(cache, as_dst, &dst_dst);
+        if (local->tm_isdst > 0 || (local->tm_isdst < 0 && dst_dst && (std_dst || as_dst < as_std))) {
+            /* In daylight saving time, or in both when the clocks go back and it comes first */
+            utc = as_dst;
+        } else {
+            /* In standard time, or in neither when the clocks go forward */
+            utc = as_std;
+        }
+    }
+    esp_rmaker_tz_localtime(cache, utc, local);
+    return utc;
+}
+
+/* Positions of the digits of YYYY-MM-DDTHH:MM:SS */
+static const uint8_t s_iso8601_digits[] = { 0, 1, 2, 3, 5, 6, 8, 9, 11, 12, 14, 15, 17, 18 };
+#define ISO8601_DATE_TIME_LEN   19
+
+static inline int iso8601_2digits(const char *s)
+{
+    return (s[0] - '0') * 10 + (s[1] - '0');
+}
+
+int esp_rmaker_time_parse_iso8601(const char *str, size_t len, time_t *utc)
+{
+    if (!str || len < ISO8601_DATE_TIME_LEN + 1) {
+        return -1;
+    }
+    /* All the checks of the fixed part are folded together, to branch once */
+    unsigned bad = 0;
+    for (size_t i = 0; i < sizeof(s_iso8601_digits); i++) {
+        bad |= !is_digit(str[s_iso8601_digits[i]]);
+    }
+    bad |= (str[4] != '-') | (str[7] != '-') | (str[13] != ':') | (str[16] != ':');
+    bad |= (str[10] != 'T') & (str[10] != 't') & (str[10] != ' ');
+    int year = iso8601_2digits(str) * 100 + iso8601_2digits(str + 2);
+    int month = iso8601_2digits(str + 5);
+    int day = iso8601_2digits(str + 8);
+    int hour = iso8601_2digits(str + 11);
+    int minute = iso8601_2digits(str + 14);
+    int second = iso8601_2digits(str + 17);
+    bad |= ((unsigned)(month - 1) > 11) | (hour > 23) | (minute > 59) | (second > 60);
+    if (bad || (unsigned)(day - 1) >= (unsigned)month_days(year, month)) {
+        return -1;
+    }
+
+    size_t i = ISO8601_DATE_TIME_LEN;
+    if (str[i] == '.') {
+        /* Fractional seconds are dropped */
+        size_t frac = ++i;
+        while (i < len && is_digit(str[i])) {
+            i++;
+        }
+        if (i == frac || i == len) {
+            return -1;
+        }
+    }
+    int32_t offset = 0;
+    if (str[i] == '+' || str[i] == '-') {
+        const char *zone = str + i + 1;
+        size_t zone_len = len - i - 1;
+        bool colon = zone_len >= 5 && zone[2] == ':';
+        if (zone_len < 4 || !is_digit(zone[0]) || !is_digit(zone[1]) ||
+                !is_digit(zone[2 + colon]) || !is_digit(zone[3 + colon])) {
+            return -1;
+        }
+        int zone_hour = iso8601_2digits(zone);
+        int zone_minute = iso8601_2digits(zone + 2 + colon);
+        if (zone_hour > 23 || zone_minute > 59) {
+            return -1;
+        }
+        offset = zone_hour * SECS_PER_HOUR + zone_minute * 60;
+        if (str[i] == '-') {
+            offset = -offset;
+        }
+    } else if (str[i] != 'Z' && str[i] != 'z') {
+        return -1;
+    }
+    *utc = (esp_rmaker_time_days_from_civil(year, month, day) * SECS_PER_DAY) + hour * SECS_PER_HOUR +
+           minute * 60 + second - offset;
+    return 0;
+}
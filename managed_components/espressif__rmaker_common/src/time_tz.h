@@ -0,0 +1,123 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*
+ * Local time without the C library's TZ handling. The POSIX TZ string is parsed once into a
+ * rule, from which the UTC times daylight saving time starts and ends in a few years are worked
+ * out and cached, so that converting between UTC and local time is a search among them. Times
+ * out of the cached years refill the cache around them. As in the C library, a time is in
+ * daylight saving time if it is between the start and the end of its UTC year, or out of the
+ * end and the start when the end comes first, as in the southern hemisphere.
+ *
+ * Dates are converted to days and back with closed-form arithmetic, without loops over years,
+ * and ISO8601 strings are read at fixed positions, without sscanf().
+ *
+ * Plain C, so that it can be built on the host by tools/time_tz_bench.c.
+ */
+
+/* Years cached, with two transitions each */
+#define ESP_RMAKER_TZ_CACHE_YEARS   8
+
+/* Day a transition happens, as in the POSIX TZ string */
+typedef struct {
+    char kind;                  /* 'J' for Jn, 'n' for n, 'M' for Mm.w.d */
+    uint16_t day;               /* n of Jn and n, d of Mm.w.d */
+    uint8_t month;
+    uint8_t week;
+    int32_t time;               /* Seconds since local midnight, before the transition */
+} esp_rmaker_tz_date_t;
+
+typedef struct {
+    int32_t std_offset;         /* Seconds east of UTC, unlike in the TZ string */
+    int32_t dst_offset;
+    bool has_dst;
+    esp_rmaker_tz_date_t start; /* Of daylight saving time */
+    esp_rmaker_tz_date_t end;
+} esp_rmaker_tz_rule_t;
+
+/* UTC times */
+typedef struct {
+    time_t year_start;
+    time_t dst_start;
+    time_t dst_end;
+} esp_rmaker_tz_year_t;
+
+typedef struct {
+    esp_rmaker_tz_rule_t rule;
+    time_t until;               /* Start of the year after the cached ones */
+    esp_rmaker_tz_year_t years[ESP_RMAKER_TZ_CACHE_YEARS];
+} esp_rmaker_tz_cache_t;
+
+/**
+ * @brief Parses a POSIX TZ string, like "PST8PDT,M3.2.0,M11.1.0"
+ *
+ * A zone with daylight saving time but no rules follows the US ones, as in the C library.
+ *
+ * @return 0 on success, -1 if the string is not valid
+ */
+int esp_rmaker_tz_parse(const char *posix, esp_rmaker_tz_rule_t *rule);
+
+/**
+ * @brief Sets up the cache for a rule, with the transitions of the years around the given time
+ */
+void esp_rmaker_tz_cache_init(esp_rmaker_tz_cache_t *cache, const esp_rmaker_tz_rule_t *rule, time_t around);
+
+/**
+ * @brief Seconds east of UTC at the given UTC time
+ *
+ * Refills the cache if the time is out of the years cached.
+ */
+int32_t esp_rmaker_tz_offset(esp_rmaker_tz_cache_t *cache, time_t utc, bool *is_dst);
+
+/**
+ * @brief Local time at the given UTC time, as localtime_r()
+ */
+void esp_rmaker_tz_localtime(esp_rmaker_tz_cache_t *cache, time_t utc, struct tm *local);
+
+/**
+ * @brief UTC time of a local time, as mktime()
+ *
+ * The fields of local are normalized. A positive or zero tm_isdst says whether the time is in
+ * daylight saving time, a negative one lets it be found out: a time repeated when the clocks go
+ * back is taken as the first one, and a time skipped when they go forward as standard time.
+ */
+time_t esp_rmaker_tz_mktime(esp_rmaker_tz_cache_t *cache, struct tm *local);
+
+/**
+ * @brief Days since 1970-01-01 of a date of the proleptic Gregorian calendar, month from 1 to 12
+ */
+int64_t esp_rmaker_time_days_from_civil(int64_t year, int month, int day);
+
+/**
+ * @brief Broken-down UTC time of seconds since the epoch, as gmtime_r()
+ */
+void esp_rmaker_time_gmtime(time_t utc, struct tm *tm);
+
+/**
+ * @brief Parses "YYYY-MM-DDTHH:MM:SS", with optional fractional seconds, then "Z" or an offset
+ *        "+HH:MM", "-HH:MM", "+HHMM" or "-HHMM"
+ *
+ * Characters after these are ignored.
+ *
+ * @return 0 on success, -1 if the string is not valid
+ */
+int esp_rmaker_time_parse_iso8601(const char *str, size_t len, time_t *utc);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,497 @@
+/*
+ * Generated by tools/tz_db_gen.py from tools/tz_db.csv, do not edit.
+ *
+ * 425 zones with 95 POSIX strings, in 6101 bytes.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#define TZ_DB_ZONES         425
+#define TZ_DB_BLOCKS        27
+#define TZ_DB_KEY_MAX       29
+
+/* POSIX strings, NUL terminated */
+static const char tz_db_posix[] =
+    "<+1245>-12:45<+1345>,M9.5.0/2:45,M4.1.0/3:45\0"
+    "<+1030>-10:30<+11>-11,M10.1.0,M4.1.0\0"
+    "<+0330>-3:30<+0430>,J79/24,J263/24\0"
+    "<+00>0<+02>-2,M3.5.0/1,M10.5.0/3\0"
+    "<-03>3<-02>,M3.5.0/-2,M10.5.0/-1\0"
+    "<+12>-12<+13>,M11.2.0,M1.2.3/99\0"
+    "<+13>-13<+14>,M9.5.0/3,M4.1.0/4\0"
+    "<-04>4<-03>,M9.1.6/24,M4.1.6/24\0"
+    "<-06>6<-05>,M9.1.6/22,M4.1.6/22\0"
+    "<+11>-11<+12>,M10.1.0,M4.1.0/3\0"
+    "<-01>1<+00>,M3.5.0/0,M10.5.0/1\0"
+    "<-04>4<-03>,M10.1.0/0,M3.4.0/0\0"
+    "ACST-9:30ACDT,M10.1.0,M4.1.0/3\0"
+    "EET-2EEST,M3.5.4/24,M10.5.5/1\0"
+    "AEST-10AEDT,M10.1.0,M4.1.0/3\0"
+    "EET-2EEST,M3.5.0/0,M10.5.0/0\0"
+    "EET-2EEST,M3.5.0/3,M10.5.0/4\0"
+    "EET-2EEST,M3.5.5/0,M10.5.5/0\0"
+    "EET-2EEST,M3.5.5/0,M10.5.6/1\0"
+    "NZST-12NZDT,M9.5.0,M4.1.0/3\0"
+    "<-03>3<-02>,M3.2.0,M11.1.0\0"
+    "CET-1CEST,M3.5.0,M10.5.0/3\0"
+    "CST5CDT,M3.2.0/0,M11.1.0/1\0"
+    "EET-2EEST,M3.5.0,M10.5.0/3\0"
+    "IST-1GMT0,M10.5.0,M3.5.0/1\0"
+    "IST-2IDT,M3.4.4/26,M10.5.0\0"
+    "NST3:30NDT,M3.2.0,M11.1.0\0"
+    "WET0WEST,M3.5.0/1,M10.5.0\0"
+    "AKST9AKDT,M3.2.0,M11.1.0\0"
+    "GMT0BST,M3.5.0/1,M10.5.0\0"
+    "HST10HDT,M3.2.0,M11.1.0\0"
+    "AST4ADT,M3.2.0,M11.1.0\0"
+    "CST6CDT,M3.2.0,M11.1.0\0"
+    "CST6CDT,M4.1.0,M10.5.0\0"
+    "EST5EDT,M3.2.0,M11.1.0\0"
+    "MST7MDT,M3.2.0,M11.1.0\0"
+    "MST7MDT,M4.1.0,M10.5.0\0"
+    "PST8PDT,M3.2.0,M11.1.0\0"
+    "<+0430>-4:30\0"
+    "<+0530>-5:30\0"
+    "<+0545>-5:45\0"
+    "<+0630>-6:30\0"
+    "<+0845>-8:45\0"
+    "<-0930>9:30\0"
+    "ACST-9:30\0"
+    "<+10>-10\0"
+    "<+11>-11\0"
+    "<+12>-12\0"
+    "<+13>-13\0"
+    "<+14>-14\0"
+    "IST-5:30\0"
+    "<+01>-1\0"
+    "<+03>-3\0"
+    "<+04>-4\0"
+    "<+05>-5\0"
+    "<+06>-6\0"
+    "<+07>-7\0"
+    "<+08>-8\0"
+    "<+09>-9\0"
+    "<-10>10\0"
+    "<-11>11\0"
+    "AEST-10\0"
+    "ChST-10\0"
+    "<-01>1\0"
+    "<-02>2\0"
+    "<-03>3\0"
+    "<-04>4\0"
+    "<-05>5\0"
+    "<-06>6\0"
+    "<-08>8\0"
+    "<-09>9\0"
+    "AWST-8\0"
+    "SAST-2\0"
+    "WITA-8\0"
+    "CAT-2\0"
+    "CET-1\0"
+    "CST-8\0"
+    "EAT-3\0"
+    "EET-2\0"
+    "HKT-8\0"
+    "HST10\0"
+    "JST-9\0"
+    "KST-9\0"
+    "MSK-3\0"
+    "PKT-5\0"
+    "PST-8\0"
+    "SST11\0"
+    "WAT-1\0"
+    "WIB-7\0"
+    "WIT-9\0"
+    "AST4\0"
+    "CST6\0"
+    "EST5\0"
+    "GMT0\0"
+    "MST7\0";
+
+static const uint16_t tz_db_posix_offsets[95] = {
+    117, 1228, 82, 1236, 1087, 1244, 1100, 1113, 1252, 1126, 1260, 1268,
+    1139, 1276, 1284, 45, 1174, 1183, 311, 0, 1192, 183, 1201, 215,
+    1210, 1324, 342, 1331, 1338, 638, 150, 1345, 373, 247, 1352, 1359,
+    279, 1366, 1152, 1373, 1292, 1300, 1164, 404, 1308, 465, 852, 1497,
+    926, 1380, 1401, 1407, 665, 1413, 692, 1502, 949, 972, 1316, 1419,
+    1425, 719, 494, 523, 435, 552, 581, 1507, 995, 1512, 877, 1431,
+    1437, 902, 746, 773, 1219, 1443, 1449, 1455, 1517, 1018, 1041, 800,
+    610, 1461, 1467, 1064, 1387, 1473, 1479, 826, 1485, 1491, 1394,
+};
+
+/* Zones, lowercased without underscores and sorted, in blocks of 16: the length of the prefix
+ * shared with the zone before, the length of the rest, the rest and the index of the POSIX string.
+ */
+static const uint8_t tz_db_zones[4335] = {
+    0x00, 0x0e, 0x61, 0x66, 0x72, 0x69, 0x63, 0x61, 0x2f, 0x61, 0x62, 0x69,
+    0x64, 0x6a, 0x61, 0x6e, 0x45, 0x08, 0x04, 0x63, 0x63, 0x72, 0x61, 0x45,
+    0x08, 0x09, 0x64, 0x64, 0x69, 0x73, 0x61, 0x62, 0x61, 0x62, 0x61, 0x3b,
+    0x08, 0x06, 0x6c, 0x67, 0x69, 0x65, 0x72, 0x73, 0x33, 0x08, 0x05, 0x73,
+    0x6d, 0x61, 0x72, 0x61, 0x3b, 0x07, 0x06, 0x62, 0x61, 0x6d, 0x61, 0x6b,
+    0x6f, 0x45, 0x09, 0x04, 0x6e, 0x67, 0x75, 0x69, 0x5a, 0x0a, 0x03, 0x6a,
+    0x75, 0x6c, 0x45, 0x08, 0x05, 0x69, 0x73, 0x73, 0x61, 0x75, 0x45, 0x08,
+    0x07, 0x6c, 0x61, 0x6e, 0x74, 0x79, 0x72, 0x65, 0x32, 0x08, 0x0a, 0x72,
+    0x61, 0x7a, 0x7a, 0x61, 0x76, 0x69, 0x6c, 0x6c, 0x65, 0x5a, 0x08, 0x08,
+    0x75, 0x6a, 0x75, 0x6d, 0x62, 0x75, 0x72, 0x61, 0x32, 0x07, 0x05, 0x63,
+    0x61, 0x69, 0x72, 0x6f, 0x3c, 0x09, 0x08, 0x73, 0x61, 0x62, 0x6c, 0x61,
+    0x6e, 0x63, 0x61, 0x01, 0x08, 0x04, 0x65, 0x75, 0x74, 0x61, 0x34, 0x08,
+    0x06, 0x6f, 0x6e, 0x61, 0x6b, 0x72, 0x79, 0x45, 0x00, 0x0c, 0x61, 0x66,
+    0x72, 0x69, 0x63, 0x61, 0x2f, 0x64, 0x61, 0x6b, 0x61, 0x72, 0x45, 0x09,
+    0x09, 0x72, 0x65, 0x73, 0x73, 0x61, 0x6c, 0x61, 0x61, 0x6d, 0x3b, 0x08,
+    0x07, 0x6a, 0x69, 0x62, 0x6f, 0x75, 0x74, 0x69, 0x3b, 0x08, 0x05, 0x6f,
+    0x75, 0x61, 0x6c, 0x61, 0x5a, 0x07, 0x07, 0x65, 0x6c, 0x61, 0x61, 0x69,
+    0x75, 0x6e, 0x01, 0x07, 0x08, 0x66, 0x72, 0x65, 0x65, 0x74, 0x6f, 0x77,
+    0x6e, 0x45, 0x07, 0x08, 0x67, 0x61, 0x62, 0x6f, 0x72, 0x6f, 0x6e, 0x65,
+    0x32, 0x07, 0x06, 0x68, 0x61, 0x72, 0x61, 0x72, 0x65, 0x32, 0x07, 0x0c,
+    0x6a, 0x6f, 0x68, 0x61, 0x6e, 0x6e, 0x65, 0x73, 0x62, 0x75, 0x72, 0x67,
+    0x58, 0x08, 0x03, 0x75, 0x62, 0x61, 0x3b, 0x07, 0x07, 0x6b, 0x61, 0x6d,
+    0x70, 0x61, 0x6c, 0x61, 0x3b, 0x08, 0x07, 0x68, 0x61, 0x72, 0x74, 0x6f,
+    0x75, 0x6d, 0x32, 0x08, 0x05, 0x69, 0x67, 0x61, 0x6c, 0x69, 0x32, 0x09,
+    0x06, 0x6e, 0x73, 0x68, 0x61, 0x73, 0x61, 0x5a, 0x07, 0x05, 0x6c, 0x61,
+    0x67, 0x6f, 0x73, 0x5a, 0x08, 0x09, 0x69, 0x62, 0x72, 0x65, 0x76, 0x69,
+    0x6c, 0x6c, 0x65, 0x5a, 0x00, 0x0b, 0x61, 0x66, 0x72, 0x69, 0x63, 0x61,
+    0x2f, 0x6c, 0x6f, 0x6d, 0x65, 0x45, 0x08, 0x05, 0x75, 0x61, 0x6e, 0x64,
+    0x61, 0x5a, 0x09, 0x08, 0x62, 0x75, 0x6d, 0x62, 0x61, 0x73, 0x68, 0x69,
+    0x32, 0x09, 0x04, 0x73, 0x61, 0x6b, 0x61, 0x32, 0x07, 0x06, 0x6d, 0x61,
+    0x6c, 0x61, 0x62, 0x6f, 0x5a, 0x09, 0x04, 0x70, 0x75, 0x74, 0x6f, 0x32,
+    0x09, 0x04, 0x73, 0x65, 0x72, 0x75, 0x58, 0x08, 0x06, 0x62, 0x61, 0x62,
+    0x61, 0x6e, 0x65, 0x58, 0x08, 0x08, 0x6f, 0x67, 0x61, 0x64, 0x69, 0x73,
+    0x68, 0x75, 0x3b, 0x09, 0x06, 0x6e, 0x72, 0x6f, 0x76, 0x69, 0x61, 0x45,
+    0x07, 0x07, 0x6e, 0x61, 0x69, 0x72, 0x6f, 0x62, 0x69, 0x3b, 0x08, 0x07,
+    0x64, 0x6a, 0x61, 0x6d, 0x65, 0x6e, 0x61, 0x5a, 0x08, 0x05, 0x69, 0x61,
+    0x6d, 0x65, 0x79, 0x5a, 0x08, 0x09, 0x6f, 0x75, 0x61, 0x6b, 0x63, 0x68,
+    0x6f, 0x74, 0x74, 0x45, 0x07, 0x0b, 0x6f, 0x75, 0x61, 0x67, 0x61, 0x64,
+    0x6f, 0x75, 0x67, 0x6f, 0x75, 0x45, 0x07, 0x0a, 0x70, 0x6f, 0x72, 0x74,
+    0x6f, 0x2d, 0x6e, 0x6f, 0x76, 0x6f, 0x5a, 0x00, 0x0e, 0x61, 0x66, 0x72,
+    0x69, 0x63, 0x61, 0x2f, 0x73, 0x61, 0x6f, 0x74, 0x6f, 0x6d, 0x65, 0x45,
+    0x07, 0x07, 0x74, 0x72, 0x69, 0x70, 0x6f, 0x6c, 0x69, 0x3c, 0x08, 0x04,
+    0x75, 0x6e, 0x69, 0x73, 0x33, 0x07, 0x08, 0x77, 0x69, 0x6e, 0x64, 0x68,
+    0x6f, 0x65, 0x6b, 0x32, 0x01, 0x0b, 0x6d, 0x65, 0x72, 0x69, 0x63, 0x61,
+    0x2f, 0x61, 0x64, 0x61, 0x6b, 0x49, 0x09, 0x08, 0x6e, 0x63, 0x68, 0x6f,
+    0x72, 0x61, 0x67, 0x65, 0x2e, 0x0a, 0x06, 0x67, 0x75, 0x69, 0x6c, 0x6c,
+    0x61, 0x2f, 0x0a, 0x05, 0x74, 0x69, 0x67, 0x75, 0x61, 0x2f, 0x09, 0x08,
+    0x72, 0x61, 0x67, 0x75, 0x61, 0x69, 0x6e, 0x61, 0x1c, 0x0a, 0x13, 0x67,
+    0x65, 0x6e, 0x74, 0x69, 0x6e, 0x61, 0x2f, 0x62, 0x75, 0x65, 0x6e, 0x6f,
+    0x73, 0x61, 0x69, 0x72, 0x65, 0x73, 0x1c, 0x12, 0x09, 0x63, 0x61, 0x74,
+    0x61, 0x6d, 0x61, 0x72, 0x63, 0x61, 0x1c, 0x13, 0x06, 0x6f, 0x72, 0x64,
+    0x6f, 0x62, 0x61, 0x1c, 0x12, 0x05, 0x6a, 0x75, 0x6a, 0x75, 0x79, 0x1c,
+    0x12, 0x07, 0x6c, 0x61, 0x72, 0x69, 0x6f, 0x6a, 0x61, 0x1c, 0x12, 0x07,
+    0x6d, 0x65, 0x6e, 0x64, 0x6f, 0x7a, 0x61, 0x1c, 0x12, 0x0b, 0x72, 0x69,
+    0x6f, 0x67, 0x61, 0x6c, 0x6c, 0x65, 0x67, 0x6f, 0x73, 0x1c, 0x00, 0x17,
+    0x61, 0x6d, 0x65, 0x72, 0x69, 0x63, 0x61, 0x2f, 0x61, 0x72, 0x67, 0x65,
+    0x6e, 0x74, 0x69, 0x6e, 0x61, 0x2f, 0x73, 0x61, 0x6c, 0x74, 0x61, 0x1c,
+    0x14, 0x05, 0x6e, 0x6a, 0x75, 0x61, 0x6e, 0x1c, 0x15, 0x04, 0x6c, 0x75,
+    0x69, 0x73, 0x1c, 0x12, 0x07, 0x74, 0x75, 0x63, 0x75, 0x6d, 0x61, 0x6e,
+    0x1c, 0x12, 0x07, 0x75, 0x73, 0x68, 0x75, 0x61, 0x69, 0x61, 0x1c, 0x0a,
+    0x03, 0x75, 0x62, 0x61, 0x2f, 0x09, 0x07, 0x73, 0x75, 0x6e, 0x63, 0x69,
+    0x6f, 0x6e, 0x20, 0x09, 0x07, 0x74, 0x69, 0x6b, 0x6f, 0x6b, 0x61, 0x6e,
+    0x43, 0x08, 0x05, 0x62, 0x61, 0x68, 0x69, 0x61, 0x1c, 0x0d, 0x08, 0x62,
+    0x61, 0x6e, 0x64, 0x65, 0x72, 0x61, 0x73, 0x39, 0x0a, 0x06, 0x72, 0x62,
+    0x61, 0x64, 0x6f, 0x73, 0x2f, 0x09, 0x04, 0x65, 0x6c, 0x65, 0x6d, 0x1c,
+    0x0b, 0x03, 0x69, 0x7a, 0x65, 0x37, 0x09, 0x0b, 0x6c, 0x61, 0x6e, 0x63,
+    0x2d, 0x73, 0x61, 0x62, 0x6c, 0x6f, 0x6e, 0x2f, 0x09, 0x07, 0x6f, 0x61,
+    0x76, 0x69, 0x73, 0x74, 0x61, 0x1f, 0x0a, 0x04, 0x67, 0x6f, 0x74, 0x61,
+    0x22, 0x00, 0x0d, 0x61, 0x6d, 0x65, 0x72, 0x69, 0x63, 0x61, 0x2f, 0x62,
+    0x6f, 0x69, 0x73, 0x65, 0x51, 0x08, 0x0c, 0x63, 0x61, 0x6d, 0x62, 0x72,
+    0x69, 0x64, 0x67, 0x65, 0x62, 0x61, 0x79, 0x51, 0x0b, 0x08, 0x70, 0x6f,
+    0x67, 0x72, 0x61, 0x6e, 0x64, 0x65, 0x1f, 0x0a, 0x04, 0x6e, 0x63, 0x75,
+    0x6e, 0x43, 0x0a, 0x05, 0x72, 0x61, 0x63, 0x61, 0x73, 0x1f, 0x0a, 0x05,
+    0x79, 0x65, 0x6e, 0x6e, 0x65, 0x1c, 0x0b, 0x03, 0x6d, 0x61, 0x6e, 0x43,
+    0x09, 0x06, 0x68, 0x69, 0x63, 0x61, 0x67, 0x6f, 0x38, 0x0b, 0x06, 0x68,
+    0x75, 0x61, 0x68, 0x75, 0x61, 0x52, 0x09, 0x08, 0x6f, 0x73, 0x74, 0x61,
+    0x72, 0x69, 0x63, 0x61, 0x37, 0x09, 0x06, 0x72, 0x65, 0x73, 0x74, 0x6f,
+    0x6e, 0x50, 0x09, 0x05, 0x75, 0x69, 0x61, 0x62, 0x61, 0x1f, 0x0a, 0x05,
+    0x72, 0x61, 0x63, 0x61, 0x6f, 0x2f, 0x08, 0x0c, 0x64, 0x61, 0x6e, 0x6d,
+    0x61, 0x72, 0x6b, 0x73, 0x68, 0x61, 0x76, 0x6e, 0x45, 0x0a, 0x04, 0x77,
+    0x73, 0x6f, 0x6e, 0x50, 0x0e, 0x05, 0x63, 0x72, 0x65, 0x65, 0x6b, 0x50,
+    0x00, 0x0e, 0x61, 0x6d, 0x65, 0x72, 0x69, 0x63, 0x61, 0x2f, 0x64, 0x65,
+    0x6e, 0x76, 0x65, 0x72, 0x51, 0x0a, 0x05, 0x74, 0x72, 0x6f, 0x69, 0x74,
+    0x44, 0x09, 0x07, 0x6f, 0x6d, 0x69, 0x6e, 0x69, 0x63, 0x61, 0x2f, 0x08,
+    0x08, 0x65, 0x64, 0x6d, 0x6f, 0x6e, 0x74, 0x6f, 0x6e, 0x51, 0x09, 0x07,
+    0x69, 0x72, 0x75, 0x6e, 0x65, 0x70, 0x65, 0x22, 0x09, 0x09, 0x6c, 0x73,
+    0x61, 0x6c, 0x76, 0x61, 0x64, 0x6f, 0x72, 0x37, 0x08, 0x09, 0x66, 0x6f,
+    0x72, 0x74, 0x61, 0x6c, 0x65, 0x7a, 0x61, 0x1c, 0x0c, 0x06, 0x6e, 0x65,
+    0x6c, 0x73, 0x6f, 0x6e, 0x50, 0x08, 0x08, 0x67, 0x6c, 0x61, 0x63, 0x65,
+    0x62, 0x61, 0x79, 0x30, 0x09, 0x06, 0x6f, 0x64, 0x74, 0x68, 0x61, 0x62,
+    0x1e, 0x0a, 0x06, 0x6f, 0x73, 0x65, 0x62, 0x61, 0x79, 0x30, 0x09, 0x08,
+    0x72, 0x61, 0x6e, 0x64, 0x74, 0x75, 0x72, 0x6b, 0x44, 0x0a, 0x05, 0x65,
+    0x6e, 0x61, 0x64, 0x61, 0x2f, 0x09, 0x09, 0x75, 0x61, 0x64, 0x65, 0x6c,
+    0x6f, 0x75, 0x70, 0x65, 0x2f, 0x0b, 0x06, 0x74, 0x65, 0x6d, 0x61, 0x6c,
+    0x61, 0x37, 0x0b, 0x06, 0x79, 0x61, 0x71, 0x75, 0x69, 0x6c, 0x22, 0x00,
+    0x0e, 0x61, 0x6d, 0x65, 0x72, 0x69, 0x63, 0x61, 0x2f, 0x67, 0x75, 0x79,
+    0x61, 0x6e, 0x61, 0x1f, 0x08, 0x07, 0x68, 0x61, 0x6c, 0x69, 0x66, 0x61,
+    0x78, 0x30, 0x0a, 0x04, 0x76, 0x61, 0x6e, 0x61, 0x36, 0x09, 0x09, 0x65,
+    0x72, 0x6d, 0x6f, 0x73, 0x69, 0x6c, 0x6c, 0x6f, 0x50, 0x08, 0x14, 0x69,
+    0x6e, 0x64, 0x69, 0x61, 0x6e, 0x61, 0x2f, 0x69, 0x6e, 0x64, 0x69, 0x61,
+    0x6e, 0x61, 0x70, 0x6f, 0x6c, 0x69, 0x73, 0x44, 0x10, 0x04, 0x6b, 0x6e,
+    0x6f, 0x78, 0x38, 0x10, 0x07, 0x6d, 0x61, 0x72, 0x65, 0x6e, 0x67, 0x6f,
+    0x44, 0x10, 0x0a, 0x70, 0x65, 0x74, 0x65, 0x72, 0x73, 0x62, 0x75, 0x72,
+    0x67, 0x44, 0x10, 0x08, 0x74, 0x65, 0x6c, 0x6c, 0x63, 0x69, 0x74, 0x79,
+    0x38, 0x10, 0x05, 0x76, 0x65, 0x76, 0x61, 0x79, 0x44, 0x11, 0x08, 0x69,
+    0x6e, 0x63, 0x65, 0x6e, 0x6e, 0x65, 0x73, 0x44, 0x10, 0x07, 0x77, 0x69,
+    0x6e, 0x61, 0x6d, 0x61, 0x63, 0x44, 0x0a, 0x04, 0x75, 0x76, 0x69, 0x6b,
+    0x51, 0x09, 0x06, 0x71, 0x61, 0x6c, 0x75, 0x69, 0x74, 0x44, 0x08, 0x07,
+    0x6a, 0x61, 0x6d, 0x61, 0x69, 0x63, 0x61, 0x43, 0x09, 0x05, 0x75, 0x6e,
+    0x65, 0x61, 0x75, 0x2e, 0x00, 0x1b, 0x61, 0x6d, 0x65, 0x72, 0x69, 0x63,
+    0x61, 0x2f, 0x6b, 0x65, 0x6e, 0x74, 0x75, 0x63, 0x6b, 0x79, 0x2f, 0x6c,
+    0x6f, 0x75, 0x69, 0x73, 0x76, 0x69, 0x6c, 0x6c, 0x65, 0x44, 0x11, 0x0a,
+    0x6d, 0x6f, 0x6e, 0x74, 0x69, 0x63, 0x65, 0x6c, 0x6c, 0x6f, 0x44, 0x09,
+    0x09, 0x72, 0x61, 0x6c, 0x65, 0x6e, 0x64, 0x69, 0x6a, 0x6b, 0x2f, 0x08,
+    0x05, 0x6c, 0x61, 0x70, 0x61, 0x7a, 0x1f, 0x09, 0x03, 0x69, 0x6d, 0x61,
+    0x22, 0x09, 0x09, 0x6f, 0x73, 0x61, 0x6e, 0x67, 0x65, 0x6c, 0x65, 0x73,
+    0x57, 0x0a, 0x0a, 0x77, 0x65, 0x72, 0x70, 0x72, 0x69, 0x6e, 0x63, 0x65,
+    0x73, 0x2f, 0x08, 0x06, 0x6d, 0x61, 0x63, 0x65, 0x69, 0x6f, 0x1c, 0x0a,
+    0x05, 0x6e, 0x61, 0x67, 0x75, 0x61, 0x37, 0x0c, 0x02, 0x75, 0x73, 0x1f,
+    0x0a, 0x05, 0x72, 0x69, 0x67, 0x6f, 0x74, 0x2f, 0x0b, 0x07, 0x74, 0x69,
+    0x6e, 0x69, 0x71, 0x75, 0x65, 0x2f, 0x0a, 0x07, 0x74, 0x61, 0x6d, 0x6f,
+    0x72, 0x6f, 0x73, 0x38, 0x0a, 0x06, 0x7a, 0x61, 0x74, 0x6c, 0x61, 0x6e,
+    0x52, 0x09, 0x08, 0x65, 0x6e, 0x6f, 0x6d, 0x69, 0x6e, 0x65, 0x65, 0x38,
+    0x0a, 0x04, 0x72, 0x69, 0x64, 0x61, 0x39, 0x00, 0x12, 0x61, 0x6d, 0x65,
+    0x72, 0x69, 0x63, 0x61, 0x2f, 0x6d, 0x65, 0x74, 0x6c, 0x61, 0x6b, 0x61,
+    0x74, 0x6c, 0x61, 0x2e, 0x0a, 0x08, 0x78, 0x69, 0x63, 0x6f, 0x63, 0x69,
+    0x74, 0x79, 0x39, 0x09, 0x07, 0x69, 0x71, 0x75, 0x65, 0x6c, 0x6f, 0x6e,
+    0x1d, 0x09, 0x06, 0x6f, 0x6e, 0x63, 0x74, 0x6f, 0x6e, 0x30, 0x0b, 0x06,
+    0x74, 0x65, 0x72, 0x72, 0x65, 0x79, 0x39, 0x0d, 0x05, 0x76, 0x69, 0x64,
+    0x65, 0x6f, 0x1c, 0x0c, 0x04, 0x72, 0x65, 0x61, 0x6c, 0x44, 0x0c, 0x06,
+    0x73, 0x65, 0x72, 0x72, 0x61, 0x74, 0x2f, 0x08, 0x06, 0x6e, 0x61, 0x73,
+    0x73, 0x61, 0x75, 0x44, 0x09, 0x06, 0x65, 0x77, 0x79, 0x6f, 0x72, 0x6b,
+    0x44, 0x09, 0x06, 0x69, 0x70, 0x69, 0x67, 0x6f, 0x6e, 0x44, 0x09, 0x03,
+    0x6f, 0x6d, 0x65, 0x2e, 0x0a, 0x05, 0x72, 0x6f, 0x6e, 0x68, 0x61, 0x1b,
+    0x0b, 0x0f, 0x74, 0x68, 0x64, 0x61, 0x6b, 0x6f, 0x74, 0x61, 0x2f, 0x62,
+    0x65, 0x75, 0x6c, 0x61, 0x68, 0x38, 0x14, 0x06, 0x63, 0x65, 0x6e, 0x74,
+    0x65, 0x72, 0x38, 0x14, 0x08, 0x6e, 0x65, 0x77, 0x73, 0x61, 0x6c, 0x65,
+    0x6d, 0x38, 0x00, 0x0f, 0x61, 0x6d, 0x65, 0x72, 0x69, 0x63, 0x61, 0x2f,
+    0x6f, 0x6a, 0x69, 0x6e, 0x61, 0x67, 0x61, 0x51, 0x08, 0x06, 0x70, 0x61,
+    0x6e, 0x61, 0x6d, 0x61, 0x43, 0x0b, 0x08, 0x67, 0x6e, 0x69, 0x72, 0x74,
+    0x75, 0x6e, 0x67, 0x44, 0x0a, 0x08, 0x72, 0x61, 0x6d, 0x61, 0x72, 0x69,
+    0x62, 0x6f, 0x1c, 0x09, 0x06, 0x68, 0x6f, 0x65, 0x6e, 0x69, 0x78, 0x50,
+    0x09, 0x0d, 0x6f, 0x72, 0x74, 0x2d, 0x61, 0x75, 0x2d, 0x70, 0x72, 0x69,
+    0x6e, 0x63, 0x65, 0x44, 0x0c, 0x07, 0x6f, 0x66, 0x73, 0x70, 0x61, 0x69,
+    0x6e, 0x2f, 0x0d, 0x05, 0x76, 0x65, 0x6c, 0x68, 0x6f, 0x1f, 0x09, 0x09,
+    0x75, 0x65, 0x72, 0x74, 0x6f, 0x72, 0x69, 0x63, 0x6f, 0x2f, 0x0a, 0x09,
+    0x6e, 0x74, 0x61, 0x61, 0x72, 0x65, 0x6e, 0x61, 0x73, 0x1c, 0x08, 0x0a,
+    0x72, 0x61, 0x69, 0x6e, 0x79, 0x72, 0x69, 0x76, 0x65, 0x72, 0x38, 0x0a,
+    0x09, 0x6e, 0x6b, 0x69, 0x6e, 0x69, 0x6e, 0x6c, 0x65, 0x74, 0x38, 0x09,
+    0x05, 0x65, 0x63, 0x69, 0x66, 0x65, 0x1c, 0x0a, 0x04, 0x67, 0x69, 0x6e,
+    0x61, 0x37, 0x0a, 0x06, 0x73, 0x6f, 0x6c, 0x75, 0x74, 0x65, 0x38, 0x09,
+    0x08, 0x69, 0x6f, 0x62, 0x72, 0x61, 0x6e, 0x63, 0x6f, 0x22, 0x00, 0x10,
+    0x61, 0x6d, 0x65, 0x72, 0x69, 0x63, 0x61, 0x2f, 0x73, 0x61, 0x6e, 0x74,
+    0x61, 0x72, 0x65, 0x6d, 0x1c, 0x0c, 0x04, 0x69, 0x61, 0x67, 0x6f, 0x21,
+    0x0c, 0x08, 0x6f, 0x64, 0x6f, 0x6d, 0x69, 0x6e, 0x67, 0x6f, 0x2f, 0x0a,
+    0x06, 0x6f, 0x70, 0x61, 0x75, 0x6c, 0x6f, 0x1c, 0x09, 0x0b, 0x63, 0x6f,
+    0x72, 0x65, 0x73, 0x62, 0x79, 0x73, 0x75, 0x6e, 0x64, 0x1a, 0x09, 0x04,
+    0x69, 0x74, 0x6b, 0x61, 0x2e, 0x09, 0x0b, 0x74, 0x62, 0x61, 0x72, 0x74,
+    0x68, 0x65, 0x6c, 0x65, 0x6d, 0x79, 0x2f, 0x0a, 0x05, 0x6a, 0x6f, 0x68,
+    0x6e, 0x73, 0x53, 0x0a, 0x05, 0x6b, 0x69, 0x74, 0x74, 0x73, 0x2f, 0x0a,
+    0x05, 0x6c, 0x75, 0x63, 0x69, 0x61, 0x2f, 0x0a, 0x06, 0x74, 0x68, 0x6f,
+    0x6d, 0x61, 0x73, 0x2f, 0x0a, 0x07, 0x76, 0x69, 0x6e, 0x63, 0x65, 0x6e,
+    0x74, 0x2f, 0x09, 0x0b, 0x77, 0x69, 0x66, 0x74, 0x63, 0x75, 0x72, 0x72,
+    0x65, 0x6e, 0x74, 0x37, 0x08, 0x0b, 0x74, 0x65, 0x67, 0x75, 0x63, 0x69,
+    0x67, 0x61, 0x6c, 0x70, 0x61, 0x37, 0x09, 0x04, 0x68, 0x75, 0x6c, 0x65,
+    0x30, 0x0b, 0x07, 0x6e, 0x64, 0x65, 0x72, 0x62, 0x61, 0x79, 0x44, 0x00,
+    0x0f, 0x61, 0x6d, 0x65, 0x72, 0x69, 0x63, 0x61, 0x2f, 0x74, 0x69, 0x6a,
+    0x75, 0x61, 0x6e, 0x61, 0x57, 0x09, 0x06, 0x6f, 0x72, 0x6f, 0x6e, 0x74,
+    0x6f, 0x44, 0x0b, 0x04, 0x74, 0x6f, 0x6c, 0x61, 0x2f, 0x08, 0x09, 0x76,
+    0x61, 0x6e, 0x63, 0x6f, 0x75, 0x76, 0x65, 0x72, 0x57, 0x08, 0x0a, 0x77,
+    0x68, 0x69, 0x74, 0x65, 0x68, 0x6f, 0x72, 0x73, 0x65, 0x50, 0x09, 0x07,
+    0x69, 0x6e, 0x6e, 0x69, 0x70, 0x65, 0x67, 0x38, 0x08, 0x07, 0x79, 0x61,
+    0x6b, 0x75, 0x74, 0x61, 0x74, 0x2e, 0x09, 0x0a, 0x65, 0x6c, 0x6c, 0x6f,
+    0x77, 0x6b, 0x6e, 0x69, 0x66, 0x65, 0x51, 0x01, 0x0f, 0x6e, 0x74, 0x61,
+    0x72, 0x63, 0x74, 0x69, 0x63, 0x61, 0x2f, 0x63, 0x61, 0x73, 0x65, 0x79,
+    0x0d, 0x0b, 0x05, 0x64, 0x61, 0x76, 0x69, 0x73, 0x0b, 0x0c, 0x0d, 0x75,
+    0x6d, 0x6f, 0x6e, 0x74, 0x64, 0x75, 0x72, 0x76, 0x69, 0x6c, 0x6c, 0x65,
+    0x10, 0x0b, 0x09, 0x6d, 0x61, 0x63, 0x71, 0x75, 0x61, 0x72, 0x69, 0x65,
+    0x11, 0x0d, 0x04, 0x77, 0x73, 0x6f, 0x6e, 0x08, 0x0c, 0x06, 0x63, 0x6d,
+    0x75, 0x72, 0x64, 0x6f, 0x54, 0x0b, 0x06, 0x70, 0x61, 0x6c, 0x6d, 0x65,
+    0x72, 0x1c, 0x0b, 0x07, 0x72, 0x6f, 0x74, 0x68, 0x65, 0x72, 0x61, 0x1c,
+    0x00, 0x10, 0x61, 0x6e, 0x74, 0x61, 0x72, 0x63, 0x74, 0x69, 0x63, 0x61,
+    0x2f, 0x73, 0x79, 0x6f, 0x77, 0x61, 0x03, 0x0b, 0x05, 0x74, 0x72, 0x6f,
+    0x6c, 0x6c, 0x00, 0x0b, 0x06, 0x76, 0x6f, 0x73, 0x74, 0x6f, 0x6b, 0x0a,
+    0x01, 0x12, 0x72, 0x63, 0x74, 0x69, 0x63, 0x2f, 0x6c, 0x6f, 0x6e, 0x67,
+    0x79, 0x65, 0x61, 0x72, 0x62, 0x79, 0x65, 0x6e, 0x34, 0x01, 0x08, 0x73,
+    0x69, 0x61, 0x2f, 0x61, 0x64, 0x65, 0x6e, 0x03, 0x06, 0x05, 0x6c, 0x6d,
+    0x61, 0x74, 0x79, 0x0a, 0x06, 0x04, 0x6d, 0x6d, 0x61, 0x6e, 0x40, 0x06,
+    0x05, 0x6e, 0x61, 0x64, 0x79, 0x72, 0x14, 0x06, 0x04, 0x71, 0x74, 0x61,
+    0x75, 0x08, 0x08, 0x03, 0x6f, 0x62, 0x65, 0x08, 0x06, 0x07, 0x73, 0x68,
+    0x67, 0x61, 0x62, 0x61, 0x74, 0x08, 0x06, 0x05, 0x74, 0x79, 0x72, 0x61,
+    0x75, 0x08, 0x05, 0x07, 0x62, 0x61, 0x67, 0x68, 0x64, 0x61, 0x64, 0x03,
+    0x07, 0x05, 0x68, 0x72, 0x61, 0x69, 0x6e, 0x03, 0x07, 0x02, 0x6b, 0x75,
+    0x05, 0x07, 0x05, 0x6e, 0x67, 0x6b, 0x6f, 0x6b, 0x0b, 0x00, 0x0c, 0x61,
+    0x73, 0x69, 0x61, 0x2f, 0x62, 0x61, 0x72, 0x6e, 0x61, 0x75, 0x6c, 0x0b,
+    0x06, 0x05, 0x65, 0x69, 0x72, 0x75, 0x74, 0x3e, 0x06, 0x06, 0x69, 0x73,
+    0x68, 0x6b, 0x65, 0x6b, 0x0a, 0x06, 0x05, 0x72, 0x75, 0x6e, 0x65, 0x69,
+    0x0d, 0x05, 0x05, 0x63, 0x68, 0x69, 0x74, 0x61, 0x0e, 0x07, 0x08, 0x6f,
+    0x69, 0x62, 0x61, 0x6c, 0x73, 0x61, 0x6e, 0x0d, 0x06, 0x06, 0x6f, 0x6c,
+    0x6f, 0x6d, 0x62, 0x6f, 0x06, 0x05, 0x08, 0x64, 0x61, 0x6d, 0x61, 0x73,
+    0x63, 0x75, 0x73, 0x41, 0x06, 0x04, 0x68, 0x61, 0x6b, 0x61, 0x0a, 0x06,
+    0x03, 0x69, 0x6c, 0x69, 0x0e, 0x06, 0x04, 0x75, 0x62, 0x61, 0x69, 0x05,
+    0x07, 0x06, 0x73, 0x68, 0x61, 0x6e, 0x62, 0x65, 0x08, 0x05, 0x09, 0x66,
+    0x61, 0x6d, 0x61, 0x67, 0x75, 0x73, 0x74, 0x61, 0x3f, 0x05, 0x04, 0x67,
+    0x61, 0x7a, 0x61, 0x42, 0x05, 0x06, 0x68, 0x65, 0x62, 0x72, 0x6f, 0x6e,
+    0x42, 0x06, 0x08, 0x6f, 0x63, 0x68, 0x69, 0x6d, 0x69, 0x6e, 0x68, 0x0b,
+    0x00, 0x0d, 0x61, 0x73, 0x69, 0x61, 0x2f, 0x68, 0x6f, 0x6e, 0x67, 0x6b,
+    0x6f, 0x6e, 0x67, 0x47, 0x07, 0x02, 0x76, 0x64, 0x0b, 0x05, 0x07, 0x69,
+    0x72, 0x6b, 0x75, 0x74, 0x73, 0x6b, 0x0d, 0x05, 0x07, 0x6a, 0x61, 0x6b,
+    0x61, 0x72, 0x74, 0x61, 0x5c, 0x07, 0x06, 0x79, 0x61, 0x70, 0x75, 0x72,
+    0x61, 0x5d, 0x06, 0x08, 0x65, 0x72, 0x75, 0x73, 0x61, 0x6c, 0x65, 0x6d,
+    0x4b, 0x05, 0x05, 0x6b, 0x61, 0x62, 0x75, 0x6c, 0x04, 0x07, 0x07, 0x6d,
+    0x63, 0x68, 0x61, 0x74, 0x6b, 0x61, 0x14, 0x07, 0x05, 0x72, 0x61, 0x63,
+    0x68, 0x69, 0x55, 0x07, 0x07, 0x74, 0x68, 0x6d, 0x61, 0x6e, 0x64, 0x75,
+    0x07, 0x06, 0x07, 0x68, 0x61, 0x6e, 0x64, 0x79, 0x67, 0x61, 0x0e, 0x06,
+    0x06, 0x6f, 0x6c, 0x6b, 0x61, 0x74, 0x61, 0x4c, 0x06, 0x0a, 0x72, 0x61,
+    0x73, 0x6e, 0x6f, 0x79, 0x61, 0x72, 0x73, 0x6b, 0x0b, 0x06, 0x0a, 0x75,
+    0x61, 0x6c, 0x61, 0x6c, 0x75, 0x6d, 0x70, 0x75, 0x72, 0x0d, 0x07, 0x05,
+    0x63, 0x68, 0x69, 0x6e, 0x67, 0x0d, 0x07, 0x04, 0x77, 0x61, 0x69, 0x74,
+    0x03, 0x00, 0x0a, 0x61, 0x73, 0x69, 0x61, 0x2f, 0x6d, 0x61, 0x63, 0x61,
+    0x75, 0x35, 0x07, 0x05, 0x67, 0x61, 0x64, 0x61, 0x6e, 0x11, 0x07, 0x06,
+    0x6b, 0x61, 0x73, 0x73, 0x61, 0x72, 0x5e, 0x07, 0x04, 0x6e, 0x69, 0x6c,
+    0x61, 0x56, 0x06, 0x05, 0x75, 0x73, 0x63, 0x61, 0x74, 0x05, 0x05, 0x07,
+    0x6e, 0x69, 0x63, 0x6f, 0x73, 0x69, 0x61, 0x3f, 0x06, 0x0b, 0x6f, 0x76,
+    0x6f, 0x6b, 0x75, 0x7a, 0x6e, 0x65, 0x74, 0x73, 0x6b, 0x0b, 0x09, 0x07,
+    0x73, 0x69, 0x62, 0x69, 0x72, 0x73, 0x6b, 0x0b, 0x05, 0x04, 0x6f, 0x6d,
+    0x73, 0x6b, 0x0a, 0x06, 0x03, 0x72, 0x61, 0x6c, 0x08, 0x05, 0x09, 0x70,
+    0x68, 0x6e, 0x6f, 0x6d, 0x70, 0x65, 0x6e, 0x68, 0x0b, 0x06, 0x08, 0x6f,
+    0x6e, 0x74, 0x69, 0x61, 0x6e, 0x61, 0x6b, 0x5c, 0x06, 0x08, 0x79, 0x6f,
+    0x6e, 0x67, 0x79, 0x61, 0x6e, 0x67, 0x4e, 0x05, 0x05, 0x71, 0x61, 0x74,
+    0x61, 0x72, 0x03, 0x06, 0x08, 0x79, 0x7a, 0x79, 0x6c, 0x6f, 0x72, 0x64,
+    0x61, 0x08, 0x05, 0x06, 0x72, 0x69, 0x79, 0x61, 0x64, 0x68, 0x03, 0x00,
+    0x0d, 0x61, 0x73, 0x69, 0x61, 0x2f, 0x73, 0x61, 0x6b, 0x68, 0x61, 0x6c,
+    0x69, 0x6e, 0x11, 0x07, 0x07, 0x6d, 0x61, 0x72, 0x6b, 0x61, 0x6e, 0x64,
+    0x08, 0x06, 0x04, 0x65, 0x6f, 0x75, 0x6c, 0x4e, 0x06, 0x07, 0x68, 0x61,
+    0x6e, 0x67, 0x68, 0x61, 0x69, 0x35, 0x06, 0x08, 0x69, 0x6e, 0x67, 0x61,
+    0x70, 0x6f, 0x72, 0x65, 0x0d, 0x06, 0x0c, 0x72, 0x65, 0x64, 0x6e, 0x65,
+    0x6b, 0x6f, 0x6c, 0x79, 0x6d, 0x73, 0x6b, 0x11, 0x05, 0x06, 0x74, 0x61,
+    0x69, 0x70, 0x65, 0x69, 0x35, 0x07, 0x06, 0x73, 0x68, 0x6b, 0x65, 0x6e,
+    0x74, 0x08, 0x06, 0x06, 0x62, 0x69, 0x6c, 0x69, 0x73, 0x69, 0x05, 0x06,
+    0x05, 0x65, 0x68, 0x72, 0x61, 0x6e, 0x02, 0x06, 0x06, 0x68, 0x69, 0x6d,
+    0x70, 0x68, 0x75, 0x0a, 0x06, 0x04, 0x6f, 0x6b, 0x79, 0x6f, 0x4d, 0x07,
+    0x03, 0x6d, 0x73, 0x6b, 0x0b, 0x05, 0x0b, 0x75, 0x6c, 0x61, 0x61, 0x6e,
+    0x62, 0x61, 0x61, 0x74, 0x61, 0x72, 0x0d, 0x06, 0x05, 0x72, 0x75, 0x6d,
+    0x71, 0x69, 0x0a, 0x06, 0x07, 0x73, 0x74, 0x2d, 0x6e, 0x65, 0x72, 0x61,
+    0x10, 0x00, 0x0e, 0x61, 0x73, 0x69, 0x61, 0x2f, 0x76, 0x69, 0x65, 0x6e,
+    0x74, 0x69, 0x61, 0x6e, 0x65, 0x0b, 0x06, 0x0a, 0x6c, 0x61, 0x64, 0x69,
+    0x76, 0x6f, 0x73, 0x74, 0x6f, 0x6b, 0x10, 0x05, 0x07, 0x79, 0x61, 0x6b,
+    0x75, 0x74, 0x73, 0x6b, 0x0e, 0x07, 0x04, 0x6e, 0x67, 0x6f, 0x6e, 0x09,
+    0x06, 0x0c, 0x65, 0x6b, 0x61, 0x74, 0x65, 0x72, 0x69, 0x6e, 0x62, 0x75,
+    0x72, 0x67, 0x08, 0x07, 0x05, 0x72, 0x65, 0x76, 0x61, 0x6e, 0x05, 0x01,
+    0x0e, 0x74, 0x6c, 0x61, 0x6e, 0x74, 0x69, 0x63, 0x2f, 0x61, 0x7a, 0x6f,
+    0x72, 0x65, 0x73, 0x1a, 0x09, 0x07, 0x62, 0x65, 0x72, 0x6d, 0x75, 0x64,
+    0x61, 0x30, 0x09, 0x06, 0x63, 0x61, 0x6e, 0x61, 0x72, 0x79, 0x5b, 0x0b,
+    0x07, 0x70, 0x65, 0x76, 0x65, 0x72, 0x64, 0x65, 0x19, 0x09, 0x05, 0x66,
+    0x61, 0x72, 0x6f, 0x65, 0x5b, 0x09, 0x07, 0x6d, 0x61, 0x64, 0x65, 0x69,
+    0x72, 0x61, 0x5b, 0x09, 0x09, 0x72, 0x65, 0x79, 0x6b, 0x6a, 0x61, 0x76,
+    0x69, 0x6b, 0x45, 0x09, 0x0c, 0x73, 0x6f, 0x75, 0x74, 0x68, 0x67, 0x65,
+    0x6f, 0x72, 0x67, 0x69, 0x61, 0x1b, 0x0a, 0x06, 0x74, 0x61, 0x6e, 0x6c,
+    0x65, 0x79, 0x1c, 0x0b, 0x06, 0x68, 0x65, 0x6c, 0x65, 0x6e, 0x61, 0x45,
+    0x00, 0x12, 0x61, 0x75, 0x73, 0x74, 0x72, 0x61, 0x6c, 0x69, 0x61, 0x2f,
+    0x61, 0x64, 0x65, 0x6c, 0x61, 0x69, 0x64, 0x65, 0x2b, 0x0a, 0x08, 0x62,
+    0x72, 0x69, 0x73, 0x62, 0x61, 0x6e, 0x65, 0x2c, 0x0c, 0x08, 0x6f, 0x6b,
+    0x65, 0x6e, 0x68, 0x69, 0x6c, 0x6c, 0x2b, 0x0a, 0x06, 0x63, 0x75, 0x72,
+    0x72, 0x69, 0x65, 0x2d, 0x0a, 0x06, 0x64, 0x61, 0x72, 0x77, 0x69, 0x6e,
+    0x2a, 0x0a, 0x05, 0x65, 0x75, 0x63, 0x6c, 0x61, 0x0c, 0x0a, 0x06, 0x68,
+    0x6f, 0x62, 0x61, 0x72, 0x74, 0x2d, 0x0a, 0x08, 0x6c, 0x69, 0x6e, 0x64,
+    0x65, 0x6d, 0x61, 0x6e, 0x2c, 0x0b, 0x07, 0x6f, 0x72, 0x64, 0x68, 0x6f,
+    0x77, 0x65, 0x0f, 0x0a, 0x09, 0x6d, 0x65, 0x6c, 0x62, 0x6f, 0x75, 0x72,
+    0x6e, 0x65, 0x2d, 0x0a, 0x05, 0x70, 0x65, 0x72, 0x74, 0x68, 0x31, 0x0a,
+    0x06, 0x73, 0x79, 0x64, 0x6e, 0x65, 0x79, 0x2d, 0x00, 0x10, 0x65, 0x75,
+    0x72, 0x6f, 0x70, 0x65, 0x2f, 0x61, 0x6d, 0x73, 0x74, 0x65, 0x72, 0x64,
+    0x61, 0x6d, 0x34, 0x08, 0x06, 0x6e, 0x64, 0x6f, 0x72, 0x72, 0x61, 0x34,
+    0x08, 0x08, 0x73, 0x74, 0x72, 0x61, 0x6b, 0x68, 0x61, 0x6e, 0x05, 0x08,
+    0x05, 0x74, 0x68, 0x65, 0x6e, 0x73, 0x3f, 0x00, 0x0f, 0x65, 0x75, 0x72,
+    0x6f, 0x70, 0x65, 0x2f, 0x62, 0x65, 0x6c, 0x67, 0x72, 0x61, 0x64, 0x65,
+    0x34, 0x09, 0x04, 0x72, 0x6c, 0x69, 0x6e, 0x34, 0x08, 0x09, 0x72, 0x61,
+    0x74, 0x69, 0x73, 0x6c, 0x61, 0x76, 0x61, 0x34, 0x09, 0x06, 0x75, 0x73,
+    0x73, 0x65, 0x6c, 0x73, 0x34, 0x08, 0x08, 0x75, 0x63, 0x68, 0x61, 0x72,
+    0x65, 0x73, 0x74, 0x3f, 0x09, 0x06, 0x64, 0x61, 0x70, 0x65, 0x73, 0x74,
+    0x34, 0x09, 0x06, 0x73, 0x69, 0x6e, 0x67, 0x65, 0x6e, 0x34, 0x07, 0x08,
+    0x63, 0x68, 0x69, 0x73, 0x69, 0x6e, 0x61, 0x75, 0x3d, 0x08, 0x09, 0x6f,
+    0x70, 0x65, 0x6e, 0x68, 0x61, 0x67, 0x65, 0x6e, 0x34, 0x07, 0x06, 0x64,
+    0x75, 0x62, 0x6c, 0x69, 0x6e, 0x4a, 0x07, 0x09, 0x67, 0x69, 0x62, 0x72,
+    0x61, 0x6c, 0x74, 0x61, 0x72, 0x34, 0x08, 0x07, 0x75, 0x65, 0x72, 0x6e,
+    0x73, 0x65, 0x79, 0x46, 0x07, 0x08, 0x68, 0x65, 0x6c, 0x73, 0x69, 0x6e,
+    0x6b, 0x69, 0x3f, 0x07, 0x09, 0x69, 0x73, 0x6c, 0x65, 0x6f, 0x66, 0x6d,
+    0x61, 0x6e, 0x46, 0x09, 0x06, 0x74, 0x61, 0x6e, 0x62, 0x75, 0x6c, 0x03,
+    0x07, 0x06, 0x6a, 0x65, 0x72, 0x73, 0x65, 0x79, 0x46, 0x00, 0x12, 0x65,
+    0x75, 0x72, 0x6f, 0x70, 0x65, 0x2f, 0x6b, 0x61, 0x6c, 0x69, 0x6e, 0x69,
+    0x6e, 0x67, 0x72, 0x61, 0x64, 0x3c, 0x08, 0x03, 0x69, 0x65, 0x76, 0x3f,
+    0x09, 0x03, 0x72, 0x6f, 0x76, 0x03, 0x07, 0x06, 0x6c, 0x69, 0x73, 0x62,
+    0x6f, 0x6e, 0x5b, 0x08, 0x08, 0x6a, 0x75, 0x62, 0x6c, 0x6a, 0x61, 0x6e,
+    0x61, 0x34, 0x08, 0x05, 0x6f, 0x6e, 0x64, 0x6f, 0x6e, 0x46, 0x08, 0x09,
+    0x75, 0x78, 0x65, 0x6d, 0x62, 0x6f, 0x75, 0x72, 0x67, 0x34, 0x07, 0x06,
+    0x6d, 0x61, 0x64, 0x72, 0x69, 0x64, 0x34, 0x09, 0x03, 0x6c, 0x74, 0x61,
+    0x34, 0x09, 0x07, 0x72, 0x69, 0x65, 0x68, 0x61, 0x6d, 0x6e, 0x3f, 0x08,
+    0x04, 0x69, 0x6e, 0x73, 0x6b, 0x03, 0x08, 0x05, 0x6f, 0x6e, 0x61, 0x63,
+    0x6f, 0x34, 0x09, 0x04, 0x73, 0x63, 0x6f, 0x77, 0x4f, 0x07, 0x04, 0x6f,
+    0x73, 0x6c, 0x6f, 0x34, 0x07, 0x05, 0x70, 0x61, 0x72, 0x69, 0x73, 0x34,
+    0x08, 0x08, 0x6f, 0x64, 0x67, 0x6f, 0x72, 0x69, 0x63, 0x61, 0x34, 0x00,
+    0x0d, 0x65, 0x75, 0x72, 0x6f, 0x70, 0x65, 0x2f, 0x70, 0x72, 0x61, 0x67,
+    0x75, 0x65, 0x34, 0x07, 0x04, 0x72, 0x69, 0x67, 0x61, 0x3f, 0x08, 0x03,
+    0x6f, 0x6d, 0x65, 0x34, 0x07, 0x06, 0x73, 0x61, 0x6d, 0x61, 0x72, 0x61,
+    0x05, 0x09, 0x07, 0x6e, 0x6d, 0x61, 0x72, 0x69, 0x6e, 0x6f, 0x34, 0x09,
+    0x06, 0x72, 0x61, 0x6a, 0x65, 0x76, 0x6f, 0x34, 0x0b, 0x03, 0x74, 0x6f,
+    0x76, 0x05, 0x08, 0x09, 0x69, 0x6d, 0x66, 0x65, 0x72, 0x6f, 0x70, 0x6f,
+    0x6c, 0x4f, 0x08, 0x05, 0x6b, 0x6f, 0x70, 0x6a, 0x65, 0x34, 0x08, 0x04,
+    0x6f, 0x66, 0x69, 0x61, 0x3f, 0x08, 0x08, 0x74, 0x6f, 0x63, 0x6b, 0x68,
+    0x6f, 0x6c, 0x6d, 0x34, 0x07, 0x07, 0x74, 0x61, 0x6c, 0x6c, 0x69, 0x6e,
+    0x6e, 0x3f, 0x08, 0x05, 0x69, 0x72, 0x61, 0x6e, 0x65, 0x34, 0x07, 0x09,
+    0x75, 0x6c, 0x79, 0x61, 0x6e, 0x6f, 0x76, 0x73, 0x6b, 0x05, 0x08, 0x07,
+    0x7a, 0x68, 0x67, 0x6f, 0x72, 0x6f, 0x64, 0x3f, 0x07, 0x05, 0x76, 0x61,
+    0x64, 0x75, 0x7a, 0x34, 0x00, 0x0e, 0x65, 0x75, 0x72, 0x6f, 0x70, 0x65,
+    0x2f, 0x76, 0x61, 0x74, 0x69, 0x63, 0x61, 0x6e, 0x34, 0x08, 0x05, 0x69,
+    0x65, 0x6e, 0x6e, 0x61, 0x34, 0x09, 0x05, 0x6c, 0x6e, 0x69, 0x75, 0x73,
+    0x3f, 0x08, 0x08, 0x6f, 0x6c, 0x67, 0x6f, 0x67, 0x72, 0x61, 0x64, 0x05,
+    0x07, 0x06, 0x77, 0x61, 0x72, 0x73, 0x61, 0x77, 0x34, 0x07, 0x06, 0x7a,
+    0x61, 0x67, 0x72, 0x65, 0x62, 0x34, 0x09, 0x08, 0x70, 0x6f, 0x72, 0x6f,
+    0x7a, 0x68, 0x79, 0x65, 0x3f, 0x08, 0x05, 0x75, 0x72, 0x69, 0x63, 0x68,
+    0x34, 0x00, 0x13, 0x69, 0x6e, 0x64, 0x69, 0x61, 0x6e, 0x2f, 0x61, 0x6e,
+    0x74, 0x61, 0x6e, 0x61, 0x6e, 0x61, 0x72, 0x69, 0x76, 0x6f, 0x3b, 0x07,
+    0x06, 0x63, 0x68, 0x61, 0x67, 0x6f, 0x73, 0x0a, 0x09, 0x07, 0x72, 0x69,
+    0x73, 0x74, 0x6d, 0x61, 0x73, 0x0b, 0x08, 0x04, 0x6f, 0x63, 0x6f, 0x73,
+    0x09, 0x09, 0x04, 0x6d, 0x6f, 0x72, 0x6f, 0x3b, 0x07, 0x09, 0x6b, 0x65,
+    0x72, 0x67, 0x75, 0x65, 0x6c, 0x65, 0x6e, 0x08, 0x07, 0x04, 0x6d, 0x61,
+    0x68, 0x65, 0x05, 0x09, 0x06, 0x6c, 0x64, 0x69, 0x76, 0x65, 0x73, 0x08,
+    0x00, 0x10, 0x69, 0x6e, 0x64, 0x69, 0x61, 0x6e, 0x2f, 0x6d, 0x61, 0x75,
+    0x72, 0x69, 0x74, 0x69, 0x75, 0x73, 0x05, 0x09, 0x05, 0x79, 0x6f, 0x74,
+    0x74, 0x65, 0x3b, 0x07, 0x07, 0x72, 0x65, 0x75, 0x6e, 0x69, 0x6f, 0x6e,
+    0x05, 0x00, 0x0c, 0x70, 0x61, 0x63, 0x69, 0x66, 0x69, 0x63, 0x2f, 0x61,
+    0x70, 0x69, 0x61, 0x17, 0x09, 0x07, 0x75, 0x63, 0x6b, 0x6c, 0x61, 0x6e,
+    0x64, 0x54, 0x08, 0x0c, 0x62, 0x6f, 0x75, 0x67, 0x61, 0x69, 0x6e, 0x76,
+    0x69, 0x6c, 0x6c, 0x65, 0x11, 0x08, 0x07, 0x63, 0x68, 0x61, 0x74, 0x68,
+    0x61, 0x6d, 0x13, 0x0a, 0x03, 0x75, 0x75, 0x6b, 0x10, 0x08, 0x06, 0x65,
+    0x61, 0x73, 0x74, 0x65, 0x72, 0x24, 0x09, 0x04, 0x66, 0x61, 0x74, 0x65,
+    0x11, 0x09, 0x08, 0x6e, 0x64, 0x65, 0x72, 0x62, 0x75, 0x72, 0x79, 0x16,
+    0x08, 0x07, 0x66, 0x61, 0x6b, 0x61, 0x6f, 0x66, 0x6f, 0x16, 0x09, 0x03,
+    0x69, 0x6a, 0x69, 0x15, 0x09, 0x07, 0x75, 0x6e, 0x61, 0x66, 0x75, 0x74,
+    0x69, 0x14, 0x08, 0x09, 0x67, 0x61, 0x6c, 0x61, 0x70, 0x61, 0x67, 0x6f,
+    0x73, 0x23, 0x0a, 0x05, 0x6d, 0x62, 0x69, 0x65, 0x72, 0x27, 0x00, 0x13,
+    0x70, 0x61, 0x63, 0x69, 0x66, 0x69, 0x63, 0x2f, 0x67, 0x75, 0x61, 0x64,
+    0x61, 0x6c, 0x63, 0x61, 0x6e, 0x61, 0x6c, 0x11, 0x0b, 0x01, 0x6d, 0x3a,
+    0x08, 0x08, 0x68, 0x6f, 0x6e, 0x6f, 0x6c, 0x75, 0x6c, 0x75, 0x48, 0x08,
+    0x0a, 0x6b, 0x69, 0x72, 0x69, 0x74, 0x69, 0x6d, 0x61, 0x74, 0x69, 0x18,
+    0x09, 0x05, 0x6f, 0x73, 0x72, 0x61, 0x65, 0x11, 0x09, 0x08, 0x77, 0x61,
+    0x6a, 0x61, 0x6c, 0x65, 0x69, 0x6e, 0x14, 0x08, 0x06, 0x6d, 0x61, 0x6a,
+    0x75, 0x72, 0x6f, 0x14, 0x0a, 0x07, 0x72, 0x71, 0x75, 0x65, 0x73, 0x61,
+    0x73, 0x26, 0x09, 0x05, 0x69, 0x64, 0x77, 0x61, 0x79, 0x59, 0x08, 0x05,
+    0x6e, 0x61, 0x75, 0x72, 0x75, 0x14, 0x09, 0x03, 0x69, 0x75, 0x65, 0x29,
+    0x09, 0x06, 0x6f, 0x72, 0x66, 0x6f, 0x6c, 0x6b, 0x12, 0x0a, 0x04, 0x75,
+    0x6d, 0x65, 0x61, 0x11, 0x08, 0x08, 0x70, 0x61, 0x67, 0x6f, 0x70, 0x61,
+    0x67, 0x6f, 0x59, 0x0a, 0x03, 0x6c, 0x61, 0x75, 0x0e, 0x09, 0x07, 0x69,
+    0x74, 0x63, 0x61, 0x69, 0x72, 0x6e, 0x25, 0x00, 0x0f, 0x70, 0x61, 0x63,
+    0x69, 0x66, 0x69, 0x63, 0x2f, 0x70, 0x6f, 0x68, 0x6e, 0x70, 0x65, 0x69,
+    0x11, 0x0a, 0x09, 0x72, 0x74, 0x6d, 0x6f, 0x72, 0x65, 0x73, 0x62, 0x79,
+    0x10, 0x08, 0x09, 0x72, 0x61, 0x72, 0x6f, 0x74, 0x6f, 0x6e, 0x67, 0x61,
+    0x28, 0x08, 0x06, 0x73, 0x61, 0x69, 0x70, 0x61, 0x6e, 0x3a, 0x08, 0x06,
+    0x74, 0x61, 0x68, 0x69, 0x74, 0x69, 0x28, 0x0a, 0x04, 0x72, 0x61, 0x77,
+    0x61, 0x14, 0x09, 0x08, 0x6f, 0x6e, 0x67, 0x61, 0x74, 0x61, 0x70, 0x75,
+    0x16, 0x08, 0x04, 0x77, 0x61, 0x6b, 0x65, 0x14, 0x0a, 0x04, 0x6c, 0x6c,
+    0x69, 0x73, 0x14,
+};
+
+/* Offsets of the blocks in tz_db_zones */
+static const uint16_t tz_db_blocks[TZ_DB_BLOCKS] = {
+    0, 152, 316, 475, 658, 817, 972, 1139, 1312, 1483, 1646, 1822,
+    1991, 2172, 2325, 2472, 2629, 2783, 2941, 3120, 3295, 3465, 3611, 3760,
+    3924, 4090, 4243,
+};
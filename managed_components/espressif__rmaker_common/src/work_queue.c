@@ -12,6 +12,8 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <string.h>
+#include <stdlib.h>
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
 #include <freertos/queue.h>
@@ -20,10 +22,15 @@
 
 #include <esp_rmaker_work_queue.h>
 
-#define ESP_RMAKER_TASK_QUEUE_SIZE           8
 #define ESP_RMAKER_TASK_STACK       CONFIG_ESP_RMAKER_WORK_QUEUE_TASK_STACK
 #define ESP_RMAKER_TASK_PRIORITY    CONFIG_ESP_RMAKER_WORK_QUEUE_TASK_PRIORITY
 
+#ifdef CONFIG_ESP_RMAKER_WORK_QUEUE_BACKGROUND_WORKER
+#define ESP_RMAKER_WORKERS          2
+#else
+#define ESP_RMAKER_WORKERS          1
+#endif
+
 static const char *TAG = "esp_rmaker_work_queue";
 
 typedef enum {
@@ -36,47 +43,510 @@ typedef enum {
 typedef struct {
     esp_rmaker_work_fn_t work_fn;
     void *priv_data;
+    TickType_t queued_at;
 } esp_rmaker_work_queue_entry_t;
 
-static QueueHandle_t work_queue;
+typedef struct {
+    uint32_t queued;
+    uint32_t dropped;
+    uint32_t executed;
+    uint16_t max_depth;
+    uint64_t total_wait_ms;
+    uint32_t max_wait_ms;
+    bool full_logged;
+} esp_rmaker_work_lane_stats_t;
+
+/* The priorities each worker runs, first worker first. Without a background worker, the first
+ * one runs all of them.
+ */
+static const struct {
+    const char *name;
+    esp_rmaker_work_prio_t first;
+    esp_rmaker_work_prio_t last;
+} s_worker_cfg[ESP_RMAKER_WORKERS] = {
+#ifdef CONFIG_ESP_RMAKER_WORK_QUEUE_BACKGROUND_WORKER
+    { "rmaker_queue_task", ESP_RMAKER_WORK_PRIO_URGENT, ESP_RMAKER_WORK_PRIO_NORMAL },
+    { "rmaker_bg_task", ESP_RMAKER_WORK_PRIO_BACKGROUND, ESP_RMAKER_WORK_PRIO_BACKGROUND },
+#else
+    { "rmaker_queue_task", ESP_RMAKER_WORK_PRIO_URGENT, ESP_RMAKER_WORK_PRIO_BACKGROUND },
+#endif
+};
+
+static const uint16_t s_lane_size[ESP_RMAKER_WORK_PRIO_MAX] = {
+    [ESP_RMAKER_WORK_PRIO_URGENT] = CONFIG_ESP_RMAKER_WORK_QUEUE_URGENT_SIZE,
+    [ESP_RMAKER_WORK_PRIO_NORMAL] = CONFIG_ESP_RMAKER_WORK_QUEUE_SIZE,
+    [ESP_RMAKER_WORK_PRIO_BACKGROUND] = CONFIG_ESP_RMAKER_WORK_QUEUE_BACKGROUND_SIZE,
+};
+
+static QueueHandle_t work_queue[ESP_RMAKER_WORK_PRIO_MAX];
+static TaskHandle_t s_workers[ESP_RMAKER_WORKERS];
+static int s_running_workers;
 static esp_rmaker_work_queue_state_t queue_state;
+static esp_rmaker_work_lane_stats_t s_stats[ESP_RMAKER_WORK_PRIO_MAX];
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/* Delayed and periodic work sits in a hierarchical timer wheel, advanced by the first worker.
+ * Level 0 has a slot per tick, every next level a slot per full turn of the one below. Entries
+ * move down a level when their slot comes up, and are queued when their level 0 slot comes up.
+ * With 4 levels of 64 slots, 2^24 ticks (46 hours at 100 Hz) are covered, longer delays are
+ * parked in the last slot of the top level and placed again when it comes up.
+ */
+#define WHEEL_LEVELS        4
+#define WHEEL_BITS          6
+#define WHEEL_SLOTS         (1 << WHEEL_BITS)
+#define WHEEL_MASK          (WHEEL_SLOTS - 1)
+#define WHEEL_MAX_DELTA     ((1UL << (WHEEL_LEVELS * WHEEL_BITS)) - 1)
+/* Due entries are queued in batches, outside of the lock */
+#define WHEEL_FIRE_BATCH    8
+/* Ticks before delayed work whose lane was full is tried again */
+#define WHEEL_RETRY_TICKS   1
+/* Ticks the wheel is advanced by at most in one critical section */
+#define WHEEL_COLLECT_TICKS 64
+/* Longest wait of a worker, to recheck the state */
+#define WORKER_WAIT_TICKS   (2000 / portTICK_PERIOD_MS)
+
+struct esp_rmaker_work_timer {
+    struct esp_rmaker_work_timer *next;
+    struct esp_rmaker_work_timer **pprev;   /* NULL when not in the wheel */
+    esp_rmaker_work_fn_t work_fn;
+    void *priv_data;
+    TickType_t expires;
+    TickType_t period;                      /* 0 for delayed work, freed once queued */
+    esp_rmaker_work_prio_t prio;
+};
+
+typedef struct {
+    esp_rmaker_work_fn_t work_fn;
+    void *priv_data;
+    esp_rmaker_work_prio_t prio;
+    struct esp_rmaker_work_timer *to_free;
+} esp_rmaker_work_fired_t;
+
+static struct esp_rmaker_work_timer *s_wheel[WHEEL_LEVELS][WHEEL_SLOTS];
+/* Next tick to process */
+static TickType_t s_wheel_now;
+static bool s_wheel_cascaded;
+/* Entries in the wheel, at any level */
+static uint32_t s_wheel_count;
+
+static int worker_of(esp_rmaker_work_prio_t prio)
+{
+    return (ESP_RMAKER_WORKERS > 1 && prio == ESP_RMAKER_WORK_PRIO_BACKGROUND) ? 1 : 0;
+}
+
+static bool is_worker(void)
+{
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    for (int i = 0; i < ESP_RMAKER_WORKERS; i++) {
+        if (s_workers[i] == self) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Under the lock, as a stopping worker clears its handle under it before deleting itself */
+static void esp_rmaker_work_queue_wake(int id)
+{
+    portENTER_CRITICAL(&s_lock);
+    if (s_workers[id]) {
+        xTaskNotifyGive(s_workers[id]);
+    }
+    portEXIT_CRITICAL(&s_lock);
+}
+
+static void wheel_unlink(struct esp_rmaker_work_timer *timer)
+{
+    if (timer->pprev) {
+        s_wheel_count--;
+        *timer->pprev = timer->next;
+        if (timer->next) {
+            timer->next->pprev = timer->pprev;
+        }
+        timer->next = NULL;
+        timer->pprev = NULL;
+    }
+}
+
+static void wheel_insert(struct esp_rmaker_work_timer *timer)
+{
+    int32_t delta = (int32_t)(timer->expires - s_wheel_now);
+    TickType_t expires = timer->expires;
+    if (delta < 0) {
+        expires = s_wheel_now;
+        delta = 0;
+    } else if ((uint32_t)delta > WHEEL_MAX_DELTA) {
+        expires = s_wheel_now + WHEEL_MAX_DELTA;
+        delta = WHEEL_MAX_DELTA;
+    }
+    int level = 0;
+    while (level < WHEEL_LEVELS - 1 && (uint32_t)delta >= (1UL << ((level + 1) * WHEEL_BITS))) {
+        level++;
+    }
+    struct esp_rmaker_work_timer **slot = &s_wheel[level][(expires >> (level * WHEEL_BITS)) & WHEEL_MASK];
+    timer->next = *slot;
+    if (timer->next) {
+        timer->next->pprev = &timer->next;
+    }
+    timer->pprev = slot;
+    *slot = timer;
+    s_wheel_count++;
+}
+
+/* Moves the entries of a slot to the levels below */
+static void wheel_cascade(int level, int idx)
+{
+    struct esp_rmaker_work_timer *timer = s_wheel[level][idx];
+    s_wheel[level][idx] = NULL;
+    while (timer) {
+        struct esp_rmaker_work_timer *next = timer->next;
+        timer->pprev = NULL;
+        s_wheel_count--;
+        wheel_insert(timer);
+        timer = next;
+    }
+}
+
+/* Takes up to max due entries off the wheel, advancing it towards now by WHEEL_COLLECT_TICKS at
+ * most, straight to it when the wheel is empty. Sets behind if it is not there yet. Under the lock.
+ */
+static int wheel_collect(TickType_t now, esp_rmaker_work_fired_t *fired, int max, bool *behind)
+{
+    int count = 0;
+    int ticks = 0;
+    while (count < max && ticks < WHEEL_COLLECT_TICKS && (int32_t)(now - s_wheel_now) >= 0) {
+        if (!s_wheel_count) {
+            /* Nothing to queue or cascade on the way */
+            s_wheel_now = now + 1;
+            s_wheel_cascaded = false;
+            break;
+        }
+        int idx = s_wheel_now & WHEEL_MASK;
+        if (idx == 0 && !s_wheel_cascaded) {
+            for (int level = 1; level < WHEEL_LEVELS; level++) {
+                int level_idx = (s_wheel_now >> (level * WHEEL_BITS)) & WHEEL_MASK;
+                wheel_cascade(level, level_idx);
+                if (level_idx) {
+                    break;
+                }
+            }
+            s_wheel_cascaded = true;
+        }
+        struct esp_rmaker_work_timer *timer = s_wheel[0][idx];
+        if (!timer) {
+            s_wheel_now++;
+            s_wheel_cascaded = false;
+            ticks++;
+            continue;
+        }
+        wheel_unlink(timer);
+        fired[count++] = (esp_rmaker_work_fired_t) {
+            .work_fn = timer->work_fn,
+            .priv_data = timer->priv_data,
+            .prio = timer->prio,
+            .to_free = timer->period ? NULL : timer,
+        };
+        if (timer->period) {
+            /* Keep the phase, unless the worker was held up for more than a period */
+            timer->expires += timer->period;
+            if ((int32_t)(timer->expires - s_wheel_now) <= 0) {
+                timer->expires = s_wheel_now + timer->period;
+            }
+            wheel_insert(timer);
+        }
+    }
+    *behind = (int32_t)(now - s_wheel_now) >= 0;
+    return count;
+}
+
+/* Ticks from now until the next level 0 slot with entries, or the next cascade, which may bring
+ * some. Under the lock, once the wheel has been advanced past now.
+ */
+static TickType_t wheel_next_wait(TickType_t now)
+{
+    if (!s_wheel_count) {
+        return WORKER_WAIT_TICKS;
+    }
+    TickType_t tick = s_wheel_now;
+    do {
+        if (s_wheel[0][tick & WHEEL_MASK]) {
+            break;
+        }
+        tick++;
+    } while (tick & WHEEL_MASK);
+    TickType_t wait = tick - now;
+    return (wait < WORKER_WAIT_TICKS) ? wait : WORKER_WAIT_TICKS;
+}
+
+/* Queues the due delayed and periodic work, returns the ticks until the next is due.
+ * Delayed work whose lane is full goes back into the wheel to be tried again, a period of
+ * periodic work is skipped then.
+ */
+static TickType_t esp_rmaker_work_queue_fire_timers(void)
+{
+    esp_rmaker_work_fired_t fired[WHEEL_FIRE_BATCH];
+    TickType_t now;
+    int count;
+    bool behind;
+    do {
+        now = xTaskGetTickCount();
+        portENTER_CRITICAL(&s_lock);
+        count = wheel_collect(now, fired, WHEEL_FIRE_BATCH, &behind);
+        portEXIT_CRITICAL(&s_lock);
+        for (int i = 0; i < count; i++) {
+            esp_err_t err = esp_rmaker_work_queue_add_task_with_prio(fired[i].work_fn, fired[i].priv_data,
+                                                                     fired[i].prio, 0);
+            struct esp_rmaker_work_timer *timer = fired[i].to_free;
+            if (err == ESP_OK || !timer) {
+                free(timer);
+                continue;
+            }
+            portENTER_CRITICAL(&s_lock);
+            timer->expires = now + WHEEL_RETRY_TICKS;
+            wheel_insert(timer);
+            portEXIT_CRITICAL(&s_lock);
+        }
+    } while (count == WHEEL_FIRE_BATCH || behind);
 
-static void esp_rmaker_handle_work_queue(void)
+    portENTER_CRITICAL(&s_lock);
+    TickType_t wait = wheel_next_wait(now);
+    portEXIT_CRITICAL(&s_lock);
+    return wait;
+}
+
+/* Runs the first queued entry of the highest priority in [first, last] */
+static bool esp_rmaker_run_one(esp_rmaker_work_prio_t first, esp_rmaker_work_prio_t last)
 {
     esp_rmaker_work_queue_entry_t work_queue_entry;
-    /* 2 sec delay to prevent spinning */
-    BaseType_t ret = xQueueReceive(work_queue, &work_queue_entry, 2000 / portTICK_PERIOD_MS);
-    while (ret == pdTRUE) {
+    for (int prio = first; prio <= (int)last; prio++) {
+        if (xQueueReceive(work_queue[prio], &work_queue_entry, 0) != pdTRUE) {
+            continue;
+        }
+        uint32_t wait_ms = pdTICKS_TO_MS(xTaskGetTickCount() - work_queue_entry.queued_at);
+        portENTER_CRITICAL(&s_lock);
+        s_stats[prio].executed++;
+        s_stats[prio].total_wait_ms += wait_ms;
+        if (wait_ms > s_stats[prio].max_wait_ms) {
+            s_stats[prio].max_wait_ms = wait_ms;
+        }
+        portEXIT_CRITICAL(&s_lock);
         work_queue_entry.work_fn(work_queue_entry.priv_data);
-        ret = xQueueReceive(work_queue, &work_queue_entry, 0);
+        return true;
     }
+    return false;
 }
 
 static void esp_rmaker_work_queue_task(void *param)
 {
-    ESP_LOGI(TAG, "RainMaker Work Queue task started.");
+    int id = (int)(intptr_t)param;
+    ESP_LOGI(TAG, "RainMaker Work Queue task %s started.", s_worker_cfg[id].name);
     while (queue_state != WORK_QUEUE_STATE_STOP_REQUESTED) {
-        esp_rmaker_handle_work_queue();
+        TickType_t wait = WORKER_WAIT_TICKS;
+        /* Urgent work queued meanwhile is picked up before the next normal one */
+        while (queue_state != WORK_QUEUE_STATE_STOP_REQUESTED) {
+            if (id == 0) {
+                wait = esp_rmaker_work_queue_fire_timers();
+            }
+            if (!esp_rmaker_run_one(s_worker_cfg[id].first, s_worker_cfg[id].last)) {
+                break;
+            }
+        }
+        /* Woken up by every add, otherwise when the next timer is due or to recheck the state */
+        if (wait) {
+            ulTaskNotifyTake(pdTRUE, wait);
+        }
     }
-    ESP_LOGI(TAG, "Stopping Work Queue task");
-    queue_state = WORK_QUEUE_STATE_INIT_DONE;
+    ESP_LOGI(TAG, "Stopping Work Queue task %s", s_worker_cfg[id].name);
+    portENTER_CRITICAL(&s_lock);
+    s_workers[id] = NULL;
+    if (--s_running_workers == 0) {
+        queue_state = WORK_QUEUE_STATE_INIT_DONE;
+    }
+    portEXIT_CRITICAL(&s_lock);
     vTaskDelete(NULL);
 }
 
-esp_err_t esp_rmaker_work_queue_add_task(esp_rmaker_work_fn_t work_fn, void *priv_data)
+esp_err_t esp_rmaker_work_queue_add_task_with_prio(esp_rmaker_work_fn_t work_fn, void *priv_data,
+                                                   esp_rmaker_work_prio_t prio, TickType_t timeout)
 {
-    if (!work_queue) {
+    if (prio >= ESP_RMAKER_WORK_PRIO_MAX || !work_fn) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!work_queue[prio]) {
         ESP_LOGE(TAG, "Cannot enqueue function as Work Queue hasn't been created.");
         return ESP_ERR_INVALID_STATE;
     }
+    if (timeout && is_worker()) {
+        timeout = 0;
+    }
     esp_rmaker_work_queue_entry_t work_queue_entry = {
         .work_fn = work_fn,
         .priv_data = priv_data,
+        .queued_at = xTaskGetTickCount(),
     };
-    if (xQueueSend(work_queue, &work_queue_entry, 0) == pdTRUE) {
-        return ESP_OK;
+    bool queued = (xQueueSend(work_queue[prio], &work_queue_entry, timeout) == pdTRUE);
+    uint16_t depth = uxQueueMessagesWaiting(work_queue[prio]);
+    bool log_full = false;
+
+    portENTER_CRITICAL(&s_lock);
+    esp_rmaker_work_lane_stats_t *stats = &s_stats[prio];
+    if (queued) {
+        stats->queued++;
+        stats->full_logged = false;
+        if (depth > stats->max_depth) {
+            stats->max_depth = depth;
+        }
+    } else {
+        stats->dropped++;
+        log_full = !stats->full_logged;
+        stats->full_logged = true;
+    }
+    portEXIT_CRITICAL(&s_lock);
+
+    if (!queued) {
+        /* Once per run of drops, the count is in the stats */
+        if (log_full) {
+            ESP_LOGW(TAG, "Work Queue of priority %d full, dropping work.", prio);
+        }
+        return ESP_ERR_TIMEOUT;
+    }
+    esp_rmaker_work_queue_wake(worker_of(prio));
+    return ESP_OK;
+}
+
+esp_err_t esp_rmaker_work_queue_add_task(esp_rmaker_work_fn_t work_fn, void *priv_data)
+{
+    esp_err_t err = esp_rmaker_work_queue_add_task_with_prio(work_fn, priv_data, ESP_RMAKER_WORK_PRIO_NORMAL, 0);
+    return (err == ESP_ERR_TIMEOUT) ? ESP_FAIL : err;
+}
+
+static esp_err_t esp_rmaker_work_timer_arm(struct esp_rmaker_work_timer *timer, uint32_t delay_ms)
+{
+    if (queue_state == WORK_QUEUE_STATE_DEINIT) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    TickType_t delay = pdMS_TO_TICKS(delay_ms);
+    portENTER_CRITICAL(&s_lock);
+    wheel_unlink(timer);
+    if (timer->period) {
+        timer->period = delay ? delay : 1;
+    }
+    TickType_t now = xTaskGetTickCount();
+    if (!s_wheel_count && (int32_t)(now - s_wheel_now) > 0) {
+        /* Not walked through while idle, as there was nothing on the way */
+        s_wheel_now = now;
+        s_wheel_cascaded = false;
+    }
+    timer->expires = now + delay;
+    wheel_insert(timer);
+    portEXIT_CRITICAL(&s_lock);
+    /* The first worker may be waiting for a later timer */
+    esp_rmaker_work_queue_wake(0);
+    return ESP_OK;
+}
+
+static struct esp_rmaker_work_timer *esp_rmaker_work_timer_create(esp_rmaker_work_fn_t work_fn, void *priv_data,
+                                                                  esp_rmaker_work_prio_t prio, bool periodic)
+{
+    struct esp_rmaker_work_timer *timer = calloc(1, sizeof(struct esp_rmaker_work_timer));
+    if (timer) {
+        timer->work_fn = work_fn;
+        timer->priv_data = priv_data;
+        timer->prio = prio;
+        timer->period = periodic ? 1 : 0;
+    }
+    return timer;
+}
+
+esp_err_t esp_rmaker_work_queue_add_delayed(esp_rmaker_work_fn_t work_fn, void *priv_data,
+                                            esp_rmaker_work_prio_t prio, uint32_t delay_ms)
+{
+    if (prio >= ESP_RMAKER_WORK_PRIO_MAX || !work_fn) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (queue_state == WORK_QUEUE_STATE_DEINIT) {
+        ESP_LOGE(TAG, "Cannot add delayed work as Work Queue hasn't been created.");
+        return ESP_ERR_INVALID_STATE;
+    }
+    struct esp_rmaker_work_timer *timer = esp_rmaker_work_timer_create(work_fn, priv_data, prio, false);
+    if (!timer) {
+        return ESP_ERR_NO_MEM;
+    }
+    return esp_rmaker_work_timer_arm(timer, delay_ms);
+}
+
+esp_err_t esp_rmaker_work_queue_add_periodic(esp_rmaker_work_fn_t work_fn, void *priv_data,
+                                             esp_rmaker_work_prio_t prio, uint32_t period_ms,
+                                             esp_rmaker_work_timer_handle_t *handle)
+{
+    if (prio >= ESP_RMAKER_WORK_PRIO_MAX || !work_fn || !handle || !period_ms) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (queue_state == WORK_QUEUE_STATE_DEINIT) {
+        ESP_LOGE(TAG, "Cannot add periodic work as Work Queue hasn't been created.");
+        return ESP_ERR_INVALID_STATE;
+    }
+    struct esp_rmaker_work_timer *timer = esp_rmaker_work_timer_create(work_fn, priv_data, prio, true);
+    if (!timer) {
+        return ESP_ERR_NO_MEM;
+    }
+    *handle = timer;
+    return esp_rmaker_work_timer_arm(timer, period_ms);
+}
+
+esp_err_t esp_rmaker_work_queue_timer_change_period(esp_rmaker_work_timer_handle_t handle, uint32_t period_ms)
+{
+    if (!handle || !period_ms) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return esp_rmaker_work_timer_arm(handle, period_ms);
+}
+
+esp_err_t esp_rmaker_work_queue_timer_stop(esp_rmaker_work_timer_handle_t handle)
+{
+    if (!handle) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    portENTER_CRITICAL(&s_lock);
+    wheel_unlink(handle);
+    portEXIT_CRITICAL(&s_lock);
+    return ESP_OK;
+}
+
+esp_err_t esp_rmaker_work_queue_timer_delete(esp_rmaker_work_timer_handle_t handle)
+{
+    esp_err_t err = esp_rmaker_work_queue_timer_stop(handle);
+    if (err == ESP_OK) {
+        free(handle);
     }
-    return ESP_FAIL;
+    return err;
+}
+
+esp_err_t esp_rmaker_work_queue_get_stats(esp_rmaker_work_prio_t prio, esp_rmaker_work_queue_stats_t *stats)
+{
+    if (prio >= ESP_RMAKER_WORK_PRIO_MAX || !stats) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    portENTER_CRITICAL(&s_lock);
+    const esp_rmaker_work_lane_stats_t *lane = &s_stats[prio];
+    *stats = (esp_rmaker_work_queue_stats_t) {
+        .queued = lane->queued,
+        .dropped = lane->dropped,
+        .executed = lane->executed,
+        .max_depth = lane->max_depth,
+        .avg_wait_ms = lane->executed ? lane->total_wait_ms / lane->executed : 0,
+        .max_wait_ms = lane->max_wait_ms,
+    };
+    portEXIT_CRITICAL(&s_lock);
+    stats->depth = work_queue[prio] ? uxQueueMessagesWaiting(work_queue[prio]) : 0;
+    return ESP_OK;
+}
+
+void esp_rmaker_work_queue_reset_stats(void)
+{
+    portENTER_CRITICAL(&s_lock);
+    memset(s_stats, 0, sizeof(s_stats));
+    portEXIT_CRITICAL(&s_lock);
 }
 
 esp_err_t esp_rmaker_work_queue_init(void)
@@ -85,11 +555,20 @@ esp_err_t esp_rmaker_work_queue_init(void)
         ESP_LOGW(TAG, "Work Queue already initialiased/started.");
         return ESP_OK;
     }
-    work_queue = xQueueCreate(ESP_RMAKER_TASK_QUEUE_SIZE, sizeof(esp_rmaker_work_queue_entry_t));
-    if (!work_queue) {
-        ESP_LOGE(TAG, "Failed to create Work Queue.");
-        return ESP_FAIL;
+    for (int prio = 0; prio < ESP_RMAKER_WORK_PRIO_MAX; prio++) {
+        work_queue[prio] = xQueueCreate(s_lane_size[prio], sizeof(esp_rmaker_work_queue_entry_t));
+        if (!work_queue[prio]) {
+            ESP_LOGE(TAG, "Failed to create Work Queue.");
+            while (--prio >= 0) {
+                vQueueDelete(work_queue[prio]);
+                work_queue[prio] = NULL;
+            }
+            return ESP_FAIL;
+        }
     }
+    esp_rmaker_work_queue_reset_stats();
+    s_wheel_now = xTaskGetTickCount();
+    s_wheel_cascaded = false;
     ESP_LOGI(TAG, "Work Queue created.");
     queue_state = WORK_QUEUE_STATE_INIT_DONE;
     return ESP_OK;
@@ -112,8 +591,22 @@ esp_err_t esp_rmaker_work_queue_deinit(void)
         ESP_LOGE(TAG, "Cannot deinitialize Work Queue as the task is still running.");
         return ESP_ERR_INVALID_STATE;
     } else {
-        vQueueDelete(work_queue);
-        work_queue = NULL;
+        for (int prio = 0; prio < ESP_RMAKER_WORK_PRIO_MAX; prio++) {
+            vQueueDelete(work_queue[prio]);
+            work_queue[prio] = NULL;
+        }
+        /* Delayed work goes with the queue, periodic work is stopped and stays with its owner */
+        for (int level = 0; level < WHEEL_LEVELS; level++) {
+            for (int idx = 0; idx < WHEEL_SLOTS; idx++) {
+                while (s_wheel[level][idx]) {
+                    struct esp_rmaker_work_timer *timer = s_wheel[level][idx];
+                    wheel_unlink(timer);
+                    if (!timer->period) {
+                        free(timer);
+                    }
+                }
+            }
+        }
         queue_state = WORK_QUEUE_STATE_DEINIT;
     }
     ESP_LOGI(TAG, "esp_rmaker_work_queue was successfully deinitialized");
@@ -130,12 +623,32 @@ esp_err_t esp_rmaker_work_queue_start(void)
         ESP_LOGE(TAG, "Failed to start Work Queue as it wasn't initialized.");
         return ESP_ERR_INVALID_STATE;
     }
-    if (xTaskCreate(&esp_rmaker_work_queue_task, "rmaker_queue_task", ESP_RMAKER_TASK_STACK,
-                NULL, ESP_RMAKER_TASK_PRIORITY, NULL) != pdPASS) {
-        ESP_LOGE(TAG, "Couldn't create RainMaker work queue task");
-        return ESP_FAIL;
-    }
+    static const struct {
+        uint32_t stack;
+        UBaseType_t priority;
+    } task_cfg[ESP_RMAKER_WORKERS] = {
+        { ESP_RMAKER_TASK_STACK, ESP_RMAKER_TASK_PRIORITY },
+#ifdef CONFIG_ESP_RMAKER_WORK_QUEUE_BACKGROUND_WORKER
+        { CONFIG_ESP_RMAKER_WORK_QUEUE_BACKGROUND_TASK_STACK, CONFIG_ESP_RMAKER_WORK_QUEUE_BACKGROUND_TASK_PRIORITY },
+#endif
+    };
+    /* Set before the tasks run, as the first one to stop checks it */
     queue_state = WORK_QUEUE_STATE_RUNNING;
+    for (int i = 0; i < ESP_RMAKER_WORKERS; i++) {
+        portENTER_CRITICAL(&s_lock);
+        s_running_workers++;
+        portEXIT_CRITICAL(&s_lock);
+        if (xTaskCreate(&esp_rmaker_work_queue_task, s_worker_cfg[i].name, task_cfg[i].stack,
+                    (void *)(intptr_t)i, task_cfg[i].priority, &s_workers[i]) != pdPASS) {
+            ESP_LOGE(TAG, "Couldn't create RainMaker work queue task");
+            portENTER_CRITICAL(&s_lock);
+            bool none_left = (--s_running_workers == 0);
+            portEXIT_CRITICAL(&s_lock);
+            /* Workers already started stop on their own */
+            queue_state = none_left ? WORK_QUEUE_STATE_INIT_DONE : WORK_QUEUE_STATE_STOP_REQUESTED;
+            return ESP_FAIL;
+        }
+    }
     return ESP_OK;
 }
 
@@ -143,6 +656,9 @@ esp_err_t esp_rmaker_work_queue_stop(void)
 {
     if (queue_state == WORK_QUEUE_STATE_RUNNING) {
         queue_state = WORK_QUEUE_STATE_STOP_REQUESTED;
+        for (int i = 0; i < ESP_RMAKER_WORKERS; i++) {
+            esp_rmaker_work_queue_wake(i);
+        }
     }
     return ESP_OK;
 }
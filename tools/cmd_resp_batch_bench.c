@@ -0,0 +1,262 @@
+/*
+ * Host benchmark of batches of commands in the command-response framework (rmaker_common/src/cmd_resp.c).
+ *
+ * Builds cmd_resp.c as it is, against the stand-ins for the ESP-IDF headers in tools/host:
+ *     cc -O2 -I tools/host -I managed_components/espressif__rmaker_common/include -o cmd_resp_batch_bench \
+ *         tools/cmd_resp_batch_bench.c managed_components/espressif__rmaker_common/src/cmd_resp_tlv.c
+ *
+ * Usage:
+ *     cmd_resp_batch_bench [RTT_MS [KBYTES_PER_S]]
+ *
+ * Stands in for a server on a link of the given round trip time (default 80 ms) and bandwidth
+ * (default 20 KB/s), in simulated time, which changes SETTINGS settings of a node, as fleet tooling
+ * does. The server waits for the response to a request before sending the next one:
+ *
+ *   - one command per request, as before batches.
+ *   - batches of a few sizes, which take a round trip each.
+ *   - batches which stop on the first error, with one setting in FAIL_EVERY failing.
+ *
+ * The requests are encoded, and handled by esp_rmaker_cmd_response_handler(), on the host, and the
+ * time this takes is added to the simulated one. Prints the settings applied per second, the
+ * round trips, the bytes sent both ways and the host time per setting.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "../managed_components/espressif__rmaker_common/src/cmd_resp.c"
+
+#define SETTINGS        1024
+#define SETTING_CMDS    8
+#define SETTING_CMD     0x2001
+#define FAIL_EVERY      50
+#define PACKET_HEADER   40          /* MQTT, TLS and TCP overhead per message */
+#define REQ_MAX         8192
+
+typedef struct {
+    uint16_t cmd;
+    char data[48];
+    size_t len;
+    bool fail;
+} bench_setting_t;
+
+typedef struct {
+    unsigned applied;
+    unsigned failed;
+    unsigned skipped;       /* Not run after a failure in the batch */
+    unsigned round_trips;
+    unsigned long bytes;
+    double duration_us;
+    double host_ns;
+} bench_result_t;
+
+static bench_setting_t s_settings[SETTINGS];
+static char s_state[SETTING_CMDS][48];
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static double write_us(size_t len, double bytes_per_us)
+{
+    return (len + PACKET_HEADER) / bytes_per_us;
+}
+
+/* Keeps the setting, failing when it is marked to */
+static esp_err_t bench_setting_handler(const void *in_data, size_t in_len, void **out_data, size_t *out_len,
+                                       esp_rmaker_cmd_ctx_t *ctx, void *priv)
+{
+    (void)ctx;
+    static char response[] = "{\"status\":\"success\"}";
+    if (in_len == 0 || in_len >= sizeof(s_state[0]) || ((const char *)in_data)[0] == '!') {
+        return ESP_FAIL;
+    }
+    char *state = s_state[(uintptr_t)priv];
+    memcpy(state, in_data, in_len);
+    state[in_len] = '\0';
+    *out_data = response;
+    *out_len = sizeof(response) - 1;
+    return ESP_OK;
+}
+
+static void bench_make_settings(bool with_failures)
+{
+    for (int i = 0; i < SETTINGS; i++) {
+        bench_setting_t *s = &s_settings[i];
+        s->cmd = SETTING_CMD + i % SETTING_CMDS;
+        s->fail = with_failures && i % FAIL_EVERY == FAIL_EVERY - 1;
+        s->len = snprintf(s->data, sizeof(s->data), "%s{\"Power\":%s,\"Brightness\":%d}", s->fail ? "!" : "",
+                          (i & 1) ? "true" : "false", i % 100);
+    }
+}
+
+static void bench_check(esp_err_t err, const char *what)
+{
+    if (err != ESP_OK) {
+        fprintf(stderr, "%s failed: %d\n", what, err);
+        exit(1);
+    }
+}
+
+/* Counts the outcomes of the commands in the body of a batch response */
+static void bench_count_batch(const void *response, size_t response_len, int sent, bench_result_t *res)
+{
+    esp_rmaker_tlv_index_t tlv;
+    static uint8_t body[REQ_MAX];
+    if (esp_rmaker_tlv_index(&tlv, response, response_len) != 0 ||
+            esp_rmaker_tlv_copy(&tlv.fields[ESP_RMAKER_TLV_TYPE_DATA], body, sizeof(body)) < 0) {
+        fprintf(stderr, "Malformed batch response\n");
+        exit(1);
+    }
+    esp_rmaker_tlv_cursor_t cursor;
+    esp_rmaker_tlv_cursor_init(&cursor, body, tlv.fields[ESP_RMAKER_TLV_TYPE_DATA].len);
+    uint8_t type;
+    esp_rmaker_tlv_field_t field;
+    int run = 0;
+    while (esp_rmaker_tlv_next(&cursor, &type, &field) > 0) {
+        if (type != ESP_RMAKER_TLV_TYPE_STATUS) {
+            continue;
+        }
+        run++;
+        if (field.value[0] == ESP_RMAKER_CMD_STATUS_SUCCESS) {
+            res->applied++;
+        } else {
+            res->failed++;
+        }
+    }
+    res->skipped += sent - run;
+}
+
+/* One command per request, each waiting for the response to the one before */
+static bench_result_t bench_single(double rtt_us, double bytes_per_us)
+{
+    bench_result_t res = { 0 };
+    static uint8_t req[REQ_MAX];
+    double t = 0;
+    for (int i = 0; i < SETTINGS; i++) {
+        const bench_setting_t *s = &s_settings[i];
+        double start = now_ns();
+        size_t req_len;
+        bench_check(esp_rmaker_cmd_resp_encode_payload("req", ESP_RMAKER_USER_ROLE_PRIMARY_USER, s->cmd, s->data,
+                                                       s->len, req, sizeof(req), &req_len), "Encoding");
+        void *output = NULL;
+        size_t output_len = 0;
+        bench_check(esp_rmaker_cmd_response_handler(req, req_len, &output, &output_len), "Handling");
+        double spent = now_ns() - start;
+        esp_rmaker_tlv_index_t tlv;
+        esp_rmaker_tlv_index(&tlv, output, output_len);
+        if (tlv.fields[ESP_RMAKER_TLV_TYPE_STATUS].value[0] == ESP_RMAKER_CMD_STATUS_SUCCESS) {
+            res.applied++;
+        } else {
+            res.failed++;
+        }
+        free(output);
+        res.host_ns += spent;
+        res.round_trips++;
+        res.bytes += req_len + output_len + 2 * PACKET_HEADER;
+        t += write_us(req_len, bytes_per_us) + spent / 1000.0 + write_us(output_len, bytes_per_us) + rtt_us;
+    }
+    res.duration_us = t;
+    return res;
+}
+
+/* Batches of up to batch_size commands, each waiting for the response to the one before */
+static bench_result_t bench_batch(double rtt_us, double bytes_per_us, int batch_size, bool stop_on_error)
+{
+    bench_result_t res = { 0 };
+    static uint8_t body[REQ_MAX];
+    static uint8_t req[REQ_MAX];
+    double t = 0;
+    for (int first = 0; first < SETTINGS; first += batch_size) {
+        int sent = SETTINGS - first < batch_size ? SETTINGS - first : batch_size;
+        double start = now_ns();
+        esp_rmaker_tlv_writer_t writer;
+        esp_rmaker_tlv_writer_init(&writer, body, sizeof(body));
+        for (int i = first; i < first + sent; i++) {
+            uint8_t cmd_buf[2];
+            put_u16_le(cmd_buf, s_settings[i].cmd);
+            if (esp_rmaker_tlv_put(&writer, ESP_RMAKER_TLV_TYPE_CMD, cmd_buf, sizeof(cmd_buf)) < 0 ||
+                    esp_rmaker_tlv_put(&writer, ESP_RMAKER_TLV_TYPE_DATA, s_settings[i].data, s_settings[i].len) < 0) {
+                fprintf(stderr, "Batch of %d does not fit\n", batch_size);
+                exit(1);
+            }
+        }
+        size_t req_len;
+        bench_check(esp_rmaker_cmd_resp_encode_payload("req", ESP_RMAKER_USER_ROLE_PRIMARY_USER,
+                                                       ESP_RMAKER_CMD_TYPE_BATCH, body, writer.len, req,
+                                                       sizeof(req) - 3, &req_len), "Encoding");
+        if (stop_on_error) {
+            req[req_len++] = ESP_RMAKER_TLV_TYPE_FLAGS;
+            req[req_len++] = 1;
+            req[req_len++] = ESP_RMAKER_CMD_BATCH_STOP_ON_ERROR;
+        }
+        void *output = NULL;
+        size_t output_len = 0;
+        bench_check(esp_rmaker_cmd_response_handler(req, req_len, &output, &output_len), "Handling");
+        double spent = now_ns() - start;
+        bench_count_batch(output, output_len, sent, &res);
+        free(output);
+        res.host_ns += spent;
+        res.round_trips++;
+        res.bytes += req_len + output_len + 2 * PACKET_HEADER;
+        t += write_us(req_len, bytes_per_us) + spent / 1000.0 + write_us(output_len, bytes_per_us) + rtt_us;
+    }
+    res.duration_us = t;
+    return res;
+}
+
+static void print_result(const char *name, const bench_result_t *res)
+{
+    printf("%-14s %10.1f %8u %8u %8u %8u %9lu %9.2f\n", name, res->applied / (res->duration_us / 1e6),
+           res->applied, res->failed, res->skipped, res->round_trips, res->bytes,
+           res->host_ns / 1000.0 / (res->applied + res->failed));
+}
+
+int main(int argc, char **argv)
+{
+    double rtt_ms = argc > 1 ? atof(argv[1]) : 80;
+    double kbytes_per_s = argc > 2 ? atof(argv[2]) : 20;
+    if (rtt_ms < 0 || kbytes_per_s <= 0) {
+        fprintf(stderr, "Usage: %s [RTT_MS [KBYTES_PER_S]]\n", argv[0]);
+        return 1;
+    }
+    double rtt_us = rtt_ms * 1000;
+    double bytes_per_us = kbytes_per_s * 1024 / 1e6;
+    for (uintptr_t i = 0; i < SETTING_CMDS; i++) {
+        bench_check(esp_rmaker_cmd_register(SETTING_CMD + i, ESP_RMAKER_USER_ROLE_PRIMARY_USER,
+                                            bench_setting_handler, false, (void *)i), "Registering");
+    }
+
+    printf("RTT %.0f ms, %.0f KB/s, %d settings, up to %d commands in a batch\n", rtt_ms, kbytes_per_s,
+           SETTINGS, CMD_BATCH_MAX);
+    printf("%-14s %10s %8s %8s %8s %8s %9s %9s\n", "", "applied/s", "applied", "failed", "skipped", "trips",
+           "bytes", "host(us)");
+    static const int sizes[] = { 1, 4, 16, 64 };
+    for (int with_failures = 0; with_failures < 2; with_failures++) {
+        bench_make_settings(with_failures);
+        if (with_failures) {
+            printf("one setting in %d failing\n", FAIL_EVERY);
+        }
+        bench_result_t res = bench_single(rtt_us, bytes_per_us);
+        print_result("single", &res);
+        for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+            if (sizes[i] > CMD_BATCH_MAX) {
+                continue;
+            }
+            char name[24];
+            snprintf(name, sizeof(name), "batch %d", sizes[i]);
+            res = bench_batch(rtt_us, bytes_per_us, sizes[i], false);
+            print_result(name, &res);
+            if (with_failures) {
+                snprintf(name, sizeof(name), "batch %d stop", sizes[i]);
+                res = bench_batch(rtt_us, bytes_per_us, sizes[i], true);
+                print_result(name, &res);
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,177 @@
+/*
+ * Host benchmark of the command-response framework (rmaker_common/src/cmd_resp.c).
+ *
+ * Builds cmd_resp.c as it is, against the stand-ins for the ESP-IDF headers in tools/host:
+ *     cc -O2 -I tools/host -I managed_components/espressif__rmaker_common/include -o cmd_resp_bench \
+ *         tools/cmd_resp_bench.c managed_components/espressif__rmaker_common/src/cmd_resp_tlv.c
+ *
+ * Usage:
+ *     cmd_resp_bench [COMMANDS...]
+ *
+ * For each count of registered commands (default 10 64 128), sends requests for them, and for
+ * one in ten commands nobody registered, through esp_rmaker_cmd_response_handler(), and prints
+ * the requests handled per second. It also times finding the commands alone, in the table and
+ * in the array of commands the framework used to scan, which logged every lookup on top.
+ * Deregistering and registering again is checked along the way.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "../managed_components/espressif__rmaker_common/src/cmd_resp.c"
+
+#define REQUESTS        200000
+#define LOOKUPS         2000000
+
+typedef struct {
+    uint8_t data[64];
+    size_t len;
+} bench_request_t;
+
+static bench_request_t s_requests[REQUESTS];
+static esp_rmaker_cmd_info_t *s_flat_list[RMAKER_MAX_CMD];
+static unsigned s_handled;
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static esp_err_t bench_handler(const void *in_data, size_t in_len, void **out_data, size_t *out_len,
+                               esp_rmaker_cmd_ctx_t *ctx, void *priv)
+{
+    (void)in_data;
+    (void)in_len;
+    (void)ctx;
+    (void)priv;
+    static char response[] = "{\"status\":\"success\"}";
+    s_handled++;
+    *out_data = response;
+    *out_len = sizeof(response) - 1;
+    return ESP_OK;
+}
+
+static esp_err_t bench_capture(const void *data, size_t data_len, void *priv)
+{
+    bench_request_t *req = priv;
+    memcpy(req->data, data, data_len);
+    req->len = data_len;
+    return ESP_OK;
+}
+
+/* Standard commands first, then custom ones, spread out */
+static uint16_t bench_cmd_id(int i)
+{
+    return i < 8 ? i + 1 : ESP_RMAKER_CMD_CUSTOM_START + (i - 8) * 37;
+}
+
+/* The lookup the framework had before, without its logs */
+static esp_rmaker_cmd_info_t *flat_get_cmd_info(uint16_t cmd)
+{
+    for (int i = 0; i < RMAKER_MAX_CMD; i++) {
+        if (s_flat_list[i] && (s_flat_list[i]->cmd == cmd)) {
+            return s_flat_list[i];
+        }
+    }
+    return NULL;
+}
+
+static void bench(int count)
+{
+    static esp_rmaker_cmd_info_t flat_info[RMAKER_MAX_CMD];
+    for (int i = 0; i < count; i++) {
+        if (esp_rmaker_cmd_register(bench_cmd_id(i), ESP_RMAKER_USER_ROLE_PRIMARY_USER, bench_handler, false, NULL) != ESP_OK) {
+            fprintf(stderr, "Could not register command %d\n", bench_cmd_id(i));
+            exit(1);
+        }
+        flat_info[i] = *esp_rmaker_get_cmd_info(bench_cmd_id(i));
+        s_flat_list[i] = &flat_info[i];
+    }
+    /* Deregistering moves commands in the table, all of them have to be found after */
+    for (int i = 0; i < count; i += 2) {
+        esp_rmaker_cmd_deregister(bench_cmd_id(i));
+    }
+    for (int i = 0; i < count; i++) {
+        if ((esp_rmaker_get_cmd_info(bench_cmd_id(i)) != NULL) != (i % 2 == 1)) {
+            fprintf(stderr, "Command %d lost after deregistering\n", bench_cmd_id(i));
+            exit(1);
+        }
+    }
+    for (int i = 0; i < count; i += 2) {
+        esp_rmaker_cmd_register(bench_cmd_id(i), ESP_RMAKER_USER_ROLE_PRIMARY_USER, bench_handler, false, NULL);
+    }
+
+    srand(count);
+    unsigned expected = 0;
+    for (int i = 0; i < REQUESTS; i++) {
+        bool unknown = (i % 10 == 9);
+        uint16_t cmd = unknown ? 0x8000 + rand() % 0x1000 : bench_cmd_id(rand() % count);
+        expected += !unknown;
+        esp_rmaker_cmd_resp_test_send("req-0123456789", ESP_RMAKER_USER_ROLE_PRIMARY_USER, cmd, "{\"p\":1}", 7,
+                                      bench_capture, &s_requests[i]);
+    }
+
+    s_handled = 0;
+    double start = now_ns();
+    for (int i = 0; i < REQUESTS; i++) {
+        void *output = NULL;
+        size_t output_len = 0;
+        esp_rmaker_cmd_response_handler(s_requests[i].data, s_requests[i].len, &output, &output_len);
+        free(output);
+    }
+    double handler_ns = (now_ns() - start) / REQUESTS;
+
+    uint16_t *cmds = malloc(LOOKUPS * sizeof(uint16_t));
+    if (!cmds) {
+        fprintf(stderr, "Out of memory\n");
+        exit(1);
+    }
+    for (int i = 0; i < LOOKUPS; i++) {
+        cmds[i] = bench_cmd_id(rand() % count);
+    }
+    uintptr_t sink = 0;
+    start = now_ns();
+    for (int i = 0; i < LOOKUPS; i++) {
+        sink += (uintptr_t)esp_rmaker_get_cmd_info(cmds[i]);
+    }
+    double table_ns = (now_ns() - start) / LOOKUPS;
+    start = now_ns();
+    for (int i = 0; i < LOOKUPS; i++) {
+        sink -= (uintptr_t)flat_get_cmd_info(cmds[i]);
+    }
+    double flat_ns = (now_ns() - start) / LOOKUPS;
+    free(cmds);
+
+    printf("%4d commands: %9.0f requests/s (%6.1f ns each), lookup: table %5.1f ns, flat %6.1f ns%s\n",
+           count, 1e9 / handler_ns, handler_ns, table_ns, flat_ns,
+           (s_handled == expected && sink != 1) ? "" : " MISMATCH");
+
+    for (int i = 0; i < count; i++) {
+        esp_rmaker_cmd_deregister(bench_cmd_id(i));
+        s_flat_list[i] = NULL;
+    }
+    if (esp_rmaker_cmd_count != 0 || s_handled != expected) {
+        exit(1);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    static const int defaults[] = { 10, 64, 128 };
+    if (argc > 1) {
+        for (int i = 1; i < argc; i++) {
+            int count = atoi(argv[i]);
+            if (count > 0 && count <= RMAKER_MAX_CMD) {
+                bench(count);
+            }
+        }
+    } else {
+        for (size_t i = 0; i < sizeof(defaults) / sizeof(defaults[0]); i++) {
+            bench(defaults[i]);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,339 @@
+/*
+ * Fuzzer of the command-response TLV parsing (rmaker_common/src/cmd_resp_tlv.c and cmd_resp.c).
+ *
+ * With libFuzzer:
+ *     clang -g -O1 -fsanitize=fuzzer,address,undefined -DCMD_RESP_FUZZ_LIBFUZZER \
+ *         -I tools/host -I managed_components/espressif__rmaker_common/include -o cmd_resp_fuzz \
+ *         tools/cmd_resp_fuzz.c managed_components/espressif__rmaker_common/src/cmd_resp_tlv.c
+ *
+ * Without, it runs on inputs of its own, commands and batches of commands it encodes and then
+ * damages or cuts short, and random bytes:
+ *     cc -g -O1 -fsanitize=address,undefined -I tools/host -I managed_components/espressif__rmaker_common/include \
+ *         -o cmd_resp_fuzz tools/cmd_resp_fuzz.c managed_components/espressif__rmaker_common/src/cmd_resp_tlv.c
+ *     cmd_resp_fuzz [ITERATIONS [SEED]]
+ *
+ * For every input, the index must agree with the former parser, which is kept below for that, on
+ * every type, encoding the values again must give them back, and the request handler and the
+ * response parser must get through it, with a response which parses, batch responses included. The encoder is checked to write exactly what it says,
+ * or nothing when the buffer is short. The sanitizers catch the reads and writes out of bounds.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../managed_components/espressif__rmaker_common/src/cmd_resp.c"
+
+#define FUZZ_MAX_VALUE  2048
+
+static void fuzz_fail(const char *what)
+{
+    fprintf(stderr, "cmd_resp_fuzz: %s\n", what);
+    abort();
+}
+
+/* The lookup of the former parser, for one type, on a buffer whose records are known to fit */
+static int ref_get_value(const uint8_t *buf, size_t len, uint8_t type, uint8_t *val)
+{
+    size_t off = 0;
+    int val_len = 0;
+    bool found = false;
+    while (off < len) {
+        uint8_t record_len = buf[off + 1];
+        if (buf[off] == type) {
+            memcpy(val + val_len, &buf[off + 2], record_len);
+            val_len += record_len;
+            if (record_len < 255) {
+                return val_len;
+            }
+            found = true;
+        } else if (found) {
+            return val_len;
+        }
+        off += 2 + record_len;
+    }
+    return found ? val_len : -1;
+}
+
+static esp_err_t fuzz_handler(const void *in_data, size_t in_len, void **out_data, size_t *out_len,
+                              esp_rmaker_cmd_ctx_t *ctx, void *priv)
+{
+    /* Every byte of the data has to be readable, and the request id terminated */
+    unsigned sum = strlen(ctx->req_id);
+    for (size_t i = 0; i < in_len; i++) {
+        sum += ((const uint8_t *)in_data)[i];
+    }
+    if (priv) {
+        /* Moves the commands around in the table, while the framework works on one */
+        esp_rmaker_cmd_deregister(ESP_RMAKER_CMD_CUSTOM_START + 1);
+        esp_rmaker_cmd_register(ESP_RMAKER_CMD_CUSTOM_START + 1, 0xff, fuzz_handler, true, NULL);
+    }
+    *out_len = sum % 600;
+    *out_data = calloc(1, *out_len + 1);
+    return (sum & 1) ? ESP_FAIL : ESP_OK;
+}
+
+static void fuzz_index(const uint8_t *data, size_t size)
+{
+    esp_rmaker_tlv_index_t index;
+    if (esp_rmaker_tlv_index(&index, data, size) != 0) {
+        return;
+    }
+    static uint8_t value[FUZZ_MAX_VALUE], ref[FUZZ_MAX_VALUE];
+    uint8_t *encoded = malloc(size ? size : 1);
+    esp_rmaker_tlv_writer_t writer;
+    esp_rmaker_tlv_writer_init(&writer, encoded, size);
+    for (int type = 0; type <= ESP_RMAKER_TLV_MAX_TYPE; type++) {
+        const esp_rmaker_tlv_field_t *field = &index.fields[type];
+        int len = esp_rmaker_tlv_copy(field, value, sizeof(value));
+        if (field->len > sizeof(value)) {
+            continue;
+        }
+        if (len != ref_get_value(data, size, type, ref) || (len > 0 && memcmp(value, ref, len) != 0)) {
+            fuzz_fail("index and former parser disagree");
+        }
+        /* Taking in fewer bytes than the value fails, rather than cut it */
+        if (len > 0 && esp_rmaker_tlv_copy(field, value, len - 1) != -1) {
+            fuzz_fail("value copied into a short buffer");
+        }
+        /* Values with a full last record may take in the next one of their type, so not those */
+        if (len >= 0 && (len == 0 || len % 255) && esp_rmaker_tlv_put(&writer, type, value, len) < 0) {
+            fuzz_fail("values encoded again do not fit where they came from");
+        }
+    }
+    esp_rmaker_tlv_index_t again;
+    if (esp_rmaker_tlv_index(&again, encoded, writer.len) != 0) {
+        fuzz_fail("encoded values do not index");
+    }
+    for (int type = 0; type <= ESP_RMAKER_TLV_MAX_TYPE; type++) {
+        const esp_rmaker_tlv_field_t *field = &index.fields[type];
+        if (!field->value || field->len > sizeof(value) || (field->len && field->len % 255 == 0)) {
+            continue;
+        }
+        int len = esp_rmaker_tlv_copy(field, value, sizeof(value));
+        if (esp_rmaker_tlv_copy(&again.fields[type], ref, sizeof(ref)) != len || memcmp(value, ref, len) != 0) {
+            fuzz_fail("values do not come back from the encoder");
+        }
+    }
+    free(encoded);
+}
+
+static void fuzz_encode(const uint8_t *data, size_t size)
+{
+    if (size < 4) {
+        return;
+    }
+    /* Values of up to four records, into buffers a few bytes short or long */
+    size_t len = ((data[0] << 8) | data[1]) % 800;
+    size_t encoded_size = esp_rmaker_tlv_encoded_size(len);
+    int delta = data[2] % 9 - 4;
+    size_t buf_size = ((int)encoded_size + delta < 0) ? 0 : encoded_size + delta;
+    uint8_t *value = malloc(len ? len : 1);
+    uint8_t *buf = malloc(buf_size ? buf_size : 1);
+    for (size_t i = 0; i < len; i++) {
+        value[i] = data[3 + i % (size - 3)];
+    }
+    esp_rmaker_tlv_writer_t writer;
+    esp_rmaker_tlv_writer_init(&writer, buf, buf_size);
+    int written = esp_rmaker_tlv_put(&writer, ESP_RMAKER_TLV_TYPE_DATA, value, len);
+    if (buf_size < encoded_size) {
+        if (written != -1 || writer.len != 0) {
+            fuzz_fail("value written past the buffer");
+        }
+    } else {
+        esp_rmaker_tlv_index_t index;
+        if (written != (int)encoded_size || writer.len != (size_t)written ||
+                esp_rmaker_tlv_index(&index, buf, writer.len) != 0 || index.fields[ESP_RMAKER_TLV_TYPE_DATA].len != len) {
+            fuzz_fail("value written is not the size given");
+        }
+    }
+    free(value);
+    free(buf);
+}
+
+static void fuzz_handle(const uint8_t *data, size_t size)
+{
+    /* Exactly the size, so that reading past it is caught */
+    uint8_t *input = malloc(size ? size : 1);
+    memcpy(input, data, size);
+    void *output = NULL;
+    size_t output_len = 0;
+    if (esp_rmaker_cmd_response_handler(input, size, &output, &output_len) == ESP_OK) {
+        esp_rmaker_tlv_index_t index;
+        if (esp_rmaker_tlv_index(&index, output, output_len) != 0 || !index.fields[ESP_RMAKER_TLV_TYPE_STATUS].value) {
+            fuzz_fail("response does not parse");
+        }
+        uint8_t cmd_buf[2] = {0};
+        esp_rmaker_tlv_copy(&index.fields[ESP_RMAKER_TLV_TYPE_CMD], cmd_buf, sizeof(cmd_buf));
+        const esp_rmaker_tlv_field_t *body = &index.fields[ESP_RMAKER_TLV_TYPE_DATA];
+        if (get_u16_le(cmd_buf) == ESP_RMAKER_CMD_TYPE_BATCH && body->value) {
+            /* A command and its status for every command run, with data on success */
+            uint8_t *copy = malloc(body->len);
+            esp_rmaker_tlv_copy(body, copy, body->len);
+            esp_rmaker_tlv_cursor_t cursor;
+            esp_rmaker_tlv_cursor_init(&cursor, copy, body->len);
+            uint8_t type, expected = ESP_RMAKER_TLV_TYPE_CMD, status = 0;
+            esp_rmaker_tlv_field_t field;
+            int ret;
+            while ((ret = esp_rmaker_tlv_next(&cursor, &type, &field)) > 0) {
+                if (type == ESP_RMAKER_TLV_TYPE_DATA && expected == ESP_RMAKER_TLV_TYPE_CMD &&
+                        status == ESP_RMAKER_CMD_STATUS_SUCCESS) {
+                    status = 0xff;
+                    continue;
+                }
+                if (type != expected) {
+                    fuzz_fail("batch response out of order");
+                }
+                if (type == ESP_RMAKER_TLV_TYPE_STATUS) {
+                    status = field.value[0];
+                }
+                expected = (type == ESP_RMAKER_TLV_TYPE_CMD) ? ESP_RMAKER_TLV_TYPE_STATUS : ESP_RMAKER_TLV_TYPE_CMD;
+            }
+            if (ret < 0 || expected != ESP_RMAKER_TLV_TYPE_CMD) {
+                fuzz_fail("batch response does not parse");
+            }
+            free(copy);
+        }
+        free(output);
+    }
+    esp_rmaker_cmd_resp_parse_response(input, size, NULL);
+    free(input);
+}
+
+static void fuzz_init(void)
+{
+    static bool done;
+    if (!done) {
+        esp_rmaker_cmd_register(ESP_RMAKER_CMD_TYPE_SET_PARAMS, 0xff, fuzz_handler, true, NULL);
+        esp_rmaker_cmd_register(ESP_RMAKER_CMD_CUSTOM_START, 0xff, fuzz_handler, true, (void *)1);
+        esp_rmaker_cmd_register(ESP_RMAKER_CMD_CUSTOM_START + 1, 0xff, fuzz_handler, true, NULL);
+        esp_rmaker_cmd_register(ESP_RMAKER_CMD_CUSTOM_START + 2, ESP_RMAKER_USER_ROLE_NODE, fuzz_handler, true, NULL);
+        done = true;
+    }
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    fuzz_init();
+    fuzz_index(data, size);
+    fuzz_encode(data, size);
+    fuzz_handle(data, size);
+    return 0;
+}
+
+#ifndef CMD_RESP_FUZZ_LIBFUZZER
+
+typedef struct {
+    uint8_t data[256];
+    size_t len;
+} fuzz_sent_t;
+
+static esp_err_t fuzz_capture(const void *data, size_t data_len, void *priv)
+{
+    fuzz_sent_t *sent = priv;
+    memcpy(sent->data, data, data_len);
+    sent->len = data_len;
+    return ESP_OK;
+}
+
+/* A command or batch from the encoder, then damaged: bytes changed, cut short, or records added */
+static size_t fuzz_make_input(uint8_t *buf, size_t size)
+{
+    static const uint16_t cmds[] = { ESP_RMAKER_CMD_TYPE_SET_PARAMS, ESP_RMAKER_CMD_CUSTOM_START,
+                                     ESP_RMAKER_CMD_CUSTOM_START + 1, ESP_RMAKER_CMD_CUSTOM_START + 2, 0x2345 };
+    size_t len = 0;
+    int kind = rand() % 4;
+    if (kind == 0) {
+        len = rand() % size;
+        for (size_t i = 0; i < len; i++) {
+            buf[i] = rand();
+        }
+        return len;
+    }
+    char req_id[40];
+    int req_id_len = rand() % 36;
+    for (int i = 0; i < req_id_len; i++) {
+        req_id[i] = 'a' + rand() % 26;
+    }
+    req_id[req_id_len] = '\0';
+    static uint8_t value[1200];
+    size_t value_len = 0;
+    bool batch = rand() % 2;
+    if (batch) {
+        /* Commands, known or not, now and then without data, a batch or none at all */
+        esp_rmaker_tlv_writer_t writer;
+        esp_rmaker_tlv_writer_init(&writer, value, sizeof(value));
+        for (int i = rand() % 20; i > 0; i--) {
+            uint8_t cmd_buf[2];
+            int pick = rand() % 40;
+            put_u16_le(cmd_buf, pick == 0 ? 0 : pick == 1 ? ESP_RMAKER_CMD_TYPE_BATCH : cmds[pick % 5]);
+            static uint8_t data[300];
+            size_t data_len = rand() % sizeof(data);
+            memset(data, rand(), data_len);
+            if (esp_rmaker_tlv_put(&writer, ESP_RMAKER_TLV_TYPE_CMD, cmd_buf, sizeof(cmd_buf)) < 0 ||
+                    (rand() % 4 && esp_rmaker_tlv_put(&writer, ESP_RMAKER_TLV_TYPE_DATA, data, data_len) < 0)) {
+                break;
+            }
+        }
+        value_len = writer.len;
+    } else {
+        value_len = (rand() % 3 == 0) ? rand() % sizeof(value) : (size_t)(rand() % 100);
+        for (size_t i = 0; i < value_len; i++) {
+            value[i] = rand();
+        }
+    }
+    uint8_t role = 1 << (rand() % 5);
+    esp_rmaker_cmd_resp_encode_payload(req_id, role, batch ? ESP_RMAKER_CMD_TYPE_BATCH : cmds[rand() % 5],
+                                       value, value_len, buf, size, &len);
+    if (len > size) {
+        len = 0;
+    }
+    if (batch && len + 3 <= size) {
+        buf[len] = ESP_RMAKER_TLV_TYPE_FLAGS;
+        buf[len + 1] = 1;
+        buf[len + 2] = rand() % 2 ? ESP_RMAKER_CMD_BATCH_STOP_ON_ERROR : 0;
+        len += 3;
+    }
+    if (kind == 1 && len) {
+        for (int i = rand() % 4; i >= 0; i--) {
+            buf[rand() % len] = rand();
+        }
+    } else if (kind == 2 && len) {
+        len = rand() % len;
+    } else if (kind == 3) {
+        /* Extra records, of types known or not */
+        for (int i = rand() % 8; i > 0; i--) {
+            uint8_t record_len = (rand() % 4 == 0) ? 255 : rand() % 20;
+            if (len + 2 + record_len > size) {
+                break;
+            }
+            buf[len] = rand() % 10;
+            buf[len + 1] = record_len;
+            memset(&buf[len + 2], rand(), record_len);
+            len += 2 + record_len;
+        }
+    }
+    return len;
+}
+
+int main(int argc, char **argv)
+{
+    long iterations = argc > 1 ? atol(argv[1]) : 200000;
+    unsigned seed = argc > 2 ? (unsigned)atol(argv[2]) : 1;
+    srand(seed);
+    static uint8_t input[1500];
+
+    /* Check the test sender and the response parser against each other first */
+    fuzz_sent_t sent;
+    esp_rmaker_cmd_resp_test_send("req", ESP_RMAKER_USER_ROLE_PRIMARY_USER, ESP_RMAKER_CMD_TYPE_SET_PARAMS,
+                                  "{}", 2, fuzz_capture, &sent);
+    LLVMFuzzerTestOneInput(sent.data, sent.len);
+
+    for (long i = 0; i < iterations; i++) {
+        size_t len = fuzz_make_input(input, sizeof(input));
+        LLVMFuzzerTestOneInput(input, len);
+    }
+    printf("%ld inputs, seed %u: no failures\n", iterations, seed);
+    return 0;
+}
+
+#endif /* CMD_RESP_FUZZ_LIBFUZZER */
@@ -0,0 +1,302 @@
+/*
+ * Host benchmark of the command-response TLV parsing and encoding (rmaker_common/src/cmd_resp_tlv.c).
+ *
+ * Builds cmd_resp.c as it is, against the stand-ins for the ESP-IDF headers in tools/host:
+ *     cc -O2 -I tools/host -I managed_components/espressif__rmaker_common/include -o cmd_resp_tlv_bench \
+ *         tools/cmd_resp_tlv_bench.c managed_components/espressif__rmaker_common/src/cmd_resp_tlv.c
+ *
+ * Usage:
+ *     cmd_resp_tlv_bench [DATA_BYTES...]
+ *
+ * For each size of command data (default 0 64 600 2000), with the request fields only and with
+ * 32 more records in front, as other fields would be, times:
+ *
+ *   - reading a request: the request id, role, command and data, with the index, against a scan
+ *     of the buffer for each of them, as the framework did before, which is kept below.
+ *   - encoding a response: into a buffer of the caller, and into one allocated for it, against
+ *     working out the size, allocating and adding every field, as the framework did before.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "../managed_components/espressif__rmaker_common/src/cmd_resp.c"
+
+#define ITERATIONS      200000
+#define EXTRA_RECORDS   32
+
+typedef struct {
+    uint8_t *bufptr;
+    int bufsize;
+    int curlen;
+} old_tlv_data_t;
+
+/* The parser and encoder the framework had before, as they were */
+static int old_get_tlv_length(const uint8_t *buf, int buflen, uint8_t type)
+{
+    if (!buf ) {
+        return -1;
+    }
+    int curlen = 0;
+    int val_len = 0;
+    bool found = false;
+    while (buflen > 0) {
+        if (buf[curlen] == type) {
+            uint8_t len = buf[curlen + 1];
+            if ((buflen - len) < 2) {
+                return -1;
+            }
+            val_len += len;
+            if (len < 255) {
+                return val_len;
+            } else {
+                found = true;
+            }
+
+        } else if (found) {
+            return val_len;
+        }
+        buflen -= (2 + buf[curlen + 1]);
+        curlen += (2 + buf[curlen + 1]);
+    }
+    if (found) {
+        return val_len;
+    }
+    return -1;
+}
+
+static int old_get_value_from_tlv(const uint8_t *buf, int buflen, uint8_t type, void *val, int val_size)
+{
+    if (!buf || !val) {
+        return -1;
+    }
+    int curlen = 0;
+    int val_len = 0;
+    bool found = false;
+    while (buflen > 0) {
+        if (buf[curlen] == type) {
+            uint8_t len = buf[curlen + 1];
+            if ((val_size < len) || ((buflen - len) < 2)) {
+                return -1;
+            }
+            memcpy((uint8_t *)val + val_len, &buf[curlen + 2], len);
+            val_len += len;
+            val_size -= len;
+            if (len < 255) {
+                return val_len;
+            } else {
+                found = true;
+            }
+
+        } else if (found) {
+            return val_len;
+        }
+        buflen -= (2 + buf[curlen + 1]);
+        curlen += (2 + buf[curlen + 1]);
+    }
+    if (found) {
+        return val_len;
+    }
+    return -1;
+}
+
+static int old_add_tlv(old_tlv_data_t *tlv_data, uint8_t type, int len, const void *val)
+{
+    if (!tlv_data->bufptr || ((len + 2) > (tlv_data->bufsize - tlv_data->curlen))) {
+        return -1;
+    }
+    if (len > 0 && val == NULL) {
+        return -1;
+    }
+    uint8_t *buf_ptr = (uint8_t *)val;
+    int orig_len = tlv_data->curlen;
+    do {
+        tlv_data->bufptr[tlv_data->curlen++] = type;
+        int tmp_len;
+        if (len > 255) {
+            tmp_len = 255;
+        } else {
+            tmp_len = len;
+        }
+        tlv_data->bufptr[tlv_data->curlen++] = tmp_len;
+        memcpy(&tlv_data->bufptr[tlv_data->curlen], buf_ptr, tmp_len);
+        tlv_data->curlen += tmp_len;
+        buf_ptr += tmp_len;
+        len -= tmp_len;
+    } while (len);
+    return tlv_data->curlen - orig_len;
+}
+
+static size_t old_get_tlv_encoded_size(size_t len)
+{
+    size_t required_packets = (len / 255) + 1;
+    return (2 * required_packets) + ((required_packets - 1) * 255) + (len % 255);
+}
+
+static esp_err_t old_prepare_payload(const char *req_id, uint8_t role, uint16_t cmd_id, const void *data,
+                                     size_t data_size, void **output, size_t *output_len)
+{
+    size_t payload_size = old_get_tlv_encoded_size(strlen(req_id)) + old_get_tlv_encoded_size(sizeof(role)) +
+                          old_get_tlv_encoded_size(sizeof(cmd_id));
+    if (data_size) {
+        payload_size += old_get_tlv_encoded_size(data_size);
+    }
+    uint8_t *payload_buffer = calloc(1, payload_size);
+    if (!payload_buffer) {
+        return ESP_ERR_NO_MEM;
+    }
+    old_tlv_data_t tlv_data = { payload_buffer, payload_size, 0 };
+    old_add_tlv(&tlv_data, ESP_RMAKER_TLV_TYPE_REQ_ID, strlen(req_id), req_id);
+    old_add_tlv(&tlv_data, ESP_RMAKER_TLV_TYPE_USER_ROLE, sizeof(role), &role);
+    uint8_t cmd_buf[2];
+    put_u16_le(cmd_buf, cmd_id);
+    old_add_tlv(&tlv_data, ESP_RMAKER_TLV_TYPE_CMD, sizeof(cmd_buf), cmd_buf);
+    if (data_size) {
+        old_add_tlv(&tlv_data, ESP_RMAKER_TLV_TYPE_DATA, data_size, data);
+    }
+    *output = payload_buffer;
+    *output_len = tlv_data.curlen;
+    return ESP_OK;
+}
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static uintptr_t s_sink;
+
+/* Reads the fields as the request handler did, allocating the data */
+static void read_old(const uint8_t *buf, size_t len)
+{
+    esp_rmaker_cmd_ctx_t ctx = {0};
+    old_get_value_from_tlv(buf, len, ESP_RMAKER_TLV_TYPE_REQ_ID, ctx.req_id, sizeof(ctx.req_id));
+    old_get_value_from_tlv(buf, len, ESP_RMAKER_TLV_TYPE_USER_ROLE, &ctx.user_role, sizeof(ctx.user_role));
+    uint8_t cmd_buf[2] = {0};
+    old_get_value_from_tlv(buf, len, ESP_RMAKER_TLV_TYPE_CMD, cmd_buf, sizeof(cmd_buf));
+    ctx.cmd = get_u16_le(cmd_buf);
+    int data_size = old_get_tlv_length(buf, len, ESP_RMAKER_TLV_TYPE_DATA);
+    if (data_size > 0) {
+        void *data = calloc(1, data_size);
+        old_get_value_from_tlv(buf, len, ESP_RMAKER_TLV_TYPE_DATA, data, data_size);
+        s_sink += ((uint8_t *)data)[data_size - 1];
+        free(data);
+    }
+    s_sink += ctx.cmd + ctx.user_role + ctx.req_id[0];
+}
+
+/* Reads the fields as the request handler does now */
+static void read_index(const uint8_t *buf, size_t len)
+{
+    esp_rmaker_cmd_ctx_t ctx = {0};
+    esp_rmaker_tlv_index_t tlv;
+    esp_rmaker_tlv_index(&tlv, buf, len);
+    esp_rmaker_tlv_copy(&tlv.fields[ESP_RMAKER_TLV_TYPE_REQ_ID], ctx.req_id, sizeof(ctx.req_id) - 1);
+    esp_rmaker_tlv_copy(&tlv.fields[ESP_RMAKER_TLV_TYPE_USER_ROLE], &ctx.user_role, sizeof(ctx.user_role));
+    uint8_t cmd_buf[2] = {0};
+    esp_rmaker_tlv_copy(&tlv.fields[ESP_RMAKER_TLV_TYPE_CMD], cmd_buf, sizeof(cmd_buf));
+    ctx.cmd = get_u16_le(cmd_buf);
+    const esp_rmaker_tlv_field_t *field = &tlv.fields[ESP_RMAKER_TLV_TYPE_DATA];
+    if (field->records > 1) {
+        void *data = malloc(field->len);
+        esp_rmaker_tlv_copy(field, data, field->len);
+        s_sink += ((uint8_t *)data)[field->len - 1];
+        free(data);
+    } else if (field->len) {
+        s_sink += field->value[field->len - 1];
+    }
+    s_sink += ctx.cmd + ctx.user_role + ctx.req_id[0];
+}
+
+static double time_read(void (*read)(const uint8_t *, size_t), const uint8_t *buf, size_t len)
+{
+    double start = now_ns();
+    for (int i = 0; i < ITERATIONS; i++) {
+        read(buf, len);
+    }
+    return (now_ns() - start) / ITERATIONS;
+}
+
+static void bench(size_t data_size)
+{
+    static const char req_id[] = "Hw8ZfXm2nL4qT9vR1kJ3aD";
+    uint8_t *data = malloc(data_size + 1);
+    memset(data, 'x', data_size);
+
+    size_t payload_len;
+    esp_rmaker_cmd_resp_encode_payload(req_id, ESP_RMAKER_USER_ROLE_PRIMARY_USER, ESP_RMAKER_CMD_CUSTOM_START,
+                                       data, data_size, NULL, 0, &payload_len);
+    size_t extra_len = EXTRA_RECORDS * (2 + 8);
+    uint8_t *request = malloc(extra_len + payload_len);
+    for (int i = 0; i < EXTRA_RECORDS; i++) {
+        uint8_t *record = request + i * (2 + 8);
+        record[0] = ESP_RMAKER_TLV_MAX_TYPE + 1 + i % 8;
+        record[1] = 8;
+        memset(record + 2, i, 8);
+    }
+    esp_rmaker_cmd_resp_encode_payload(req_id, ESP_RMAKER_USER_ROLE_PRIMARY_USER, ESP_RMAKER_CMD_CUSTOM_START,
+                                       data, data_size, request + extra_len, payload_len, &payload_len);
+
+    double old_ns = time_read(read_old, request + extra_len, payload_len);
+    double index_ns = time_read(read_index, request + extra_len, payload_len);
+    double old_extra_ns = time_read(read_old, request, extra_len + payload_len);
+    double index_extra_ns = time_read(read_index, request, extra_len + payload_len);
+
+    uint8_t *out = malloc(payload_len);
+    double start = now_ns();
+    for (int i = 0; i < ITERATIONS; i++) {
+        void *output = NULL;
+        size_t output_len = 0;
+        old_prepare_payload(req_id, ESP_RMAKER_USER_ROLE_PRIMARY_USER, ESP_RMAKER_CMD_CUSTOM_START, data, data_size,
+                            &output, &output_len);
+        s_sink += output_len;
+        free(output);
+    }
+    double old_enc_ns = (now_ns() - start) / ITERATIONS;
+    start = now_ns();
+    for (int i = 0; i < ITERATIONS; i++) {
+        void *output;
+        size_t output_len;
+        esp_rmaker_cmd_resp_prepare_response_payload(req_id, ESP_RMAKER_USER_ROLE_PRIMARY_USER,
+                                                     ESP_RMAKER_CMD_CUSTOM_START, data, data_size, &output, &output_len);
+        s_sink += output_len;
+        free(output);
+    }
+    double alloc_enc_ns = (now_ns() - start) / ITERATIONS;
+    start = now_ns();
+    for (int i = 0; i < ITERATIONS; i++) {
+        size_t output_len;
+        esp_rmaker_cmd_resp_encode_payload(req_id, ESP_RMAKER_USER_ROLE_PRIMARY_USER, ESP_RMAKER_CMD_CUSTOM_START,
+                                           data, data_size, out, payload_len, &output_len);
+        s_sink += output_len + out[output_len - 1];
+    }
+    double buf_enc_ns = (now_ns() - start) / ITERATIONS;
+
+    printf("%6zu %9.1f %9.1f %9.1f %9.1f %9.1f %9.1f %9.1f\n", data_size, old_ns, index_ns, old_extra_ns,
+           index_extra_ns, old_enc_ns, alloc_enc_ns, buf_enc_ns);
+    free(out);
+    free(request);
+    free(data);
+}
+
+int main(int argc, char **argv)
+{
+    static const size_t defaults[] = { 0, 64, 600, 2000 };
+    printf("Nanoseconds per request or response\n");
+    printf("%6s %9s %9s %9s %9s %9s %9s %9s\n", "", "read", "", "+32 recs", "", "encode", "", "");
+    printf("%6s %9s %9s %9s %9s %9s %9s %9s\n", "bytes", "scans", "index", "scans", "index", "before", "alloc",
+           "buffer");
+    if (argc > 1) {
+        for (int i = 1; i < argc; i++) {
+            bench(strtoul(argv[i], NULL, 0));
+        }
+    } else {
+        for (size_t i = 0; i < sizeof(defaults) / sizeof(defaults[0]); i++) {
+            bench(defaults[i]);
+        }
+    }
+    return s_sink == 1;
+}
@@ -0,0 +1,4 @@
+/* Host stand-in, see sdkconfig.h */
+#pragma once
+
+#include <esp_err.h>
@@ -0,0 +1,12 @@
+/* Host stand-in, see sdkconfig.h. Logs are compiled out, as the tools measure the code around them. */
+#pragma once
+
+#include <stdio.h>
+
+#define ESP_HOST_LOG(tag, format, ...)  do { (void)(tag); if (0) { printf(format, ##__VA_ARGS__); } } while (0)
+
+#define ESP_LOGE(tag, format, ...)  ESP_HOST_LOG(tag, format, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...)  ESP_HOST_LOG(tag, format, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...)  ESP_HOST_LOG(tag, format, ##__VA_ARGS__)
+#define ESP_LOGD(tag, format, ...)  ESP_HOST_LOG(tag, format, ##__VA_ARGS__)
+#define ESP_LOGV(tag, format, ...)  ESP_HOST_LOG(tag, format, ##__VA_ARGS__)
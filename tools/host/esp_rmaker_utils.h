@@ -0,0 +1,7 @@
+/* Host stand-in, see sdkconfig.h */
+#pragma once
+
+#include <stdlib.h>
+
+#define MEM_ALLOC_EXTRAM(size)          malloc(size)
+#define MEM_CALLOC_EXTRAM(num, size)    calloc(num, size)
@@ -0,0 +1,8 @@
+/*
+ * Stand-ins for the ESP-IDF headers, so that the host tools in tools/ can build
+ * rmaker_common sources as they are. Only what those sources use is here.
+ */
+#pragma once
+
+#define CONFIG_ESP_RMAKER_MAX_COMMANDS  128
+#define CONFIG_ESP_RMAKER_CMD_BATCH_MAX_ENTRIES  64
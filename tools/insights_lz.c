@@ -0,0 +1,270 @@
+/*
+ * Host side of the Insights message compression (CONFIG_ESP_INSIGHTS_COMPRESS).
+ *
+ * Builds the device's compressor as it is, so results match the firmware byte for byte:
+ *     cc -O2 -I managed_components/espressif__esp_insights/src -o insights_lz \
+ *         tools/insights_lz.c managed_components/espressif__esp_insights/src/esp_insights_compress.c
+ *
+ * Usage:
+ *     insights_lz d IN OUT        expand the messages in IN (one publish, possibly a batch of messages)
+ *     insights_lz c IN OUT        compress one raw message
+ *     insights_lz bench FILE...   size ratio and CPU cost per KB on captured messages
+ *
+ * bench takes raw messages, or serial logs of a device with CONFIG_ESP_INSIGHTS_DEBUG_ENABLED and
+ * without CONFIG_ESP_INSIGHTS_DEBUG_PRINT_JSON, which hex dumps every message it sends:
+ *     idf.py monitor | tee insights.log
+ *     insights_lz bench insights.log
+ * The device logs its own compression time for each message as well, which is the number that
+ * counts for the firmware; the host timing here is for comparing changes to the compressor.
+ */
+
+#include <ctype.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "esp_insights_compress.h"
+
+#define MSG_MAX         (64 * 1024)
+#define BENCH_ROUNDS    200
+
+static uint16_t s_workspace[ESP_INSIGHTS_COMPRESS_WORKSPACE_SIZE / sizeof(uint16_t)];
+
+static uint8_t *read_file(const char *path, size_t *len)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        perror(path);
+        return NULL;
+    }
+    size_t cap = 4096, n = 0;
+    uint8_t *buf = malloc(cap);
+    size_t r;
+    while (buf && (r = fread(buf + n, 1, cap - n, f)) > 0) {
+        n += r;
+        if (n == cap) {
+            cap *= 2;
+            buf = realloc(buf, cap);
+        }
+    }
+    fclose(f);
+    *len = n;
+    return buf;
+}
+
+static int write_file(const char *path, const uint8_t *data, size_t len)
+{
+    FILE *f = fopen(path, "wb");
+    if (!f || fwrite(data, 1, len, f) != len) {
+        perror(path);
+        if (f) {
+            fclose(f);
+        }
+        return -1;
+    }
+    fclose(f);
+    return 0;
+}
+
+static double now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+/* Length of the TLV at msg, including its header */
+static size_t tlv_len(const uint8_t *msg, size_t len)
+{
+    if (len < ESP_INSIGHTS_MSG_HDR_LEN) {
+        return 0;
+    }
+    size_t n = ESP_INSIGHTS_MSG_HDR_LEN + (msg[1] | (msg[2] << 8));
+    return (n <= len) ? n : 0;
+}
+
+static int cmd_decompress(const char *in, const char *out)
+{
+    size_t len, out_len = 0;
+    uint8_t *data = read_file(in, &len);
+    uint8_t *buf = malloc(MSG_MAX * 4);
+    if (!data || !buf) {
+        return 1;
+    }
+    for (size_t pos = 0; pos < len;) {
+        size_t n = tlv_len(data + pos, len - pos);
+        size_t m = n ? esp_insights_decompress_msg(data + pos, n, buf + out_len, MSG_MAX * 4 - out_len) : 0;
+        if (!m) {
+            fprintf(stderr, "%s: bad message at offset %zu\n", in, pos);
+            return 1;
+        }
+        pos += n;
+        out_len += m;
+    }
+    int ret = write_file(out, buf, out_len) ? 1 : 0;
+    free(data);
+    free(buf);
+    return ret;
+}
+
+static int cmd_compress(const char *in, const char *out)
+{
+    size_t len;
+    uint8_t *data = read_file(in, &len);
+    uint8_t *buf = malloc(MSG_MAX);
+    if (!data || !buf) {
+        return 1;
+    }
+    size_t n = esp_insights_compress_msg(data, len, buf, MSG_MAX, s_workspace);
+    if (!n) {
+        fprintf(stderr, "%s: does not get smaller, it would be sent as it is\n", in);
+    }
+    int ret = n ? write_file(out, buf, n) : write_file(out, data, len);
+    free(data);
+    free(buf);
+    return ret ? 1 : 0;
+}
+
+/* Splits a serial log into the messages hex dumped in it. A message is a run of lines which hold
+ * nothing but "0x.." bytes, empty lines included, and ends at any other line.
+ */
+static size_t parse_hex_log(const char *text, uint8_t **msgs, size_t *lens, size_t max)
+{
+    size_t count = 0, cur = 0;
+    uint8_t *buf = NULL;
+
+    for (const char *line = text; *line && count < max;) {
+        const char *end = strchr(line, '\n');
+        end = end ? end : line + strlen(line);
+        const char *p = line;
+        size_t bytes = 0;
+        bool hex = true;
+        uint8_t tmp[64];
+        while (p < end) {
+            if (isspace((unsigned char) *p)) {
+                p++;
+            } else if (p + 4 <= end && p[0] == '0' && p[1] == 'x' && isxdigit((unsigned char) p[2]) &&
+                       isxdigit((unsigned char) p[3]) && bytes < sizeof(tmp)) {
+                tmp[bytes++] = strtoul((char []) { p[2], p[3], 0 }, NULL, 16);
+                p += 4;
+            } else {
+                hex = false;
+                break;
+            }
+        }
+        if (hex && bytes) {
+            if (!buf) {
+                buf = malloc(MSG_MAX);
+                cur = 0;
+            }
+            if (cur + bytes <= MSG_MAX) {
+                memcpy(buf + cur, tmp, bytes);
+                cur += bytes;
+            }
+        } else if (!hex && buf) {
+            msgs[count] = buf;
+            lens[count++] = cur;
+            buf = NULL;
+        }
+        line = *end ? end + 1 : end;
+    }
+    if (buf && count < max) {
+        msgs[count] = buf;
+        lens[count++] = cur;
+    }
+    return count;
+}
+
+/* Messages start with a binary type byte, logs are text throughout */
+static bool is_text(const uint8_t *data, size_t len)
+{
+    for (size_t i = 0; i < len; i++) {
+        if (!isprint(data[i]) && !isspace(data[i]) && data[i] != 0x1b) {
+            return false;
+        }
+    }
+    return len > 0;
+}
+
+static int cmd_bench(int argc, char **argv)
+{
+    enum { MAX_MSGS = 4096 };
+    static uint8_t *msgs[MAX_MSGS];
+    static size_t lens[MAX_MSGS];
+    static uint8_t packed[MSG_MAX], expanded[MSG_MAX];
+    size_t count = 0;
+
+    for (int i = 0; i < argc; i++) {
+        size_t len;
+        uint8_t *data = read_file(argv[i], &len);
+        if (!data) {
+            return 1;
+        }
+        data = realloc(data, len + 1);
+        data[len] = 0;
+        size_t n = is_text(data, len) ?
+                   parse_hex_log((const char *) data, msgs + count, lens + count, MAX_MSGS - count) : 0;
+        if (n) {
+            count += n;
+            free(data);
+        } else if (count < MAX_MSGS) {
+            msgs[count] = data;
+            lens[count++] = len;
+        }
+    }
+    if (!count) {
+        fprintf(stderr, "no messages found\n");
+        return 1;
+    }
+
+    size_t raw_total = 0, packed_total = 0;
+    double c_us = 0, d_us = 0;
+    printf("%6s %8s %8s %7s %10s %10s\n", "msg", "raw", "packed", "ratio", "comp us/KB", "dec us/KB");
+    for (size_t i = 0; i < count; i++) {
+        size_t plen = 0, elen = 0;
+        double t0 = now_us();
+        for (int r = 0; r < BENCH_ROUNDS; r++) {
+            plen = esp_insights_compress_msg(msgs[i], lens[i], packed, sizeof(packed), s_workspace);
+        }
+        double t1 = now_us();
+        const uint8_t *sent = plen ? packed : msgs[i];
+        size_t sent_len = plen ? plen : lens[i];
+        for (int r = 0; r < BENCH_ROUNDS; r++) {
+            elen = esp_insights_decompress_msg(sent, sent_len, expanded, sizeof(expanded));
+        }
+        double t2 = now_us();
+        if (elen != lens[i] || memcmp(expanded, msgs[i], elen)) {
+            fprintf(stderr, "message %zu does not round trip\n", i);
+            return 1;
+        }
+        double kb = lens[i] / 1024.0;
+        double cu = (t1 - t0) / BENCH_ROUNDS / kb, du = (t2 - t1) / BENCH_ROUNDS / kb;
+        printf("%6zu %8zu %8zu %6.1f%% %10.1f %10.1f\n", i, lens[i], sent_len, 100.0 * sent_len / lens[i], cu, du);
+        raw_total += lens[i];
+        packed_total += sent_len;
+        c_us += (t1 - t0) / BENCH_ROUNDS;
+        d_us += (t2 - t1) / BENCH_ROUNDS;
+    }
+    double kb = raw_total / 1024.0;
+    printf("%6s %8zu %8zu %6.1f%% %10.1f %10.1f\n", "total", raw_total, packed_total,
+           100.0 * packed_total / raw_total, c_us / kb, d_us / kb);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc == 4 && !strcmp(argv[1], "d")) {
+        return cmd_decompress(argv[2], argv[3]);
+    }
+    if (argc == 4 && !strcmp(argv[1], "c")) {
+        return cmd_compress(argv[2], argv[3]);
+    }
+    if (argc >= 3 && !strcmp(argv[1], "bench")) {
+        return cmd_bench(argc - 2, argv + 2);
+    }
+    fprintf(stderr, "usage: %s d IN OUT | c IN OUT | bench FILE...\n", argv[0]);
+    return 2;
+}
@@ -0,0 +1,255 @@
+/*
+ * Host benchmark of the MQTT publish queue (esp-mqtt-outbox.c).
+ *
+ * Builds the device's publish queue as it is:
+ *     cc -O2 -I managed_components/espressif__rmaker_common/src/esp-mqtt -o mqtt_outbox_bench \
+ *         tools/mqtt_outbox_bench.c managed_components/espressif__rmaker_common/src/esp-mqtt/esp-mqtt-outbox.c
+ *
+ * Usage:
+ *     mqtt_outbox_bench [RTT_MS [KBYTES_PER_S [BURST_PERIOD_MS]]]
+ *
+ * Stands in for a broker with a link of the given round trip time (default 80 ms) and bandwidth
+ * (default 20 KB/s), in simulated time. Bursts of param reports, full-state param inits and alerts
+ * are published every BURST_PERIOD_MS (default 500, 0 for all at once), as they are when many
+ * params change at once:
+ *
+ *   - directly, as the glue did before: every publish writes its message with the MQTT client,
+ *     and the caller waits for the link to take it.
+ *   - through the queue, for a few QoS 1 windows: the caller only copies the message, which is
+ *     measured on the host, and the queue hands messages to the link as the window allows.
+ *
+ * Prints the time callers spend per publish, the publishes taken per second until the last
+ * acknowledgement, the bytes sent, and the time from the burst to the acknowledgement.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "esp-mqtt-outbox.h"
+
+#define BURSTS          50
+#define PACKET_HEADER   40          /* MQTT, TLS and TCP overhead per message */
+#define BUDGET          16384
+#define MAX_MSG_ID      65536
+
+typedef struct {
+    const char *topic;
+    size_t len;
+    bool coalesce;
+} bench_msg_t;
+
+/* One burst: param reports, full-state inits of the same node, which are coalesced, and alerts */
+static const bench_msg_t s_burst[] = {
+    { "node/7CDFA1B2C3D4/params/local", 200, false },
+    { "node/7CDFA1B2C3D4/params/local/init", 600, true },
+    { "node/7CDFA1B2C3D4/params/local", 200, false },
+    { "node/7CDFA1B2C3D4/params/local", 200, false },
+    { "node/7CDFA1B2C3D4/params/local/init", 600, true },
+    { "node/7CDFA1B2C3D4/alert", 100, false },
+    { "node/7CDFA1B2C3D4/params/local", 200, false },
+    { "node/7CDFA1B2C3D4/params/local", 200, false },
+    { "node/7CDFA1B2C3D4/params/local/init", 600, true },
+    { "node/7CDFA1B2C3D4/params/local", 200, false },
+    { "node/7CDFA1B2C3D4/params/local", 200, false },
+    { "node/7CDFA1B2C3D4/params/local/init", 600, true },
+    { "node/7CDFA1B2C3D4/alert", 100, false },
+    { "node/7CDFA1B2C3D4/params/local", 200, false },
+    { "node/7CDFA1B2C3D4/params/local", 200, false },
+    { "node/7CDFA1B2C3D4/params/local", 200, false },
+};
+#define BURST_LEN   (sizeof(s_burst) / sizeof(s_burst[0]))
+
+typedef struct {
+    double caller_us;       /* Per publish */
+    double caller_max_us;
+    unsigned published;     /* Taken, including the coalesced ones */
+    unsigned acked;
+    unsigned rejected;
+    double duration_us;     /* First publish to last acknowledgement */
+    unsigned long bytes;    /* Sent over the link */
+    double latency_sum_us;
+    double latency_max_us;
+} bench_result_t;
+
+static char s_payload[1024];
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static double write_us(size_t len, double bytes_per_us)
+{
+    return (len + PACKET_HEADER) / bytes_per_us;
+}
+
+static void record_latency(bench_result_t *res, double latency_us)
+{
+    res->acked++;
+    res->latency_sum_us += latency_us;
+    if (latency_us > res->latency_max_us) {
+        res->latency_max_us = latency_us;
+    }
+}
+
+/* Every publish writes to the link and waits for it, acknowledgements come a round trip later */
+static bench_result_t bench_direct(double rtt_us, double bytes_per_us, double period_us)
+{
+    bench_result_t res = { 0 };
+    double link_free = 0, last_ack = 0;
+    for (int burst = 0; burst < BURSTS; burst++) {
+        double burst_time = burst * period_us;
+        double t = burst_time;
+        for (size_t i = 0; i < BURST_LEN; i++) {
+            double start = t > link_free ? t : link_free;
+            double end = start + write_us(s_burst[i].len, bytes_per_us);
+            double blocked = end - t;
+            res.caller_us += blocked;
+            if (blocked > res.caller_max_us) {
+                res.caller_max_us = blocked;
+            }
+            link_free = end;
+            res.bytes += s_burst[i].len + PACKET_HEADER;
+            last_ack = end + rtt_us;
+            record_latency(&res, last_ack - burst_time);
+            res.published++;
+            t = end;
+        }
+    }
+    res.caller_us /= BURSTS * BURST_LEN;
+    res.duration_us = last_ack;
+    return res;
+}
+
+typedef struct {
+    int mqtt_msg_id;
+    double time;
+} bench_ack_t;
+
+/* Publishes are copied into the queue, which is drained onto the link as the window allows */
+static bench_result_t bench_queue(double rtt_us, double bytes_per_us, double period_us, uint8_t window)
+{
+    bench_result_t res = { 0 };
+    esp_mqtt_outbox_t outbox;
+    esp_mqtt_outbox_init(&outbox, BUDGET, window);
+    static double publish_time[MAX_MSG_ID];
+    bench_ack_t *acks = calloc(BURSTS * BURST_LEN, sizeof(bench_ack_t));
+    if (!acks) {
+        fprintf(stderr, "Out of memory\n");
+        exit(1);
+    }
+    int ack_head = 0, ack_tail = 0, next_mqtt_id = 1;
+    double link_free = 0, now = 0, last_ack = 0, push_ns = 0;
+    int burst = 0;
+
+    while (true) {
+        double next_burst = burst < BURSTS ? burst * period_us : -1;
+        double next_ack = ack_head < ack_tail ? acks[ack_head].time : -1;
+        bool can_send = outbox.head && (!outbox.head->qos || outbox.num_inflight < outbox.window);
+        double next_send = can_send ? (now > link_free ? now : link_free) : -1;
+
+        /* The earliest of the three, bursts first, then acknowledgements, which open the window */
+        double next = -1;
+        int what = -1;
+        double candidates[3] = { next_burst, next_ack, next_send };
+        for (int i = 0; i < 3; i++) {
+            if (candidates[i] >= 0 && (next < 0 || candidates[i] < next)) {
+                next = candidates[i];
+                what = i;
+            }
+        }
+        if (what < 0) {
+            break;
+        }
+        now = next;
+
+        if (what == 0) {
+            for (size_t i = 0; i < BURST_LEN; i++) {
+                double start = now_ns();
+                int msg_id = esp_mqtt_outbox_push(&outbox, s_burst[i].topic, s_payload, s_burst[i].len, 1,
+                                                  s_burst[i].coalesce, (int64_t)now);
+                double spent = (now_ns() - start) / 1000.0;
+                push_ns += spent * 1000.0;
+                if (spent > res.caller_max_us) {
+                    res.caller_max_us = spent;
+                }
+                if (msg_id < 0) {
+                    res.rejected++;
+                    continue;
+                }
+                res.published++;
+                if (publish_time[msg_id] == 0) {
+                    /* A coalesced message is as old as the one it replaced */
+                    publish_time[msg_id] = now + 1;
+                }
+            }
+            burst++;
+        } else if (what == 1) {
+            int64_t latency;
+            int msg_id = esp_mqtt_outbox_acked(&outbox, acks[ack_head].mqtt_msg_id, (int64_t)now, &latency);
+            ack_head++;
+            if (msg_id > 0) {
+                record_latency(&res, now - (publish_time[msg_id] - 1));
+                publish_time[msg_id] = 0;
+                last_ack = now;
+            }
+        } else {
+            esp_mqtt_outbox_msg_t *msg = esp_mqtt_outbox_pop(&outbox);
+            double end = now + write_us(msg->len, bytes_per_us);
+            res.bytes += msg->len + PACKET_HEADER;
+            link_free = end;
+            int mqtt_msg_id = next_mqtt_id++;
+            esp_mqtt_outbox_sent(&outbox, msg, mqtt_msg_id, (int64_t)now, NULL);
+            acks[ack_tail++] = (bench_ack_t) { mqtt_msg_id, end + rtt_us };
+        }
+    }
+    res.caller_us = push_ns / 1000.0 / (BURSTS * BURST_LEN);
+    res.duration_us = last_ack;
+    esp_mqtt_outbox_clear(&outbox);
+    free(acks);
+    return res;
+}
+
+static void print_result(const char *name, const bench_result_t *res)
+{
+    printf("%-12s %9.1f %9.1f %9.1f %8u %8u %9lu %9.1f %9.1f\n", name, res->caller_us, res->caller_max_us,
+           res->published / (res->duration_us / 1e6), res->acked, res->rejected, res->bytes,
+           res->latency_sum_us / res->acked / 1000.0, res->latency_max_us / 1000.0);
+}
+
+int main(int argc, char **argv)
+{
+    double rtt_ms = argc > 1 ? atof(argv[1]) : 80;
+    double kbytes_per_s = argc > 2 ? atof(argv[2]) : 20;
+    double period_ms = argc > 3 ? atof(argv[3]) : 500;
+    if (rtt_ms < 0 || kbytes_per_s <= 0 || period_ms < 0) {
+        fprintf(stderr, "Usage: %s [RTT_MS [KBYTES_PER_S [BURST_PERIOD_MS]]]\n", argv[0]);
+        return 1;
+    }
+    memset(s_payload, 'x', sizeof(s_payload));
+    double rtt_us = rtt_ms * 1000;
+    double bytes_per_us = kbytes_per_s * 1024 / 1e6;
+
+    double period_us = period_ms * 1000;
+
+    printf("RTT %.0f ms, %.0f KB/s, %d bursts of %zu publishes every %.0f ms\n", rtt_ms, kbytes_per_s,
+           BURSTS, BURST_LEN, period_ms);
+    printf("%-12s %9s %9s %9s %8s %8s %9s %9s %9s\n", "", "call(us)", "max(us)", "pub/s", "acked", "rejected",
+           "bytes", "avg(ms)", "max(ms)");
+    bench_result_t res = bench_direct(rtt_us, bytes_per_us, period_us);
+    print_result("direct", &res);
+    static const uint8_t windows[] = { 1, 2, 4, 8, 32 };
+    for (size_t i = 0; i < sizeof(windows) / sizeof(windows[0]); i++) {
+        char name[16];
+        snprintf(name, sizeof(name), "window %u", windows[i]);
+        res = bench_queue(rtt_us, bytes_per_us, period_us, windows[i]);
+        print_result(name, &res);
+    }
+    return 0;
+}
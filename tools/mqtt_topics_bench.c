@@ -0,0 +1,174 @@
+/*
+ * Host benchmark of the MQTT subscription dispatch (esp-mqtt-topics.c).
+ *
+ * Builds the device's topic tree as it is:
+ *     cc -O2 -I managed_components/espressif__rmaker_common/src/esp-mqtt -o mqtt_topics_bench \
+ *         tools/mqtt_topics_bench.c managed_components/espressif__rmaker_common/src/esp-mqtt/esp-mqtt-topics.c
+ *
+ * Usage:
+ *     mqtt_topics_bench [SUBSCRIPTIONS...]
+ *
+ * For each count of subscriptions (default 10 100 300 1000), subscribes to that many topics
+ * shaped like the RainMaker ones, one in 50 with '+', and dispatches messages on them and on
+ * topics nobody subscribed to. It does so with the flat array and matcher the glue used before,
+ * which knew no '#', and with the tree, checks that both find the same subscriptions, and prints
+ * the time per message.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "esp-mqtt-topics.h"
+
+#define MESSAGES        200000
+#define TOPIC_MAX       64
+
+typedef struct {
+    esp_mqtt_topic_entry_t entry;
+    char topic[TOPIC_MAX];
+    unsigned hits;
+} subscription_t;
+
+static const char *s_kinds[] = { "params/remote", "otaurl", "to-node", "user/mapping", "params/local/init" };
+#define NUM_KINDS   (sizeof(s_kinds) / sizeof(s_kinds[0]))
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/* The matcher of the flat array, as it was in esp-mqtt-glue.c, which knows '+' only */
+static bool flat_topic_matches(const char *topic_filter, const char *topic_name, int topic_len)
+{
+    const char *filter_pos = topic_filter;
+    const char *topic_pos = topic_name;
+    int topic_consumed = 0;
+
+    while (*filter_pos && topic_consumed < topic_len) {
+        if (*filter_pos == '+') {
+            while (topic_consumed < topic_len && *topic_pos != '/') {
+                topic_pos++;
+                topic_consumed++;
+            }
+            filter_pos++;
+        } else if (*filter_pos == *topic_pos) {
+            filter_pos++;
+            topic_pos++;
+            topic_consumed++;
+        } else {
+            return false;
+        }
+    }
+    return (*filter_pos == '\0' && topic_consumed == topic_len);
+}
+
+static void flat_dispatch(subscription_t *subs, int count, const char *topic, int len)
+{
+    for (int i = 0; i < count; i++) {
+        if (flat_topic_matches(subs[i].topic, topic, len)) {
+            subs[i].hits++;
+        }
+    }
+}
+
+static void tree_hit(esp_mqtt_topic_entry_t *entry, void *arg)
+{
+    ((subscription_t *)entry)->hits++;
+    (*(unsigned *)arg)++;
+}
+
+static void make_topic(char *buf, int node, int kind)
+{
+    snprintf(buf, TOPIC_MAX, "node/%08X%04X/%s", 0x7CDFA1u + node * 7919u, node, s_kinds[kind]);
+}
+
+static void bench(int count)
+{
+    subscription_t *subs = calloc(count, sizeof(subscription_t));
+    char (*topics)[TOPIC_MAX] = malloc(MESSAGES * sizeof(*topics));
+    if (!subs || !topics) {
+        fprintf(stderr, "Out of memory\n");
+        exit(1);
+    }
+    esp_mqtt_topics_t tree = { 0 };
+
+    /* One wildcard subscription in 50, which the flat matcher can do too */
+    for (int i = 0; i < count; i++) {
+        if (i % 50 == 49) {
+            snprintf(subs[i].topic, TOPIC_MAX, "node/+/%s", s_kinds[i % NUM_KINDS]);
+        } else {
+            make_topic(subs[i].topic, i / NUM_KINDS, i % NUM_KINDS);
+        }
+        esp_mqtt_topic_node_t *node = esp_mqtt_topics_get(&tree, subs[i].topic, true);
+        if (!node) {
+            fprintf(stderr, "Out of memory\n");
+            exit(1);
+        }
+        esp_mqtt_topics_add(node, &subs[i].entry);
+    }
+    /* Three in four messages are for a subscription, the others are not */
+    srand(count);
+    for (int i = 0; i < MESSAGES; i++) {
+        int sub = rand() % count;
+        int node = (i % 4 == 3) ? count + rand() % 1000 : sub / (int)NUM_KINDS;
+        make_topic(topics[i], node, sub % NUM_KINDS);
+    }
+
+    double start = now_ns();
+    for (int i = 0; i < MESSAGES; i++) {
+        flat_dispatch(subs, count, topics[i], strlen(topics[i]));
+    }
+    double flat_ns = (now_ns() - start) / MESSAGES;
+    unsigned long flat_hits = 0;
+    for (int i = 0; i < count; i++) {
+        flat_hits += subs[i].hits;
+        subs[i].hits = 0;
+    }
+
+    unsigned tree_hits = 0;
+    start = now_ns();
+    for (int i = 0; i < MESSAGES; i++) {
+        esp_mqtt_topics_match(&tree, topics[i], strlen(topics[i]), tree_hit, &tree_hits);
+    }
+    double tree_ns = (now_ns() - start) / MESSAGES;
+
+    /* Both have to find the same subscriptions */
+    bool same = (flat_hits == tree_hits);
+    for (int i = 0; i < count; i++) {
+        esp_mqtt_topics_remove(&subs[i].entry);
+    }
+    esp_mqtt_topics_prune(&tree);
+    same = same && !tree.root.children && !tree.buckets;
+
+    printf("%6d subscriptions: flat %8.1f ns/msg, tree %6.1f ns/msg, %5.1fx, %lu hits%s\n",
+           count, flat_ns, tree_ns, flat_ns / tree_ns, flat_hits, same ? "" : " MISMATCH");
+    free(topics);
+    free(subs);
+    if (!same) {
+        exit(1);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    static const int defaults[] = { 10, 100, 300, 1000 };
+    if (argc > 1) {
+        for (int i = 1; i < argc; i++) {
+            int count = atoi(argv[i]);
+            if (count > 0) {
+                bench(count);
+            }
+        }
+    } else {
+        for (size_t i = 0; i < sizeof(defaults) / sizeof(defaults[0]); i++) {
+            bench(defaults[i]);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,288 @@
+#!/usr/bin/env python3
+#
+# Client and load generator for the hub's local control service (_smarthub._tcp).
+# Protocol is described in main/app_local_ctrl.h. Find the hub with:
+#     avahi-browse -rt _smarthub._tcp
+# The key is printed, in hex and as a QR code, on the hub's serial console at boot.
+#
+# Examples:
+#     smarthub_ctl.py --host 192.168.1.50 --key <hex> get
+#     smarthub_ctl.py --host 192.168.1.50 --key <hex> set light 1
+#     smarthub_ctl.py --host 192.168.1.50 --key <hex> watch
+#     smarthub_ctl.py --host 192.168.1.50 --key <hex> bench --count 2000 --clients 4
+
+import argparse
+import hashlib
+import hmac
+import os
+import socket
+import statistics
+import struct
+import sys
+import threading
+import time
+
+DEFAULT_PORT = 8090
+TAG_LEN = 16
+
+KEY_OP, KEY_SEQ, KEY_DEV, KEY_VAL, KEY_STATUS, KEY_NONCE, KEY_MAC, KEY_STATE = range(8)
+OP_HELLO, OP_AUTH, OP_GET, OP_SET, OP_SUBSCRIBE, OP_EVENT = range(6)
+STATUS = ['OK', 'BAD_REQUEST', 'UNAUTHORIZED', 'INVALID_DEVICE', 'BUSY']
+DEVICES = ['fan', 'light', 'tv', 'plug', 'security']
+
+
+# Minimal CBOR for the subset the hub speaks: ints, byte strings, arrays, maps.
+
+def _cbor_head(major, n):
+    if n < 24:
+        return bytes([major << 5 | n])
+    if n < 0x100:
+        return bytes([major << 5 | 24, n])
+    if n < 0x10000:
+        return bytes([major << 5 | 25]) + struct.pack('>H', n)
+    return bytes([major << 5 | 26]) + struct.pack('>I', n)
+
+
+def cbor_encode(obj):
+    if isinstance(obj, bool):
+        return b'\xf5' if obj else b'\xf4'
+    if isinstance(obj, int):
+        return _cbor_head(0, obj) if obj >= 0 else _cbor_head(1, -1 - obj)
+    if isinstance(obj, bytes):
+        return _cbor_head(2, len(obj)) + obj
+    if isinstance(obj, (list, tuple)):
+        return _cbor_head(4, len(obj)) + b''.join(cbor_encode(x) for x in obj)
+    if isinstance(obj, dict):
+        return _cbor_head(5, len(obj)) + b''.join(cbor_encode(k) + cbor_encode(v) for k, v in obj.items())
+    raise TypeError(type(obj))
+
+
+def cbor_decode(buf, pos=0):
+    ib = buf[pos]
+    major, info = ib >> 5, ib & 0x1f
+    pos += 1
+    if major == 7:
+        return {20: False, 21: True, 22: None}[info], pos
+    if info < 24:
+        n = info
+    else:
+        size = {24: 1, 25: 2, 26: 4, 27: 8}[info]
+        n = int.from_bytes(buf[pos:pos + size], 'big')
+        pos += size
+    if major == 0:
+        return n, pos
+    if major == 1:
+        return -1 - n, pos
+    if major in (2, 3):
+        data = buf[pos:pos + n]
+        return (data if major == 2 else data.decode()), pos + n
+    if major == 4:
+        out = []
+        for _ in range(n):
+            v, pos = cbor_decode(buf, pos)
+            out.append(v)
+        return out, pos
+    if major == 5:
+        out = {}
+        for _ in range(n):
+            k, pos = cbor_decode(buf, pos)
+            out[k], pos = cbor_decode(buf, pos)
+        return out, pos
+    raise ValueError('unsupported CBOR major type %d' % major)
+
+
+class HubClient:
+    def __init__(self, host, port, key):
+        self.sock = socket.create_connection((host, port), timeout=5)
+        self.sock.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+        self.seq = 0
+        self.events = []
+        self.session = None
+        self.tx_ctr = self.rx_ctr = 0
+        hello = self._recv()
+        if hello.get(KEY_OP) != OP_HELLO:
+            raise RuntimeError('expected HELLO, got %r' % hello)
+        nonce = hello[KEY_NONCE]
+        mac = hmac.new(key, nonce, hashlib.sha256).digest()
+        self._send({KEY_OP: OP_AUTH, KEY_SEQ: 0, KEY_MAC: mac})
+        # Every frame from the hub's reply to AUTH on is tagged, unless AUTH failed.
+        payload = self._recv_frame()
+        self.session = hmac.new(key, b'session' + nonce, hashlib.sha256).digest()
+        body, tag = payload[:-TAG_LEN], payload[-TAG_LEN:]
+        if len(payload) > TAG_LEN and hmac.compare_digest(tag, self._tag(b'H', 0, body)):
+            self.rx_ctr = 1
+            return
+        rsp = cbor_decode(payload)[0]
+        raise RuntimeError('hub returned %s' % STATUS[rsp.get(KEY_STATUS, 0)])
+
+    def _tag(self, direction, ctr, payload):
+        return hmac.new(self.session, direction + struct.pack('>I', ctr) + payload, hashlib.sha256).digest()[:TAG_LEN]
+
+    def _send(self, msg):
+        payload = cbor_encode(msg)
+        if self.session:
+            payload += self._tag(b'C', self.tx_ctr, payload)
+            self.tx_ctr += 1
+        self.sock.sendall(struct.pack('>H', len(payload)) + payload)
+
+    def _recv_exact(self, n):
+        buf = b''
+        while len(buf) < n:
+            chunk = self.sock.recv(n - len(buf))
+            if not chunk:
+                raise ConnectionError('hub closed the connection')
+            buf += chunk
+        return buf
+
+    def _recv_frame(self):
+        (n,) = struct.unpack('>H', self._recv_exact(2))
+        return self._recv_exact(n)
+
+    def _recv(self):
+        payload = self._recv_frame()
+        if self.session:
+            payload, tag = payload[:-TAG_LEN], payload[-TAG_LEN:]
+            if not hmac.compare_digest(tag, self._tag(b'H', self.rx_ctr, payload)):
+                raise ConnectionError('frame from the hub has a bad tag')
+            self.rx_ctr += 1
+        return cbor_decode(payload)[0]
+
+    def recv_event(self):
+        if self.events:
+            return self.events.pop(0)
+        return self._recv()
+
+    def request(self, msg):
+        self.seq = (self.seq + 1) & 0xffff
+        msg[KEY_SEQ] = self.seq
+        self._send(msg)
+        while True:
+            rsp = self._recv()
+            if rsp.get(KEY_OP) == OP_EVENT:
+                self.events.append(rsp)
+                continue
+            status = rsp.get(KEY_STATUS, 0)
+            if status != 0:
+                raise RuntimeError('hub returned %s' % STATUS[status])
+            return rsp
+
+    def get(self, dev=None):
+        msg = {KEY_OP: OP_GET}
+        if dev is not None:
+            msg[KEY_DEV] = dev
+        return self.request(msg)
+
+    def set(self, dev, val):
+        return self.request({KEY_OP: OP_SET, KEY_DEV: dev, KEY_VAL: val})
+
+    def subscribe(self, on=True):
+        return self.request({KEY_OP: OP_SUBSCRIBE, KEY_VAL: int(on)})
+
+    def close(self):
+        self.sock.close()
+
+
+def fmt_state(state):
+    return ', '.join('%s=%d' % (name, v) for name, v in zip(DEVICES, state))
+
+
+def dev_index(name):
+    if name.isdigit():
+        return int(name)
+    return DEVICES.index(name.lower())
+
+
+def cmd_bench(args, key):
+    lat = []
+    busy = [0]
+    lock = threading.Lock()
+    per_client = args.count // args.clients
+
+    def worker(idx):
+        c = HubClient(args.host, args.port, key)
+        local = []
+        for i in range(per_client):
+            t0 = time.perf_counter()
+            if args.op == 'set':
+                try:
+                    c.set(DEVICES.index('plug'), (i + idx) & 1)
+                except RuntimeError:
+                    # BUSY: the actuation queue is full, the round trip still counts
+                    with lock:
+                        busy[0] += 1
+            else:
+                c.get(i % len(DEVICES))
+            local.append((time.perf_counter() - t0) * 1000.0)
+        c.close()
+        with lock:
+            lat.extend(local)
+
+    threads = [threading.Thread(target=worker, args=(i,)) for i in range(args.clients)]
+    t0 = time.perf_counter()
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+    elapsed = time.perf_counter() - t0
+
+    lat.sort()
+    print('%d %s requests over %d connection(s) in %.2f s: %.0f req/s' %
+          (len(lat), args.op, args.clients, elapsed, len(lat) / elapsed))
+    print('latency ms: min %.2f  p50 %.2f  p90 %.2f  p99 %.2f  max %.2f  mean %.2f' %
+          (lat[0], lat[len(lat) // 2], lat[int(len(lat) * 0.9)], lat[int(len(lat) * 0.99)],
+           lat[-1], statistics.mean(lat)))
+    if busy[0]:
+        print('%d set(s) rejected as BUSY' % busy[0])
+
+
+def main():
+    p = argparse.ArgumentParser(description='Smart Home hub local control client')
+    p.add_argument('--host', required=True)
+    p.add_argument('--port', type=int, default=DEFAULT_PORT)
+    p.add_argument('--key', default=os.environ.get('SMARTHUB_KEY'), help='hex key (or $SMARTHUB_KEY)')
+    sub = p.add_subparsers(dest='cmd', required=True)
+    g = sub.add_parser('get')
+    g.add_argument('device', nargs='?')
+    s = sub.add_parser('set')
+    s.add_argument('device')
+    s.add_argument('value', type=int)
+    sub.add_parser('watch')
+    b = sub.add_parser('bench')
+    b.add_argument('--count', type=int, default=1000)
+    b.add_argument('--clients', type=int, default=1)
+    b.add_argument('--op', choices=['get', 'set'], default='get')
+    args = p.parse_args()
+
+    if not args.key:
+        p.error('--key is required')
+    key = bytes.fromhex(args.key)
+
+    if args.cmd == 'bench':
+        cmd_bench(args, key)
+        return 0
+
+    c = HubClient(args.host, args.port, key)
+    if args.cmd == 'get':
+        if args.device:
+            rsp = c.get(dev_index(args.device))
+            print('%s=%d' % (DEVICES[rsp[KEY_DEV]], rsp[KEY_VAL]))
+        else:
+            print(fmt_state(c.get()[KEY_STATE]))
+    elif args.cmd == 'set':
+        c.set(dev_index(args.device), args.value)
+        print('OK')
+    elif args.cmd == 'watch':
+        c.sock.settimeout(None)
+        print(fmt_state(c.subscribe()[KEY_STATE]))
+        try:
+            while True:
+                ev = c.recv_event()
+                print('%s=%d' % (DEVICES[ev[KEY_DEV]], ev[KEY_VAL]))
+        except KeyboardInterrupt:
+            pass
+    c.close()
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
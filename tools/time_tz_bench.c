@@ -0,0 +1,380 @@
+/*
+ * Host check and benchmark of the timezone cache and ISO8601 parser (rmaker_common/src/time_tz.c).
+ *
+ Builds time_tz.c as it is:
+ *     cc -O2 -o time_tz_bench tools/time_tz_bench.c managed_components/espressif__rmaker_common/src/time_tz.c
+ *
+ * Usage:
+ *     time_tz_bench [CSV [ZONE...]]
+ *
+ * For each zone of the timezone database, read from tools/tz_db.csv (or CSV), or the ones given, parses its POSIX string and checks, against
+ * the host C library with TZ set to it, local time around every transition and on a grid from
+ * 2008 to 2037, and that mktime() gives back the time it was given, for standard time, daylight
+ * saving time and both ways of the ambiguous times. The C library may read a zoneinfo file named
+ * like the string, like EST5EDT, whose past rules differ, hence 2008 onwards. Checks the ISO8601
+ * parser against the sscanf() based one time.c had before, which is kept below.
+ *
+ * Then times, for a few zones, localtime_r() and mktime() of the C library against the cache,
+ * the former ISO8601 parser against the new one, and the former timegm loop against the days of
+ * a date worked out in closed form.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../managed_components/espressif__rmaker_common/src/time_tz.h"
+
+#define FIRST_YEAR      2008
+#define LAST_YEAR       2037
+#define GRID_STEP       (7 * 3600 + 13 * 60 + 17)
+#define ITERATIONS      1000000
+#define MAX_ZONES       1024
+
+typedef struct {
+    char name[64];
+    char posix[64];
+} bench_zone_t;
+
+static bench_zone_t s_zones[MAX_ZONES];
+static size_t s_count;
+
+static unsigned s_failures;
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/* The conversion time.c had before, as it was */
+static inline int old_is_leap(int y)
+{
+    return ((y % 4 == 0) && (y % 100 != 0)) || (y % 400 == 0);
+}
+
+static inline time_t old_rmaker_timegm(struct tm *tm)
+{
+    int year  = tm->tm_year + 1900;
+    int month = tm->tm_mon;
+    if (month < 0) { year += (month - 11) / 12; month = 12 + (month % 12); }
+    else if (month > 11) { year += month / 12; month %= 12; }
+
+    static const int mdays_cum[12] = {0,31,59,90,120,151,181,212,243,273,304,334};
+
+    int64_t days = 0;
+    if (year >= 1970) for (int y = 1970; y < year; ++y) days += 365 + old_is_leap(y);
+    else              for (int y = year;  y < 1970; ++y) days -= 365 + old_is_leap(y);
+
+    days += mdays_cum[month];
+    if (month > 1 && old_is_leap(year)) days += 1;
+    days += (tm->tm_mday - 1);
+
+    int64_t seconds = days * 86400LL
+                    + (int64_t)tm->tm_hour * 3600
+                    + (int64_t)tm->tm_min  * 60
+                    + (int64_t)tm->tm_sec;
+
+    return (time_t)seconds;
+}
+
+static int old_convert_iso8601_to_epoch(const char *str, int len, time_t *out_epoch)
+{
+    char buf[64];
+    int copy_len = 0;
+    if (len > 0) {
+        copy_len = (len < (int)sizeof(buf) - 1) ? len : (int)sizeof(buf) - 1;
+    } else {
+        size_t str_len = strlen(str);
+        copy_len = (str_len < sizeof(buf) - 1) ? (int)str_len : (int)sizeof(buf) - 1;
+    }
+    memcpy(buf, str, copy_len);
+    buf[copy_len] = '\0';
+
+    struct tm tm_utc = {0};
+    int year, month, day, hour, minute, second;
+    int tz_hour = 0, tz_minute = 0;
+    char tz_sign = '+';
+
+    if (sscanf(buf, "%d-%d-%dT%d:%d:%d%c%d:%d",
+               &year, &month, &day, &hour, &minute, &second,
+               &tz_sign, &tz_hour, &tz_minute) == 9) {
+    } else if (sscanf(buf, "%d-%d-%dT%d:%d:%dZ",
+                      &year, &month, &day, &hour, &minute, &second) == 6) {
+        size_t buf_len = strlen(buf);
+        if (buf_len < 20 || buf[19] != 'Z') {
+            return -1;
+        }
+        tz_hour = 0;
+        tz_minute = 0;
+        tz_sign = '+';
+    } else {
+        return -1;
+    }
+    tm_utc.tm_year = year - 1900;
+    tm_utc.tm_mon = month - 1;
+    tm_utc.tm_mday = day;
+    tm_utc.tm_hour = hour;
+    tm_utc.tm_min = minute;
+    tm_utc.tm_sec = second;
+    int total_offset_seconds = (tz_hour * 3600) + (tz_minute * 60);
+    if (tz_sign == '-') {
+        total_offset_seconds = -total_offset_seconds;
+    }
+    *out_epoch = old_rmaker_timegm(&tm_utc) - total_offset_seconds;
+    return 0;
+}
+
+/* Lines of "name","posix" */
+static void read_zones(const char *path)
+{
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        perror(path);
+        exit(1);
+    }
+    char line[256];
+    while (s_count < MAX_ZONES && fgets(line, sizeof(line), f)) {
+        bench_zone_t *zone = &s_zones[s_count];
+        if (line[0] != '#' && sscanf(line, "\"%63[^\"]\",\"%63[^\"]\"", zone->name, zone->posix) == 2) {
+            s_count++;
+        }
+    }
+    fclose(f);
+}
+
+static void set_tz(const char *posix)
+{
+    setenv("TZ", posix, 1);
+    tzset();
+}
+
+static void fail(const char *zone, const char *what, time_t t)
+{
+    if (s_failures++ < 20) {
+        fprintf(stderr, "%s: %s at %lld\n", zone, what, (long long)t);
+    }
+}
+
+static void check_instant(const char *zone, esp_rmaker_tz_cache_t *cache, time_t t)
+{
+    struct tm ref, got;
+    localtime_r(&t, &ref);
+    esp_rmaker_tz_localtime(cache, t, &got);
+    if (ref.tm_year != got.tm_year || ref.tm_mon != got.tm_mon || ref.tm_mday != got.tm_mday ||
+            ref.tm_hour != got.tm_hour || ref.tm_min != got.tm_min || ref.tm_sec != got.tm_sec ||
+            ref.tm_wday != got.tm_wday || ref.tm_yday != got.tm_yday || ref.tm_isdst != got.tm_isdst) {
+        fail(zone, "localtime differs", t);
+        return;
+    }
+    /* Back, with the DST flag as found */
+    struct tm back = got;
+    if (esp_rmaker_tz_mktime(cache, &back) != t || memcmp(&back, &got, sizeof(back)) != 0) {
+        fail(zone, "mktime does not give the time back", t);
+    }
+    /* Without it, the first of two local times which are the same */
+    back = got;
+    back.tm_isdst = -1;
+    time_t first = esp_rmaker_tz_mktime(cache, &back);
+    int32_t offset = got.tm_isdst ? cache->rule.dst_offset : cache->rule.std_offset;
+    int32_t other_offset = got.tm_isdst ? cache->rule.std_offset : cache->rule.dst_offset;
+    if (first != t && !(first < t && first == t + offset - other_offset)) {
+        fail(zone, "mktime of an unknown DST differs", t);
+    }
+}
+
+static void check_zone(const char *zone, const char *posix)
+{
+    esp_rmaker_tz_rule_t rule;
+    if (esp_rmaker_tz_parse(posix, &rule) != 0) {
+        fail(zone, "cannot parse", 0);
+        return;
+    }
+    set_tz(posix);
+    esp_rmaker_tz_cache_t cache;
+    esp_rmaker_tz_cache_init(&cache, &rule, 0);
+    time_t first = esp_rmaker_time_days_from_civil(FIRST_YEAR, 1, 1) * 86400;
+    time_t last = esp_rmaker_time_days_from_civil(LAST_YEAR + 1, 1, 1) * 86400;
+    for (time_t t = first; t < last; t += GRID_STEP) {
+        check_instant(zone, &cache, t);
+    }
+    if (!rule.has_dst) {
+        return;
+    }
+    for (int year = FIRST_YEAR; year <= LAST_YEAR; year++) {
+        esp_rmaker_tz_cache_init(&cache, &rule, esp_rmaker_time_days_from_civil(year, 6, 1) * 86400);
+        esp_rmaker_tz_year_t entry = cache.years[1];
+        const time_t around[] = { entry.dst_start, entry.dst_end };
+        for (int i = 0; i < 2; i++) {
+            for (int delta = -3601; delta <= 3601; delta += 1800) {
+                check_instant(zone, &cache, around[i] + delta);
+            }
+            check_instant(zone, &cache, around[i] - 1);
+            check_instant(zone, &cache, around[i]);
+        }
+    }
+}
+
+static void check_iso8601(void)
+{
+    static const char *bad[] = {
+        "2025-08-12T06:49:11", "2025-13-12T06:49:11Z", "2025-02-29T06:49:11Z", "2025-08-12T24:49:11Z",
+        "2025-08-12X06:49:11Z", "2025-08-12T06:49:11+5:30", "2025-08-12T06:49:11.Z", "20250812T064911Z",
+        "2025-08-12T06:49:11+05", "2025-08-12T06:49:11.123",
+    };
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+        time_t t;
+        if (esp_rmaker_time_parse_iso8601(bad[i], strlen(bad[i]), &t) == 0) {
+            fail(bad[i], "accepted", t);
+        }
+    }
+    srand(7);
+    for (int i = 0; i < 200000; i++) {
+        struct tm tm;
+        esp_rmaker_time_gmtime((time_t)(rand() % 3000000) * 1000 + rand() % 1000, &tm);
+        char str[48];
+        int zone = rand() % 3;
+        int zone_minutes = (rand() % (14 * 60 + 1)) * (rand() % 2 ? 1 : -1);
+        int len = snprintf(str, sizeof(str), "%04d-%02d-%02dT%02d:%02d:%02d", tm.tm_year + 1900, tm.tm_mon + 1,
+                           tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec);
+        if (zone == 0) {
+            len += snprintf(str + len, sizeof(str) - len, "Z");
+        } else {
+            len += snprintf(str + len, sizeof(str) - len, "%c%02d:%02d", zone_minutes < 0 ? '-' : '+',
+                            abs(zone_minutes) / 60, abs(zone_minutes) % 60);
+        }
+        time_t ref, got;
+        if (old_convert_iso8601_to_epoch(str, len, &ref) != 0 || esp_rmaker_time_parse_iso8601(str, len, &got) != 0 ||
+                ref != got) {
+            fail(str, "parsed differently", 0);
+        }
+    }
+    const char *frac = "2025-08-12T06:49:11.123456+05:30";
+    time_t t;
+    if (esp_rmaker_time_parse_iso8601(frac, strlen(frac), &t) != 0 || t != 1754981351 - 5 * 3600 - 30 * 60) {
+        fail(frac, "parsed wrongly", 0);
+    }
+}
+
+static void bench_zone(const char *posix)
+{
+    esp_rmaker_tz_rule_t rule;
+    esp_rmaker_tz_cache_t cache;
+    esp_rmaker_tz_parse(posix, &rule);
+    time_t base = 1760000000;
+    esp_rmaker_tz_cache_init(&cache, &rule, base);
+    set_tz(posix);
+    struct tm tm;
+    volatile long sink = 0;
+
+    double start = now_ns();
+    for (int i = 0; i < ITERATIONS; i++) {
+        time_t t = base + (time_t)i * 97;
+        localtime_r(&t, &tm);
+        sink += tm.tm_hour;
+    }
+    double libc_local = (now_ns() - start) / ITERATIONS;
+    start = now_ns();
+    for (int i = 0; i < ITERATIONS; i++) {
+        esp_rmaker_tz_localtime(&cache, base + (time_t)i * 97, &tm);
+        sink += tm.tm_hour;
+    }
+    double cache_local = (now_ns() - start) / ITERATIONS;
+
+    start = now_ns();
+    for (int i = 0; i < ITERATIONS; i++) {
+        localtime_r(&base, &tm);
+        tm.tm_mday += i % 400;
+        tm.tm_isdst = -1;
+        sink += mktime(&tm);
+    }
+    double libc_mk = (now_ns() - start) / ITERATIONS;
+    start = now_ns();
+    for (int i = 0; i < ITERATIONS; i++) {
+        esp_rmaker_tz_localtime(&cache, base, &tm);
+        tm.tm_mday += i % 400;
+        tm.tm_isdst = -1;
+        sink += esp_rmaker_tz_mktime(&cache, &tm);
+    }
+    double cache_mk = (now_ns() - start) / ITERATIONS;
+
+    start = now_ns();
+    for (int i = 0; i < ITERATIONS / 10; i++) {
+        esp_rmaker_tz_parse(posix, &rule);
+        esp_rmaker_tz_cache_init(&cache, &rule, base);
+        sink += cache.until;
+    }
+    double setup = (now_ns() - start) / (ITERATIONS / 10);
+    printf("%-36s %9.1f %9.1f %9.1f %9.1f %9.1f\n", posix, libc_local, cache_local, libc_mk, cache_mk, setup);
+}
+
+static void bench_iso8601(void)
+{
+    static const char *strs[] = {
+        "2025-08-12T06:49:11Z", "2031-02-28T23:59:59+05:30", "2019-12-31T00:00:00-08:00", "2040-06-15T12:30:45Z",
+    };
+    volatile time_t sink = 0;
+    double start = now_ns();
+    for (int i = 0; i < ITERATIONS; i++) {
+        time_t t;
+        old_convert_iso8601_to_epoch(strs[i & 3], 0, &t);
+        sink += t;
+    }
+    double old_ns = (now_ns() - start) / ITERATIONS;
+    start = now_ns();
+    for (int i = 0; i < ITERATIONS; i++) {
+        time_t t;
+        esp_rmaker_time_parse_iso8601(strs[i & 3], strlen(strs[i & 3]), &t);
+        sink += t;
+    }
+    double new_ns = (now_ns() - start) / ITERATIONS;
+
+    struct tm tm = { .tm_year = 130, .tm_mon = 5, .tm_mday = 15 };
+    start = now_ns();
+    for (int i = 0; i < ITERATIONS; i++) {
+        tm.tm_year = 100 + (i & 63);
+        sink += old_rmaker_timegm(&tm);
+    }
+    double old_timegm = (now_ns() - start) / ITERATIONS;
+    start = now_ns();
+    for (int i = 0; i < ITERATIONS; i++) {
+        sink += esp_rmaker_time_days_from_civil(2000 + (i & 63), 6, 15);
+    }
+    double new_timegm = (now_ns() - start) / ITERATIONS;
+    printf("ISO8601 (ns): sscanf %.1f, fixed positions %.1f; days of a date: loop %.1f, closed form %.1f\n",
+           old_ns, new_ns, old_timegm, new_timegm);
+}
+
+int main(int argc, char **argv)
+{
+    read_zones(argc > 1 ? argv[1] : "tools/tz_db.csv");
+    size_t checked = 0;
+    for (size_t i = 0; i < s_count; i++) {
+        bool wanted = argc < 3;
+        for (int arg = 2; arg < argc && !wanted; arg++) {
+            wanted = strcmp(argv[arg], s_zones[i].name) == 0;
+        }
+        if (wanted) {
+            check_zone(s_zones[i].name, s_zones[i].posix);
+            checked++;
+        }
+    }
+    check_iso8601();
+    printf("%zu zones checked, %u failures\n", checked, s_failures);
+    if (s_failures) {
+        return 1;
+    }
+
+    printf("%-36s %9s %9s %9s %9s %9s\n", "ns per call", "localtime", "cache", "mktime", "cache", "setup");
+    static const char *bench_zones[] = {
+        "CST-8", "PST8PDT,M3.2.0,M11.1.0", "CET-1CEST,M3.5.0,M10.5.0/3", "AEST-10AEDT,M10.1.0,M4.1.0/3",
+        "<+1245>-12:45<+1345>,M9.5.0/2:45,M4.1.0/3:45",
+    };
+    for (size_t i = 0; i < sizeof(bench_zones) / sizeof(bench_zones[0]); i++) {
+        bench_zone(bench_zones[i]);
+    }
+    bench_iso8601();
+    return 0;
+}
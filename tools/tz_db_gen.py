@@ -0,0 +1,169 @@
+#!/usr/bin/env python3
+#
+# Generates the timezone database of rmaker_common (src/timezone_db.h) from tools/tz_db.csv.
+#
+#     tz_db_gen.py [CSV [OUTPUT]]
+#
+# Zones are looked up by name, lowercased and without underscores, as esp_rmaker_tz_db_get_posix_str()
+# has always compared them. The names are stored that way, sorted, in blocks of BLOCK_ZONES: each
+# one as the length of the prefix it shares with the one before, then the rest, so that only the
+# first of a block is stored whole. A binary search on the first names finds the block, which is
+# then scanned. The POSIX strings are stored once each, and one which ends another is not stored
+# at all, the zones have the index of theirs.
+#
+# Run after editing tools/tz_db.csv, and check the result with tools/tz_db_test.c.
+
+import csv
+import os
+import sys
+
+BLOCK_ZONES = 16
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+DEFAULT_CSV = os.path.join(ROOT, 'tools', 'tz_db.csv')
+DEFAULT_OUTPUT = os.path.join(ROOT, 'managed_components', 'espressif__rmaker_common', 'src', 'timezone_db.h')
+
+
+def zone_key(name):
+    return name.lower().replace('_', '')
+
+
+def read_zones(path):
+    zones = {}
+    with open(path, newline='') as f:
+        for row in csv.reader(line for line in f if not line.startswith('#')):
+            if not row:
+                continue
+            name, posix = row
+            key = zone_key(name)
+            if key in zones:
+                sys.exit('%s: %s is there twice' % (path, name))
+            zones[key] = posix
+    return sorted(zones.items(), key=lambda zone: zone[0].encode())
+
+
+def pack_posix(strings):
+    """Concatenates the strings, NUL terminated, each pointing into a longer one it ends"""
+    blob = b''
+    offsets = {}
+    for s in sorted(strings, key=lambda s: (-len(s), s)):
+        data = s.encode() + b'\0'
+        found = blob.find(data)
+        if found < 0:
+            found = len(blob)
+            blob += data
+        offsets[s] = found
+    return blob, offsets
+
+
+def pack_zones(zones, posix_index):
+    data = bytearray()
+    blocks = []
+    prev = b''
+    for i, (key, posix) in enumerate(zones):
+        name = key.encode()
+        if i % BLOCK_ZONES == 0:
+            blocks.append(len(data))
+            shared = 0
+        else:
+            shared = 0
+            while shared < min(len(prev), len(name)) and prev[shared] == name[shared]:
+                shared += 1
+        suffix = name[shared:]
+        if len(name) > 255 or posix_index[posix] > 255:
+            sys.exit('%s does not fit' % key)
+        data += bytes([shared, len(suffix)]) + suffix + bytes([posix_index[posix]])
+        prev = name
+    return bytes(data), blocks
+
+
+def unpack(zones_data, blocks, posix_blob, posix_offsets):
+    """Reads the zones back, as timezone.c does"""
+    out = []
+    for b, start in enumerate(blocks):
+        end = blocks[b + 1] if b + 1 < len(blocks) else len(zones_data)
+        pos = start
+        name = b''
+        while pos < end:
+            shared, suffix_len = zones_data[pos], zones_data[pos + 1]
+            name = name[:shared] + zones_data[pos + 2:pos + 2 + suffix_len]
+            offset = posix_offsets[zones_data[pos + 2 + suffix_len]]
+            posix = posix_blob[offset:posix_blob.index(b'\0', offset)]
+            out.append((name.decode(), posix.decode()))
+            pos += 3 + suffix_len
+    return out
+
+
+def c_string(data, indent):
+    """The blob as string literals, one per NUL terminated string"""
+    lines = []
+    for s in data.split(b'\0')[:-1]:
+        lines.append('%s"%s\\0"' % (indent, s.decode().replace('\\', '\\\\').replace('"', '\\"')))
+    return '\n'.join(lines)
+
+
+def c_array(values, fmt, indent, per_line):
+    lines = []
+    for i in range(0, len(values), per_line):
+        lines.append(indent + ', '.join(fmt % v for v in values[i:i + per_line]) + ',')
+    return '\n'.join(lines)
+
+
+def main():
+    csv_path = sys.argv[1] if len(sys.argv) > 1 else DEFAULT_CSV
+    output = sys.argv[2] if len(sys.argv) > 2 else DEFAULT_OUTPUT
+    zones = read_zones(csv_path)
+    strings = sorted(set(posix for _, posix in zones))
+    posix_blob, offsets = pack_posix(strings)
+    posix_offsets = [offsets[s] for s in strings]
+    posix_index = {s: i for i, s in enumerate(strings)}
+    zones_data, blocks = pack_zones(zones, posix_index)
+    if unpack(zones_data, blocks, posix_blob, posix_offsets) != zones:
+        sys.exit('The zones do not read back')
+    if len(posix_blob) > 0xffff or len(zones_data) > 0xffff:
+        sys.exit('The database does not fit')
+    size = len(posix_blob) + 2 * len(posix_offsets) + len(zones_data) + 2 * len(blocks)
+
+    with open(output, 'w') as f:
+        f.write('''/*
+ * Generated by tools/tz_db_gen.py from tools/tz_db.csv, do not edit.
+ *
+ * %d zones with %d POSIX strings, in %d bytes.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#define TZ_DB_ZONES         %d
+#define TZ_DB_BLOCKS        %d
+#define TZ_DB_KEY_MAX       %d
+
+/* POSIX strings, NUL terminated */
+static const char tz_db_posix[] =
+%s;
+
+static const uint16_t tz_db_posix_offsets[%d] = {
+%s
+};
+
+/* Zones, lowercased without underscores and sorted, in blocks of %d: the length of the prefix
+ * shared with the zone before, the length of the rest, the rest and the index of the POSIX string.
+ */
+static const uint8_t tz_db_zones[%d] = {
+%s
+};
+
+/* Offsets of the blocks in tz_db_zones */
+static const uint16_t tz_db_blocks[TZ_DB_BLOCKS] = {
+%s
+};
+''' % (len(zones), len(strings), size, len(zones), len(blocks), max(len(key) for key, _ in zones),
+            c_string(posix_blob, '    '), len(posix_offsets), c_array(posix_offsets, '%d', '    ', 12),
+            BLOCK_ZONES, len(zones_data), c_array(list(zones_data), '0x%02x', '    ', 12),
+            c_array(blocks, '%d', '    ', 12)))
+    print('%d zones with %d POSIX strings, in %d bytes, written to %s' % (len(zones), len(strings), size, output))
+
+
+if __name__ == '__main__':
+    main()
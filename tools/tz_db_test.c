@@ -0,0 +1,200 @@
+/*
+ * Host test and benchmark of the timezone database (rmaker_common/src/timezone.c and timezone_db.h).
+ *
+ * Builds timezone.c as it is, with the database generated by tools/tz_db_gen.py:
+ *     cc -O2 -o tz_db_test tools/tz_db_test.c
+ *
+ * Usage:
+ *     tz_db_test [CSV]
+ *
+ * Reads the zones from tools/tz_db.csv (or CSV) and checks that every one of them is found, with
+ * its POSIX string, also in upper case and without underscores, as the lookup has always allowed,
+ * and that names which are not in the database, like a zone with a character more or less, are
+ * not. Exits with 1 on a failure.
+ *
+ * Then prints the size of the database against the table of name and POSIX string pointers the
+ * database was before, on a 32 bit target, and times lookups with both. The former lookup is kept
+ * below.
+ */
+
+#include <ctype.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../managed_components/espressif__rmaker_common/src/timezone.c"
+
+#define MAX_ZONES       1024
+#define LOOKUPS         2000000
+
+typedef struct {
+    const char *name;
+    const char *posix_str;
+} old_tz_db_pair_t;
+
+static old_tz_db_pair_t s_zones[MAX_ZONES];
+static size_t s_count;
+static unsigned s_failures;
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/* The lookup timezone.c had before, as it was */
+static int old_tz_name_cmp(const char * target, const char * other)
+{
+    if (!target || !other) {
+        return -1;
+    }
+
+    while (*target) {
+        if (lower(*target) != lower(*other)) {
+            break;
+        }
+        do {
+            target++;
+        } while (*target == '_');
+        do {
+            other++;
+        } while (*other == '_');
+    }
+
+    return lower(*target) - lower(*other);
+}
+
+static const char *old_get_posix_str(const char *name)
+{
+    int lo = 0, hi = s_count;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        old_tz_db_pair_t mid_pair = s_zones[mid];
+        int comparison = old_tz_name_cmp(name, mid_pair.name);
+        if (comparison == 0) {
+            return mid_pair.posix_str;
+        } else if (comparison < 0) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+    return NULL;
+}
+
+/* Lines of "name","posix" */
+static void read_zones(const char *path)
+{
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        perror(path);
+        exit(1);
+    }
+    char line[256];
+    while (fgets(line, sizeof(line), f)) {
+        char name[128], posix[128];
+        if (line[0] == '#' || sscanf(line, "\"%127[^\"]\",\"%127[^\"]\"", name, posix) != 2) {
+            continue;
+        }
+        if (s_count == MAX_ZONES) {
+            fprintf(stderr, "Too many zones\n");
+            exit(1);
+        }
+        s_zones[s_count].name = strdup(name);
+        s_zones[s_count].posix_str = strdup(posix);
+        s_count++;
+    }
+    fclose(f);
+}
+
+static void expect(const char *name, const char *posix)
+{
+    const char *got = esp_rmaker_tz_db_get_posix_str(name);
+    if ((posix == NULL) != (got == NULL) || (posix && strcmp(posix, got) != 0)) {
+        if (s_failures++ < 20) {
+            fprintf(stderr, "%s: expected %s, got %s\n", name, posix ? posix : "nothing", got ? got : "nothing");
+        }
+    }
+}
+
+static void check_zones(void)
+{
+    if (s_count != TZ_DB_ZONES) {
+        fprintf(stderr, "%zu zones in the CSV, %d in the database, run tools/tz_db_gen.py\n", s_count, TZ_DB_ZONES);
+        s_failures++;
+    }
+    for (size_t i = 0; i < s_count; i++) {
+        const char *name = s_zones[i].name;
+        expect(name, s_zones[i].posix_str);
+
+        char variant[160];
+        size_t len = strlen(name);
+        for (size_t j = 0; j <= len; j++) {
+            variant[j] = toupper((unsigned char)name[j]);
+        }
+        expect(variant, s_zones[i].posix_str);
+        size_t k = 0;
+        for (size_t j = 0; j <= len; j++) {
+            if (name[j] != '_') {
+                variant[k++] = name[j];
+            }
+        }
+        expect(variant, s_zones[i].posix_str);
+
+        /* A character more or less, unless that is another zone */
+        snprintf(variant, sizeof(variant), "%sx", name);
+        expect(variant, old_get_posix_str(variant));
+        snprintf(variant, sizeof(variant), "%.*s", (int)len - 1, name);
+        expect(variant, old_get_posix_str(variant));
+        snprintf(variant, sizeof(variant), "0%s", name);
+        expect(variant, NULL);
+    }
+    expect("", NULL);
+    expect(NULL, NULL);
+    expect("America/Los_Angeles/With/A/Name/Longer/Than/Any/Zone", NULL);
+}
+
+static void bench(void)
+{
+    size_t strings = 0;
+    for (size_t i = 0; i < s_count; i++) {
+        strings += strlen(s_zones[i].name) + 1;
+        /* The compiler keeps one copy of the same string */
+        bool seen = false;
+        for (size_t j = 0; j < i && !seen; j++) {
+            seen = strcmp(s_zones[i].posix_str, s_zones[j].posix_str) == 0;
+        }
+        strings += seen ? 0 : strlen(s_zones[i].posix_str) + 1;
+    }
+    size_t old_size = strings + s_count * 2 * 4;
+    size_t new_size = sizeof(tz_db_posix) + sizeof(tz_db_posix_offsets) + sizeof(tz_db_zones) + sizeof(tz_db_blocks);
+    printf("flash: table %zu bytes (%zu of pointers), database %zu bytes\n", old_size, s_count * 2 * 4, new_size);
+
+    volatile size_t sink = 0;
+    double start = now_ns();
+    for (int i = 0; i < LOOKUPS; i++) {
+        sink += (size_t)old_get_posix_str(s_zones[(size_t)i * 7919 % s_count].name);
+    }
+    double old_ns = (now_ns() - start) / LOOKUPS;
+    start = now_ns();
+    for (int i = 0; i < LOOKUPS; i++) {
+        sink += (size_t)esp_rmaker_tz_db_get_posix_str(s_zones[(size_t)i * 7919 % s_count].name);
+    }
+    double new_ns = (now_ns() - start) / LOOKUPS;
+    printf("lookup: table %.1f ns, database %.1f ns\n", old_ns, new_ns);
+}
+
+int main(int argc, char **argv)
+{
+    read_zones(argc > 1 ? argv[1] : "tools/tz_db.csv");
+    check_zones();
+    printf("%zu zones checked, %u failures\n", s_count, s_failures);
+    if (s_failures) {
+        return 1;
+    }
+    bench();
+    return 0;
+}